@@ -0,0 +1 @@
+bin\TextureConverter.exe -configFile=bin\DirectStorageSample.json -variants=none,gdeflate-fastest,gdeflate-default,gdeflate-best
\ No newline at end of file
@@ -19,6 +19,19 @@
 
 #pragma once
 
+// Quality tier 0 is the full texture. Tier N drops the top N mips.
+static const uint32_t c_DirectStorageSampleMaxQualityTiers = 3;
+
+// Describes one quality tier of a texture stored in the texture data file.
+struct DirectStorageSampleTextureQualityTier
+{
+    D3D12_RESOURCE_DESC resourceDesc;
+    DSTORAGE_COMPRESSION_FORMAT compressionFormat;
+    uint64_t resourceSizeCompressed;
+    uint64_t resourceSizeUncompressed;
+    int64_t resourceOffset;
+};
+
 struct DirectStorageSampleTextureMetadataHeader
 {
     D3D12_RESOURCE_DESC resourceDesc;
@@ -27,5 +40,120 @@ struct DirectStorageSampleTextureMetadataHeader
     uint64_t resourceSizeUncompressed;
     int64_t resourceOffset;
     wchar_t resourceName[MAX_PATH]; // This is the name of the resource this header describes. It's just the file name.
+
+    uint32_t qualityTierCount; // Includes the full texture, so this is at least 1.
+    DirectStorageSampleTextureQualityTier reducedQualityTiers[c_DirectStorageSampleMaxQualityTiers - 1]; // Tiers 1 and up.
+};
+
+inline DirectStorageSampleTextureQualityTier GetTextureQualityTier(const DirectStorageSampleTextureMetadataHeader& header, uint32_t qualityTier)
+{
+    // Textures without enough mips for the requested tier use their smallest tier.
+    qualityTier = qualityTier < header.qualityTierCount ? qualityTier : header.qualityTierCount - 1;
+
+    if (qualityTier == 0)
+    {
+        return DirectStorageSampleTextureQualityTier{ header.resourceDesc, header.compressionFormat, header.resourceSizeCompressed, header.resourceSizeUncompressed, header.resourceOffset };
+    }
+
+    return header.reducedQualityTiers[qualityTier - 1];
+}
+
+// Placement tables live next to the metadata in Placement.bin. They are only valid for the adapter and driver they were computed on.
+static const uint32_t c_DirectStorageSamplePlacementVersion = 1;
+
+struct DirectStorageSamplePlacementAdapterKey
+{
+    uint32_t vendorId;
+    uint32_t deviceId;
+    uint32_t subSysId;
+    uint32_t revision;
+    uint64_t driverVersion;
+};
+
+struct DirectStorageSamplePlacementHeader
+{
+    uint32_t version;
+    uint32_t textureCount; // Same order as the metadata headers.
+    uint32_t qualityTierCount;
+    DirectStorageSamplePlacementAdapterKey adapterKey;
+    uint64_t heapSize[c_DirectStorageSampleMaxQualityTiers];
+    uint64_t heapAlignment[c_DirectStorageSampleMaxQualityTiers];
+};
+
+// Followed by qualityTierCount * textureCount of these, all textures of tier 0 first.
+struct DirectStorageSampleTexturePlacement
+{
+    uint64_t heapOffset;
+    uint64_t sizeInBytes;
+    uint64_t alignment; // Placed resources must be created with this alignment in their desc.
+};
+
+// Packages converted with -textureRegions store every texture as separately compressed regions, listed in Regions.bin.
+// Each region is read with its own request, smallest mips first, so no request is bigger than c_DirectStorageSampleMaxRegionSize.
+// The tiers of a texture share its regions, tier N just skips the regions of the top N mips.
+static const uint32_t c_DirectStorageSampleRegionVersion = 1;
+static const uint32_t c_DirectStorageSampleMaxRegionSize = 16 * 1024 * 1024; // Uncompressed. Bigger subresources are split into rows, or depth slices.
+
+struct DirectStorageSampleRegionHeader
+{
+    uint32_t version;
+    uint32_t textureCount; // Same order as the metadata headers.
+    uint64_t textureDataSize; // Size of the texture data file the regions are in, catches a table left over from another conversion.
+};
+
+// Followed by textureCount of these, then all the regions.
+struct DirectStorageSampleTextureRegionRange
+{
+    uint32_t firstRegion;
+    uint32_t regionCount;
+};
+
+struct DirectStorageSampleTextureRegion
+{
+    uint32_t mipLevel; // Of the full texture.
+    uint32_t arraySlice;
+    D3D12_BOX box; // Texels of the mip, rows of block compressed textures start on a block.
+    DSTORAGE_COMPRESSION_FORMAT compressionFormat;
+    uint32_t sizeCompressed;
+    uint32_t sizeUncompressed; // Laid out like GetCopyableFootprints lays out a texture the size of the box.
+    int64_t offset; // In the texture data file.
+};
+
+// Packages converted with -textureTiles also store 2D textures as 64KiB tiles of a reserved resource, listed in Tiles.bin.
+// The tiles come after the texture's regular data, so the package still loads without them.
+// A texture's packed mips come first, then the tiles of its standard mips, smallest mip first and row by row.
+static const uint32_t c_DirectStorageSampleTileVersion = 1;
+
+struct DirectStorageSampleTileHeader
+{
+    uint32_t version;
+    uint32_t textureCount; // Same order as the metadata headers.
+    uint64_t textureDataSize; // Size of the texture data file the tiles are in, catches a table left over from another conversion.
+};
+
+// Followed by textureCount of these, then all the tiles.
+struct DirectStorageSampleTextureTiles
+{
+    uint32_t tileWidth; // Texels, the standard tile shape the converter expected the device to use.
+    uint32_t tileHeight;
+    uint32_t standardMipCount; // 0 if the texture isn't stored as tiles.
+    uint32_t firstTile;
+    uint32_t tileCount;
+
+    // The packed mips, laid out like GetCopyableFootprints lays out the subresources from standardMipCount on.
+    DSTORAGE_COMPRESSION_FORMAT packedCompressionFormat;
+    uint32_t packedSizeCompressed;
+    uint32_t packedSizeUncompressed;
+    int64_t packedOffset;
+};
+
+struct DirectStorageSampleTile
+{
+    uint32_t mipLevel;
+    uint32_t x; // In tiles.
+    uint32_t y;
+    DSTORAGE_COMPRESSION_FORMAT compressionFormat;
+    uint32_t sizeCompressed; // Uncompressed, every tile is D3D12_TILED_RESOURCE_TILE_SIZE_IN_BYTES, zero padded past the edge of the mip.
+    int64_t offset;
 };
 
@@ -0,0 +1,110 @@
+// AMD SampleDX12 sample code
+// 
+// Copyright(c) 2023 Advanced Micro Devices, Inc.All rights reserved.
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+
+#include "HeapPlacement.h"
+#include <dxgi1_4.h>
+#include <wrl/client.h>
+#include <numeric>
+#include <algorithm>
+
+using Microsoft::WRL::ComPtr;
+
+static uint64_t AlignUp(uint64_t value, uint64_t alignment)
+{
+    return ((value + alignment - 1) / alignment) * alignment;
+}
+
+D3D12_RESOURCE_ALLOCATION_INFO ComputeHeapPlacement(ID3D12Device* const pDevice, const std::vector<D3D12_RESOURCE_DESC>& resourceDescs, std::vector<DirectStorageSampleTexturePlacement>& placementsOut)
+{
+    placementsOut.resize(resourceDescs.size());
+
+    for (size_t resourceIdx = 0; resourceIdx < resourceDescs.size(); resourceIdx++)
+    {
+        // Ask for small alignment first, the runtime hands back the default alignment if the texture doesn't qualify.
+        D3D12_RESOURCE_DESC resourceDesc = resourceDescs[resourceIdx];
+        resourceDesc.Alignment = D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT;
+        D3D12_RESOURCE_ALLOCATION_INFO allocInfo = pDevice->GetResourceAllocationInfo(0, 1, &resourceDesc);
+        if (allocInfo.Alignment != D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT)
+        {
+            resourceDesc.Alignment = 0;
+            allocInfo = pDevice->GetResourceAllocationInfo(0, 1, &resourceDesc);
+        }
+
+        auto& placement = placementsOut[resourceIdx];
+        placement.sizeInBytes = allocInfo.SizeInBytes;
+        placement.alignment = allocInfo.Alignment;
+    }
+
+    // Largest alignment first, so the 4KiB textures fill in behind the 64KiB ones without gaps.
+    std::vector<size_t> placementOrder(placementsOut.size());
+    std::iota(placementOrder.begin(), placementOrder.end(), 0);
+    std::stable_sort(placementOrder.begin(), placementOrder.end()
+        , [&placementsOut](size_t lhs, size_t rhs) { return placementsOut[lhs].alignment > placementsOut[rhs].alignment; });
+
+    D3D12_RESOURCE_ALLOCATION_INFO heapAllocInfo{ 0, D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT };
+    for (const auto resourceIdx : placementOrder)
+    {
+        auto& placement = placementsOut[resourceIdx];
+        placement.heapOffset = AlignUp(heapAllocInfo.SizeInBytes, placement.alignment);
+        heapAllocInfo.SizeInBytes = placement.heapOffset + placement.sizeInBytes;
+        heapAllocInfo.Alignment = (std::max)(heapAllocInfo.Alignment, placement.alignment);
+    }
+    heapAllocInfo.SizeInBytes = AlignUp(heapAllocInfo.SizeInBytes, heapAllocInfo.Alignment);
+
+    return heapAllocInfo;
+}
+
+DirectStorageSamplePlacementAdapterKey GetPlacementAdapterKey(ID3D12Device* const pDevice)
+{
+    DirectStorageSamplePlacementAdapterKey adapterKey{};
+
+    ComPtr<IDXGIFactory4> pFactory;
+    ComPtr<IDXGIAdapter1> pAdapter;
+    if (FAILED(CreateDXGIFactory1(IID_PPV_ARGS(&pFactory))) || FAILED(pFactory->EnumAdapterByLuid(pDevice->GetAdapterLuid(), IID_PPV_ARGS(&pAdapter))))
+    {
+        return adapterKey;
+    }
+
+    DXGI_ADAPTER_DESC1 adapterDesc{};
+    if (SUCCEEDED(pAdapter->GetDesc1(&adapterDesc)))
+    {
+        adapterKey.vendorId = adapterDesc.VendorId;
+        adapterKey.deviceId = adapterDesc.DeviceId;
+        adapterKey.subSysId = adapterDesc.SubSysId;
+        adapterKey.revision = adapterDesc.Revision;
+    }
+
+    // Layouts can change with the driver, so it is part of the key.
+    LARGE_INTEGER driverVersion{};
+    if (SUCCEEDED(pAdapter->CheckInterfaceSupport(__uuidof(IDXGIDevice), &driverVersion)))
+    {
+        adapterKey.driverVersion = driverVersion.QuadPart;
+    }
+
+    return adapterKey;
+}
+
+bool IsSamePlacementAdapterKey(const DirectStorageSamplePlacementAdapterKey& lhs, const DirectStorageSamplePlacementAdapterKey& rhs)
+{
+    return lhs.vendorId == rhs.vendorId
+        && lhs.deviceId == rhs.deviceId
+        && lhs.subSysId == rhs.subSysId
+        && lhs.revision == rhs.revision
+        && lhs.driverVersion == rhs.driverVersion;
+}
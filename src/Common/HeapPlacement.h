@@ -0,0 +1,33 @@
+// AMD SampleDX12 sample code
+// 
+// Copyright(c) 2023 Advanced Micro Devices, Inc.All rights reserved.
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+
+#pragma once
+
+#include <vector>
+#include <d3d12.h>
+#include <dstorage.h>
+#include "DirectStorageSampleTexturePackageFormat.h"
+
+// Lays out textures in one heap. Textures that qualify for 4KiB small resource alignment are packed together after the 64KiB aligned ones.
+// Returns the heap size and alignment, placementsOut follows the order of resourceDescs.
+D3D12_RESOURCE_ALLOCATION_INFO ComputeHeapPlacement(ID3D12Device* const pDevice, const std::vector<D3D12_RESOURCE_DESC>& resourceDescs, std::vector<DirectStorageSampleTexturePlacement>& placementsOut);
+
+// Identifies the adapter and driver placement tables were computed with.
+DirectStorageSamplePlacementAdapterKey GetPlacementAdapterKey(ID3D12Device* const pDevice);
+bool IsSamePlacementAdapterKey(const DirectStorageSamplePlacementAdapterKey& lhs, const DirectStorageSamplePlacementAdapterKey& rhs);
@@ -0,0 +1,86 @@
+// AMD SampleDX12 sample code
+// 
+// Copyright(c) 2023 Advanced Micro Devices, Inc.All rights reserved.
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+
+
+#pragma once
+
+#include <atomic>
+#include <utility>
+
+// Unbounded multiple producer, single consumer queue. Push is lock free and never blocks, any thread may call it.
+// Only one thread may call TryPop. A push that's still linking its node can hide the ones after it for a moment,
+// so producers should wake the consumer after pushing rather than the consumer counting on seeing everything.
+// Items must be default constructible. Every push allocates a node.
+template<typename T>
+class MpscQueue
+{
+public:
+    MpscQueue()
+        : m_pHead(new Node)
+        , m_pTail(m_pHead.load())
+    {
+    }
+
+    ~MpscQueue()
+    {
+        T item;
+        while (TryPop(item))
+        {
+        }
+        delete m_pTail;
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    void Push(T item)
+    {
+        Node* pNode = new Node;
+        pNode->item = std::move(item);
+
+        // Claim the head, then link the old one to us. Pushes are ordered by the exchange.
+        Node* pPrev = m_pHead.exchange(pNode, std::memory_order_acq_rel);
+        pPrev->pNext.store(pNode, std::memory_order_release);
+    }
+
+    bool TryPop(T& itemOut)
+    {
+        // The tail is a dummy, the first item is in the node after it, which becomes the next dummy.
+        Node* pNext = m_pTail->pNext.load(std::memory_order_acquire);
+        if (!pNext)
+        {
+            return false;
+        }
+
+        itemOut = std::move(pNext->item);
+        delete m_pTail;
+        m_pTail = pNext;
+        return true;
+    }
+
+private:
+    struct Node
+    {
+        T item{};
+        std::atomic<Node*> pNext{ nullptr };
+    };
+
+    std::atomic<Node*> m_pHead;
+    Node* m_pTail; // Consumer only.
+};
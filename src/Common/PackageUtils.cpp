@@ -184,7 +184,7 @@ std::vector<FileInfo> GetSupportedFilesInfo(const std::wstring& basePath, const
                     if (!(findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY))
                     {
                         std::wstring foundPath = searchPath + findData.cFileName;
-                        fileInfos.push_back({ std::move(foundPath),findData.nFileSizeHigh | findData.nFileSizeLow });
+                        fileInfos.push_back({ std::move(foundPath),(static_cast<uint64_t>(findData.nFileSizeHigh) << 32) | findData.nFileSizeLow });
                     }
                 } while (FindNextFileW(searchHandle, &findData));
             }
@@ -203,4 +203,137 @@ std::vector<FileInfo> GetSupportedFilesInfo(const std::string& basePath, const s
     std::transform(searchStrings.begin(), searchStrings.end(), searchStringsW.begin(), [&utf8utf16converter](const std::string& s) {return utf8utf16converter.from_bytes(s); });
 
     return GetSupportedFilesInfo(utf8utf16converter.from_bytes(basePath), searchStringsW);
+}
+
+static std::wstring GetPackageFileName(const wchar_t* const baseName, const std::wstring& variantName, const wchar_t* const extension = L".bin")
+{
+    if (variantName.empty())
+    {
+        return std::wstring(baseName) + extension;
+    }
+
+    return std::wstring(baseName) + L"_" + variantName + extension;
+}
+
+std::wstring GetMetaDataFileName(const std::wstring& variantName)
+{
+    return GetPackageFileName(L"MetaData", variantName);
+}
+
+std::wstring GetTextureDataFileName(const std::wstring& variantName)
+{
+    return GetPackageFileName(L"TextureData", variantName);
+}
+
+std::wstring GetPlacementFileName(const std::wstring& variantName)
+{
+    return GetPackageFileName(L"Placement", variantName);
+}
+
+std::wstring GetRegionFileName(const std::wstring& variantName)
+{
+    return GetPackageFileName(L"Regions", variantName);
+}
+
+std::wstring GetTileFileName(const std::wstring& variantName)
+{
+    return GetPackageFileName(L"Tiles", variantName);
+}
+
+std::wstring GetManifestFileName(const std::wstring& variantName)
+{
+    return GetPackageFileName(L"PackageManifest", variantName, L".json");
+}
+
+static const uint32_t c_PackageManifestVersion = 1;
+
+bool WritePackageManifest(const std::wstring& path, const std::vector<PackageManifestEntry>& entries)
+{
+    std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>, wchar_t> converter;
+    auto fileInfoToJson = [&converter](const FileInfo& fileInfo) { return json{ {"path", converter.to_bytes(fileInfo.Name)}, {"size", fileInfo.Size} }; };
+
+    json manifest;
+    manifest["version"] = c_PackageManifestVersion;
+    manifest["packages"] = json::array();
+    for (const auto& entry : entries)
+    {
+        json package;
+        package["sceneDirectory"] = converter.to_bytes(entry.sceneDirectory);
+        package["sceneFilename"] = converter.to_bytes(entry.sceneFilename);
+        package["metaData"] = fileInfoToJson(entry.metaData);
+        package["textureData"] = fileInfoToJson(entry.textureData);
+        if (!entry.placement.Name.empty())
+        {
+            package["placement"] = fileInfoToJson(entry.placement);
+        }
+        if (!entry.regions.Name.empty())
+        {
+            package["regions"] = fileInfoToJson(entry.regions);
+        }
+        if (!entry.tiles.Name.empty())
+        {
+            package["tiles"] = fileInfoToJson(entry.tiles);
+        }
+        if (!entry.textureHeapSizes.empty())
+        {
+            package["textureHeapSizes"] = entry.textureHeapSizes;
+        }
+        manifest["packages"].push_back(std::move(package));
+    }
+
+    std::ofstream manifestStream(path, std::ios::out | std::ios::trunc);
+    if (!manifestStream)
+    {
+        return false;
+    }
+    manifestStream << manifest.dump(4) << std::endl;
+
+    return manifestStream.good();
+}
+
+bool ReadPackageManifest(const std::wstring& path, std::vector<PackageManifestEntry>& entriesOut)
+{
+    std::ifstream manifestStream(path, std::ios::in | std::ios::binary);
+    if (!manifestStream)
+    {
+        return false;
+    }
+
+    json manifest = json::parse(manifestStream, nullptr, false);
+    if (manifest.is_discarded() || manifest.value("version", 0u) != c_PackageManifestVersion)
+    {
+        return false;
+    }
+
+    std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>, wchar_t> converter;
+    auto jsonToFileInfo = [&converter](const json& fileInfo) { return FileInfo{ converter.from_bytes(fileInfo["path"].get<std::string>()), fileInfo["size"].get<uint64_t>() }; };
+
+    entriesOut.clear();
+    for (const auto& package : manifest["packages"])
+    {
+        PackageManifestEntry entry;
+        entry.sceneDirectory = converter.from_bytes(package["sceneDirectory"].get<std::string>());
+        entry.sceneFilename = converter.from_bytes(package["sceneFilename"].get<std::string>());
+        entry.metaData = jsonToFileInfo(package["metaData"]);
+        entry.textureData = jsonToFileInfo(package["textureData"]);
+        if (package.find("placement") != package.end())
+        {
+            entry.placement = jsonToFileInfo(package["placement"]);
+        }
+        if (package.find("regions") != package.end())
+        {
+            entry.regions = jsonToFileInfo(package["regions"]);
+        }
+        if (package.find("tiles") != package.end())
+        {
+            entry.tiles = jsonToFileInfo(package["tiles"]);
+        }
+        if (package.find("textureHeapSizes") != package.end())
+        {
+            entry.textureHeapSizes = package["textureHeapSizes"].get<std::vector<uint64_t>>();
+        }
+        entriesOut.push_back(std::move(entry));
+    }
+
+    return true;
 }
\ No newline at end of file
@@ -35,4 +35,28 @@ bool IsSameDirectory(const std::wstring& dir1, const std::wstring& dir2);
 std::vector<FileInfo> GetSupportedFilesInfo(const std::wstring& basePath, const std::vector<std::wstring>& searchStrings);
 std::vector<FileInfo> GetSupportedFilesInfo(const std::string& basePath, const std::vector<std::string>& searchStrings);
 
+// Package file names for a named variant. An empty variant name maps to the original MetaData.bin/TextureData.bin names.
+std::wstring GetMetaDataFileName(const std::wstring& variantName);
+std::wstring GetTextureDataFileName(const std::wstring& variantName);
+std::wstring GetPlacementFileName(const std::wstring& variantName);
+std::wstring GetRegionFileName(const std::wstring& variantName);
+std::wstring GetTileFileName(const std::wstring& variantName);
+
+// The converter lists every package of a variant in one manifest next to DirectStorageSample.json, so startup doesn't have to search for them.
+struct PackageManifestEntry
+{
+    std::wstring sceneDirectory; // As written in DirectStorageSample.json.
+    std::wstring sceneFilename;
+    FileInfo metaData;
+    FileInfo textureData;
+    FileInfo placement; // Empty name if the package has no placement table.
+    FileInfo regions; // Empty name unless the textures were stored as regions.
+    FileInfo tiles; // Empty name unless the textures were also stored as tiles.
+    std::vector<uint64_t> textureHeapSizes; // Placed heap size of the textures per quality tier, on the converting adapter. Lets a load be budgeted before its metadata is read.
+};
+
+std::wstring GetManifestFileName(const std::wstring& variantName);
+bool WritePackageManifest(const std::wstring& path, const std::vector<PackageManifestEntry>& entries);
+bool ReadPackageManifest(const std::wstring& path, std::vector<PackageManifestEntry>& entriesOut);
+
 
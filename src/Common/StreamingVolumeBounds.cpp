@@ -0,0 +1,472 @@
+// AMD SampleDX12 sample code
+// 
+// Copyright(c) 2023 Advanced Micro Devices, Inc.All rights reserved.
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "StreamingVolumeBounds.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <immintrin.h>
+
+// MSVC lets any function use the wide instructions, GCC and Clang have to be told which ones may.
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define TARGET_AVX2
+#define TARGET_AVX512
+#else
+#include <cpuid.h>
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#define TARGET_AVX512 __attribute__((target("avx512f")))
+#endif
+
+// Nothing is ever inside a box with a negative size, and it's infinitely far away.
+static const float c_PaddingRadius = -FLT_MAX;
+
+struct BoundsArrays
+{
+    const float* centerX;
+    const float* centerY;
+    const float* centerZ;
+    const float* radiusX;
+    const float* radiusY;
+    const float* radiusZ;
+};
+
+// Kernels work on whole batches of 16, the arrays are padded so that's always safe to read.
+// The indexed ones look the volumes up through the index list, 16 indices per batch.
+typedef void (*ContainmentKernel)(const BoundsArrays& bounds, const float point[3], float margin, size_t first, size_t batchCount, uint8_t* insideOut);
+typedef void (*IndexedContainmentKernel)(const BoundsArrays& bounds, const float point[3], float margin, const uint32_t* indices, size_t batchCount, uint8_t* insideOut);
+typedef void (*DistanceKernel)(const BoundsArrays& bounds, const float point[3], size_t first, size_t batchCount, float* distancesOut);
+typedef void (*IndexedDistanceKernel)(const BoundsArrays& bounds, const float point[3], const uint32_t* indices, size_t batchCount, float* distancesOut);
+
+//--------------------------------------------------------------------------------------
+//
+// Scalar
+//
+//--------------------------------------------------------------------------------------
+static inline uint8_t IsInsideScalar(const BoundsArrays& bounds, const float point[3], float margin, uint32_t volumeIndex)
+{
+    return fabsf(point[0] - bounds.centerX[volumeIndex]) <= bounds.radiusX[volumeIndex] + margin &&
+        fabsf(point[1] - bounds.centerY[volumeIndex]) <= bounds.radiusY[volumeIndex] + margin &&
+        fabsf(point[2] - bounds.centerZ[volumeIndex]) <= bounds.radiusZ[volumeIndex] + margin;
+}
+
+static inline float GetSignedDistanceScalar(const BoundsArrays& bounds, const float point[3], uint32_t volumeIndex)
+{
+    const float qx = fabsf(point[0] - bounds.centerX[volumeIndex]) - bounds.radiusX[volumeIndex];
+    const float qy = fabsf(point[1] - bounds.centerY[volumeIndex]) - bounds.radiusY[volumeIndex];
+    const float qz = fabsf(point[2] - bounds.centerZ[volumeIndex]) - bounds.radiusZ[volumeIndex];
+    const float ox = std::max(qx, 0.0f);
+    const float oy = std::max(qy, 0.0f);
+    const float oz = std::max(qz, 0.0f);
+    return sqrtf(ox * ox + oy * oy + oz * oz) + std::min(std::max(qx, std::max(qy, qz)), 0.0f);
+}
+
+static void ContainmentScalar(const BoundsArrays& bounds, const float point[3], float margin, size_t first, size_t batchCount, uint8_t* insideOut)
+{
+    for (size_t i = 0; i < batchCount * 16; i++)
+    {
+        insideOut[i] = IsInsideScalar(bounds, point, margin, static_cast<uint32_t>(first + i));
+    }
+}
+
+static void IndexedContainmentScalar(const BoundsArrays& bounds, const float point[3], float margin, const uint32_t* indices, size_t batchCount, uint8_t* insideOut)
+{
+    for (size_t i = 0; i < batchCount * 16; i++)
+    {
+        insideOut[i] = IsInsideScalar(bounds, point, margin, indices[i]);
+    }
+}
+
+static void DistanceScalar(const BoundsArrays& bounds, const float point[3], size_t first, size_t batchCount, float* distancesOut)
+{
+    for (size_t i = 0; i < batchCount * 16; i++)
+    {
+        distancesOut[i] = GetSignedDistanceScalar(bounds, point, static_cast<uint32_t>(first + i));
+    }
+}
+
+static void IndexedDistanceScalar(const BoundsArrays& bounds, const float point[3], const uint32_t* indices, size_t batchCount, float* distancesOut)
+{
+    for (size_t i = 0; i < batchCount * 16; i++)
+    {
+        distancesOut[i] = GetSignedDistanceScalar(bounds, point, indices[i]);
+    }
+}
+
+//--------------------------------------------------------------------------------------
+//
+// AVX2, 8 volumes at a time
+//
+//--------------------------------------------------------------------------------------
+struct BoxesAVX2
+{
+    __m256 centerX, centerY, centerZ;
+    __m256 radiusX, radiusY, radiusZ;
+};
+
+static TARGET_AVX2 inline BoxesAVX2 LoadBoxesAVX2(const BoundsArrays& bounds, size_t first)
+{
+    return {
+        _mm256_loadu_ps(bounds.centerX + first), _mm256_loadu_ps(bounds.centerY + first), _mm256_loadu_ps(bounds.centerZ + first),
+        _mm256_loadu_ps(bounds.radiusX + first), _mm256_loadu_ps(bounds.radiusY + first), _mm256_loadu_ps(bounds.radiusZ + first) };
+}
+
+static TARGET_AVX2 inline BoxesAVX2 GatherBoxesAVX2(const BoundsArrays& bounds, const uint32_t* indices)
+{
+    const __m256i index = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(indices));
+    return {
+        _mm256_i32gather_ps(bounds.centerX, index, 4), _mm256_i32gather_ps(bounds.centerY, index, 4), _mm256_i32gather_ps(bounds.centerZ, index, 4),
+        _mm256_i32gather_ps(bounds.radiusX, index, 4), _mm256_i32gather_ps(bounds.radiusY, index, 4), _mm256_i32gather_ps(bounds.radiusZ, index, 4) };
+}
+
+static TARGET_AVX2 inline __m256 AbsAVX2(__m256 value)
+{
+    return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), value);
+}
+
+static TARGET_AVX2 inline void StoreInsideAVX2(const BoxesAVX2& boxes, const float point[3], float margin, uint8_t* insideOut)
+{
+    const __m256 marginV = _mm256_set1_ps(margin);
+    const __m256 insideX = _mm256_cmp_ps(AbsAVX2(_mm256_sub_ps(_mm256_set1_ps(point[0]), boxes.centerX)), _mm256_add_ps(boxes.radiusX, marginV), _CMP_LE_OQ);
+    const __m256 insideY = _mm256_cmp_ps(AbsAVX2(_mm256_sub_ps(_mm256_set1_ps(point[1]), boxes.centerY)), _mm256_add_ps(boxes.radiusY, marginV), _CMP_LE_OQ);
+    const __m256 insideZ = _mm256_cmp_ps(AbsAVX2(_mm256_sub_ps(_mm256_set1_ps(point[2]), boxes.centerZ)), _mm256_add_ps(boxes.radiusZ, marginV), _CMP_LE_OQ);
+    const int mask = _mm256_movemask_ps(_mm256_and_ps(insideX, _mm256_and_ps(insideY, insideZ)));
+    for (int lane = 0; lane < 8; lane++)
+    {
+        insideOut[lane] = (mask >> lane) & 1;
+    }
+}
+
+static TARGET_AVX2 inline void StoreDistanceAVX2(const BoxesAVX2& boxes, const float point[3], float* distancesOut)
+{
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 qx = _mm256_sub_ps(AbsAVX2(_mm256_sub_ps(_mm256_set1_ps(point[0]), boxes.centerX)), boxes.radiusX);
+    const __m256 qy = _mm256_sub_ps(AbsAVX2(_mm256_sub_ps(_mm256_set1_ps(point[1]), boxes.centerY)), boxes.radiusY);
+    const __m256 qz = _mm256_sub_ps(AbsAVX2(_mm256_sub_ps(_mm256_set1_ps(point[2]), boxes.centerZ)), boxes.radiusZ);
+    const __m256 ox = _mm256_max_ps(qx, zero);
+    const __m256 oy = _mm256_max_ps(qy, zero);
+    const __m256 oz = _mm256_max_ps(qz, zero);
+    const __m256 outside = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(ox, ox), _mm256_add_ps(_mm256_mul_ps(oy, oy), _mm256_mul_ps(oz, oz))));
+    const __m256 inside = _mm256_min_ps(_mm256_max_ps(qx, _mm256_max_ps(qy, qz)), zero);
+    _mm256_storeu_ps(distancesOut, _mm256_add_ps(outside, inside));
+}
+
+static TARGET_AVX2 void ContainmentAVX2(const BoundsArrays& bounds, const float point[3], float margin, size_t first, size_t batchCount, uint8_t* insideOut)
+{
+    for (size_t i = 0; i < batchCount * 16; i += 8)
+    {
+        StoreInsideAVX2(LoadBoxesAVX2(bounds, first + i), point, margin, insideOut + i);
+    }
+}
+
+static TARGET_AVX2 void IndexedContainmentAVX2(const BoundsArrays& bounds, const float point[3], float margin, const uint32_t* indices, size_t batchCount, uint8_t* insideOut)
+{
+    for (size_t i = 0; i < batchCount * 16; i += 8)
+    {
+        StoreInsideAVX2(GatherBoxesAVX2(bounds, indices + i), point, margin, insideOut + i);
+    }
+}
+
+static TARGET_AVX2 void DistanceAVX2(const BoundsArrays& bounds, const float point[3], size_t first, size_t batchCount, float* distancesOut)
+{
+    for (size_t i = 0; i < batchCount * 16; i += 8)
+    {
+        StoreDistanceAVX2(LoadBoxesAVX2(bounds, first + i), point, distancesOut + i);
+    }
+}
+
+static TARGET_AVX2 void IndexedDistanceAVX2(const BoundsArrays& bounds, const float point[3], const uint32_t* indices, size_t batchCount, float* distancesOut)
+{
+    for (size_t i = 0; i < batchCount * 16; i += 8)
+    {
+        StoreDistanceAVX2(GatherBoxesAVX2(bounds, indices + i), point, distancesOut + i);
+    }
+}
+
+//--------------------------------------------------------------------------------------
+//
+// AVX-512, 16 volumes at a time
+//
+//--------------------------------------------------------------------------------------
+struct BoxesAVX512
+{
+    __m512 centerX, centerY, centerZ;
+    __m512 radiusX, radiusY, radiusZ;
+};
+
+static TARGET_AVX512 inline BoxesAVX512 LoadBoxesAVX512(const BoundsArrays& bounds, size_t first)
+{
+    return {
+        _mm512_loadu_ps(bounds.centerX + first), _mm512_loadu_ps(bounds.centerY + first), _mm512_loadu_ps(bounds.centerZ + first),
+        _mm512_loadu_ps(bounds.radiusX + first), _mm512_loadu_ps(bounds.radiusY + first), _mm512_loadu_ps(bounds.radiusZ + first) };
+}
+
+static TARGET_AVX512 inline BoxesAVX512 GatherBoxesAVX512(const BoundsArrays& bounds, const uint32_t* indices)
+{
+    const __m512i index = _mm512_loadu_si512(indices);
+    return {
+        _mm512_i32gather_ps(index, bounds.centerX, 4), _mm512_i32gather_ps(index, bounds.centerY, 4), _mm512_i32gather_ps(index, bounds.centerZ, 4),
+        _mm512_i32gather_ps(index, bounds.radiusX, 4), _mm512_i32gather_ps(index, bounds.radiusY, 4), _mm512_i32gather_ps(index, bounds.radiusZ, 4) };
+}
+
+static TARGET_AVX512 inline void StoreInsideAVX512(const BoxesAVX512& boxes, const float point[3], float margin, uint8_t* insideOut)
+{
+    const __m512 marginV = _mm512_set1_ps(margin);
+    __mmask16 mask = _mm512_cmp_ps_mask(_mm512_abs_ps(_mm512_sub_ps(_mm512_set1_ps(point[0]), boxes.centerX)), _mm512_add_ps(boxes.radiusX, marginV), _CMP_LE_OQ);
+    mask = _mm512_mask_cmp_ps_mask(mask, _mm512_abs_ps(_mm512_sub_ps(_mm512_set1_ps(point[1]), boxes.centerY)), _mm512_add_ps(boxes.radiusY, marginV), _CMP_LE_OQ);
+    mask = _mm512_mask_cmp_ps_mask(mask, _mm512_abs_ps(_mm512_sub_ps(_mm512_set1_ps(point[2]), boxes.centerZ)), _mm512_add_ps(boxes.radiusZ, marginV), _CMP_LE_OQ);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(insideOut), _mm512_cvtepi32_epi8(_mm512_maskz_mov_epi32(mask, _mm512_set1_epi32(1))));
+}
+
+static TARGET_AVX512 inline void StoreDistanceAVX512(const BoxesAVX512& boxes, const float point[3], float* distancesOut)
+{
+    const __m512 zero = _mm512_setzero_ps();
+    const __m512 qx = _mm512_sub_ps(_mm512_abs_ps(_mm512_sub_ps(_mm512_set1_ps(point[0]), boxes.centerX)), boxes.radiusX);
+    const __m512 qy = _mm512_sub_ps(_mm512_abs_ps(_mm512_sub_ps(_mm512_set1_ps(point[1]), boxes.centerY)), boxes.radiusY);
+    const __m512 qz = _mm512_sub_ps(_mm512_abs_ps(_mm512_sub_ps(_mm512_set1_ps(point[2]), boxes.centerZ)), boxes.radiusZ);
+    const __m512 ox = _mm512_max_ps(qx, zero);
+    const __m512 oy = _mm512_max_ps(qy, zero);
+    const __m512 oz = _mm512_max_ps(qz, zero);
+    const __m512 outside = _mm512_sqrt_ps(_mm512_fmadd_ps(ox, ox, _mm512_fmadd_ps(oy, oy, _mm512_mul_ps(oz, oz))));
+    const __m512 inside = _mm512_min_ps(_mm512_max_ps(qx, _mm512_max_ps(qy, qz)), zero);
+    _mm512_storeu_ps(distancesOut, _mm512_add_ps(outside, inside));
+}
+
+static TARGET_AVX512 void ContainmentAVX512(const BoundsArrays& bounds, const float point[3], float margin, size_t first, size_t batchCount, uint8_t* insideOut)
+{
+    for (size_t i = 0; i < batchCount * 16; i += 16)
+    {
+        StoreInsideAVX512(LoadBoxesAVX512(bounds, first + i), point, margin, insideOut + i);
+    }
+}
+
+static TARGET_AVX512 void IndexedContainmentAVX512(const BoundsArrays& bounds, const float point[3], float margin, const uint32_t* indices, size_t batchCount, uint8_t* insideOut)
+{
+    for (size_t i = 0; i < batchCount * 16; i += 16)
+    {
+        StoreInsideAVX512(GatherBoxesAVX512(bounds, indices + i), point, margin, insideOut + i);
+    }
+}
+
+static TARGET_AVX512 void DistanceAVX512(const BoundsArrays& bounds, const float point[3], size_t first, size_t batchCount, float* distancesOut)
+{
+    for (size_t i = 0; i < batchCount * 16; i += 16)
+    {
+        StoreDistanceAVX512(LoadBoxesAVX512(bounds, first + i), point, distancesOut + i);
+    }
+}
+
+static TARGET_AVX512 void IndexedDistanceAVX512(const BoundsArrays& bounds, const float point[3], const uint32_t* indices, size_t batchCount, float* distancesOut)
+{
+    for (size_t i = 0; i < batchCount * 16; i += 16)
+    {
+        StoreDistanceAVX512(GatherBoxesAVX512(bounds, indices + i), point, distancesOut + i);
+    }
+}
+
+//--------------------------------------------------------------------------------------
+//
+// StreamingVolumeBounds
+//
+//--------------------------------------------------------------------------------------
+static const ContainmentKernel c_ContainmentKernels[] = { ContainmentScalar, ContainmentAVX2, ContainmentAVX512 };
+static const IndexedContainmentKernel c_IndexedContainmentKernels[] = { IndexedContainmentScalar, IndexedContainmentAVX2, IndexedContainmentAVX512 };
+static const DistanceKernel c_DistanceKernels[] = { DistanceScalar, DistanceAVX2, DistanceAVX512 };
+static const IndexedDistanceKernel c_IndexedDistanceKernels[] = { IndexedDistanceScalar, IndexedDistanceAVX2, IndexedDistanceAVX512 };
+
+static BoundsArrays GetBoundsArrays(const std::vector<float>& centerX, const std::vector<float>& centerY, const std::vector<float>& centerZ,
+    const std::vector<float>& radiusX, const std::vector<float>& radiusY, const std::vector<float>& radiusZ)
+{
+    return { centerX.data(), centerY.data(), centerZ.data(), radiusX.data(), radiusY.data(), radiusZ.data() };
+}
+
+uint32_t StreamingVolumeBounds::Add(const float center[3], const float radius[3])
+{
+    const uint32_t volumeIndex = static_cast<uint32_t>(m_count++);
+
+    // Grow a whole batch at a time, the new slots are padding until used.
+    if (m_count > m_centerX.size())
+    {
+        const size_t paddedCount = m_centerX.size() + c_BatchSize;
+        m_centerX.resize(paddedCount, 0.0f);
+        m_centerY.resize(paddedCount, 0.0f);
+        m_centerZ.resize(paddedCount, 0.0f);
+        m_radiusX.resize(paddedCount, c_PaddingRadius);
+        m_radiusY.resize(paddedCount, c_PaddingRadius);
+        m_radiusZ.resize(paddedCount, c_PaddingRadius);
+    }
+
+    m_centerX[volumeIndex] = center[0];
+    m_centerY[volumeIndex] = center[1];
+    m_centerZ[volumeIndex] = center[2];
+    m_radiusX[volumeIndex] = radius[0];
+    m_radiusY[volumeIndex] = radius[1];
+    m_radiusZ[volumeIndex] = radius[2];
+    return volumeIndex;
+}
+
+void StreamingVolumeBounds::Clear()
+{
+    m_count = 0;
+    m_centerX.clear();
+    m_centerY.clear();
+    m_centerZ.clear();
+    m_radiusX.clear();
+    m_radiusY.clear();
+    m_radiusZ.clear();
+}
+
+void StreamingVolumeBounds::TestContainment(const float point[3], float margin, uint8_t* insideOut) const
+{
+    const BoundsArrays bounds = GetBoundsArrays(m_centerX, m_centerY, m_centerZ, m_radiusX, m_radiusY, m_radiusZ);
+    const size_t fullBatchCount = m_count / c_BatchSize;
+    const size_t tailCount = m_count % c_BatchSize;
+
+    c_ContainmentKernels[static_cast<int>(m_kernel)](bounds, point, margin, 0, fullBatchCount, insideOut);
+
+    // The last batch reads padding, which mustn't be written out.
+    if (tailCount > 0)
+    {
+        uint8_t inside[c_BatchSize];
+        c_ContainmentKernels[static_cast<int>(m_kernel)](bounds, point, margin, fullBatchCount * c_BatchSize, 1, inside);
+        memcpy(insideOut + fullBatchCount * c_BatchSize, inside, tailCount);
+    }
+}
+
+void StreamingVolumeBounds::TestContainment(const float point[3], float margin, const uint32_t* indices, size_t indexCount, uint8_t* insideOut) const
+{
+    const BoundsArrays bounds = GetBoundsArrays(m_centerX, m_centerY, m_centerZ, m_radiusX, m_radiusY, m_radiusZ);
+    const size_t fullBatchCount = indexCount / c_BatchSize;
+    const size_t tailCount = indexCount % c_BatchSize;
+
+    c_IndexedContainmentKernels[static_cast<int>(m_kernel)](bounds, point, margin, indices, fullBatchCount, insideOut);
+
+    // Fill up the last batch with a volume that's surely there.
+    if (tailCount > 0)
+    {
+        uint32_t tailIndices[c_BatchSize] = {};
+        uint8_t inside[c_BatchSize];
+        memcpy(tailIndices, indices + fullBatchCount * c_BatchSize, tailCount * sizeof(uint32_t));
+        c_IndexedContainmentKernels[static_cast<int>(m_kernel)](bounds, point, margin, tailIndices, 1, inside);
+        memcpy(insideOut + fullBatchCount * c_BatchSize, inside, tailCount);
+    }
+}
+
+void StreamingVolumeBounds::GetSignedDistances(const float point[3], float* distancesOut) const
+{
+    const BoundsArrays bounds = GetBoundsArrays(m_centerX, m_centerY, m_centerZ, m_radiusX, m_radiusY, m_radiusZ);
+    const size_t fullBatchCount = m_count / c_BatchSize;
+    const size_t tailCount = m_count % c_BatchSize;
+
+    c_DistanceKernels[static_cast<int>(m_kernel)](bounds, point, 0, fullBatchCount, distancesOut);
+
+    if (tailCount > 0)
+    {
+        float distances[c_BatchSize];
+        c_DistanceKernels[static_cast<int>(m_kernel)](bounds, point, fullBatchCount * c_BatchSize, 1, distances);
+        memcpy(distancesOut + fullBatchCount * c_BatchSize, distances, tailCount * sizeof(float));
+    }
+}
+
+void StreamingVolumeBounds::GetSignedDistances(const float point[3], const uint32_t* indices, size_t indexCount, float* distancesOut) const
+{
+    const BoundsArrays bounds = GetBoundsArrays(m_centerX, m_centerY, m_centerZ, m_radiusX, m_radiusY, m_radiusZ);
+    const size_t fullBatchCount = indexCount / c_BatchSize;
+    const size_t tailCount = indexCount % c_BatchSize;
+
+    c_IndexedDistanceKernels[static_cast<int>(m_kernel)](bounds, point, indices, fullBatchCount, distancesOut);
+
+    if (tailCount > 0)
+    {
+        uint32_t tailIndices[c_BatchSize] = {};
+        float distances[c_BatchSize];
+        memcpy(tailIndices, indices + fullBatchCount * c_BatchSize, tailCount * sizeof(uint32_t));
+        c_IndexedDistanceKernels[static_cast<int>(m_kernel)](bounds, point, tailIndices, 1, distances);
+        memcpy(distancesOut + fullBatchCount * c_BatchSize, distances, tailCount * sizeof(float));
+    }
+}
+
+void StreamingVolumeBounds::SetKernel(Kernel kernel)
+{
+    m_kernel = kernel <= GetBestKernel() ? kernel : GetBestKernel();
+}
+
+static void CpuId(int regs[4], int leaf, int subLeaf)
+{
+#if defined(_MSC_VER)
+    __cpuidex(regs, leaf, subLeaf);
+#else
+    unsigned int a = 0, b = 0, c = 0, d = 0;
+    __cpuid_count(leaf, subLeaf, a, b, c, d);
+    regs[0] = static_cast<int>(a);
+    regs[1] = static_cast<int>(b);
+    regs[2] = static_cast<int>(c);
+    regs[3] = static_cast<int>(d);
+#endif
+}
+
+static unsigned long long GetXcr0()
+{
+#if defined(_MSC_VER)
+    return _xgetbv(0);
+#else
+    unsigned int eax = 0, edx = 0;
+    __asm__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return (static_cast<unsigned long long>(edx) << 32) | eax;
+#endif
+}
+
+StreamingVolumeBounds::Kernel StreamingVolumeBounds::GetBestKernel()
+{
+    static const Kernel bestKernel = []()
+    {
+        int regs[4];
+        CpuId(regs, 0, 0);
+        const int maxLeaf = regs[0];
+
+        // The OS has to save the wide registers too, not just the CPU support them.
+        CpuId(regs, 1, 0);
+        const bool osxsave = (regs[2] & (1 << 27)) != 0;
+        const bool avx = (regs[2] & (1 << 28)) != 0;
+        if (!osxsave || !avx || maxLeaf < 7)
+        {
+            return Kernel::Scalar;
+        }
+
+        const unsigned long long xcr0 = GetXcr0();
+        CpuId(regs, 7, 0);
+        const bool avx2 = (regs[1] & (1 << 5)) != 0 && (xcr0 & 0x6) == 0x6;
+        const bool avx512 = (regs[1] & (1 << 16)) != 0 && (xcr0 & 0xE6) == 0xE6;
+        return avx512 ? Kernel::AVX512 : (avx2 ? Kernel::AVX2 : Kernel::Scalar);
+    }();
+    return bestKernel;
+}
+
+const char* StreamingVolumeBounds::GetKernelName(Kernel kernel)
+{
+    switch (kernel)
+    {
+    case Kernel::Scalar: return "Scalar";
+    case Kernel::AVX2: return "AVX2";
+    case Kernel::AVX512: return "AVX-512";
+    default: return "Unknown";
+    }
+}
@@ -0,0 +1,72 @@
+// AMD SampleDX12 sample code
+// 
+// Copyright(c) 2023 Advanced Micro Devices, Inc.All rights reserved.
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// The boxes of the streaming volumes, kept apart from the rest of their state as one array per component.
+// Lets the per-frame containment and distance tests go through 8 or 16 volumes at a time with AVX2 or AVX-512.
+// Points and sizes are x, y, z, so it can be used and tested without the framework.
+// The arrays are padded with boxes nothing is ever inside of, so the kernels never deal with a partial batch.
+class StreamingVolumeBounds
+{
+public:
+    enum class Kernel
+    {
+        Scalar,
+        AVX2,
+        AVX512,
+        Count
+    };
+
+    uint32_t Add(const float center[3], const float radius[3]);
+    void Clear();
+    size_t GetCount() const { return m_count; }
+
+    // insideOut gets 1 for every volume the point is in when grown by margin, 0 otherwise.
+    void TestContainment(const float point[3], float margin, uint8_t* insideOut) const;
+    void TestContainment(const float point[3], float margin, const uint32_t* indices, size_t indexCount, uint8_t* insideOut) const;
+
+    // Distance from the point to each box, negative inside.
+    void GetSignedDistances(const float point[3], float* distancesOut) const;
+    void GetSignedDistances(const float point[3], const uint32_t* indices, size_t indexCount, float* distancesOut) const;
+
+    // The best kernel the CPU supports is used unless told otherwise, falling back to it when the CPU can't run the one asked for.
+    void SetKernel(Kernel kernel);
+    Kernel GetKernel() const { return m_kernel; }
+    static Kernel GetBestKernel();
+    static const char* GetKernelName(Kernel kernel);
+
+private:
+    static constexpr size_t c_BatchSize = 16;
+
+    size_t m_count = 0;
+    Kernel m_kernel = GetBestKernel();
+
+    // Box centers and half sizes, by volume index.
+    std::vector<float> m_centerX;
+    std::vector<float> m_centerY;
+    std::vector<float> m_centerZ;
+    std::vector<float> m_radiusX;
+    std::vector<float> m_radiusY;
+    std::vector<float> m_radiusZ;
+};
@@ -0,0 +1,299 @@
+// AMD SampleDX12 sample code
+// 
+// Copyright(c) 2023 Advanced Micro Devices, Inc.All rights reserved.
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+
+
+#include "TileResidencyMap.h"
+#include <algorithm>
+#include <cassert>
+
+void TileResidencyMap::Reset(uint32_t slotCount)
+{
+    m_textures.clear();
+    m_freeTextures.clear();
+    m_slotOwners.assign(slotCount, SlotOwner{});
+
+    // Handed out from the back, so the pool fills up from slot 0.
+    m_freeSlots.resize(slotCount);
+    for (uint32_t slot = 0; slot < slotCount; slot++)
+    {
+        m_freeSlots[slot] = slotCount - 1 - slot;
+    }
+
+    m_frame = 1;
+    m_stats = Stats{};
+    m_stats.slotCount = slotCount;
+}
+
+TileResidencyMap::TextureId TileResidencyMap::AddTexture(const std::vector<uint32_t>& mipTileCounts, uint32_t pinnedSlotCount, std::vector<uint32_t>& pinnedSlotsOut, std::vector<TileEviction>& evictionsOut)
+{
+    pinnedSlotsOut.clear();
+    evictionsOut.clear();
+    if (mipTileCounts.empty())
+    {
+        return c_InvalidTexture;
+    }
+
+    std::vector<uint32_t> candidates;
+    if (m_freeSlots.size() < pinnedSlotCount)
+    {
+        CollectEvictionCandidates(candidates);
+        if (m_freeSlots.size() + candidates.size() < pinnedSlotCount)
+        {
+            return c_InvalidTexture;
+        }
+    }
+
+    TextureId textureId = static_cast<TextureId>(m_textures.size());
+    if (!m_freeTextures.empty())
+    {
+        textureId = m_freeTextures.back();
+        m_freeTextures.pop_back();
+    }
+    else
+    {
+        m_textures.emplace_back();
+    }
+
+    Texture& texture = m_textures[textureId];
+    texture = Texture{};
+    texture.isUsed = true;
+    texture.mipFirstTile.resize(mipTileCounts.size() + 1, 0);
+    for (size_t mip = 0; mip < mipTileCounts.size(); mip++)
+    {
+        texture.mipFirstTile[mip + 1] = texture.mipFirstTile[mip] + mipTileCounts[mip];
+    }
+    texture.tiles.resize(texture.mipFirstTile.back());
+
+    size_t nextCandidate = 0;
+    for (uint32_t pinnedIdx = 0; pinnedIdx < pinnedSlotCount; pinnedIdx++)
+    {
+        const uint32_t slot = TakeSlot(candidates, nextCandidate, evictionsOut);
+        assert(slot != c_InvalidSlot);
+        texture.pinnedSlots.push_back(slot);
+    }
+    m_stats.pinnedSlots += pinnedSlotCount;
+
+    pinnedSlotsOut = texture.pinnedSlots;
+    return textureId;
+}
+
+void TileResidencyMap::RemoveTexture(TextureId texture)
+{
+    Texture& removed = m_textures[texture];
+    assert(removed.isUsed && removed.loadingTiles == 0);
+
+    for (auto& tile : removed.tiles)
+    {
+        if (tile.state == TileState::Resident)
+        {
+            m_slotOwners[tile.slot] = SlotOwner{};
+            m_freeSlots.push_back(tile.slot);
+            m_stats.residentTiles--;
+        }
+    }
+
+    m_freeSlots.insert(m_freeSlots.end(), removed.pinnedSlots.cbegin(), removed.pinnedSlots.cend());
+    m_stats.pinnedSlots -= static_cast<uint32_t>(removed.pinnedSlots.size());
+
+    removed = Texture{};
+    m_freeTextures.push_back(texture);
+}
+
+void TileResidencyMap::RequestMip(TextureId texture, uint32_t mip)
+{
+    Texture& requested = m_textures[texture];
+    assert(requested.isUsed);
+    requested.requestedMip = std::min(requested.requestedMip, std::min(mip, GetMipCount(requested) - 1));
+}
+
+void TileResidencyMap::Update(uint32_t maxLoads, std::vector<TileLoad>& loadsOut, std::vector<TileEviction>& evictionsOut)
+{
+    loadsOut.clear();
+    evictionsOut.clear();
+
+    // Everything requested that isn't resident yet, keyed by how far the mip is from the texture's smallest one.
+    struct Wanted
+    {
+        uint32_t mipFromSmallest;
+        TextureId texture;
+        uint32_t tile;
+    };
+    std::vector<Wanted> wanted;
+
+    for (TextureId textureId = 0; textureId < m_textures.size(); textureId++)
+    {
+        Texture& texture = m_textures[textureId];
+        if (!texture.isUsed || texture.requestedMip == c_NoMip)
+        {
+            continue;
+        }
+
+        const uint32_t mipCount = GetMipCount(texture);
+        for (uint32_t mip = texture.requestedMip; mip < mipCount; mip++)
+        {
+            for (uint32_t tileIdx = texture.mipFirstTile[mip]; tileIdx < texture.mipFirstTile[mip + 1]; tileIdx++)
+            {
+                Tile& tile = texture.tiles[tileIdx];
+                tile.lastWantedFrame = m_frame;
+                if (tile.state == TileState::NotResident)
+                {
+                    wanted.push_back({ mipCount - 1 - mip, textureId, tileIdx });
+                }
+            }
+        }
+        texture.requestedMip = c_NoMip;
+    }
+
+    // Every texture gets its smallest mips before anyone gets a larger one.
+    std::stable_sort(wanted.begin(), wanted.end(), [](const Wanted& lhs, const Wanted& rhs) { return lhs.mipFromSmallest < rhs.mipFromSmallest; });
+
+    std::vector<uint32_t> candidates;
+    bool hasCandidates = false;
+    size_t nextCandidate = 0;
+    for (const auto& want : wanted)
+    {
+        if (loadsOut.size() >= maxLoads)
+        {
+            break;
+        }
+
+        // Only look for tiles to evict once the free slots run out.
+        if (m_freeSlots.empty() && !hasCandidates)
+        {
+            CollectEvictionCandidates(candidates);
+            hasCandidates = true;
+        }
+
+        const uint32_t slot = TakeSlot(candidates, nextCandidate, evictionsOut);
+        if (slot == c_InvalidSlot)
+        {
+            // The pool is full of tiles wanted this frame.
+            break;
+        }
+
+        Tile& tile = m_textures[want.texture].tiles[want.tile];
+        tile.state = TileState::Loading;
+        tile.slot = slot;
+        m_slotOwners[slot] = { want.texture, want.tile };
+        m_textures[want.texture].loadingTiles++;
+        m_stats.loadingTiles++;
+        m_stats.loads++;
+        loadsOut.push_back({ want.texture, want.tile, slot });
+    }
+
+    m_frame++;
+}
+
+void TileResidencyMap::OnTileLoaded(TextureId texture, uint32_t tile)
+{
+    Texture& loaded = m_textures[texture];
+    assert(loaded.isUsed && loaded.tiles[tile].state == TileState::Loading);
+    loaded.tiles[tile].state = TileState::Resident;
+    loaded.loadingTiles--;
+    m_stats.loadingTiles--;
+    m_stats.residentTiles++;
+}
+
+uint32_t TileResidencyMap::GetResidentMip(TextureId texture) const
+{
+    const Texture& resident = m_textures[texture];
+    uint32_t mip = GetMipCount(resident);
+    while (mip > 0)
+    {
+        const auto first = resident.tiles.cbegin() + resident.mipFirstTile[mip - 1];
+        const auto last = resident.tiles.cbegin() + resident.mipFirstTile[mip];
+        if (!std::all_of(first, last, [](const Tile& tile) { return tile.state == TileState::Resident; }))
+        {
+            break;
+        }
+        mip--;
+    }
+    return mip;
+}
+
+uint32_t TileResidencyMap::GetMipOfTile(TextureId texture, uint32_t tile) const
+{
+    const auto& mipFirstTile = m_textures[texture].mipFirstTile;
+    return static_cast<uint32_t>(std::upper_bound(mipFirstTile.cbegin(), mipFirstTile.cend(), tile) - mipFirstTile.cbegin()) - 1;
+}
+
+bool TileResidencyMap::IsLoading(TextureId texture) const
+{
+    return m_textures[texture].loadingTiles > 0;
+}
+
+void TileResidencyMap::CollectEvictionCandidates(std::vector<uint32_t>& slotsOut) const
+{
+    slotsOut.clear();
+    for (uint32_t slot = 0; slot < m_slotOwners.size(); slot++)
+    {
+        const SlotOwner& owner = m_slotOwners[slot];
+        if (owner.texture == c_InvalidTexture)
+        {
+            continue;
+        }
+
+        const Tile& tile = m_textures[owner.texture].tiles[owner.tile];
+        if (tile.state == TileState::Resident && tile.lastWantedFrame < m_frame)
+        {
+            slotsOut.push_back(slot);
+        }
+    }
+
+    // Tile indices start at mip 0, so a lower index is a larger mip of the same texture.
+    std::sort(slotsOut.begin(), slotsOut.end(), [this](uint32_t lhs, uint32_t rhs)
+        {
+            const SlotOwner& lhsOwner = m_slotOwners[lhs];
+            const SlotOwner& rhsOwner = m_slotOwners[rhs];
+            const uint64_t lhsFrame = m_textures[lhsOwner.texture].tiles[lhsOwner.tile].lastWantedFrame;
+            const uint64_t rhsFrame = m_textures[rhsOwner.texture].tiles[rhsOwner.tile].lastWantedFrame;
+            if (lhsFrame != rhsFrame)
+            {
+                return lhsFrame < rhsFrame;
+            }
+            return GetMipOfTile(lhsOwner.texture, lhsOwner.tile) < GetMipOfTile(rhsOwner.texture, rhsOwner.tile);
+        });
+}
+
+uint32_t TileResidencyMap::TakeSlot(const std::vector<uint32_t>& candidates, size_t& nextCandidate, std::vector<TileEviction>& evictionsOut)
+{
+    if (!m_freeSlots.empty())
+    {
+        const uint32_t slot = m_freeSlots.back();
+        m_freeSlots.pop_back();
+        return slot;
+    }
+
+    if (nextCandidate >= candidates.size())
+    {
+        return c_InvalidSlot;
+    }
+
+    const uint32_t slot = candidates[nextCandidate++];
+    SlotOwner& owner = m_slotOwners[slot];
+    Tile& tile = m_textures[owner.texture].tiles[owner.tile];
+    assert(tile.state == TileState::Resident && tile.slot == slot);
+    tile.state = TileState::NotResident;
+    tile.slot = c_InvalidSlot;
+    evictionsOut.push_back({ owner.texture, owner.tile, slot });
+    owner = SlotOwner{};
+    m_stats.residentTiles--;
+    m_stats.evictions++;
+    return slot;
+}
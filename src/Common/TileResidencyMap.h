@@ -0,0 +1,137 @@
+// AMD SampleDX12 sample code
+// 
+// Copyright(c) 2023 Advanced Micro Devices, Inc.All rights reserved.
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Which 64KiB tiles of the streamed textures are in the tile pool, and which ones to load or evict next.
+// It only hands out pool slots and never touches a resource, so it can be used and tested without a device.
+// Textures ask for a mip every frame. That mip and everything smaller is loaded, smallest mips first,
+// and tiles nobody asks for any more stay until their slot is needed, least recently wanted first.
+class TileResidencyMap
+{
+public:
+    using TextureId = uint32_t;
+    static constexpr TextureId c_InvalidTexture = UINT32_MAX;
+    static constexpr uint32_t c_InvalidSlot = UINT32_MAX;
+    static constexpr uint32_t c_NoMip = UINT32_MAX;
+
+    struct TileLoad
+    {
+        TextureId texture;
+        uint32_t tile; // Index into the texture's tiles, mip 0 first and row by row.
+        uint32_t slot;
+    };
+
+    struct TileEviction
+    {
+        TextureId texture;
+        uint32_t tile;
+        uint32_t slot;
+    };
+
+    struct Stats
+    {
+        uint32_t slotCount = 0;
+        uint32_t pinnedSlots = 0; // Packed mips, resident as long as their texture.
+        uint32_t residentTiles = 0;
+        uint32_t loadingTiles = 0;
+        uint64_t loads = 0; // Since Reset.
+        uint64_t evictions = 0;
+    };
+
+    TileResidencyMap() = default;
+    explicit TileResidencyMap(uint32_t slotCount) { Reset(slotCount); }
+
+    // Forgets all textures.
+    void Reset(uint32_t slotCount);
+
+    // mipTileCounts has the tile count of every standard mip, mip 0 first. pinnedSlotCount slots hold the packed mips.
+    // Returns c_InvalidTexture if the pool can't fit the pinned slots, pinnedSlotsOut gets them otherwise.
+    // Tiles may be evicted to make room, like in Update.
+    TextureId AddTexture(const std::vector<uint32_t>& mipTileCounts, uint32_t pinnedSlotCount, std::vector<uint32_t>& pinnedSlotsOut, std::vector<TileEviction>& evictionsOut);
+    // No tile of the texture may still be loading.
+    void RemoveTexture(TextureId texture);
+
+    // The texture wants mip and all the mips smaller than it this frame. Asking several times keeps the largest mip.
+    void RequestMip(TextureId texture, uint32_t mip);
+
+    // Picks up to maxLoads tiles to load for this frame's requests and the slots they go to, then starts the next frame.
+    // Evictions are slots taken from a tile that was resident, they come before the load reusing the slot.
+    void Update(uint32_t maxLoads, std::vector<TileLoad>& loadsOut, std::vector<TileEviction>& evictionsOut);
+
+    // A tile handed out by Update has its data.
+    void OnTileLoaded(TextureId texture, uint32_t tile);
+
+    // Largest mip whose tiles, and those of every mip smaller than it, are all resident. The mip count if none is.
+    uint32_t GetResidentMip(TextureId texture) const;
+    uint32_t GetMipOfTile(TextureId texture, uint32_t tile) const;
+    bool IsLoading(TextureId texture) const;
+
+    const Stats& GetStats() const { return m_stats; }
+
+private:
+    enum class TileState : uint8_t
+    {
+        NotResident,
+        Loading,
+        Resident
+    };
+
+    struct Tile
+    {
+        TileState state = TileState::NotResident;
+        uint32_t slot = c_InvalidSlot;
+        uint64_t lastWantedFrame = 0;
+    };
+
+    struct Texture
+    {
+        bool isUsed = false;
+        std::vector<uint32_t> mipFirstTile; // One more than the mip count, the last is the tile count.
+        std::vector<Tile> tiles;
+        std::vector<uint32_t> pinnedSlots;
+        uint32_t requestedMip = c_NoMip; // This frame.
+        uint32_t loadingTiles = 0;
+    };
+
+    // Slot owners, so an evicted slot can find the tile it takes from.
+    struct SlotOwner
+    {
+        TextureId texture = c_InvalidTexture;
+        uint32_t tile = 0;
+    };
+
+    // Resident tiles nobody wanted this frame, least recently wanted and largest mips first.
+    void CollectEvictionCandidates(std::vector<uint32_t>& slotsOut) const;
+    // A free slot, or one taken from the next eviction candidate. c_InvalidSlot if there is neither.
+    uint32_t TakeSlot(const std::vector<uint32_t>& candidates, size_t& nextCandidate, std::vector<TileEviction>& evictionsOut);
+    uint32_t GetMipCount(const Texture& texture) const { return static_cast<uint32_t>(texture.mipFirstTile.size() - 1); }
+
+    std::vector<Texture> m_textures;
+    std::vector<TextureId> m_freeTextures;
+    std::vector<uint32_t> m_freeSlots;
+    std::vector<SlotOwner> m_slotOwners; // c_InvalidTexture for free and pinned slots.
+    uint64_t m_frame = 1;
+    Stats m_stats;
+};
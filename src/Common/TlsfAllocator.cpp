@@ -0,0 +1,345 @@
+// AMD SampleDX12 sample code
+// 
+// Copyright(c) 2023 Advanced Micro Devices, Inc.All rights reserved.
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+
+#include "TlsfAllocator.h"
+#include <algorithm>
+#include <cassert>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// value must not be 0.
+static uint32_t FindLowestBit(uint64_t value)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, value);
+    return index;
+#else
+    return static_cast<uint32_t>(__builtin_ctzll(value));
+#endif
+}
+
+static uint32_t FindHighestBit(uint64_t value)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    return index;
+#else
+    return 63u - static_cast<uint32_t>(__builtin_clzll(value));
+#endif
+}
+
+static uint64_t AlignUp(uint64_t value, uint64_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+void TlsfAllocator::Reset(uint64_t size)
+{
+    m_blocks.clear();
+    m_recycledBlocks.clear();
+    for (auto& secondLevelLists : m_freeLists)
+    {
+        std::fill(std::begin(secondLevelLists), std::end(secondLevelLists), c_InvalidAllocation);
+    }
+    m_firstLevelBitmap = 0;
+    std::fill(std::begin(m_secondLevelBitmaps), std::end(m_secondLevelBitmaps), 0u);
+
+    m_size = size & ~(c_MinBlockSize - 1);
+    m_usedSize = 0;
+
+    if (m_size > 0)
+    {
+        const uint32_t blockIdx = NewBlock();
+        m_blocks[blockIdx].offset = 0;
+        m_blocks[blockIdx].size = m_size;
+        InsertFree(blockIdx);
+    }
+}
+
+void TlsfAllocator::MapSize(uint64_t size, uint32_t& firstLevel, uint32_t& secondLevel)
+{
+    // Sizes are at least c_MinBlockSize, so there are always enough bits below the top one for the second level.
+    firstLevel = FindHighestBit(size);
+    secondLevel = static_cast<uint32_t>(size >> (firstLevel - c_SecondLevelLog2)) ^ c_SecondLevelCount;
+}
+
+uint32_t TlsfAllocator::NewBlock()
+{
+    uint32_t blockIdx;
+    if (!m_recycledBlocks.empty())
+    {
+        blockIdx = m_recycledBlocks.back();
+        m_recycledBlocks.pop_back();
+        m_blocks[blockIdx] = Block();
+    }
+    else
+    {
+        blockIdx = static_cast<uint32_t>(m_blocks.size());
+        m_blocks.emplace_back();
+    }
+
+    m_blocks[blockIdx].isUsed = true;
+    return blockIdx;
+}
+
+void TlsfAllocator::DeleteBlock(uint32_t blockIdx)
+{
+    m_blocks[blockIdx].isUsed = false;
+    m_recycledBlocks.push_back(blockIdx);
+}
+
+void TlsfAllocator::InsertFree(uint32_t blockIdx)
+{
+    uint32_t firstLevel, secondLevel;
+    MapSize(m_blocks[blockIdx].size, firstLevel, secondLevel);
+
+    auto& block = m_blocks[blockIdx];
+    block.isFree = true;
+    block.prevFree = c_InvalidAllocation;
+    block.nextFree = m_freeLists[firstLevel][secondLevel];
+    if (block.nextFree != c_InvalidAllocation)
+    {
+        m_blocks[block.nextFree].prevFree = blockIdx;
+    }
+    m_freeLists[firstLevel][secondLevel] = blockIdx;
+
+    m_firstLevelBitmap |= 1ull << firstLevel;
+    m_secondLevelBitmaps[firstLevel] |= 1u << secondLevel;
+}
+
+void TlsfAllocator::RemoveFree(uint32_t blockIdx)
+{
+    uint32_t firstLevel, secondLevel;
+    MapSize(m_blocks[blockIdx].size, firstLevel, secondLevel);
+
+    auto& block = m_blocks[blockIdx];
+    if (block.prevFree != c_InvalidAllocation)
+    {
+        m_blocks[block.prevFree].nextFree = block.nextFree;
+    }
+    else
+    {
+        m_freeLists[firstLevel][secondLevel] = block.nextFree;
+    }
+
+    if (block.nextFree != c_InvalidAllocation)
+    {
+        m_blocks[block.nextFree].prevFree = block.prevFree;
+    }
+
+    if (m_freeLists[firstLevel][secondLevel] == c_InvalidAllocation)
+    {
+        m_secondLevelBitmaps[firstLevel] &= ~(1u << secondLevel);
+        if (m_secondLevelBitmaps[firstLevel] == 0)
+        {
+            m_firstLevelBitmap &= ~(1ull << firstLevel);
+        }
+    }
+
+    block.isFree = false;
+    block.prevFree = c_InvalidAllocation;
+    block.nextFree = c_InvalidAllocation;
+}
+
+uint32_t TlsfAllocator::FindFree(uint64_t size, uint64_t alignment) const
+{
+    // Every block starts on c_MinBlockSize, so this much is always enough to align inside it.
+    const uint64_t searchSize = size + alignment - c_MinBlockSize;
+
+    // Round up to the next size class, then any block in the first non-empty list at or above it fits.
+    uint32_t firstLevel, secondLevel;
+    MapSize(searchSize, firstLevel, secondLevel);
+    const uint64_t roundedSize = searchSize + (1ull << (firstLevel - c_SecondLevelLog2)) - 1;
+    MapSize(roundedSize, firstLevel, secondLevel);
+
+    uint32_t secondLevelMap = m_secondLevelBitmaps[firstLevel] & (~0u << secondLevel);
+    if (secondLevelMap == 0)
+    {
+        const uint64_t firstLevelMap = firstLevel + 1 < c_FirstLevelCount ? m_firstLevelBitmap & (~0ull << (firstLevel + 1)) : 0;
+        if (firstLevelMap == 0)
+        {
+            // Nothing guaranteed to fit. Blocks in the classes the request itself falls in can still be big enough.
+            uint32_t lastFirstLevel, lastSecondLevel;
+            MapSize(size, firstLevel, secondLevel);
+            MapSize(searchSize, lastFirstLevel, lastSecondLevel);
+            while (true)
+            {
+                for (uint32_t blockIdx = m_freeLists[firstLevel][secondLevel]; blockIdx != c_InvalidAllocation; blockIdx = m_blocks[blockIdx].nextFree)
+                {
+                    const auto& block = m_blocks[blockIdx];
+                    if (AlignUp(block.offset, alignment) + size <= block.offset + block.size)
+                    {
+                        return blockIdx;
+                    }
+                }
+
+                if (firstLevel == lastFirstLevel && secondLevel == lastSecondLevel)
+                {
+                    return c_InvalidAllocation;
+                }
+
+                if (++secondLevel == c_SecondLevelCount)
+                {
+                    secondLevel = 0;
+                    firstLevel++;
+                }
+            }
+        }
+
+        firstLevel = FindLowestBit(firstLevelMap);
+        secondLevelMap = m_secondLevelBitmaps[firstLevel];
+    }
+
+    secondLevel = FindLowestBit(secondLevelMap);
+    return m_freeLists[firstLevel][secondLevel];
+}
+
+void TlsfAllocator::SplitTail(uint32_t blockIdx, uint64_t size)
+{
+    if (m_blocks[blockIdx].size - size < c_MinBlockSize)
+    {
+        return;
+    }
+
+    // The block was free, so the block after it isn't. The tail doesn't need merging.
+    const uint32_t tailIdx = NewBlock();
+    auto& block = m_blocks[blockIdx];
+    auto& tail = m_blocks[tailIdx];
+    tail.offset = block.offset + size;
+    tail.size = block.size - size;
+    tail.prevPhysical = blockIdx;
+    tail.nextPhysical = block.nextPhysical;
+    if (tail.nextPhysical != c_InvalidAllocation)
+    {
+        m_blocks[tail.nextPhysical].prevPhysical = tailIdx;
+    }
+    block.nextPhysical = tailIdx;
+    block.size = size;
+
+    InsertFree(tailIdx);
+}
+
+uint32_t TlsfAllocator::Merge(uint32_t firstIdx, uint32_t secondIdx)
+{
+    auto& first = m_blocks[firstIdx];
+    const auto& second = m_blocks[secondIdx];
+    assert(first.nextPhysical == secondIdx && first.offset + first.size == second.offset);
+
+    first.size += second.size;
+    first.nextPhysical = second.nextPhysical;
+    if (first.nextPhysical != c_InvalidAllocation)
+    {
+        m_blocks[first.nextPhysical].prevPhysical = firstIdx;
+    }
+
+    DeleteBlock(secondIdx);
+    return firstIdx;
+}
+
+TlsfAllocator::Allocation TlsfAllocator::Allocate(uint64_t size, uint64_t alignment, uint64_t& offsetOut)
+{
+    assert((alignment & (alignment - 1)) == 0);
+    size = AlignUp(std::max<uint64_t>(size, 1), c_MinBlockSize);
+    alignment = std::max(alignment, c_MinBlockSize);
+    if (size > m_size)
+    {
+        return c_InvalidAllocation;
+    }
+
+    uint32_t blockIdx = FindFree(size, alignment);
+    if (blockIdx == c_InvalidAllocation)
+    {
+        return c_InvalidAllocation;
+    }
+    RemoveFree(blockIdx);
+
+    // Give the space in front of the aligned offset back as its own free block. The block before is in use, or it would have been merged.
+    const uint64_t alignedOffset = AlignUp(m_blocks[blockIdx].offset, alignment);
+    const uint64_t padding = alignedOffset - m_blocks[blockIdx].offset;
+    if (padding > 0)
+    {
+        const uint32_t frontIdx = NewBlock();
+        auto& block = m_blocks[blockIdx];
+        auto& front = m_blocks[frontIdx];
+        front.offset = block.offset;
+        front.size = padding;
+        front.prevPhysical = block.prevPhysical;
+        front.nextPhysical = blockIdx;
+        if (front.prevPhysical != c_InvalidAllocation)
+        {
+            m_blocks[front.prevPhysical].nextPhysical = frontIdx;
+        }
+        block.prevPhysical = frontIdx;
+        block.offset = alignedOffset;
+        block.size -= padding;
+
+        InsertFree(frontIdx);
+    }
+
+    SplitTail(blockIdx, size);
+
+    m_usedSize += m_blocks[blockIdx].size;
+    offsetOut = m_blocks[blockIdx].offset;
+    return blockIdx;
+}
+
+void TlsfAllocator::Free(Allocation allocation)
+{
+    assert(allocation < m_blocks.size() && m_blocks[allocation].isUsed && !m_blocks[allocation].isFree);
+    m_usedSize -= m_blocks[allocation].size;
+
+    uint32_t blockIdx = allocation;
+    const uint32_t prevIdx = m_blocks[blockIdx].prevPhysical;
+    if (prevIdx != c_InvalidAllocation && m_blocks[prevIdx].isFree)
+    {
+        RemoveFree(prevIdx);
+        blockIdx = Merge(prevIdx, blockIdx);
+    }
+
+    const uint32_t nextIdx = m_blocks[blockIdx].nextPhysical;
+    if (nextIdx != c_InvalidAllocation && m_blocks[nextIdx].isFree)
+    {
+        RemoveFree(nextIdx);
+        blockIdx = Merge(blockIdx, nextIdx);
+    }
+
+    InsertFree(blockIdx);
+}
+
+uint64_t TlsfAllocator::GetLargestFreeSize() const
+{
+    if (m_firstLevelBitmap == 0)
+    {
+        return 0;
+    }
+
+    const uint32_t firstLevel = FindHighestBit(m_firstLevelBitmap);
+    const uint32_t secondLevel = FindHighestBit(m_secondLevelBitmaps[firstLevel]);
+
+    uint64_t largestSize = 0;
+    for (uint32_t blockIdx = m_freeLists[firstLevel][secondLevel]; blockIdx != c_InvalidAllocation; blockIdx = m_blocks[blockIdx].nextFree)
+    {
+        largestSize = std::max(largestSize, m_blocks[blockIdx].size);
+    }
+
+    return largestSize;
+}
@@ -0,0 +1,87 @@
+// AMD SampleDX12 sample code
+// 
+// Copyright(c) 2023 Advanced Micro Devices, Inc.All rights reserved.
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Two-level segregated fit allocator for ranges inside something of a fixed size, like a D3D12 heap.
+// It only hands out offsets and never touches memory, so it can be used and tested without a device.
+// Allocate and Free are constant time. Sizes are rounded up to c_MinBlockSize, alignments must be powers of two.
+class TlsfAllocator
+{
+public:
+    using Allocation = uint32_t;
+    static constexpr Allocation c_InvalidAllocation = UINT32_MAX;
+    static constexpr uint64_t c_MinBlockSize = 4096; // D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT.
+
+    TlsfAllocator() = default;
+    explicit TlsfAllocator(uint64_t size) { Reset(size); }
+
+    // Forgets all allocations. size is rounded down to c_MinBlockSize.
+    void Reset(uint64_t size);
+
+    // Returns c_InvalidAllocation when no free range is big enough.
+    Allocation Allocate(uint64_t size, uint64_t alignment, uint64_t& offsetOut);
+    void Free(Allocation allocation);
+
+    uint64_t GetOffset(Allocation allocation) const { return m_blocks[allocation].offset; }
+    uint64_t GetAllocationSize(Allocation allocation) const { return m_blocks[allocation].size; }
+
+    uint64_t GetSize() const { return m_size; }
+    uint64_t GetUsedSize() const { return m_usedSize; }
+    uint64_t GetLargestFreeSize() const;
+    bool IsEmpty() const { return m_usedSize == 0; }
+
+private:
+    // 16 lists per power of two keeps the waste from rounding up a request below ~6%.
+    static constexpr uint32_t c_SecondLevelLog2 = 4;
+    static constexpr uint32_t c_SecondLevelCount = 1u << c_SecondLevelLog2;
+    static constexpr uint32_t c_FirstLevelCount = 64;
+
+    struct Block
+    {
+        uint64_t offset = 0;
+        uint64_t size = 0;
+        uint32_t prevPhysical = c_InvalidAllocation; // Blocks either side of this one in the range.
+        uint32_t nextPhysical = c_InvalidAllocation;
+        uint32_t prevFree = c_InvalidAllocation; // Free list of the block's size class.
+        uint32_t nextFree = c_InvalidAllocation;
+        bool isFree = false;
+        bool isUsed = false; // false for recycled entries in m_blocks.
+    };
+
+    static void MapSize(uint64_t size, uint32_t& firstLevel, uint32_t& secondLevel);
+    uint32_t NewBlock();
+    void DeleteBlock(uint32_t blockIdx);
+    void InsertFree(uint32_t blockIdx);
+    void RemoveFree(uint32_t blockIdx);
+    uint32_t FindFree(uint64_t size, uint64_t alignment) const;
+    void SplitTail(uint32_t blockIdx, uint64_t size);
+    uint32_t Merge(uint32_t firstIdx, uint32_t secondIdx);
+
+    std::vector<Block> m_blocks;
+    std::vector<uint32_t> m_recycledBlocks;
+    uint32_t m_freeLists[c_FirstLevelCount][c_SecondLevelCount];
+    uint64_t m_firstLevelBitmap = 0;
+    uint32_t m_secondLevelBitmaps[c_FirstLevelCount] = {};
+    uint64_t m_size = 0;
+    uint64_t m_usedSize = 0;
+};
@@ -0,0 +1,140 @@
+// AMD SampleDX12 sample code
+// 
+// Copyright(c) 2023 Advanced Micro Devices, Inc.All rights reserved.
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "stdafx.h"
+#include "CameraTrajectory.h"
+
+#include <cfloat>
+
+// Slab test. tEnter is where along the segment, from 0 to 1, it first touches the box.
+static bool IntersectSegmentBox(const math::Point3& start, const math::Point3& end, const math::Point3& boxMin, const math::Point3& boxMax, float& tEnter)
+{
+    float tMin = 0.0f;
+    float tMax = 1.0f;
+    for (int axis = 0; axis < 3; axis++)
+    {
+        const float origin = start[axis];
+        const float delta = end[axis] - start[axis];
+        if (fabsf(delta) < 1e-6f)
+        {
+            if (origin < boxMin[axis] || origin > boxMax[axis])
+            {
+                return false;
+            }
+            continue;
+        }
+
+        float t0 = (boxMin[axis] - origin) / delta;
+        float t1 = (boxMax[axis] - origin) / delta;
+        if (t0 > t1)
+        {
+            std::swap(t0, t1);
+        }
+
+        tMin = max(tMin, t0);
+        tMax = min(tMax, t1);
+        if (tMin > tMax)
+        {
+            return false;
+        }
+    }
+
+    tEnter = tMin;
+    return true;
+}
+
+void CameraTrajectory::AddPosition(double timeMilliseconds, const math::Point3& position)
+{
+    m_samples.push_back({ timeMilliseconds, position });
+    while (m_samples.size() > 2 && (timeMilliseconds - m_samples.front().time) > c_WindowMilliseconds)
+    {
+        m_samples.pop_front();
+    }
+}
+
+math::Vector3 CameraTrajectory::GetVelocity() const
+{
+    if (m_samples.size() < 2)
+    {
+        return math::Vector3(0.0f);
+    }
+
+    const auto& first = m_samples.front();
+    const auto& last = m_samples.back();
+    const double seconds = (last.time - first.time) / 1000.0;
+    if (seconds <= 0.0)
+    {
+        return math::Vector3(0.0f);
+    }
+
+    return (last.position - first.position) / static_cast<float>(seconds);
+}
+
+float CameraTrajectory::GetTimeToEnter(const math::Point3& boxMin, const math::Point3& boxMax, const std::vector<math::Point3>& waypoints, float maxSeconds) const
+{
+    if (m_samples.empty())
+    {
+        return FLT_MAX;
+    }
+
+    const math::Vector3 velocity = GetVelocity();
+    const float speed = Vectormath::SSE::length(velocity);
+    if (speed < 1e-3f)
+    {
+        return FLT_MAX;
+    }
+
+    math::Point3 segmentStart = m_samples.back().position;
+    float segmentStartTime = 0.0f;
+
+    auto testSegment = [&](const math::Point3& segmentEnd, float segmentSeconds, float& timeToEnter)
+    {
+        float tEnter;
+        if (IntersectSegmentBox(segmentStart, segmentEnd, boxMin, boxMax, tEnter))
+        {
+            timeToEnter = segmentStartTime + tEnter * segmentSeconds;
+            return timeToEnter <= maxSeconds;
+        }
+        return false;
+    };
+
+    float timeToEnter = FLT_MAX;
+    if (waypoints.empty())
+    {
+        return testSegment(segmentStart + velocity * maxSeconds, maxSeconds, timeToEnter) ? timeToEnter : FLT_MAX;
+    }
+
+    for (const auto& waypoint : waypoints)
+    {
+        const float segmentSeconds = Vectormath::SSE::length(waypoint - segmentStart) / speed;
+        if (testSegment(waypoint, segmentSeconds, timeToEnter))
+        {
+            return timeToEnter;
+        }
+
+        segmentStartTime += segmentSeconds;
+        segmentStart = waypoint;
+        if (segmentStartTime > maxSeconds)
+        {
+            break;
+        }
+    }
+
+    return FLT_MAX;
+}
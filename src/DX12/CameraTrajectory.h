@@ -0,0 +1,48 @@
+// AMD SampleDX12 sample code
+// 
+// Copyright(c) 2023 Advanced Micro Devices, Inc.All rights reserved.
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <deque>
+
+// Recent camera positions, used to guess when the camera will reach a streaming volume.
+class CameraTrajectory
+{
+public:
+    void AddPosition(double timeMilliseconds, const math::Point3& position);
+    void Reset() { m_samples.clear(); }
+
+    // Averaged over the last c_WindowMilliseconds, units per second.
+    math::Vector3 GetVelocity() const;
+
+    // Seconds until the camera reaches the box, or FLT_MAX if it won't within maxSeconds.
+    // The camera follows the waypoints in order at its current speed when there are any, otherwise it keeps its current velocity.
+    float GetTimeToEnter(const math::Point3& boxMin, const math::Point3& boxMax, const std::vector<math::Point3>& waypoints, float maxSeconds) const;
+
+private:
+    struct Sample
+    {
+        double time;
+        math::Point3 position;
+    };
+
+    static constexpr double c_WindowMilliseconds = 500.0;
+
+    std::deque<Sample> m_samples;
+};
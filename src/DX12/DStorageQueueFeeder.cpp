@@ -0,0 +1,227 @@
+// AMD SampleDX12 sample code
+// 
+// Copyright(c) 2023 Advanced Micro Devices, Inc.All rights reserved.
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include "stdafx.h"
+#include "DStorageQueueFeeder.h"
+
+void DStorageQueueFeeder::OnCreate(IDStorageQueue* pQueue)
+{
+    m_pQueue = pQueue;
+    ThrowIfFailed(pQueue->QueryInterface(IID_PPV_ARGS(&m_pQueue1)));
+
+    DSTORAGE_QUEUE_INFO queueInfo{};
+    m_pQueue->Query(&queueInfo);
+    m_emptySlots = queueInfo.EmptySlotCount;
+    m_progressInterval = max(1u, queueInfo.EmptySlotCount / 2);
+
+    // Auto reset, the wait stays registered and runs every time the queue sets it.
+    m_progressEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+    (void)RegisterWaitForSingleObject(&m_progressWait, m_progressEvent, OnQueueProgress, this, INFINITE, WT_EXECUTEDEFAULT);
+}
+
+void DStorageQueueFeeder::OnDestroy()
+{
+    // Blocks until a callback that's already running is done.
+    (void)UnregisterWaitEx(m_progressWait, INVALID_HANDLE_VALUE);
+    (void)CloseHandle(m_progressEvent);
+    m_progressWait = nullptr;
+    m_progressEvent = nullptr;
+
+    assert(m_waiting.empty());
+    m_pQueue1->Release();
+    m_pQueue1 = nullptr;
+    m_pQueue = nullptr;
+}
+
+void DStorageQueueFeeder::EnqueueRequest(const DSTORAGE_REQUEST& request)
+{
+    Command command;
+    command.type = CommandType_Request;
+    command.request = request;
+    Enqueue(command);
+}
+
+void DStorageQueueFeeder::EnqueueStatus(IDStorageStatusArray* pStatusArray, uint32_t index, std::atomic<uint32_t>* pEnqueuedCount)
+{
+    Command command;
+    command.type = CommandType_Status;
+    command.pStatusArray = pStatusArray;
+    command.index = index;
+    command.pEnqueuedCount = pEnqueuedCount;
+    Enqueue(command);
+}
+
+void DStorageQueueFeeder::EnqueueSignal(ID3D12Fence* pFence, uint64_t value)
+{
+    Command command;
+    command.type = CommandType_Signal;
+    command.pFence = pFence;
+    command.value = value;
+    Enqueue(command);
+}
+
+void DStorageQueueFeeder::EnqueueSetEvent(HANDLE event)
+{
+    Command command;
+    command.type = CommandType_SetEvent;
+    command.event = event;
+    Enqueue(command);
+}
+
+void DStorageQueueFeeder::Submit()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_pQueue->Submit();
+}
+
+void DStorageQueueFeeder::CancelRequestsWithTag(uint64_t mask, uint64_t value)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_waiting.erase(std::remove_if(m_waiting.begin(), m_waiting.end(), [mask, value](const Command& command)
+        {
+            return command.type == CommandType_Request && (command.request.CancellationTag & mask) == value;
+        }), m_waiting.end());
+    m_stats.waitingCommands = static_cast<uint32_t>(m_waiting.size());
+
+    m_pQueue->CancelRequestsWithTag(mask, value);
+}
+
+DStorageQueueFeeder::Stats DStorageQueueFeeder::GetStats()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+void DStorageQueueFeeder::Enqueue(const Command& command)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // Commands keep their order, nothing passes the ones already waiting.
+    if (m_waiting.empty())
+    {
+        Drain();
+    }
+
+    if (m_waiting.empty() && m_emptySlots > 1)
+    {
+        EnqueueOnQueue(command);
+        return;
+    }
+
+    m_waiting.push_back(command);
+    m_stats.deferredCommands++;
+    m_stats.waitingCommands = static_cast<uint32_t>(m_waiting.size());
+    m_stats.maxWaitingCommands = max(m_stats.maxWaitingCommands, m_stats.waitingCommands);
+    Drain();
+}
+
+void DStorageQueueFeeder::EnqueueOnQueue(const Command& command)
+{
+    assert(m_emptySlots > 0);
+    m_emptySlots--;
+    m_commandsSinceProgressEvent++;
+
+    switch (command.type)
+    {
+    case CommandType_Request:
+        m_pQueue->EnqueueRequest(&command.request);
+        break;
+
+    case CommandType_Status:
+        m_pQueue->EnqueueStatus(command.pStatusArray, command.index);
+        if (command.pEnqueuedCount)
+        {
+            (*command.pEnqueuedCount)++;
+        }
+        break;
+
+    case CommandType_Signal:
+        m_pQueue->EnqueueSignal(command.pFence, command.value);
+        break;
+
+    case CommandType_SetEvent:
+        m_pQueue1->EnqueueSetEvent(command.event);
+        break;
+    }
+}
+
+// Caller holds m_mutex.
+uint32_t DStorageQueueFeeder::Drain()
+{
+    // The count only goes stale in the safe direction, ask the queue once it looks full.
+    if (m_emptySlots <= 1)
+    {
+        DSTORAGE_QUEUE_INFO queueInfo{};
+        m_pQueue->Query(&queueInfo);
+        m_emptySlots = queueInfo.EmptySlotCount;
+    }
+
+    // The last slot is kept for the progress event.
+    uint32_t movedCount = 0;
+    while (!m_waiting.empty() && m_emptySlots > 1)
+    {
+        EnqueueOnQueue(m_waiting.front());
+        m_waiting.pop_front();
+        movedCount++;
+
+        if (!m_waiting.empty() && m_emptySlots > 1 && m_commandsSinceProgressEvent >= m_progressInterval)
+        {
+            EnqueueProgressEvent();
+        }
+    }
+    m_stats.waitingCommands = static_cast<uint32_t>(m_waiting.size());
+
+    // Wake up once the queue has got through everything on it, unless an event is the last thing on it already.
+    if (!m_waiting.empty() && m_commandsSinceProgressEvent > 0)
+    {
+        EnqueueProgressEvent();
+    }
+
+    // Submit so the queue gets to the events without waiting for the caller.
+    if (movedCount > 0 && !m_waiting.empty())
+    {
+        m_pQueue->Submit();
+    }
+    return movedCount;
+}
+
+// Caller holds m_mutex.
+void DStorageQueueFeeder::EnqueueProgressEvent()
+{
+    assert(m_emptySlots > 0);
+    m_emptySlots--;
+    m_pQueue1->EnqueueSetEvent(m_progressEvent);
+    m_commandsSinceProgressEvent = 0;
+}
+
+void CALLBACK DStorageQueueFeeder::OnQueueProgress(PVOID pContext, BOOLEAN timedOut)
+{
+    (void)timedOut;
+
+    // Several events set before this runs only wake it once, Drain asks the queue how much room it has anyway.
+    auto* pFeeder = static_cast<DStorageQueueFeeder*>(pContext);
+    std::lock_guard<std::mutex> lock(pFeeder->m_mutex);
+
+    // What was moved over has to be submitted, the caller may have submitted long ago. Drain already has if some are still waiting.
+    if (pFeeder->Drain() > 0 && pFeeder->m_waiting.empty())
+    {
+        pFeeder->m_pQueue->Submit();
+    }
+}
@@ -0,0 +1,100 @@
+// AMD SampleDX12 sample code
+// 
+// Copyright(c) 2023 Advanced Micro Devices, Inc.All rights reserved.
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <dstorage.h>
+
+// Sits in front of a DirectStorage queue so enqueueing never blocks on a full queue.
+// Commands go straight to the queue while it has room, after that they wait here in order, and are moved over when the queue gets through
+// what it has. Everything enqueued on the queue must go through here, or the room it has can't be trusted.
+// Thread safe.
+class DStorageQueueFeeder
+{
+public:
+    struct Stats
+    {
+        uint32_t waitingCommands = 0; // Held here right now.
+        uint32_t maxWaitingCommands = 0;
+        uint64_t deferredCommands = 0; // Commands that couldn't go straight to the queue.
+    };
+
+    enum CommandType : uint32_t
+    {
+        CommandType_Request,
+        CommandType_Status,
+        CommandType_Signal,
+        CommandType_SetEvent,
+    };
+
+    struct Command
+    {
+        CommandType type = CommandType_Request;
+        DSTORAGE_REQUEST request{};
+        IDStorageStatusArray* pStatusArray = nullptr;
+        uint32_t index = 0;
+        std::atomic<uint32_t>* pEnqueuedCount = nullptr; // Status only, optional. Counts the entry once it's on the queue and means something.
+        ID3D12Fence* pFence = nullptr;
+        uint64_t value = 0;
+        HANDLE event = nullptr;
+    };
+
+    void OnCreate(IDStorageQueue* pQueue);
+    // The queue must be done with everything, the caller releases it.
+    void OnDestroy();
+
+    void EnqueueRequest(const DSTORAGE_REQUEST& request);
+    void EnqueueStatus(IDStorageStatusArray* pStatusArray, uint32_t index, std::atomic<uint32_t>* pEnqueuedCount = nullptr);
+    void EnqueueSignal(ID3D12Fence* pFence, uint64_t value);
+    void EnqueueSetEvent(HANDLE event);
+    void Enqueue(const Command& command);
+    // Commands still waiting here go out as soon as the queue has room, they don't need another submit.
+    void Submit();
+    // Drops the waiting requests the queue would cancel, then cancels the ones on the queue.
+    void CancelRequestsWithTag(uint64_t mask, uint64_t value);
+
+    IDStorageQueue* GetQueue() const { return m_pQueue; }
+    Stats GetStats();
+
+private:
+    void EnqueueOnQueue(const Command& command);
+    // Caller holds m_mutex. Returns how many commands were moved over.
+    uint32_t Drain();
+    void EnqueueProgressEvent();
+    static void CALLBACK OnQueueProgress(PVOID pContext, BOOLEAN timedOut);
+
+    std::mutex m_mutex;
+    IDStorageQueue* m_pQueue = nullptr;
+    IDStorageQueue1* m_pQueue1 = nullptr;
+    uint32_t m_emptySlots = 0; // Known free, only ever goes up behind our back.
+    uint32_t m_progressInterval = 1; // Half the queue.
+
+    std::deque<Command> m_waiting;
+    // While commands wait, the queue sets this after every half queue of commands moved over, and after the last one,
+    // so they're refilled while it still has the other half to work on.
+    HANDLE m_progressEvent = nullptr;
+    HANDLE m_progressWait = nullptr;
+    uint32_t m_commandsSinceProgressEvent = 0;
+
+    Stats m_stats;
+};
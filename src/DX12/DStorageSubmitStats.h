@@ -0,0 +1,62 @@
+// AMD SampleDX12 sample code
+// 
+// Copyright(c) 2023 Advanced Micro Devices, Inc.All rights reserved.
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+// Why a queue was submitted.
+enum class SubmitReason : uint32_t
+{
+    Requests, // submitthreshold requests since the last submit.
+    Bytes, // submitbytes read by them.
+    Latency, // The oldest command has waited submitlatencyms.
+    Flush, // Someone asked, like a scene that has enqueued all its reads, or a wait on a fence.
+    Count
+};
+
+inline const char* GetSubmitReasonName(SubmitReason reason)
+{
+    static const char* names[] = { "Requests", "Bytes", "Latency", "Flush" };
+    return names[static_cast<uint32_t>(reason)];
+}
+
+struct SubmitEvent
+{
+    double time = 0.0; // ms since the submit thread started.
+    uint32_t queueIndex = 0;
+    SubmitReason reason = SubmitReason::Flush;
+    uint32_t commands = 0; // Requests, signals, status entries and events.
+    uint32_t requests = 0;
+    uint64_t bytes = 0; // Read by the requests, compressed.
+    double oldestWait = 0.0; // ms the first command of the batch waited to be submitted.
+};
+
+// Totals since the submit thread started.
+struct SubmitStats
+{
+    uint64_t submits = 0;
+    uint64_t requests = 0;
+    uint64_t bytes = 0;
+    uint32_t maxBatchRequests = 0;
+    uint64_t maxBatchBytes = 0;
+    std::array<uint64_t, static_cast<uint32_t>(SubmitReason::Count)> submitsByReason{};
+};
@@ -0,0 +1,249 @@
+// AMD SampleDX12 sample code
+// 
+// Copyright(c) 2023 Advanced Micro Devices, Inc.All rights reserved.
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include "stdafx.h"
+#include "DStorageSubmitThread.h"
+
+void DStorageSubmitThread::OnCreate(const std::vector<DStorageQueueFeeder*>& feeders, const Policy& policy)
+{
+    m_feeders = feeders;
+    m_policy = policy;
+    m_batches.assign(feeders.size(), Batch{});
+    m_creationTime = MillisecondsNow();
+
+    m_wakeEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+    m_thread = std::thread(&DStorageSubmitThread::Run, this);
+}
+
+void DStorageSubmitThread::OnDestroy()
+{
+    Item item;
+    item.type = ItemType_Stop;
+    Push(std::move(item));
+    m_thread.join();
+
+    (void)CloseHandle(m_wakeEvent);
+    m_wakeEvent = nullptr;
+    m_feeders.clear();
+    m_batches.clear();
+}
+
+void DStorageSubmitThread::EnqueueRequest(uint32_t queueIndex, const DSTORAGE_REQUEST& request)
+{
+    Item item;
+    item.queueIndex = queueIndex;
+    item.command.type = DStorageQueueFeeder::CommandType_Request;
+    item.command.request = request;
+    Push(std::move(item));
+}
+
+void DStorageSubmitThread::EnqueueStatus(uint32_t queueIndex, IDStorageStatusArray* pStatusArray, uint32_t index, std::atomic<uint32_t>* pEnqueuedCount)
+{
+    Item item;
+    item.queueIndex = queueIndex;
+    item.command.type = DStorageQueueFeeder::CommandType_Status;
+    item.command.pStatusArray = pStatusArray;
+    item.command.index = index;
+    item.command.pEnqueuedCount = pEnqueuedCount;
+    Push(std::move(item));
+}
+
+void DStorageSubmitThread::EnqueueSignal(uint32_t queueIndex, ID3D12Fence* pFence, uint64_t value)
+{
+    Item item;
+    item.queueIndex = queueIndex;
+    item.command.type = DStorageQueueFeeder::CommandType_Signal;
+    item.command.pFence = pFence;
+    item.command.value = value;
+    Push(std::move(item));
+}
+
+void DStorageSubmitThread::EnqueueSetEvent(uint32_t queueIndex, HANDLE event)
+{
+    Item item;
+    item.queueIndex = queueIndex;
+    item.command.type = DStorageQueueFeeder::CommandType_SetEvent;
+    item.command.event = event;
+    Push(std::move(item));
+}
+
+void DStorageSubmitThread::Flush(uint32_t queueIndex)
+{
+    Item item;
+    item.type = ItemType_Flush;
+    item.queueIndex = queueIndex;
+    Push(std::move(item));
+}
+
+void DStorageSubmitThread::CancelRequestsWithTag(uint32_t queueIndex, uint64_t mask, uint64_t value)
+{
+    Item item;
+    item.type = ItemType_Cancel;
+    item.queueIndex = queueIndex;
+    item.mask = mask;
+    item.value = value;
+    Push(std::move(item));
+}
+
+DStorageSubmitThread::Stats DStorageSubmitThread::GetStats()
+{
+    std::lock_guard<std::mutex> lock(m_statsMutex);
+    return m_stats;
+}
+
+std::vector<SubmitEvent> DStorageSubmitThread::TakeEvents()
+{
+    std::lock_guard<std::mutex> lock(m_statsMutex);
+    return std::move(m_events);
+}
+
+void DStorageSubmitThread::Push(Item&& item)
+{
+    item.time = MillisecondsNow();
+    m_items.Push(std::move(item));
+    (void)SetEvent(m_wakeEvent);
+}
+
+void DStorageSubmitThread::Run()
+{
+    bool isStopping = false;
+    while (!isStopping)
+    {
+        // Sleep until something is pushed, or the oldest unsubmitted command is due.
+        DWORD timeout = INFINITE;
+        if (m_policy.maxLatencyMilliseconds > 0.0f)
+        {
+            const double now = MillisecondsNow();
+            for (const auto& batch : m_batches)
+            {
+                if (batch.commands > 0)
+                {
+                    const double wait = max(0.0, batch.firstTime + m_policy.maxLatencyMilliseconds - now);
+                    timeout = min(timeout, static_cast<DWORD>(ceil(wait)));
+                }
+            }
+        }
+        (void)WaitForSingleObject(m_wakeEvent, timeout);
+
+        Item item;
+        while (m_items.TryPop(item))
+        {
+            if (item.type == ItemType_Stop)
+            {
+                isStopping = true;
+                continue;
+            }
+            Process(item);
+        }
+
+        const double now = MillisecondsNow();
+        for (uint32_t queueIndex = 0; queueIndex < m_batches.size(); queueIndex++)
+        {
+            const auto& batch = m_batches[queueIndex];
+            if (batch.commands > 0 && m_policy.maxLatencyMilliseconds > 0.0f && now - batch.firstTime >= m_policy.maxLatencyMilliseconds)
+            {
+                Submit(queueIndex, SubmitReason::Latency);
+            }
+        }
+    }
+
+    // Nothing is left behind unsubmitted.
+    for (uint32_t queueIndex = 0; queueIndex < m_batches.size(); queueIndex++)
+    {
+        if (m_batches[queueIndex].commands > 0)
+        {
+            Submit(queueIndex, SubmitReason::Flush);
+        }
+    }
+}
+
+void DStorageSubmitThread::Process(const Item& item)
+{
+    DStorageQueueFeeder* pFeeder = m_feeders[item.queueIndex];
+    auto& batch = m_batches[item.queueIndex];
+
+    switch (item.type)
+    {
+    case ItemType_Command:
+        pFeeder->Enqueue(item.command);
+        if (batch.commands++ == 0)
+        {
+            batch.firstTime = item.time;
+        }
+        if (item.command.type == DStorageQueueFeeder::CommandType_Request)
+        {
+            const auto& request = item.command.request;
+            batch.requests++;
+            batch.bytes += request.Options.SourceType == DSTORAGE_REQUEST_SOURCE_MEMORY ? request.Source.Memory.Size : request.Source.File.Size;
+
+            if (m_policy.maxRequests > 0 && batch.requests >= m_policy.maxRequests)
+            {
+                Submit(item.queueIndex, SubmitReason::Requests);
+            }
+            else if (m_policy.maxBytes > 0 && batch.bytes >= m_policy.maxBytes)
+            {
+                Submit(item.queueIndex, SubmitReason::Bytes);
+            }
+        }
+        break;
+
+    case ItemType_Flush:
+        // Several loads flush every queue, the ones with nothing new don't count.
+        if (batch.commands > 0)
+        {
+            Submit(item.queueIndex, SubmitReason::Flush);
+        }
+        break;
+
+    case ItemType_Cancel:
+        pFeeder->CancelRequestsWithTag(item.mask, item.value);
+        break;
+
+    default:
+        break;
+    }
+}
+
+void DStorageSubmitThread::Submit(uint32_t queueIndex, SubmitReason reason)
+{
+    m_feeders[queueIndex]->Submit();
+
+    auto& batch = m_batches[queueIndex];
+    const double now = MillisecondsNow();
+
+    SubmitEvent event;
+    event.time = now - m_creationTime;
+    event.queueIndex = queueIndex;
+    event.reason = reason;
+    event.commands = batch.commands;
+    event.requests = batch.requests;
+    event.bytes = batch.bytes;
+    event.oldestWait = now - batch.firstTime;
+    batch = Batch{};
+
+    std::lock_guard<std::mutex> lock(m_statsMutex);
+    m_stats.submits++;
+    m_stats.requests += event.requests;
+    m_stats.bytes += event.bytes;
+    m_stats.maxBatchRequests = max(m_stats.maxBatchRequests, event.requests);
+    m_stats.maxBatchBytes = max(m_stats.maxBatchBytes, event.bytes);
+    m_stats.submitsByReason[static_cast<uint32_t>(reason)]++;
+    m_events.push_back(event);
+}
@@ -0,0 +1,109 @@
+// AMD SampleDX12 sample code
+// 
+// Copyright(c) 2023 Advanced Micro Devices, Inc.All rights reserved.
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+#include <array>
+#include <thread>
+#include <vector>
+#include "DStorageQueueFeeder.h"
+#include "DStorageSubmitStats.h"
+#include "MpscQueue.h"
+
+// One thread that every command for the DirectStorage queues goes through, and that decides when they're submitted.
+// Producers push commands on a lock free queue and never touch the DirectStorage queues, the thread hands them to each queue's feeder
+// in the order they were pushed and submits a queue once its batch hits one of the policy's limits, or on an explicit flush.
+class DStorageSubmitThread
+{
+public:
+    // 0 turns a limit off.
+    struct Policy
+    {
+        uint32_t maxRequests = 0;
+        uint64_t maxBytes = 0;
+        float maxLatencyMilliseconds = 0.0f;
+    };
+
+    using Stats = SubmitStats;
+
+    // The feeders are indexed by queue index and must outlive the thread.
+    void OnCreate(const std::vector<DStorageQueueFeeder*>& feeders, const Policy& policy);
+    // Hands over and submits everything pushed so far, then stops the thread.
+    void OnDestroy();
+
+    void EnqueueRequest(uint32_t queueIndex, const DSTORAGE_REQUEST& request);
+    // See DStorageQueueFeeder::Command for pEnqueuedCount.
+    void EnqueueStatus(uint32_t queueIndex, IDStorageStatusArray* pStatusArray, uint32_t index, std::atomic<uint32_t>* pEnqueuedCount = nullptr);
+    void EnqueueSignal(uint32_t queueIndex, ID3D12Fence* pFence, uint64_t value);
+    void EnqueueSetEvent(uint32_t queueIndex, HANDLE event);
+    // Submits the queue once the thread gets to it, with everything pushed for it before.
+    void Flush(uint32_t queueIndex);
+    // Cancels what was pushed for the queue before, including what the thread hasn't handed over yet.
+    void CancelRequestsWithTag(uint32_t queueIndex, uint64_t mask, uint64_t value);
+
+    Stats GetStats();
+    // Every submit since the last call.
+    std::vector<SubmitEvent> TakeEvents();
+
+private:
+    enum ItemType : uint32_t
+    {
+        ItemType_Command,
+        ItemType_Flush,
+        ItemType_Cancel,
+        ItemType_Stop,
+    };
+
+    struct Item
+    {
+        ItemType type = ItemType_Command;
+        uint32_t queueIndex = 0;
+        double time = 0.0;
+        DStorageQueueFeeder::Command command;
+        uint64_t mask = 0;
+        uint64_t value = 0;
+    };
+
+    // What's been handed to a queue since it was last submitted. Only the thread uses it.
+    struct Batch
+    {
+        uint32_t commands = 0;
+        uint32_t requests = 0;
+        uint64_t bytes = 0;
+        double firstTime = 0.0;
+    };
+
+    void Push(Item&& item);
+    void Run();
+    void Process(const Item& item);
+    void Submit(uint32_t queueIndex, SubmitReason reason);
+
+    std::vector<DStorageQueueFeeder*> m_feeders;
+    Policy m_policy;
+    MpscQueue<Item> m_items;
+    HANDLE m_wakeEvent = nullptr;
+    std::thread m_thread;
+    std::vector<Batch> m_batches;
+    double m_creationTime = 0.0;
+
+    std::mutex m_statsMutex;
+    Stats m_stats;
+    std::vector<SubmitEvent> m_events;
+};
@@ -76,9 +76,40 @@ void DirectStorageSample::OnParseCommandLine(LPSTR lpCmdLine, uint32_t* pWidth,
         m_sampleOptions.ioOptions.m_usePlacedResources = jData.value("placedresources", m_sampleOptions.ioOptions.m_usePlacedResources);
         m_sampleOptions.ioOptions.m_stagingBufferSize = jData.value("stagingbuffersize", m_sampleOptions.ioOptions.m_stagingBufferSize);
         m_sampleOptions.ioOptions.m_queueLength = jData.value("queuelength", m_sampleOptions.ioOptions.m_queueLength);
+        m_sampleOptions.ioOptions.m_submitThreshold = jData.value("submitthreshold", m_sampleOptions.ioOptions.m_submitThreshold);
+        m_sampleOptions.ioOptions.m_submitBytes = jData.value("submitbytes", m_sampleOptions.ioOptions.m_submitBytes);
+        m_sampleOptions.ioOptions.m_submitLatencyMilliseconds = jData.value("submitlatencyms", m_sampleOptions.ioOptions.m_submitLatencyMilliseconds);
         m_sampleOptions.ioOptions.m_allowCancellation = jData.value("allowcancellation", m_sampleOptions.ioOptions.m_allowCancellation);
         m_sampleOptions.ioOptions.m_disableGPUDecompression = jData.value("disablegpudecompression", m_sampleOptions.ioOptions.m_disableGPUDecompression);
         m_sampleOptions.ioOptions.m_disableMetaCommand = jData.value("disablemetacommand", m_sampleOptions.ioOptions.m_disableMetaCommand);
+        m_sampleOptions.ioOptions.m_packageVariant = jData.value("packagevariant", m_sampleOptions.ioOptions.m_packageVariant);
+        m_sampleOptions.ioOptions.m_useQualityTiers = jData.value("qualitytiers", m_sampleOptions.ioOptions.m_useQualityTiers);
+        m_sampleOptions.ioOptions.m_textureMemoryBudget = jData.value("texturememorybudget", m_sampleOptions.ioOptions.m_textureMemoryBudget);
+        m_sampleOptions.ioOptions.m_qualityTierDistance = jData.value("qualitytierdistance", m_sampleOptions.ioOptions.m_qualityTierDistance);
+        m_sampleOptions.ioOptions.m_useTextureLOD = jData.value("texturelod", m_sampleOptions.ioOptions.m_useTextureLOD);
+        m_sampleOptions.ioOptions.m_useTiledTextures = jData.value("tiledtextures", m_sampleOptions.ioOptions.m_useTiledTextures);
+        m_sampleOptions.ioOptions.m_tilePoolSize = jData.value("tilepoolsize", m_sampleOptions.ioOptions.m_tilePoolSize);
+        m_sampleOptions.ioOptions.m_textureHeapPoolSize = jData.value("textureheappoolsize", m_sampleOptions.ioOptions.m_textureHeapPoolSize);
+        m_sampleOptions.ioOptions.m_useTextureCache = jData.value("texturecache", m_sampleOptions.ioOptions.m_useTextureCache);
+        m_sampleOptions.ioOptions.m_metaDataCacheSeconds = jData.value("metadatacacheseconds", m_sampleOptions.ioOptions.m_metaDataCacheSeconds);
+        m_sampleOptions.ioOptions.m_metaDataCacheSize = jData.value("metadatacachesize", m_sampleOptions.ioOptions.m_metaDataCacheSize);
+        m_sampleOptions.ioOptions.m_payloadCacheSize = jData.value("payloadcachesize", m_sampleOptions.ioOptions.m_payloadCacheSize);
+        m_sampleOptions.ioOptions.m_volumeEnterMargin = jData.value("volumeentermargin", m_sampleOptions.ioOptions.m_volumeEnterMargin);
+        m_sampleOptions.ioOptions.m_volumeExitMargin = jData.value("volumeexitmargin", m_sampleOptions.ioOptions.m_volumeExitMargin);
+        m_sampleOptions.ioOptions.m_volumeMinDwellSeconds = jData.value("volumemindwellseconds", m_sampleOptions.ioOptions.m_volumeMinDwellSeconds);
+        m_sampleOptions.ioOptions.m_unloadKeepAliveSeconds = jData.value("unloadkeepaliveseconds", m_sampleOptions.ioOptions.m_unloadKeepAliveSeconds);
+        m_sampleOptions.ioOptions.m_usePrefetch = jData.value("prefetch", m_sampleOptions.ioOptions.m_usePrefetch);
+        m_sampleOptions.ioOptions.m_prefetchLeadSeconds = jData.value("prefetchleadseconds", m_sampleOptions.ioOptions.m_prefetchLeadSeconds);
+        m_sampleOptions.ioOptions.m_streamingGridCellSize = jData.value("streaminggridcellsize", m_sampleOptions.ioOptions.m_streamingGridCellSize);
+        m_sampleOptions.ioOptions.m_loaderThreadCount = jData.value("loaderthreads", m_sampleOptions.ioOptions.m_loaderThreadCount);
+        m_sampleOptions.ioOptions.m_maxConcurrentLoads = jData.value("maxconcurrentloads", m_sampleOptions.ioOptions.m_maxConcurrentLoads);
+        m_sampleOptions.ioOptions.m_usePriorityQueues = jData.value("priorityqueues", m_sampleOptions.ioOptions.m_usePriorityQueues);
+        m_sampleOptions.ioOptions.m_ioHighPrioritySeconds = jData.value("iohighpriorityseconds", m_sampleOptions.ioOptions.m_ioHighPrioritySeconds);
+        m_sampleOptions.ioOptions.m_ioLowPrioritySeconds = jData.value("iolowpriorityseconds", m_sampleOptions.ioOptions.m_ioLowPrioritySeconds);
+        m_sampleOptions.ioOptions.m_ioDeferMilliseconds = jData.value("iodeferms", m_sampleOptions.ioOptions.m_ioDeferMilliseconds);
+        m_sampleOptions.ioOptions.m_useProgressiveScenes = jData.value("progressivescenes", m_sampleOptions.ioOptions.m_useProgressiveScenes);
+        m_sampleOptions.ioOptions.m_useResidencyManager = jData.value("residencymanager", m_sampleOptions.ioOptions.m_useResidencyManager);
+        m_sampleOptions.ioOptions.m_residencyBudget = jData.value("residencybudget", m_sampleOptions.ioOptions.m_residencyBudget);
 
         // camera options
         m_sampleOptions.cameraOptions.m_cameraSpeed = jData.value("cameraspeed", m_sampleOptions.cameraOptions.m_cameraSpeed);
@@ -142,10 +173,11 @@ void DirectStorageSample::OnParseCommandLine(LPSTR lpCmdLine, uint32_t* pWidth,
     // parse streaming volumes.
     const auto& jsonStreamingVolumes = m_jsonConfigFile["StreamingVolumes"];
     const auto streamingVolumeCount = jsonStreamingVolumes.size();
-    m_StreamingVolumes.resize(streamingVolumeCount);
+    m_streamingVolumeGrid.OnCreate(max(m_sampleOptions.ioOptions.m_streamingGridCellSize, 0.001f));
+    m_StreamingVolumes.reserve(streamingVolumeCount);
     for (size_t volIdx = 0; volIdx < streamingVolumeCount; volIdx++)
     {
-        StreamingVolume& volume = m_StreamingVolumes[volIdx];
+        StreamingVolume volume;
         json::object_t volJsonNode = jsonStreamingVolumes[volIdx];
         volume.m_center = math::Point3(GetElementVector(volJsonNode, "position", math::Vector4(0, 0, 0, 0)).getXYZ());
         volume.m_radius = math::Vector3(GetElementVector(volJsonNode, "radius", math::Vector4(0.5, 0.5, 0.5, 0)).getXYZ());
@@ -163,6 +195,7 @@ void DirectStorageSample::OnParseCommandLine(LPSTR lpCmdLine, uint32_t* pWidth,
         }
 
         volume.m_sceneName = GetElementString(volJsonNode, "sceneName", "Unknown");
+        AddStreamingVolume(volume);
     }
 
     // create scene name to path pair map.
@@ -185,9 +218,10 @@ void DirectStorageSample::OnCreate()
     InitDirectXCompiler();
     CreateShaderCache();
 
+    // Reading the package metadata can take a while, render while it happens. Scenes start streaming once it's done.
     if (m_sampleOptions.ioOptions.m_useDirectStorage)
     {
-        Sample::InitializeDirectStorage(m_device.GetDevice(), L"..\\media\\", m_sceneNameToScenePath, m_sampleOptions.ioOptions);
+        m_directStorageInitialized = Sample::InitializeDirectStorageAsync(m_device.GetDevice(), L"..\\media\\", m_sceneNameToScenePath, m_sampleOptions.ioOptions);
     }
     
 
@@ -195,6 +229,29 @@ void DirectStorageSample::OnCreate()
     m_pRenderer = new Renderer();
     m_pRenderer->OnCreate(&m_device, &m_swapChain, &m_AsyncPool, m_sampleOptions.displayOptions.m_fontSize, &m_sceneNameToScenePath, &m_StreamingVolumes, &m_sampleOptions);
 
+    // Without the residency manager nothing is ever over budget, scenes are still accounted for the UI.
+    MemoryBudgetSource* pBudgetSource = &m_fixedMemoryBudget;
+    if (!m_sampleOptions.ioOptions.m_useResidencyManager)
+    {
+        m_fixedMemoryBudget.SetBudget(UINT64_MAX);
+    }
+    else if (m_sampleOptions.ioOptions.m_residencyBudget > 0)
+    {
+        m_fixedMemoryBudget.SetBudget(m_sampleOptions.ioOptions.m_residencyBudget * 1024ull * 1024ull);
+    }
+    else
+    {
+        m_adapterMemoryBudget.OnCreate(&m_device);
+        pBudgetSource = &m_adapterMemoryBudget;
+    }
+    m_residencyManager.OnCreate(pBudgetSource);
+
+    // The tile pool is created with the first tiled texture and lives until shutdown, scenes get what's left.
+    if (m_sampleOptions.ioOptions.m_useDirectStorage && m_sampleOptions.ioOptions.m_useTiledTextures)
+    {
+        m_residencyManager.SetReservedBytes(m_sampleOptions.ioOptions.m_tilePoolSize * 1024ull * 1024ull);
+    }
+
     // init GUI (non gfx stuff)
     ImGUI_Init((void *)m_windowHwnd);
     m_UIState.Initialize();
@@ -220,12 +277,17 @@ void DirectStorageSample::OnDestroy()
     {
         std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>, wchar_t> utf8utf16converter;
         m_profiler.Save(utf8utf16converter.from_bytes(m_sampleOptions.profilerOptions.m_profilerOutputPath).c_str());
+        m_profiler.SaveResidency(utf8utf16converter.from_bytes(m_sampleOptions.profilerOptions.m_profilerOutputPath + ".residency.csv").c_str());
+        m_profiler.SaveSubmits(utf8utf16converter.from_bytes(m_sampleOptions.profilerOptions.m_profilerOutputPath + ".submits.csv").c_str());
     }
 
     m_AsyncPool.Flush();
     ImGUI_Shutdown();
     ShutdownStreaming();
 
+    m_residencyManager.OnDestroy();
+    m_adapterMemoryBudget.OnDestroy();
+
     m_device.GPUFlush();
  
 
@@ -237,6 +299,12 @@ void DirectStorageSample::OnDestroy()
 
     if (m_sampleOptions.ioOptions.m_useDirectStorage)
     {
+        // Initialization may still be running if we're closed early.
+        if (m_directStorageInitialized.valid())
+        {
+            m_directStorageInitialized.wait();
+        }
+
         // shutdown DirectStorage.
         Sample::ShutdownDirectStorage();
     }
@@ -302,35 +370,316 @@ void DirectStorageSample::OnUpdateDisplay()
     }
 }
 
+bool DirectStorageSample::IsStreamingReady()
+{
+    if (!m_sampleOptions.ioOptions.m_useDirectStorage || m_bStreamingReady)
+    {
+        return true;
+    }
+
+    if (m_directStorageInitialized.wait_for(std::chrono::duration<int>(0)) == std::future_status::ready)
+    {
+        m_bStreamingReady = m_directStorageInitialized.get();
+        assert(m_bStreamingReady);
+    }
+
+    return m_bStreamingReady;
+}
+
+void DirectStorageSample::AddStreamingVolume(const StreamingVolume& volume)
+{
+    assert(!m_bStreamingStarted);
+    const float center[3] = { volume.m_center.getX(), volume.m_center.getY(), volume.m_center.getZ() };
+    const float radius[3] = { volume.m_radius.getX(), volume.m_radius.getY(), volume.m_radius.getZ() };
+    const uint32_t volumeIndex = m_streamingVolumeBounds.Add(center, radius);
+    assert(volumeIndex == m_StreamingVolumes.size());
+    m_streamingVolumeGrid.Insert(volumeIndex, volume.m_center - volume.m_radius, volume.m_center + volume.m_radius);
+    m_StreamingVolumes.push_back(volume);
+}
+
 void DirectStorageSample::CheckAndRequestScenesToLoad()
 {
     CPUUserMarker marker("CheckAndRequestScenesToLoad");
+    m_bStreamingStarted = true;
+
+    // Streaming volumes stay inactive until DirectStorage knows about the packages.
+    if (!IsStreamingReady())
+    {
+        return;
+    }
+
+    if (m_sampleOptions.ioOptions.m_useDirectStorage)
+    {
+        Sample::DStorageTrimSceneMetaData(m_sampleOptions.ioOptions);
+    }
+
     // Get eye pos.
     const auto eyePos = math::Point3(m_camera.GetPosition().get128());
 
-    auto& streamingVolumes(m_StreamingVolumes);
-    for (auto& vol : streamingVolumes)
+    // Only volumes near the camera can be entered or prefetched, the rest just need looking at while they're busy.
+    // The search reaches as far as the camera can get within the longest prefetch lead.
+    {
+        float searchDistance = max(m_sampleOptions.ioOptions.m_volumeEnterMargin, 0.0f);
+        if (m_sampleOptions.ioOptions.m_usePrefetch)
+        {
+            const float maxLeadSeconds = max(m_maxPrefetchLeadSeconds, m_sampleOptions.ioOptions.m_prefetchLeadSeconds);
+            searchDistance += Vectormath::SSE::length(m_cameraTrajectory.GetVelocity()) * maxLeadSeconds;
+        }
+
+        const math::Vector3 searchExtent(searchDistance);
+        m_frameStreamingVolumes = m_activeStreamingVolumes;
+        m_streamingVolumeGrid.Query(eyePos - searchExtent, eyePos + searchExtent, m_frameStreamingVolumes);
+
+        // Same order as a plain walk over the volumes, and no volume twice.
+        std::sort(m_frameStreamingVolumes.begin(), m_frameStreamingVolumes.end());
+        m_frameStreamingVolumes.erase(std::unique(m_frameStreamingVolumes.begin(), m_frameStreamingVolumes.end()), m_frameStreamingVolumes.end());
+    }
+
+    // Closer scenes are more important. A scene shown by several volumes goes by the closest one.
+    auto getScenePriority = [&eyePos](const StreamingVolume& vol)
+    {
+        return -Vectormath::SSE::length(eyePos - math::Point3(vol.m_streamedSceneDataTransform.getTranslation()));
+    };
+
+    // Prefetched scenes are the first to go, and never push anything else out.
+    const float prefetchPriority = -FLT_MAX;
+
+    {
+        std::unordered_map<std::string, float> scenePriorities;
+        for (uint32_t volIdx : m_frameStreamingVolumes)
+        {
+            const auto& vol = m_StreamingVolumes[volIdx];
+            if (vol.m_LoadingState == GLTFLoadingState::Loading || vol.m_LoadingState == GLTFLoadingState::Loaded)
+            {
+                const float priority = vol.m_bPrefetched ? prefetchPriority : getScenePriority(vol);
+                auto insertResult = scenePriorities.insert({ vol.m_sceneName, priority });
+                insertResult.first->second = std::max(insertResult.first->second, priority);
+            }
+        }
+
+        for (const auto& scenePriority : scenePriorities)
+        {
+            m_residencyManager.SetScenePriority(scenePriority.first, scenePriority.second);
+        }
+
+        // The budget may have shrunk, or a scene come in bigger than estimated.
+        std::vector<std::string> evictedScenes;
+        m_residencyManager.Update(evictedScenes);
+        for (const auto& sceneName : evictedScenes)
+        {
+            EvictScene(sceneName);
+        }
+    }
+
+    // The margins let volumes be entered a little before the eye reaches them and left a little after, and the dwell time gives scenes some time.
+    // Keeps a camera moving along a volume's border from loading and unloading its scene over and over.
+    const float enterMargin = m_sampleOptions.ioOptions.m_volumeEnterMargin;
+    const float exitMargin = max(m_sampleOptions.ioOptions.m_volumeExitMargin, enterMargin);
+    const double now = MillisecondsNow();
+
+    // Volumes the camera will reach within a scene's load time start loading early, so the scene is there on arrival.
+    // Until a scene has been loaded once the lead time comes from the options. The autopilot tells us where it goes next.
+    const bool usePrefetch = m_sampleOptions.ioOptions.m_usePrefetch;
+    const bool usePriorityQueues = m_sampleOptions.ioOptions.m_useDirectStorage && m_sampleOptions.ioOptions.m_usePriorityQueues;
+
+    // The texture LOD picks a quality tier, only DirectStorage packages have them. The projection scale is the screen pixels one unit covers one unit away.
+    const bool useTextureLOD = m_sampleOptions.ioOptions.m_useDirectStorage && m_sampleOptions.ioOptions.m_useQualityTiers && m_sampleOptions.ioOptions.m_useTextureLOD;
+    // Tiled textures ask for their tiles with the same estimate.
+    const bool useTiledTextures = m_sampleOptions.ioOptions.m_useDirectStorage && m_sampleOptions.ioOptions.m_useTiledTextures;
+    const float projectionScale = (useTextureLOD || useTiledTextures) ? 0.5f * m_Height * m_camera.GetProjection().getElem(1, 1) : 0.0f;
+    std::vector<math::Point3> waypoints;
+    if ((usePrefetch || usePriorityQueues) && m_UIState.bAutopilot)
+    {
+        waypoints = GetAutopilotWaypoints(4);
+    }
+
+    auto getPrefetchLeadSeconds = [&](const StreamingVolume& vol)
+    {
+        auto loadSecondsItr = m_sceneLoadSeconds.find(vol.m_sceneName);
+        return loadSecondsItr != m_sceneLoadSeconds.end() ? loadSecondsItr->second * 1.25f : m_sampleOptions.ioOptions.m_prefetchLeadSeconds;
+    };
+
+    // Where the eye is for all of this frame's volumes in one go. Volumes further than the camera can get in time aren't worth a trajectory test.
+    const size_t frameVolumeCount = m_frameStreamingVolumes.size();
+    m_frameInsideEnterMargin.resize(frameVolumeCount);
+    m_frameInsideExitMargin.resize(frameVolumeCount);
+    const float eye[3] = { eyePos.getX(), eyePos.getY(), eyePos.getZ() };
+    m_streamingVolumeBounds.TestContainment(eye, enterMargin, m_frameStreamingVolumes.data(), frameVolumeCount, m_frameInsideEnterMargin.data());
+    m_streamingVolumeBounds.TestContainment(eye, exitMargin, m_frameStreamingVolumes.data(), frameVolumeCount, m_frameInsideExitMargin.data());
+
+    const float cameraSpeed = Vectormath::SSE::length(m_cameraTrajectory.GetVelocity());
+    if (usePrefetch || usePriorityQueues)
+    {
+        m_frameSignedDistances.resize(frameVolumeCount);
+        m_streamingVolumeBounds.GetSignedDistances(eye, m_frameStreamingVolumes.data(), frameVolumeCount, m_frameSignedDistances.data());
+    }
+
+    auto isHeadingFor = [&](const StreamingVolume& vol, size_t frameIdx, float withinSeconds)
+    {
+        // The margin grows the box on every side, its corners by up to sqrt(3) times as much.
+        if (m_frameSignedDistances[frameIdx] > cameraSpeed * withinSeconds + fabsf(enterMargin) * 1.7320508f)
+        {
+            return false;
+        }
+
+        const math::Vector3 extent = vol.m_radius + math::Vector3(enterMargin);
+        return m_cameraTrajectory.GetTimeToEnter(vol.m_center - extent, vol.m_center + extent, waypoints, withinSeconds) <= withinSeconds;
+    };
+
+    // Seconds until the camera is in the volume itself rather than its margin, which decides the priority of the scene's reads.
+    // Past iolowpriorityseconds the answer doesn't matter, it's low priority either way.
+    auto getTimeToVisible = [&](const StreamingVolume& vol, size_t frameIdx)
     {
-        if (vol.m_LoadingState == GLTFLoadingState::Unloaded && vol.IsPointInside(eyePos))
+        const float maxSeconds = m_sampleOptions.ioOptions.m_ioLowPrioritySeconds;
+        if (m_frameSignedDistances[frameIdx] <= 0.0f)
         {
+            return 0.0f;
+        }
+        if (m_frameSignedDistances[frameIdx] > cameraSpeed * maxSeconds)
+        {
+            return FLT_MAX;
+        }
+        return m_cameraTrajectory.GetTimeToEnter(vol.m_center - vol.m_radius, vol.m_center + vol.m_radius, waypoints, maxSeconds);
+    };
+    std::unordered_map<std::string, float> sceneTimesToVisible;
+
+    auto makeLoadRequest = [&](StreamingVolume& vol, uint64_t workloadId, bool isPrefetch)
+    {
+        SceneLoadRequest loadRequest;
+        loadRequest.workloadId = workloadId;
+        loadRequest.m_sceneName = &vol.m_sceneName;
+        loadRequest.m_streamedSceneDataTransform = vol.m_streamedSceneDataTransform;
+        loadRequest.m_useDirectStorage = m_sampleOptions.ioOptions.m_useDirectStorage;
+        loadRequest.m_usePlacedResources = m_sampleOptions.ioOptions.m_usePlacedResources;
+        loadRequest.m_packageVariant = m_sampleOptions.ioOptions.m_packageVariant;
+        loadRequest.m_distanceToScene = -getScenePriority(vol);
+        loadRequest.m_bPrefetched = isPrefetch;
+        loadRequest.m_projectionScale = projectionScale;
+        return loadRequest;
+    };
+
+    auto hasLeftVolume = [&](const StreamingVolume& vol, size_t frameIdx)
+    {
+        // A prefetch is given up once the camera turns away, with some slack so it doesn't flicker.
+        if (vol.m_bPrefetched)
+        {
+            return !m_frameInsideEnterMargin[frameIdx] && !isHeadingFor(vol, frameIdx, 2.0f * getPrefetchLeadSeconds(vol));
+        }
+        return !m_frameInsideExitMargin[frameIdx] && (now - vol.m_enterTime >= m_sampleOptions.ioOptions.m_volumeMinDwellSeconds * 1000.0);
+    };
+
+    for (size_t frameIdx = 0; frameIdx < frameVolumeCount; frameIdx++)
+    {
+        auto& vol = m_StreamingVolumes[m_frameStreamingVolumes[frameIdx]];
+        const bool isInside = m_frameInsideEnterMargin[frameIdx] != 0;
+        if (vol.m_bPrefetched && isInside && (vol.m_LoadingState == GLTFLoadingState::Loading || vol.m_LoadingState == GLTFLoadingState::Loaded))
+        {
+            // Made it, from now on it's like any other entered volume.
+            vol.m_bPrefetched = false;
+            vol.m_enterTime = now;
+        }
+
+        // A volume still waiting out its scene's keep-alive can take the scene back.
+        const bool canEnter = vol.m_LoadingState == GLTFLoadingState::Unloaded || (vol.m_LoadingState == GLTFLoadingState::Unloading && vol.m_bKeepAlive);
+        const bool isPrefetch = canEnter && !isInside && usePrefetch && isHeadingFor(vol, frameIdx, getPrefetchLeadSeconds(vol));
+        if (canEnter && (isInside || isPrefetch))
+        {
+            // Only the first volume showing a scene loads it, the others wait for the same SceneData.
+            // A scene that doesn't fit the budget is asked for again next frame, in case something else unloaded.
+            auto& sharedScene = m_sharedScenes[vol.m_sceneName];
+            if (sharedScene.m_refCount == 0)
+            {
+                // Every load holds a workload ID until its scene is destroyed, when they're all taken the load waits like it does for memory.
+                if (m_sampleOptions.ioOptions.m_useDirectStorage && !Sample::DStorageHasFreeWorkloadId())
+                {
+                    continue;
+                }
+
+                // Until the scene has been loaded once, all there is to go by is its buffers and the texture size the package lists for the tier its distance picks.
+                uint64_t estimatedBytes = Renderer::GetSceneBufferMemorySize();
+                if (m_sampleOptions.ioOptions.m_useDirectStorage)
+                {
+                    estimatedBytes += Sample::GetSceneTextureMemoryEstimate(m_sceneNameToScenePath.at(vol.m_sceneName), -getScenePriority(vol), m_sampleOptions.ioOptions);
+                }
+
+                std::vector<std::string> evictedScenes;
+                if (!m_residencyManager.RequestLoad(vol.m_sceneName, isPrefetch ? prefetchPriority : getScenePriority(vol), estimatedBytes, evictedScenes))
+                {
+                    continue;
+                }
+
+                for (const auto& sceneName : evictedScenes)
+                {
+                    EvictScene(sceneName);
+                }
+
+                // Take the scene back from a volume still waiting out its keep-alive. An unloading volume can only take back its own.
+                StreamingVolume* pKeptAliveVolume = vol.m_LoadingState == GLTFLoadingState::Unloading ? &vol : FindKeptAliveVolume(vol.m_sceneName);
+                const bool isResurrected = pKeptAliveVolume != nullptr && ResurrectScene(*pKeptAliveVolume);
+                if (!isResurrected && vol.m_LoadingState == GLTFLoadingState::Unloading)
+                {
+                    // Too late, it's being destroyed. Load it again once that's done, the memory is the unload's until then.
+                    m_residencyManager.OnSceneUnloading(vol.m_sceneName);
+                    vol.m_bKeepAlive = false;
+                    continue;
+                }
+            }
+            else if (vol.m_LoadingState == GLTFLoadingState::Unloading)
+            {
+                // Someone else is loading the scene already, finish our unload first.
+                continue;
+            }
+
             vol.m_LoadingState = GLTFLoadingState::Loading;
+            vol.m_enterTime = now;
+            vol.m_bPrefetched = isPrefetch;
+            if (sharedScene.m_refCount++ == 0 && !sharedScene.m_bResurrected)
+            {
+                uint64_t workloadId = 0;
+                if (m_sampleOptions.ioOptions.m_useDirectStorage)
+                {
+                    workloadId = m_sampleOptions.profilerOptions.m_bioTiming ? Sample::DStorageBeginProfileLoading() : Sample::DStorageAllocateWorkloadId();
+                }
+                const SceneLoadRequest loadRequest = makeLoadRequest(vol, workloadId, isPrefetch);
 
-            SceneLoadRequest loadRequest;
-            loadRequest.workloadId = (m_sampleOptions.ioOptions.m_useDirectStorage && m_sampleOptions.profilerOptions.m_bioTiming) ? Sample::DStorageBeginProfileLoading() : 0;
-            loadRequest.m_sceneName = &vol.m_sceneName;
-            loadRequest.m_streamedSceneDataTransform = vol.m_streamedSceneDataTransform;
-            loadRequest.m_useDirectStorage = m_sampleOptions.ioOptions.m_useDirectStorage;
-            loadRequest.m_usePlacedResources = m_sampleOptions.ioOptions.m_usePlacedResources;
+                // Before the load is submitted, it may start on its reads right away.
+                sharedScene.m_ioPriorityClass = usePriorityQueues ? Sample::SelectIOPriorityClass(getTimeToVisible(vol, frameIdx), m_sampleOptions.ioOptions) : Sample::IOPriorityClass_Normal;
+                if (m_sampleOptions.ioOptions.m_useDirectStorage)
+                {
+                    Sample::DStorageSetWorkloadPriorityClass(loadRequest.workloadId, static_cast<Sample::IOPriorityClass>(sharedScene.m_ioPriorityClass));
+                }
 
-            vol.workloadId = loadRequest.workloadId;
-            vol.m_LoadedSceneFuture = std::move(m_pRenderer->LoadSceneAsync(loadRequest));
+                sharedScene.workloadId = loadRequest.workloadId;
+                sharedScene.m_bTimingRecorded = false;
+                sharedScene.m_bResidencyRecorded = false;
+                sharedScene.m_LoadedSceneFuture = m_pRenderer->LoadSceneAsync(loadRequest).share();
+            }
+
+            vol.workloadId = sharedScene.workloadId;
+            vol.m_LoadedSceneFuture = sharedScene.m_LoadedSceneFuture;
         }
 
-        if (m_sampleOptions.ioOptions.m_allowCancellation && vol.m_LoadingState == GLTFLoadingState::Loading && !vol.IsPointInside(eyePos))
+        if (m_sampleOptions.ioOptions.m_allowCancellation && vol.m_LoadingState == GLTFLoadingState::Loading && hasLeftVolume(vol, frameIdx))
         {
-            // Cancel scene async
-            vol.m_LoadingState = GLTFLoadingState::CancellationRequested;
-            if (m_sampleOptions.ioOptions.m_useDirectStorage) Sample::DStorageCancelRequest(vol.workloadId);
+            auto& sharedScene = m_sharedScenes.at(vol.m_sceneName);
+            if (sharedScene.m_refCount > 1)
+            {
+                // Other volumes still want the scene, just stop waiting for it.
+                sharedScene.m_refCount--;
+                vol.m_LoadedSceneFuture = {};
+                vol.m_LoadingState = GLTFLoadingState::Unloaded;
+            }
+            else
+            {
+                // Cancel scene async. Volumes entering from now on start a fresh load.
+                // A resurrected scene has no reads left to cancel.
+                const bool isResurrected = sharedScene.m_bResurrected;
+                DiscardSceneRefine(vol.m_sceneName, sharedScene);
+                sharedScene = SharedScene();
+                m_residencyManager.OnSceneUnloaded(vol.m_sceneName);
+                vol.m_LoadingState = GLTFLoadingState::CancellationRequested;
+                if (m_sampleOptions.ioOptions.m_useDirectStorage && !isResurrected) Sample::DStorageCancelRequest(vol.workloadId);
+            }
         }
 
         if (vol.m_LoadingState == GLTFLoadingState::CancellationRequested)
@@ -342,10 +691,18 @@ void DirectStorageSample::CheckAndRequestScenesToLoad()
                 vol.m_pSceneData = vol.m_LoadedSceneFuture.get();
                 vol.m_pSceneData->m_timingData.frameTimes.Reset();
                 vol.m_LoadingState = GLTFLoadingState::Unloading;
-                vol.m_LoadedSceneFuture = std::move(m_pRenderer->UnloadSceneAsync(vol.m_sceneName, vol.m_pSceneData));
+                vol.m_LoadedSceneFuture = m_pRenderer->UnloadSceneAsync(vol.m_sceneName, vol.m_pSceneData).share();
             }
         }
 
+        if (usePriorityQueues && vol.m_LoadingState == GLTFLoadingState::Loading)
+        {
+            // The closest volume showing the scene decides, see below.
+            const float timeToVisible = getTimeToVisible(vol, frameIdx);
+            auto insertResult = sceneTimesToVisible.insert({ vol.m_sceneName, timeToVisible });
+            insertResult.first->second = min(insertResult.first->second, timeToVisible);
+        }
+
         if (vol.m_LoadingState == GLTFLoadingState::Loading)
         {            
             auto status = vol.m_LoadedSceneFuture.wait_for(std::chrono::duration<int>(0));
@@ -355,16 +712,22 @@ void DirectStorageSample::CheckAndRequestScenesToLoad()
                 vol.m_pSceneData = vol.m_LoadedSceneFuture.get();
                 vol.m_LoadingState = GLTFLoadingState::Loaded;
 
-                if (m_sampleOptions.ioOptions.m_useDirectStorage && m_sampleOptions.profilerOptions.m_bioTiming) vol.m_pSceneData->m_timingData.ioTime = Sample::DStorageProfileRetrieveTiming(vol.workloadId);
+                auto& sharedScene = m_sharedScenes.at(vol.m_sceneName);
+                if (!sharedScene.m_bResidencyRecorded)
+                {
+                    sharedScene.m_bResidencyRecorded = true;
+                    m_residencyManager.OnSceneLoaded(vol.m_sceneName, vol.m_pSceneData->m_gpuMemorySize);
+                }
 
-                if (m_sampleOptions.profilerOptions.m_bProfilerOutputEnabled)
+                // Progressive scenes are shown with placeholder textures, their load is timed once the real ones are in.
+                vol.m_bTexturesPending = !vol.m_pSceneData->m_bTexturesResident;
+                if (!vol.m_bTexturesPending)
                 {
-                    vol.m_pSceneData->m_timingData.frameTimes = std::move(vol.frameTimes);
-                    m_profiler.AddData(vol.m_pSceneData->m_timingData);
+                    RecordSceneLoadTiming(vol, sharedScene);
                 }
 
                 // Notify scene loaded.
-                m_pRenderer->AddScene(vol.m_pSceneData);
+                m_pRenderer->AddScene(vol.m_pSceneData, &vol.m_streamedSceneDataTransform);
             }
             else
             {
@@ -372,12 +735,81 @@ void DirectStorageSample::CheckAndRequestScenesToLoad()
             }
         }
 
-        if (vol.m_LoadingState == GLTFLoadingState::Loaded && !vol.IsPointInside(eyePos))
+        if (vol.m_LoadingState == GLTFLoadingState::Loaded && vol.m_bTexturesPending)
         {
-            vol.m_LoadingState = GLTFLoadingState::Unloading;
-            vol.m_pSceneData->m_timingData.frameTimes.Reset();
-            m_pRenderer->RemoveScene(vol.m_pSceneData);
-            vol.m_LoadedSceneFuture = std::move(m_pRenderer->UnloadSceneAsync(vol.m_sceneName, vol.m_pSceneData));
+            if (vol.m_pSceneData->m_bTexturesResident)
+            {
+                vol.m_bTexturesPending = false;
+                RecordSceneLoadTiming(vol, m_sharedScenes.at(vol.m_sceneName));
+            }
+            else
+            {
+                vol.frameTimes.AddTime(m_pRenderer->GetLastFrameTiming());
+            }
+        }
+
+        // Scenes loaded without the mips the camera was too far away to see are loaded again once it gets closer, and swapped in when their textures are in.
+        if (useTextureLOD && vol.m_LoadingState == GLTFLoadingState::Loaded && vol.m_pSceneData->m_textureLODTier > 0 && vol.m_pSceneData->m_bTexturesResident)
+        {
+            auto& sharedScene = m_sharedScenes.at(vol.m_sceneName);
+            if (sharedScene.m_RefinedSceneFuture.valid())
+            {
+                if (sharedScene.m_RefinedSceneFuture.wait_for(std::chrono::duration<int>(0)) == std::future_status::ready && sharedScene.m_RefinedSceneFuture.get()->m_bTexturesResident)
+                {
+                    SwapRefinedScene(vol.m_sceneName);
+                }
+            }
+            else if (vol.m_pSceneData->GetTextureLODMipDrop(vol.m_streamedSceneDataTransform, -getScenePriority(vol), projectionScale) < vol.m_pSceneData->m_textureLODTier)
+            {
+                // Fewer mips dropped don't help if the distance or the memory budget keep the scene at its tier anyway.
+                const uint32_t refinedQualityTier = m_pRenderer->SelectRefinedQualityTier(vol.m_pSceneData, vol.m_streamedSceneDataTransform, -getScenePriority(vol), projectionScale);
+                std::vector<std::string> evictedScenes;
+                const uint64_t refineBytes = Renderer::GetSceneBufferMemorySize() + Sample::GetSceneTextureResidentSize(m_sceneNameToScenePath.at(vol.m_sceneName), refinedQualityTier);
+                if (refinedQualityTier < vol.m_pSceneData->m_timingData.loadRequest.m_qualityTier && Sample::DStorageHasFreeWorkloadId() && m_residencyManager.RequestRefine(vol.m_sceneName, refineBytes, evictedScenes))
+                {
+                    for (const auto& sceneName : evictedScenes)
+                    {
+                        EvictScene(sceneName);
+                    }
+
+                    // The scene is already on screen, its better textures can wait for everything else.
+                    const SceneLoadRequest loadRequest = makeLoadRequest(vol, Sample::DStorageAllocateWorkloadId(), false);
+                    Sample::DStorageSetWorkloadPriorityClass(loadRequest.workloadId, usePriorityQueues ? Sample::IOPriorityClass_Low : Sample::IOPriorityClass_Normal);
+                    sharedScene.m_refinedWorkloadId = loadRequest.workloadId;
+                    sharedScene.m_refineReservedBytes = refineBytes;
+                    sharedScene.m_RefinedSceneFuture = m_pRenderer->LoadSceneAsync(loadRequest).share();
+                }
+            }
+        }
+
+        // Tiles of the textures of the scenes on screen, a scene shown by several volumes takes the largest mips any of them needs.
+        if (useTiledTextures && vol.m_LoadingState == GLTFLoadingState::Loaded && vol.m_pSceneData->m_bTexturesResident)
+        {
+            vol.m_pSceneData->RequestTiledTextureMips(vol.m_streamedSceneDataTransform, -getScenePriority(vol), projectionScale);
+        }
+
+        if (vol.m_LoadingState == GLTFLoadingState::Loaded && hasLeftVolume(vol, frameIdx))
+        {
+            m_pRenderer->RemoveScene(vol.m_pSceneData, &vol.m_streamedSceneDataTransform);
+
+            auto& sharedScene = m_sharedScenes.at(vol.m_sceneName);
+            if (--sharedScene.m_refCount > 0)
+            {
+                // Still shown by other volumes.
+                vol.m_pSceneData = nullptr;
+                vol.m_LoadedSceneFuture = {};
+                vol.m_LoadingState = GLTFLoadingState::Unloaded;
+            }
+            else
+            {
+                DiscardSceneRefine(vol.m_sceneName, sharedScene);
+                sharedScene = SharedScene();
+                m_residencyManager.OnSceneUnloading(vol.m_sceneName);
+                vol.m_LoadingState = GLTFLoadingState::Unloading;
+                vol.m_bKeepAlive = m_sampleOptions.ioOptions.m_unloadKeepAliveSeconds > 0.0f;
+                vol.m_pSceneData->m_timingData.frameTimes.Reset();
+                vol.m_LoadedSceneFuture = m_pRenderer->UnloadSceneAsync(vol.m_sceneName, vol.m_pSceneData, m_sampleOptions.ioOptions.m_unloadKeepAliveSeconds).share();
+            }
         }
 
         if (vol.m_LoadingState == GLTFLoadingState::Unloading)
@@ -387,11 +819,276 @@ void DirectStorageSample::CheckAndRequestScenesToLoad()
             {
                 vol.m_pSceneData = vol.m_LoadedSceneFuture.get(); // should be null ptr.
                 vol.m_LoadingState = GLTFLoadingState::Unloaded;
+                vol.m_bKeepAlive = false;
+                m_residencyManager.OnSceneDestroyed(vol.m_sceneName);
+            }
+        }
+    }
+
+    // Loads still waiting to enqueue their reads move to the class the camera now puts them in.
+    for (const auto& sceneTimeToVisible : sceneTimesToVisible)
+    {
+        auto sharedSceneItr = m_sharedScenes.find(sceneTimeToVisible.first);
+        if (sharedSceneItr == m_sharedScenes.end() || sharedSceneItr->second.m_refCount == 0 || sharedSceneItr->second.m_bResurrected)
+        {
+            continue;
+        }
+
+        auto& sharedScene = sharedSceneItr->second;
+        const auto priorityClass = Sample::SelectIOPriorityClass(sceneTimeToVisible.second, m_sampleOptions.ioOptions);
+        if (priorityClass != sharedScene.m_ioPriorityClass)
+        {
+            sharedScene.m_ioPriorityClass = priorityClass;
+            Sample::DStorageSetWorkloadPriorityClass(sharedScene.workloadId, priorityClass);
+        }
+    }
+
+    // Evictions and resurrections only touch volumes that were active, so everything that changed was looked at this frame.
+    m_activeStreamingVolumes.clear();
+    for (uint32_t volIdx : m_frameStreamingVolumes)
+    {
+        if (m_StreamingVolumes[volIdx].m_LoadingState != GLTFLoadingState::Unloaded)
+        {
+            m_activeStreamingVolumes.push_back(volIdx);
+        }
+    }
+
+    UpdateRetiringScenes();
+
+    if (useTiledTextures)
+    {
+        Sample::DStorageUpdateTiledTextures();
+    }
+
+    for (auto& residencyEvent : m_residencyManager.TakeEvents())
+    {
+        if (m_sampleOptions.profilerOptions.m_bProfilerOutputEnabled)
+        {
+            m_profiler.AddResidencyEvent(std::move(residencyEvent));
+        }
+    }
+
+    // Taken every frame either way, the submit thread keeps them until then.
+    if (m_sampleOptions.ioOptions.m_useDirectStorage)
+    {
+        for (const auto& submitEvent : Sample::DStorageTakeSubmitEvents())
+        {
+            if (m_sampleOptions.profilerOptions.m_bProfilerOutputEnabled)
+            {
+                m_profiler.AddSubmitEvent(submitEvent);
             }
         }
     }
 }
 
+void DirectStorageSample::RecordSceneLoadTiming(StreamingVolume& vol, SharedScene& sharedScene)
+{
+    if (!sharedScene.m_bTimingRecorded)
+    {
+        sharedScene.m_bTimingRecorded = true;
+
+        // Smoothed, a single slow load shouldn't make every prefetch of the scene start far too early.
+        if (!sharedScene.m_bResurrected)
+        {
+            const float loadSeconds = static_cast<float>(vol.m_pSceneData->m_timingData.loadTime / 1000.0);
+            auto insertResult = m_sceneLoadSeconds.insert({ vol.m_sceneName, loadSeconds });
+            if (!insertResult.second)
+            {
+                insertResult.first->second = 0.75f * insertResult.first->second + 0.25f * loadSeconds;
+            }
+            m_maxPrefetchLeadSeconds = max(m_maxPrefetchLeadSeconds, insertResult.first->second * 1.25f);
+        }
+
+        if (m_sampleOptions.ioOptions.m_useDirectStorage && m_sampleOptions.profilerOptions.m_bioTiming && !sharedScene.m_bResurrected) vol.m_pSceneData->m_timingData.ioTime = Sample::DStorageProfileRetrieveTiming(vol.workloadId);
+
+        if (m_sampleOptions.profilerOptions.m_bProfilerOutputEnabled && !sharedScene.m_bResurrected)
+        {
+            vol.m_pSceneData->m_timingData.frameTimes = std::move(vol.frameTimes);
+            m_profiler.AddData(vol.m_pSceneData->m_timingData);
+        }
+    }
+    vol.frameTimes.Reset();
+}
+
+void DirectStorageSample::SwapRefinedScene(const std::string& sceneName)
+{
+    auto& sharedScene = m_sharedScenes.at(sceneName);
+    SceneData* pRefinedSceneData = sharedScene.m_RefinedSceneFuture.get();
+
+    // Every volume showing the scene moves over at once. They're all active, so among this frame's volumes.
+    SceneData* pReplacedSceneData = nullptr;
+    for (uint32_t volIdx : m_frameStreamingVolumes)
+    {
+        auto& vol = m_StreamingVolumes[volIdx];
+        if (vol.m_sceneName != sceneName || (vol.m_LoadingState != GLTFLoadingState::Loaded && vol.m_LoadingState != GLTFLoadingState::Loading))
+        {
+            continue;
+        }
+
+        // A volume still in Loading hasn't looked at its finished future yet, it picks up the refined scene instead.
+        if (vol.m_LoadingState == GLTFLoadingState::Loaded)
+        {
+            m_pRenderer->RemoveScene(vol.m_pSceneData, &vol.m_streamedSceneDataTransform);
+            pReplacedSceneData = vol.m_pSceneData;
+            vol.m_pSceneData = pRefinedSceneData;
+            m_pRenderer->AddScene(vol.m_pSceneData, &vol.m_streamedSceneDataTransform);
+        }
+        vol.workloadId = sharedScene.m_refinedWorkloadId;
+        vol.m_LoadedSceneFuture = sharedScene.m_RefinedSceneFuture;
+    }
+
+    sharedScene.m_LoadedSceneFuture = sharedScene.m_RefinedSceneFuture;
+    sharedScene.workloadId = sharedScene.m_refinedWorkloadId;
+    sharedScene.m_RefinedSceneFuture = {};
+
+    // The refine's reservation moves over to the replaced scene until it's destroyed.
+    assert(pReplacedSceneData != nullptr);
+    const uint64_t replacedBytes = pReplacedSceneData != nullptr ? pReplacedSceneData->m_gpuMemorySize : 0;
+    m_residencyManager.OnRefineSwapped(sceneName, sharedScene.m_refineReservedBytes, pRefinedSceneData->m_gpuMemorySize, replacedBytes);
+    sharedScene.m_refineReservedBytes = 0;
+
+    if (pReplacedSceneData != nullptr)
+    {
+        pReplacedSceneData->m_timingData.frameTimes.Reset();
+        m_retiringScenes.push_back({ sceneName, m_pRenderer->UnloadSceneAsync(sceneName, pReplacedSceneData).share(), true, replacedBytes });
+    }
+}
+
+void DirectStorageSample::DiscardSceneRefine(const std::string& sceneName, SharedScene& sharedScene)
+{
+    if (sharedScene.m_RefinedSceneFuture.valid())
+    {
+        m_retiringScenes.push_back({ sceneName, sharedScene.m_RefinedSceneFuture, false, sharedScene.m_refineReservedBytes });
+        sharedScene.m_RefinedSceneFuture = {};
+        sharedScene.m_refineReservedBytes = 0;
+    }
+}
+
+bool DirectStorageSample::UpdateRetiringScenes()
+{
+    for (size_t retiringIdx = 0; retiringIdx < m_retiringScenes.size();)
+    {
+        auto& retiringScene = m_retiringScenes[retiringIdx];
+        if (retiringScene.m_sceneFuture.wait_for(std::chrono::duration<int>(0)) != std::future_status::ready)
+        {
+            retiringIdx++;
+            continue;
+        }
+
+        if (retiringScene.m_bUnloading)
+        {
+            m_residencyManager.ReleaseRefine(retiringScene.m_reservedBytes);
+            retiringScene = std::move(m_retiringScenes.back());
+            m_retiringScenes.pop_back();
+            continue;
+        }
+
+        SceneData* pSceneData = retiringScene.m_sceneFuture.get();
+        retiringScene.m_sceneFuture = m_pRenderer->UnloadSceneAsync(retiringScene.m_sceneName, pSceneData).share();
+        retiringScene.m_bUnloading = true;
+        retiringIdx++;
+    }
+
+    return !m_retiringScenes.empty();
+}
+
+// Kept-alive volumes are still active, so they're among the volumes looked at this frame.
+StreamingVolume* DirectStorageSample::FindKeptAliveVolume(const std::string& sceneName)
+{
+    for (uint32_t volIdx : m_frameStreamingVolumes)
+    {
+        auto& vol = m_StreamingVolumes[volIdx];
+        if (vol.m_sceneName == sceneName && vol.m_LoadingState == GLTFLoadingState::Unloading && vol.m_bKeepAlive)
+        {
+            return &vol;
+        }
+    }
+    return nullptr;
+}
+
+bool DirectStorageSample::ResurrectScene(StreamingVolume& keptAliveVolume)
+{
+    if (!m_pRenderer->ResurrectScene(keptAliveVolume.m_pSceneData))
+    {
+        // Its keep-alive ran out, the unload goes ahead.
+        keptAliveVolume.m_bKeepAlive = false;
+        return false;
+    }
+
+    // The unload now hands the scene back, so volumes wait on it like on a load.
+    auto& sharedScene = m_sharedScenes.at(keptAliveVolume.m_sceneName);
+    sharedScene.m_LoadedSceneFuture = keptAliveVolume.m_LoadedSceneFuture;
+    sharedScene.workloadId = keptAliveVolume.workloadId;
+    sharedScene.m_bTimingRecorded = false;
+    sharedScene.m_bResidencyRecorded = false;
+    sharedScene.m_bResurrected = true;
+
+    keptAliveVolume.m_pSceneData = nullptr;
+    keptAliveVolume.m_LoadedSceneFuture = {};
+    keptAliveVolume.m_LoadingState = GLTFLoadingState::Unloaded;
+    keptAliveVolume.m_bKeepAlive = false;
+    return true;
+}
+
+void DirectStorageSample::EvictScene(const std::string& sceneName)
+{
+    // Already unloading, a kept-alive scene only has to stop waiting. One being destroyed needs nothing.
+    StreamingVolume* pKeptAliveVolume = FindKeptAliveVolume(sceneName);
+    if (pKeptAliveVolume != nullptr)
+    {
+        m_pRenderer->EndSceneKeepAlive(pKeptAliveVolume->m_pSceneData);
+        pKeptAliveVolume->m_bKeepAlive = false;
+        return;
+    }
+
+    // Every volume showing the scene lets go of it, the first one takes care of the unload. They're all active, so among this frame's volumes.
+    StreamingVolume* pUnloadingVolume = nullptr;
+    SceneData* pSceneData = nullptr;
+    for (uint32_t volIdx : m_frameStreamingVolumes)
+    {
+        auto& vol = m_StreamingVolumes[volIdx];
+        if (vol.m_sceneName != sceneName || (vol.m_LoadingState != GLTFLoadingState::Loaded && vol.m_LoadingState != GLTFLoadingState::Loading))
+        {
+            continue;
+        }
+
+        // Only loaded scenes are evicted, so a volume still in Loading has a finished future it hasn't looked at yet.
+        if (vol.m_LoadingState == GLTFLoadingState::Loaded)
+        {
+            m_pRenderer->RemoveScene(vol.m_pSceneData, &vol.m_streamedSceneDataTransform);
+            pSceneData = vol.m_pSceneData;
+        }
+        else
+        {
+            pSceneData = vol.m_LoadedSceneFuture.get();
+        }
+
+        vol.m_pSceneData = nullptr;
+        vol.m_LoadedSceneFuture = {};
+        vol.m_LoadingState = GLTFLoadingState::Unloaded;
+        vol.frameTimes.Reset();
+
+        if (pUnloadingVolume == nullptr)
+        {
+            pUnloadingVolume = &vol;
+        }
+    }
+
+    if (pUnloadingVolume == nullptr)
+    {
+        return;
+    }
+
+    auto& sharedScene = m_sharedScenes.at(sceneName);
+    DiscardSceneRefine(sceneName, sharedScene);
+    sharedScene = SharedScene();
+
+    pSceneData->m_timingData.frameTimes.Reset();
+    pUnloadingVolume->m_pSceneData = pSceneData;
+    pUnloadingVolume->m_LoadingState = GLTFLoadingState::Unloading;
+    pUnloadingVolume->m_LoadedSceneFuture = m_pRenderer->UnloadSceneAsync(sceneName, pSceneData).share();
+}
+
 void DirectStorageSample::ShutdownStreaming()
 {
     {
@@ -434,18 +1131,49 @@ void DirectStorageSample::ShutdownStreaming()
             } while (isInFlight);
         };
 
+        // Nothing will come back for scenes waiting out their keep-alive.
+        for (auto& vol : m_StreamingVolumes)
+        {
+            if (vol.m_LoadingState == GLTFLoadingState::Unloading && vol.m_bKeepAlive)
+            {
+                m_pRenderer->EndSceneKeepAlive(vol.m_pSceneData);
+            }
+        }
+
         waitForInFlightOperations();
 
-        // Request scene unload.
+        // Request scene unload. Volumes sharing a scene unload it once.
+        std::vector<SceneData*> unloadedScenes;
         for (auto& vol : m_StreamingVolumes)
         {
             if (vol.m_LoadingState == GLTFLoadingState::Loaded)
             {
-                vol.m_LoadedSceneFuture = m_pRenderer->UnloadSceneAsync(vol.m_sceneName,vol.m_pSceneData);
+                if (std::find(unloadedScenes.begin(), unloadedScenes.end(), vol.m_pSceneData) == unloadedScenes.end())
+                {
+                    unloadedScenes.push_back(vol.m_pSceneData);
+                    vol.m_LoadingState = GLTFLoadingState::Unloading;
+                    vol.m_LoadedSceneFuture = m_pRenderer->UnloadSceneAsync(vol.m_sceneName, vol.m_pSceneData).share();
+                }
+                else
+                {
+                    vol.m_pSceneData = nullptr;
+                    vol.m_LoadingState = GLTFLoadingState::Unloaded;
+                }
             }
         }
 
         waitForInFlightOperations();
+
+        // Refines still loading, and the scenes they replaced.
+        for (auto& sharedScene : m_sharedScenes)
+        {
+            DiscardSceneRefine(sharedScene.first, sharedScene.second);
+        }
+        while (UpdateRetiringScenes())
+        {
+            std::this_thread::yield();
+        }
+        m_sharedScenes.clear();
     }
 }
 
@@ -506,9 +1234,8 @@ void DirectStorageSample::UpdateCamera(Camera& cam, const ImGuiIO* io)
 
     if (m_UIState.bAutopilot)
     {
-        static int sourceIdx = 0;
-        static int targetIdx = 1;
-        static int directionalOffset = 1;
+        int& sourceIdx = m_autopilotSourceIdx;
+        int& targetIdx = m_autopilotTargetIdx;
         auto startPos = m_StreamingVolumes[sourceIdx].m_center;
         auto endPos = m_StreamingVolumes[targetIdx].m_center;
 
@@ -543,16 +1270,7 @@ void DirectStorageSample::UpdateCamera(Camera& cam, const ImGuiIO* io)
         int mask = _mm_movemask_ps(_mm_cmpeq_ps(lastPosition.get128(), clampedPosition.get128()));
         if (mask == 0xF)
         {
-            // now change targets.
-            sourceIdx = (sourceIdx + directionalOffset) % m_StreamingVolumes.size();
-            targetIdx = (sourceIdx + directionalOffset) % m_StreamingVolumes.size();
-
-            // change directions if necessary and set the next target.
-            if (abs(sourceIdx - targetIdx) >= 1)
-            {
-                directionalOffset = targetIdx < sourceIdx ? -1 : 1;
-                targetIdx = sourceIdx + directionalOffset;
-            }
+            AdvanceAutopilotTarget(sourceIdx, targetIdx, m_autopilotDirectionalOffset);
         }
 
         // record last position.
@@ -579,6 +1297,40 @@ void DirectStorageSample::UpdateCamera(Camera& cam, const ImGuiIO* io)
    lastPosition = Vectormath::SSE::Point3(cam.GetPosition().get128());
 }
 
+void DirectStorageSample::AdvanceAutopilotTarget(int& sourceIdx, int& targetIdx, int& directionalOffset) const
+{
+    // now change targets.
+    sourceIdx = (sourceIdx + directionalOffset) % m_StreamingVolumes.size();
+    targetIdx = (sourceIdx + directionalOffset) % m_StreamingVolumes.size();
+
+    // change directions if necessary and set the next target.
+    if (abs(sourceIdx - targetIdx) >= 1)
+    {
+        directionalOffset = targetIdx < sourceIdx ? -1 : 1;
+        targetIdx = sourceIdx + directionalOffset;
+    }
+}
+
+// The volume centers the autopilot will fly through next, starting with its current target.
+std::vector<math::Point3> DirectStorageSample::GetAutopilotWaypoints(size_t count) const
+{
+    std::vector<math::Point3> waypoints;
+    if (m_StreamingVolumes.size() < 2)
+    {
+        return waypoints;
+    }
+
+    int sourceIdx = m_autopilotSourceIdx;
+    int targetIdx = m_autopilotTargetIdx;
+    int directionalOffset = m_autopilotDirectionalOffset;
+    for (size_t i = 0; i < count; i++)
+    {
+        waypoints.push_back(m_StreamingVolumes[targetIdx].m_center);
+        AdvanceAutopilotTarget(sourceIdx, targetIdx, directionalOffset);
+    }
+    return waypoints;
+}
+
 //--------------------------------------------------------------------------------------
 //
 // OnRender
@@ -597,6 +1349,7 @@ void DirectStorageSample::OnRender()
     BuildUI(); // UI logic. Note that the rendering of the UI happens later.
 
     OnUpdate();
+    m_cameraTrajectory.AddPosition(MillisecondsNow(), math::Point3(m_camera.GetPosition().get128()));
     CheckAndRequestScenesToLoad();
 
     TimeState timeState = {};
@@ -19,7 +19,11 @@
 #pragma once
 
 #include "base/FrameworkWindows.h"
+#include "CameraTrajectory.h"
 #include "Renderer.h"
+#include "ResidencyManager.h"
+#include "StreamingVolumeBounds.h"
+#include "StreamingVolumeGrid.h"
 #include "UI.h"
 #include "Profile.h"
 #include "SampleOptions.h"
@@ -38,13 +42,25 @@ public:
 
     void BuildUI();
     
+    // Only while parsing the config. Loads and the renderer keep pointers into m_StreamingVolumes once streaming starts, so it can't grow after that.
+    void AddStreamingVolume(const StreamingVolume& volume);
     void CheckAndRequestScenesToLoad();
+    bool IsStreamingReady();
+    void EvictScene(const std::string& sceneName);
+    StreamingVolume* FindKeptAliveVolume(const std::string& sceneName);
+    bool ResurrectScene(StreamingVolume& keptAliveVolume);
+    void RecordSceneLoadTiming(StreamingVolume& vol, SharedScene& sharedScene);
+    void SwapRefinedScene(const std::string& sceneName);
+    void DiscardSceneRefine(const std::string& sceneName, SharedScene& sharedScene);
+    bool UpdateRetiringScenes();
     void ShutdownStreaming();
 
     void OnUpdate();
 
     void HandleInput(const ImGuiIO& io);
     void UpdateCamera(Camera& cam, const ImGuiIO* io);
+    void AdvanceAutopilotTarget(int& sourceIdx, int& targetIdx, int& directionalOffset) const;
+    std::vector<math::Point3> GetAutopilotWaypoints(size_t count) const;
     
 private:
     SampleOptions               m_sampleOptions;
@@ -65,11 +81,41 @@ private:
 
     float                       m_time; // Time accumulator in seconds, used for animation.
 
+    // Autopilot flies from the source volume to the target volume.
+    int                         m_autopilotSourceIdx = 0;
+    int                         m_autopilotTargetIdx = 1;
+    int                         m_autopilotDirectionalOffset = 1;
+
     // json config file
     json                        m_jsonConfigFile;
     std::vector<std::string>    m_sceneNames;
     std::unordered_map<std::string, ScenePathPair> m_sceneNameToScenePath;
     std::vector<StreamingVolume> m_StreamingVolumes;
+    StreamingVolumeBounds       m_streamingVolumeBounds; // Same indices as m_StreamingVolumes.
+    StreamingVolumeGrid         m_streamingVolumeGrid;
+    std::vector<uint32_t>       m_activeStreamingVolumes; // Indices of the volumes that aren't unloaded.
+    std::vector<uint32_t>       m_frameStreamingVolumes; // Indices of the volumes looked at this frame.
+    // Where the eye is relative to this frame's volumes, same order as m_frameStreamingVolumes.
+    std::vector<uint8_t>        m_frameInsideEnterMargin;
+    std::vector<uint8_t>        m_frameInsideExitMargin;
+    std::vector<float>          m_frameSignedDistances;
+    std::unordered_map<std::string, SharedScene> m_sharedScenes; // By scene name.
+    std::vector<RetiringScene>  m_retiringScenes; // Left behind by the texture LOD, unloaded once their loads are done.
+
+    // Keeps the streamed scenes within the GPU memory budget.
+    AdapterMemoryBudgetSource   m_adapterMemoryBudget;
+    FixedMemoryBudgetSource     m_fixedMemoryBudget;
+    ResidencyManager            m_residencyManager;
+
+    // Where the camera is heading, and how long each scene took to load, for prefetching.
+    CameraTrajectory            m_cameraTrajectory;
+    std::unordered_map<std::string, float> m_sceneLoadSeconds; // By scene name.
+    float                       m_maxPrefetchLeadSeconds = 0.0f; // The longest lead any scene has had, sizes the search for volumes to prefetch.
+
+    // Signalled once DirectStorage has found all packages.
+    std::future<bool>           m_directStorageInitialized;
+    bool                        m_bStreamingReady = false;
+    bool                        m_bStreamingStarted = false; // Set on the first streaming update, see AddStreamingVolume.
 
     bool                        m_bPlay;
 };
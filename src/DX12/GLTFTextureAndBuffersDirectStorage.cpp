@@ -30,8 +30,13 @@
 #include <dstorage.h>
 #include <codecvt>
 #include <unordered_map>
+#include <condition_variable>
 #include "misc/DxgiFormatHelper.h"
 #include "PackageUtils.h"
+#include "HeapPlacement.h"
+#include "TiledTextureStreamer.h"
+#include "DStorageQueueFeeder.h"
+#include "DStorageSubmitThread.h"
 #include "Misc/CPUUserMarkers.h"
 #include "DirectStorageSample.h"
 
@@ -59,50 +64,448 @@ namespace Sample
     struct ResourceLookupEntry
     {
         const DirectStorageSampleTextureMetadataHeader* metaDataHeader = nullptr;
-        uint64_t resourceHeapOffset = 0;
-        uint64_t resourceHeapSize = 0;
+        std::array<uint64_t, c_DirectStorageSampleMaxQualityTiers> resourceHeapOffset{}; // Indexed by the quality tier of the scene.
+        std::array<uint64_t, c_DirectStorageSampleMaxQualityTiers> resourceHeapSize{};
+        std::array<uint64_t, c_DirectStorageSampleMaxQualityTiers> resourceHeapAlignment{};
+        const DirectStorageSampleTextureRegion* regions = nullptr; // Smallest mips first. Null if the texture is stored in one piece per tier.
+        uint32_t regionCount = 0;
+        const DirectStorageSampleTextureTiles* tiles = nullptr; // Null unless the package has tiles and tiledtextures is on.
+        const DirectStorageSampleTile* tileEntries = nullptr; // The texture's tiles.
         IDStorageFile* reseourceFileHandle = nullptr;
         std::string gltfPath; // really debug data.
     };
 
+    // A queue reading into GPU resources. Fences are signalled on every one of them, each queue needs its own.
+    // Everything is enqueued through the submit thread and the queue's feeder, so loads never block on a full queue.
+    struct DStorageGPUQueue
+    {
+        IDStorageQueue* pQueue = nullptr;
+        DStorageQueueFeeder* pFeeder = nullptr;
+        ID3D12Fence* pFenceCPU = nullptr;
+        ID3D12Fence* pFenceGPU = nullptr;
+    };
+
+    // A file queue per priority class, then the memory queue for textures of scenes in the payload cache.
+    static constexpr uint32_t c_DStorageMemoryQueueIndex = IOPriorityClass_Count;
+    static std::array<DStorageGPUQueue, IOPriorityClass_Count + 1> g_DStorageGPUQueues;
+    // Hands commands to the feeders of g_DStorageGPUQueues and decides when to submit, queues are passed by index.
+    static DStorageSubmitThread g_DStorageSubmitThread;
+
     static IDStorageFactory* g_DStorageFactory = nullptr;
-    static IDStorageQueue* g_DStorageQueueNormal = nullptr;
     static IDStorageQueue* g_DStorageQueueRealtime = nullptr;
-    static ID3D12Fence* g_DStorageFenceGPU = nullptr;
+    static IDStorageQueue* g_DStorageQueueFileToMemory = nullptr; // Fills the payload cache.
     static std::atomic<UINT64> g_DStorageFenceValueGPU = 0;
-    static ID3D12Fence* g_DStorageFenceCPU = nullptr;
-    static HANDLE g_DStorageFenceCPUEvent = INVALID_HANDLE_VALUE;
     static std::atomic<UINT64> g_DStorageFenceValueCPU = 0;
     static ID3D12Fence* g_DStorageFenceProfile = nullptr;
     static HANDLE g_DStorageFenceProfileEvent = INVALID_HANDLE_VALUE;
     static std::atomic<UINT64> g_DStorageFenceValueProfile = 0;
-    static std::vector<std::vector<DirectStorageSampleTextureMetadataHeader>> g_MetaDataHeaders;
-    static std::unordered_map<std::wstring, ResourceLookupEntry> g_ResourceTable;
     static std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>, wchar_t> g_Converter;
     static const std::unordered_map<std::string, ScenePathPair>* g_pScenePathMap = nullptr;  
-    static std::unordered_map<ScenePathPair, D3D12_HEAP_DESC> g_SceneHeapTemplates;
-    static std::unordered_map<ScenePathPair, size_t> g_SceneTextureDataSizeOnDisk;
-    static std::unordered_map<ScenePathPair, size_t> g_SceneTextureDataSizeUncompressed;
-    static std::vector<IDStorageFile*> g_FileHandles;
+    static ID3D12Device* g_pDevice = nullptr;
+    static const IOOptions* g_pIOOptions = nullptr;
+    using PerQualityTierSizes = std::array<size_t, c_DirectStorageSampleMaxQualityTiers>;
+
+    // Where the package of a scene is. Found once at startup, the files are only read when the scene is loaded.
+    struct ScenePackageFiles
+    {
+        FileInfo metaData;
+        FileInfo textureData;
+        FileInfo placement; // Name is empty when the package has no placement table.
+        FileInfo regions; // Name is empty unless the textures are stored as regions.
+        FileInfo tiles; // Name is empty unless the textures are also stored as tiles.
+        std::vector<uint64_t> textureHeapSizes; // Per quality tier, from the manifest. Empty for packages found on disk.
+    };
+
+    // Everything read from, or computed for, one scene's package. Only kept while the scene is loading or cached.
+    struct SceneMetaData
+    {
+        std::mutex loadMutex;
+        bool isLoaded = false;
+        uint32_t refCount = 0;
+        double lastUsedTime = 0.0;
+
+        std::vector<DirectStorageSampleTextureMetadataHeader> headers;
+        std::array<D3D12_HEAP_DESC, c_DirectStorageSampleMaxQualityTiers> heapTemplates{};
+        PerQualityTierSizes textureDataSizeOnDisk{};
+        PerQualityTierSizes textureDataSizeUncompressed{};
+        PerQualityTierSizes textureResidentSize{};
+        uint32_t qualityTierCount = 1;
+        uint32_t maxTextureSize = 0; // Width or height of the scene's largest full quality texture, for the texture LOD.
+        std::vector<uint8_t> regionTable; // The resource entries point into it.
+        std::vector<uint8_t> tileTable; // Same.
+        IDStorageFile* textureFileHandle = nullptr;
+    };
+
+    static std::unordered_map<ScenePathPair, ScenePackageFiles> g_ScenePackages;
+
+    // Guards the resident scenes and the resource table, which changes whenever a scene is loaded or evicted.
+    static std::mutex g_SceneMetaDataMutex;
+    static std::unordered_map<ScenePathPair, std::unique_ptr<SceneMetaData>> g_SceneMetaData;
+    static std::unordered_map<std::wstring, ResourceLookupEntry> g_ResourceTable;
+
+    // Committed textures shared between scenes, keyed by resource name and quality tier.
+    struct CachedTexture
+    {
+        ID3D12Resource* pResource = nullptr;
+        uint32_t refCount = 0; // Scenes using the texture, the resource is released with the last one.
+        uint64_t workloadId = 0; // The load that reads it. Cancelling that load would leave everyone with an empty texture.
+        uint32_t queueIndex = 0; // The queue it's read on.
+    };
+
+    static std::mutex g_TextureCacheMutex;
+    static std::unordered_map<std::wstring, CachedTexture> g_TextureCache;
+    static std::unordered_map<ID3D12Resource*, std::wstring> g_TextureCacheKeys;
+
+    // Compressed texture data of a scene's package, kept in system memory so loading the scene again doesn't touch the disk.
+    struct ScenePayload
+    {
+        std::mutex loadMutex;
+        bool isLoaded = false;
+        uint32_t refCount = 0;
+        double lastUsedTime = 0.0;
+        uint64_t size = 0;
+        std::unique_ptr<uint8_t[]> data;
+    };
+
+    static std::mutex g_PayloadCacheMutex;
+    static std::unordered_map<ScenePathPair, std::unique_ptr<ScenePayload>> g_PayloadCache;
+    static uint64_t g_PayloadCacheSize = 0; // Bytes of every payload in g_PayloadCache, loaded or not.
+    static PayloadCacheStats g_PayloadCacheStats;
+
+    // Workload IDs index every per-workload array below. Each load holds its ID until its scene is destroyed, see DStorageFreeWorkloadId.
+    static constexpr uint32_t c_MaxWorkloads = 512;
+    static std::mutex g_WorkloadIdMutex;
+    static std::vector<uint64_t> g_FreeWorkloadIds;
+    static uint64_t g_NextWorkloadId = 0; // IDs from here on have never been handed out.
+
+    // Quality tier used by Texture::InitFromFile for each workload.
+    static std::array<std::atomic<uint32_t>, c_MaxWorkloads> g_WorkloadQualityTiers;
+    // Where the workload's scene starts in its placed resources heap.
+    static std::array<std::atomic<uint64_t>, c_MaxWorkloads> g_WorkloadHeapOffsets;
+    // The package bytes the workload's textures are read from, nullptr reads them from the file.
+    static std::array<std::atomic<const uint8_t*>, c_MaxWorkloads> g_WorkloadPayloads;
+
+    // Which queues a workload's reads go to and what they cost.
+    struct WorkloadIO
+    {
+        std::atomic<uint32_t> priorityClass{ IOPriorityClass_Normal }; // Can change until the reads are enqueued.
+        std::atomic<uint32_t> queueIndex{ IOPriorityClass_Normal }; // File queue picked by DStorageBeginWorkloadIO.
+        std::atomic<uint32_t> queueMask{ 0 }; // Queues the workload waits for. Shared textures can be read on another load's queue.
+        std::atomic<uint64_t> requests{ 0 };
+        std::atomic<uint64_t> bytes{ 0 };
+        double beginTime = 0.0; // Only used by the loading thread.
+        double deferTime = 0.0;
+        std::atomic<IDStorageStatusArray*> pTextureStatus{ nullptr }; // Progressive scenes only, an entry per texture read.
+        std::atomic<uint32_t> textureStatusCount{ 0 };
+        // Entries below this are on the queue. The ones above still read complete from the slot's last workload.
+        std::atomic<uint32_t> textureStatusEnqueuedCount{ 0 };
+        std::atomic<bool> bProfiled{ false }; // Set by DStorageBeginProfileLoading, the start marker is enqueued with the reads.
+    };
 
-    D3D12_HEAP_DESC GetTextureHeapDescForScene(const ScenePathPair& scenePathPair)
+    static std::array<WorkloadIO, c_MaxWorkloads> g_WorkloadIO;
+    static std::mutex g_TextureStatusMutex;
+    static constexpr uint32_t c_MaxTrackedTexturesPerWorkload = 1024;
+
+    // Stand in for the textures of progressive scenes while they're read. Indexed by kind, then sRGB.
+    enum PlaceholderKind : uint32_t
+    {
+        PlaceholderKind_White,
+        PlaceholderKind_Black,
+        PlaceholderKind_FlatNormal,
+        PlaceholderKind_Count
+    };
+    static std::array<std::array<ID3D12Resource*, 2>, PlaceholderKind_Count> g_PlaceholderTextures{};
+
+    // Textures a progressive workload created, so DStorageBindPlaceholderTextures can find them.
+    struct WorkloadTexture
     {
-        return g_SceneHeapTemplates[scenePathPair];
+        Texture* pTexture = nullptr;
+        std::wstring fileName;
+        ID3D12Resource* pLoadedResource = nullptr; // Set while the placeholder is bound.
+        IMG_INFO loadedHeader{};
+    };
+    static std::mutex g_WorkloadTexturesMutex;
+    static std::array<std::vector<WorkloadTexture>, c_MaxWorkloads> g_WorkloadTextures;
+
+    // Created with the first tiled texture, it needs the graphics queue. Stays null if the device can't stream tiles.
+    static std::once_flag g_TiledTextureStreamerOnce;
+    static std::atomic<TiledTextureStreamer*> g_TiledTextureStreamer{ nullptr };
+
+    // Streamer ids of the tiled textures, by resource and by the workload that created them.
+    static std::mutex g_TiledTexturesMutex;
+    static std::unordered_map<ID3D12Resource*, TiledTextureStreamer::TextureId> g_TiledTextureIds;
+    static std::array<std::vector<TiledTextureStreamer::TextureId>, c_MaxWorkloads> g_WorkloadTiledTextures;
+
+    static TiledTextureStreamer* GetTiledTextureStreamer(Device* pDevice)
+    {
+        std::call_once(g_TiledTextureStreamerOnce, [pDevice]()
+            {
+                // Tiles are read on the low priority queue, they're only wanted once the scene is on screen.
+                auto* pStreamer = new TiledTextureStreamer;
+                const uint64_t poolSize = static_cast<uint64_t>(g_pIOOptions->m_tilePoolSize) * 1024 * 1024;
+                if (pStreamer->OnCreate(pDevice->GetDevice(), pDevice->GetGraphicsQueue(), &g_DStorageSubmitThread, IOPriorityClass_Low, poolSize))
+                {
+                    g_TiledTextureStreamer = pStreamer;
+                }
+                else
+                {
+                    Trace("Tiled textures need tier 2 tiled resources and a tile pool, textures are loaded whole.");
+                    delete pStreamer;
+                }
+            });
+        return g_TiledTextureStreamer;
+    }
+
+    // Guards the stats, deferred workloads wait on the condition for the classes above them.
+    static std::mutex g_IOPriorityMutex;
+    static std::condition_variable g_IOPriorityCondition;
+    static std::array<IOPriorityStats, IOPriorityClass_Count> g_IOPriorityStats;
+
+    // Only valid between DStorageAcquireSceneMetaData and DStorageReleaseSceneMetaData.
+    static const SceneMetaData& GetAcquiredSceneMetaData(const ScenePathPair& scenePathPair)
+    {
+        std::lock_guard<std::mutex> lock(g_SceneMetaDataMutex);
+        const auto& sceneMetaData = *g_SceneMetaData.at(scenePathPair);
+        assert(sceneMetaData.isLoaded && sceneMetaData.refCount > 0);
+        return sceneMetaData;
+    }
+
+    D3D12_HEAP_DESC GetTextureHeapDescForScene(const ScenePathPair& scenePathPair, uint32_t qualityTier)
+    {
+        return GetAcquiredSceneMetaData(scenePathPair).heapTemplates[qualityTier];
     }
    
-    size_t GetSceneTextureDataSizeUncompressed(const ScenePathPair& scenePathPair)
+    size_t GetSceneTextureDataSizeUncompressed(const ScenePathPair& scenePathPair, uint32_t qualityTier)
+    {
+        return GetAcquiredSceneMetaData(scenePathPair).textureDataSizeUncompressed[qualityTier];
+    }
+
+    size_t GetSceneTextureDataSizeOnDisk(const ScenePathPair& scenePathPair, uint32_t qualityTier)
+    {
+        return GetAcquiredSceneMetaData(scenePathPair).textureDataSizeOnDisk[qualityTier];
+    }
+
+    double GetSceneTextureCompressionRatio(const ScenePathPair& scenePathPair, uint32_t qualityTier)
+    {
+        return GetSceneTextureDataSizeUncompressed(scenePathPair, qualityTier) / (double)GetSceneTextureDataSizeOnDisk(scenePathPair, qualityTier);
+    }
+
+    size_t GetSceneTextureResidentSize(const ScenePathPair& scenePathPair, uint32_t qualityTier)
+    {
+        return GetAcquiredSceneMetaData(scenePathPair).textureResidentSize[qualityTier];
+    }
+
+    uint32_t GetSceneQualityTierCount(const ScenePathPair& scenePathPair)
+    {
+        return GetAcquiredSceneMetaData(scenePathPair).qualityTierCount;
+    }
+
+    uint32_t GetSceneMaxTextureSize(const ScenePathPair& scenePathPair)
+    {
+        return GetAcquiredSceneMetaData(scenePathPair).maxTextureSize;
+    }
+
+    uint32_t GetTextureLODMipDrop(uint32_t textureSize, float sceneRadius, float distanceToScene, float projectionScale)
+    {
+        // Nothing to go by, or the camera is in the scene's bounds and may get right up to any of it.
+        const float nearestDistance = distanceToScene - sceneRadius;
+        if (textureSize == 0 || sceneRadius <= 0.0f || projectionScale <= 0.0f || nearestDistance <= 0.0f)
+        {
+            return 0;
+        }
+
+        // The texture is taken to cover the scene once. Tiled textures have even more texels per pixel, so this errs on the side of keeping mips.
+        const float screenPixels = projectionScale * 2.0f * sceneRadius / nearestDistance;
+        if (screenPixels >= textureSize)
+        {
+            return 0;
+        }
+        return static_cast<uint32_t>(floorf(log2f(textureSize / max(screenPixels, 1.0f))));
+    }
+
+    // Drop one tier per qualitytierdistance units away from the scene.
+    static uint32_t GetDistanceQualityTier(float distanceToScene, uint32_t minQualityTier, uint32_t qualityTierCount, const IOOptions& ioOptions)
+    {
+        uint32_t qualityTier = minQualityTier;
+        if (ioOptions.m_qualityTierDistance > 0.0f)
+        {
+            qualityTier = max(qualityTier, static_cast<uint32_t>(distanceToScene / ioOptions.m_qualityTierDistance));
+        }
+        return min(qualityTier, qualityTierCount - 1);
+    }
+
+    uint32_t SelectSceneQualityTier(const ScenePathPair& scenePathPair, float distanceToScene, uint32_t minQualityTier, uint64_t textureMemoryBudget, const IOOptions& ioOptions)
+    {
+        const uint32_t qualityTierCount = GetSceneQualityTierCount(scenePathPair);
+        uint32_t qualityTier = GetDistanceQualityTier(distanceToScene, minQualityTier, qualityTierCount, ioOptions);
+
+        // Then keep dropping until the textures fit in the budget, or there is nothing left to drop.
+        while ((qualityTier + 1 < qualityTierCount) && (GetSceneTextureResidentSize(scenePathPair, qualityTier) > textureMemoryBudget))
+        {
+            qualityTier++;
+        }
+
+        return qualityTier;
+    }
+
+    uint64_t GetSceneTextureMemoryEstimate(const ScenePathPair& scenePathPair, float distanceToScene, const IOOptions& ioOptions)
+    {
+        // Cached metadata has the sizes for this adapter.
+        {
+            std::lock_guard<std::mutex> lock(g_SceneMetaDataMutex);
+            auto sceneMetaDataItr = g_SceneMetaData.find(scenePathPair);
+            if (sceneMetaDataItr != g_SceneMetaData.end() && sceneMetaDataItr->second->isLoaded)
+            {
+                const auto& sceneMetaData = *sceneMetaDataItr->second;
+                const uint32_t qualityTier = ioOptions.m_useQualityTiers ? GetDistanceQualityTier(distanceToScene, 0, sceneMetaData.qualityTierCount, ioOptions) : 0;
+                return sceneMetaData.textureResidentSize[qualityTier];
+            }
+        }
+
+        // Otherwise the converter's heap sizes. Packages found on disk only have the size of their texture file, the compressed data of every tier.
+        const auto packageFilesItr = g_ScenePackages.find(scenePathPair);
+        if (packageFilesItr == g_ScenePackages.cend())
+        {
+            return 0;
+        }
+        const auto& packageFiles = packageFilesItr->second;
+        const auto& textureHeapSizes = packageFiles.textureHeapSizes;
+        if (textureHeapSizes.empty())
+        {
+            return packageFiles.textureData.Size;
+        }
+        const uint32_t qualityTier = ioOptions.m_useQualityTiers ? GetDistanceQualityTier(distanceToScene, 0, static_cast<uint32_t>(textureHeapSizes.size()), ioOptions) : 0;
+        return textureHeapSizes[qualityTier];
+    }
+
+    void DStorageSetWorkloadQualityTier(uint64_t workloadId, uint32_t qualityTier)
+    {
+        g_WorkloadQualityTiers[workloadId % g_WorkloadQualityTiers.size()] = qualityTier;
+    }
+
+    void DStorageSetWorkloadHeapOffset(uint64_t workloadId, uint64_t heapOffset)
+    {
+        g_WorkloadHeapOffsets[workloadId % g_WorkloadHeapOffsets.size()] = heapOffset;
+    }
+
+    IOPriorityClass SelectIOPriorityClass(float timeToVisible, const IOOptions& ioOptions)
+    {
+        if (!ioOptions.m_usePriorityQueues)
+        {
+            return IOPriorityClass_Normal;
+        }
+
+        if (timeToVisible <= ioOptions.m_ioHighPrioritySeconds)
+        {
+            return IOPriorityClass_High;
+        }
+        return timeToVisible <= ioOptions.m_ioLowPrioritySeconds ? IOPriorityClass_Normal : IOPriorityClass_Low;
+    }
+
+    const char* GetIOPriorityClassName(IOPriorityClass priorityClass)
+    {
+        static const char* names[IOPriorityClass_Count] = { "High", "Normal", "Low" };
+        return names[priorityClass];
+    }
+
+    void DStorageSetWorkloadPriorityClass(uint64_t workloadId, IOPriorityClass priorityClass)
+    {
+        {
+            std::lock_guard<std::mutex> lock(g_IOPriorityMutex);
+            g_WorkloadIO[workloadId % g_WorkloadIO.size()].priorityClass = priorityClass;
+        }
+
+        // A deferred workload may have just been promoted.
+        g_IOPriorityCondition.notify_all();
+    }
+
+    static void EnqueueProfileMarker(uint64_t workloadId);
+
+    void DStorageBeginWorkloadIO(uint64_t workloadId)
+    {
+        auto& workloadIO = g_WorkloadIO[workloadId % g_WorkloadIO.size()];
+        const double deferStartTime = MillisecondsNow();
+
+        uint32_t priorityClass = IOPriorityClass_Normal;
+        {
+            std::unique_lock<std::mutex> lock(g_IOPriorityMutex);
+
+            // Low priority reads hold back while higher ones are in flight, they'd only take disk bandwidth and staging buffer space from them.
+            // Reads can't move between queues once enqueued, waiting also lets the camera promote the workload before it commits to one.
+            const auto deferLimit = std::chrono::milliseconds(g_pIOOptions->m_ioDeferMilliseconds);
+            g_IOPriorityCondition.wait_for(lock, deferLimit, [&workloadIO]()
+                {
+                    return workloadIO.priorityClass != IOPriorityClass_Low
+                        || (g_IOPriorityStats[IOPriorityClass_High].inFlight == 0 && g_IOPriorityStats[IOPriorityClass_Normal].inFlight == 0);
+                });
+
+            priorityClass = workloadIO.priorityClass;
+            g_IOPriorityStats[priorityClass].inFlight++;
+        }
+
+        workloadIO.queueIndex = priorityClass;
+        workloadIO.queueMask = 1u << priorityClass;
+        workloadIO.requests = 0;
+        workloadIO.bytes = 0;
+        workloadIO.beginTime = MillisecondsNow();
+        workloadIO.deferTime = workloadIO.beginTime - deferStartTime;
+
+        // Now that the queue is known, the profiled time starts when it gets to the workload's reads.
+        if (workloadIO.bProfiled)
+        {
+            EnqueueProfileMarker(workloadId);
+        }
+
+        if (g_pIOOptions->m_useProgressiveScenes)
+        {
+            // Slots are reused by later workloads, so is their status array.
+            if (workloadIO.pTextureStatus == nullptr)
+            {
+                IDStorageStatusArray* pTextureStatus = nullptr;
+                ThrowIfFailed(g_DStorageFactory->CreateStatusArray(c_MaxTrackedTexturesPerWorkload, "Texture Status Array", IID_PPV_ARGS(&pTextureStatus)));
+                workloadIO.pTextureStatus = pTextureStatus;
+            }
+            workloadIO.textureStatusCount = 0;
+            workloadIO.textureStatusEnqueuedCount = 0;
+
+            std::lock_guard<std::mutex> lock(g_WorkloadTexturesMutex);
+            g_WorkloadTextures[workloadId % g_WorkloadTextures.size()].clear();
+        }
+
+        if (g_pIOOptions->m_useTiledTextures)
+        {
+            std::lock_guard<std::mutex> lock(g_TiledTexturesMutex);
+            g_WorkloadTiledTextures[workloadId % g_WorkloadTiledTextures.size()].clear();
+        }
+    }
+
+    std::array<IOPriorityStats, IOPriorityClass_Count> DStorageGetIOPriorityStats()
+    {
+        std::lock_guard<std::mutex> lock(g_IOPriorityMutex);
+        return g_IOPriorityStats;
+    }
+
+    EnqueueStats DStorageGetEnqueueStats()
     {
-        return g_SceneTextureDataSizeUncompressed.at(scenePathPair);
+        EnqueueStats enqueueStats;
+        for (const auto& gpuQueue : g_DStorageGPUQueues)
+        {
+            const auto stats = gpuQueue.pFeeder->GetStats();
+            enqueueStats.waitingCommands += stats.waitingCommands;
+            enqueueStats.maxWaitingCommands = max(enqueueStats.maxWaitingCommands, stats.maxWaitingCommands);
+            enqueueStats.deferredCommands += stats.deferredCommands;
+        }
+        return enqueueStats;
     }
 
-    size_t GetSceneTextureDataSizeOnDisk(const ScenePathPair& scenePathPair)
+    SubmitStats DStorageGetSubmitStats()
     {
-        return g_SceneTextureDataSizeOnDisk.at(scenePathPair);
+        return g_DStorageSubmitThread.GetStats();
     }
 
-    double GetSceneTextureCompressionRatio(const ScenePathPair& scenePathPair)
+    std::vector<SubmitEvent> DStorageTakeSubmitEvents()
     {
-        return g_SceneTextureDataSizeUncompressed.at(scenePathPair) / (double)g_SceneTextureDataSizeOnDisk.at(scenePathPair);
+        return g_DStorageSubmitThread.TakeEvents();
     }
 
 
@@ -111,17 +514,125 @@ namespace Sample
         // Get Desc from file.
         auto fileName = g_Converter.from_bytes(szFilename);     
 
-        const auto& resourceEntry = g_ResourceTable[fileName];
+        // The scene holds on to its metadata while loading, the entry can't be evicted under us.
+        const ResourceLookupEntry* pResourceEntry = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(g_SceneMetaDataMutex);
+            pResourceEntry = &g_ResourceTable.at(fileName);
+        }
+        const auto& resourceEntry = *pResourceEntry;
         const auto& metaDataHeader = resourceEntry.metaDataHeader;
 
-        CD3DX12_RESOURCE_DESC RDescs(metaDataHeader->resourceDesc);
+        // The scene picked a quality tier before loading its textures. Textures without that tier use their smallest one.
+        const uint32_t sceneQualityTier = g_WorkloadQualityTiers[workloadId % g_WorkloadQualityTiers.size()];
+        uint32_t textureQualityTier = min(sceneQualityTier, metaDataHeader->qualityTierCount - 1);
+        auto qualityTier = GetTextureQualityTier(*metaDataHeader, textureQualityTier);
+
+        // Full quality committed textures with tiles in the package are streamed a tile at a time, and only read their packed mips with the scene.
+        const bool canStreamTiles = g_pIOOptions->m_useTiledTextures && resourceEntry.tiles && (pTextureHeap == nullptr) && (qualityTier.resourceDesc.MipLevels == metaDataHeader->resourceDesc.MipLevels);
+
+        // Without regions the texture is read with one request, which has to fit the staging buffer. Drop mips until it does.
+        // A smaller tier fits in the heap range of the scene's tier.
+        if (!resourceEntry.regions && !canStreamTiles)
+        {
+            while (qualityTier.resourceSizeUncompressed > g_pIOOptions->m_stagingBufferSize && textureQualityTier + 1 < metaDataHeader->qualityTierCount)
+            {
+                qualityTier = GetTextureQualityTier(*metaDataHeader, ++textureQualityTier);
+            }
+
+            if (qualityTier.resourceSizeUncompressed > g_pIOOptions->m_stagingBufferSize)
+            {
+                Trace("Texture is bigger than the staging buffer at every tier, it isn't loaded. Convert with -textureRegions=true or raise stagingbuffersize: %s", resourceEntry.gltfPath.c_str());
+                return false;
+            }
+            if (textureQualityTier != min(sceneQualityTier, metaDataHeader->qualityTierCount - 1))
+            {
+                Trace("Texture is bigger than the staging buffer, it's loaded at tier %u. Convert with -textureRegions=true or raise stagingbuffersize: %s", textureQualityTier, resourceEntry.gltfPath.c_str());
+            }
+        }
+
+        CD3DX12_RESOURCE_DESC RDescs(qualityTier.resourceDesc);
         RDescs.Format = SetFormatGamma((DXGI_FORMAT)RDescs.Format, useSRGB);
+
+        // stuff needed later that's not important here. We are using this to create the SRV. It's an adapter for some reason.
+        m_header.format = RDescs.Format;
+        m_header.bitCount = BitsPerPixel(RDescs.Format);
+        m_header.mipMapCount = RDescs.MipLevels;
+        m_header.arraySize = RDescs.ArraySize();
+        m_header.depth = RDescs.Depth();
+        m_header.width = RDescs.Width;
+        m_header.height = RDescs.Height;
+
+        if (g_pIOOptions->m_useProgressiveScenes)
+        {
+            std::lock_guard<std::mutex> lock(g_WorkloadTexturesMutex);
+            g_WorkloadTextures[workloadId % g_WorkloadTextures.size()].push_back({ this, fileName });
+        }
+
+        // Each scene streams its own tiled textures.
+        TiledTextureStreamer* pTiledTextureStreamer = nullptr;
+        if (canStreamTiles)
+        {
+            pTiledTextureStreamer = GetTiledTextureStreamer(pDevice);
+        }
+
+        // Placed textures live in their scene's heap and go away with it, only committed ones can be shared.
+        const bool useTextureCache = (pTextureHeap == nullptr) && g_pIOOptions->m_useTextureCache && (pTiledTextureStreamer == nullptr);
+        const auto textureCacheKey = fileName + L'|' + std::to_wstring(textureQualityTier);
+        if (useTextureCache)
+        {
+            std::lock_guard<std::mutex> lock(g_TextureCacheMutex);
+            auto cachedItr = g_TextureCache.find(textureCacheKey);
+            if (cachedItr != g_TextureCache.end())
+            {
+                // Same name and tier should always be the same texture, but don't hand out one that doesn't match.
+                const auto cachedDesc = cachedItr->second.pResource->GetDesc();
+                if (cachedDesc.Width == RDescs.Width && cachedDesc.Height == RDescs.Height && cachedDesc.MipLevels == RDescs.MipLevels && cachedDesc.Format == RDescs.Format)
+                {
+                    // If the read is still in flight, it was enqueued before anything this load enqueues, so our fence covers it.
+                    // It may be on another load's queue though, wait for that one too.
+                    g_WorkloadIO[workloadId % g_WorkloadIO.size()].queueMask |= 1u << cachedItr->second.queueIndex;
+                    cachedItr->second.refCount++;
+                    m_pResource = cachedItr->second.pResource;
+                    return true;
+                }
+            }
+        }
  
+        // Falls back to a committed texture if the device doesn't tile it like the package does.
+        TiledTextureStreamer::TextureId tiledTexture = TileResidencyMap::c_InvalidTexture;
+        if (pTiledTextureStreamer)
+        {
+            tiledTexture = pTiledTextureStreamer->CreateTexture(RDescs, *resourceEntry.tiles, resourceEntry.tileEntries, resourceEntry.reseourceFileHandle, resourceEntry.gltfPath.c_str(), &m_pResource);
+        }
+
+        if (tiledTexture == TileResidencyMap::c_InvalidTexture && canStreamTiles && !resourceEntry.regions && qualityTier.resourceSizeUncompressed > g_pIOOptions->m_stagingBufferSize)
+        {
+            // The whole texture read that's left in place of the tiles can't fit the staging buffer.
+            Trace("Texture can't be tiled and is bigger than the staging buffer, it isn't loaded. Convert with -textureRegions=true or raise stagingbuffersize: %s", resourceEntry.gltfPath.c_str());
+            if (g_pIOOptions->m_useProgressiveScenes)
+            {
+                std::lock_guard<std::mutex> lock(g_WorkloadTexturesMutex);
+                auto& workloadTextures = g_WorkloadTextures[workloadId % g_WorkloadTextures.size()];
+                workloadTextures.erase(std::remove_if(workloadTextures.begin(), workloadTextures.end(), [this](const WorkloadTexture& workloadTexture) { return workloadTexture.pTexture == this; }), workloadTextures.end());
+            }
+            return false;
+        }
+
+        if (tiledTexture != TileResidencyMap::c_InvalidTexture)
+        {
+            std::lock_guard<std::mutex> lock(g_TiledTexturesMutex);
+            g_TiledTextureIds[m_pResource] = tiledTexture;
+            g_WorkloadTiledTextures[workloadId % g_WorkloadTiledTextures.size()].push_back(tiledTexture);
+        }
         // If the caller passed in a heap, attempt to use placed resources.
-        if (pTextureHeap)
+        else if (pTextureHeap)
         {
+            // Small textures were placed with 4KiB alignment, the desc has to ask for it.
+            RDescs.Alignment = resourceEntry.resourceHeapAlignment[sceneQualityTier];
+
             HRESULT hr = pDevice->GetDevice()->CreatePlacedResource(pTextureHeap
-                , resourceEntry.resourceHeapOffset
+                , g_WorkloadHeapOffsets[workloadId % g_WorkloadHeapOffsets.size()] + resourceEntry.resourceHeapOffset[sceneQualityTier]
                 , &RDescs
                 , D3D12_RESOURCE_STATE_COMMON
                 , nullptr
@@ -142,41 +653,289 @@ namespace Sample
             assert(hr == S_OK);
         }
 
+        const auto& fileHandle = resourceEntry.reseourceFileHandle;
+        auto& workloadIO = g_WorkloadIO[workloadId % g_WorkloadIO.size()];
 
-        // stuff needed later that's not important here. We are using this to create the SRV. It's an adapter for some reason.
-        m_header.format = RDescs.Format;
-        m_header.bitCount = BitsPerPixel(RDescs.Format);
-        m_header.mipMapCount = RDescs.MipLevels;
-        m_header.arraySize = RDescs.ArraySize();
-        m_header.depth = RDescs.Depth();
-        m_header.width = RDescs.Width;
-        m_header.height = RDescs.Height;
+        assert((qualityTier.resourceOffset % 4096) == 0);
 
-        const auto& fileHandle = resourceEntry.reseourceFileHandle;
+        // perform the read. From the payload cache if the scene is in it, decompression still happens on the GPU.
+        const uint8_t* pPayload = g_WorkloadPayloads[workloadId % g_WorkloadPayloads.size()];
+        const uint32_t queueIndex = pPayload ? c_DStorageMemoryQueueIndex : workloadIO.queueIndex;
+        auto makeRequest = [&](DSTORAGE_COMPRESSION_FORMAT compressionFormat, int64_t offset, uint32_t size)
+        {
+            DSTORAGE_REQUEST req = {};
+            req.Options.CompressionFormat = compressionFormat;
+            if (pPayload)
+            {
+                req.Options.SourceType = DSTORAGE_REQUEST_SOURCE_MEMORY;
+                req.Source.Memory.Source = pPayload + offset;
+                req.Source.Memory.Size = size;
+            }
+            else
+            {
+                req.Options.SourceType = DSTORAGE_REQUEST_SOURCE_FILE;
+                req.Source.File.Source = fileHandle;
+                req.Source.File.Offset = offset;
+                req.Source.File.Size = size;
+            }
+            req.CancellationTag = workloadId;
+            req.Name = (char*)resourceEntry.gltfPath.c_str();
+            return req;
+        };
 
-        assert((metaDataHeader->resourceOffset % 4096) == 0);
+        std::vector<DSTORAGE_REQUEST> requests;
+        uint64_t requestBytes = qualityTier.resourceSizeCompressed;
+        if (tiledTexture != TileResidencyMap::c_InvalidTexture)
+        {
+            // Only the packed mips are read with the scene, the streamer reads the other tiles once they're asked for.
+            const auto& textureTiles = *resourceEntry.tiles;
+            if (textureTiles.packedSizeUncompressed > 0)
+            {
+                DSTORAGE_REQUEST req = makeRequest(textureTiles.packedCompressionFormat, textureTiles.packedOffset, textureTiles.packedSizeCompressed);
+                req.Options.DestinationType = DSTORAGE_REQUEST_DESTINATION_MULTIPLE_SUBRESOURCES;
+                req.Destination.MultipleSubresources.Resource = m_pResource;
+                req.Destination.MultipleSubresources.FirstSubresource = textureTiles.standardMipCount;
+                req.UncompressedSize = textureTiles.packedSizeUncompressed;
+                requests.push_back(req);
+            }
+            requestBytes = textureTiles.packedSizeCompressed;
+        }
+        else if (resourceEntry.regions)
+        {
+            // One request per region, smallest mips first, so no request needs more staging memory than a region.
+            // The tier leaves out the top mips, which are the last regions.
+            const uint32_t droppedMips = metaDataHeader->resourceDesc.MipLevels - qualityTier.resourceDesc.MipLevels;
+            for (uint32_t regionIdx = 0; regionIdx < resourceEntry.regionCount && resourceEntry.regions[regionIdx].mipLevel >= droppedMips; regionIdx++)
+            {
+                const auto& region = resourceEntry.regions[regionIdx];
+                DSTORAGE_REQUEST req = makeRequest(region.compressionFormat, region.offset, region.sizeCompressed);
+                req.Options.DestinationType = DSTORAGE_REQUEST_DESTINATION_TEXTURE_REGION;
+                req.Destination.Texture.Resource = m_pResource;
+                req.Destination.Texture.SubresourceIndex = (region.mipLevel - droppedMips) + region.arraySlice * qualityTier.resourceDesc.MipLevels;
+                req.Destination.Texture.Region = region.box;
+                req.UncompressedSize = region.sizeUncompressed;
+                requests.push_back(req);
+            }
+        }
+        else
+        {
+            assert(qualityTier.resourceSizeUncompressed <= g_pIOOptions->m_stagingBufferSize);
+            DSTORAGE_REQUEST req = makeRequest(qualityTier.compressionFormat, qualityTier.resourceOffset, static_cast<uint32_t>(qualityTier.resourceSizeCompressed));
+            req.Options.DestinationType = DSTORAGE_REQUEST_DESTINATION_MULTIPLE_SUBRESOURCES;
+            req.Destination.MultipleSubresources.Resource = m_pResource;
+            req.Destination.MultipleSubresources.FirstSubresource = 0;
+            req.UncompressedSize = static_cast<uint32_t>(qualityTier.resourceSizeUncompressed);
+            requests.push_back(req);
+        }
 
-        // perform the read.
-        DSTORAGE_REQUEST req = {};
-        req.Options.CompressionFormat = metaDataHeader->compressionFormat;
-        req.Options.SourceType = DSTORAGE_REQUEST_SOURCE_FILE;
-        req.Options.DestinationType = DSTORAGE_REQUEST_DESTINATION_MULTIPLE_SUBRESOURCES;
-        req.Source.File.Source = fileHandle;
-        req.Source.File.Offset = metaDataHeader->resourceOffset;
-        req.Source.File.Size = metaDataHeader->resourceSizeCompressed;
-        req.Destination.MultipleSubresources.Resource = m_pResource;
-        req.Destination.MultipleSubresources.FirstSubresource = 0;
-        req.UncompressedSize = metaDataHeader->resourceSizeUncompressed;
+        workloadIO.queueMask |= 1u << queueIndex;
+        workloadIO.requests += requests.size();
+        workloadIO.bytes += requestBytes;
 
+        auto enqueueRequests = [&]()
+        {
+            for (const auto& req : requests)
+            {
+                g_DStorageSubmitThread.EnqueueRequest(queueIndex, req);
+            }
+
+            // Completes once the texture is in, for DStorageGetWorkloadTextureProgress.
+            // Numbered as they're pushed, so they reach the workload's queue in order and the enqueued count covers the entries below it.
+            IDStorageStatusArray* pTextureStatus = workloadIO.pTextureStatus;
+            if (pTextureStatus)
+            {
+                std::lock_guard<std::mutex> lock(g_TextureStatusMutex);
+                const uint32_t statusIndex = workloadIO.textureStatusCount;
+                if (statusIndex < c_MaxTrackedTexturesPerWorkload)
+                {
+                    workloadIO.textureStatusCount++;
+                    g_DStorageSubmitThread.EnqueueStatus(queueIndex, pTextureStatus, statusIndex, &workloadIO.textureStatusEnqueuedCount);
+                }
+            }
+        };
+
+        if (useTextureCache)
+        {
+            // Enqueue and publish together. Whoever finds the texture enqueues their fence after this read, and cancellation can't slip in between.
+            std::lock_guard<std::mutex> lock(g_TextureCacheMutex);
+            enqueueRequests();
 
-        req.CancellationTag = workloadId;
-        req.Name = (char*)resourceEntry.gltfPath.c_str();
-        g_DStorageQueueNormal->EnqueueRequest(&req);
+            // Lost a race with another scene loading the same texture, ours just stays private.
+            if (g_TextureCache.find(textureCacheKey) == g_TextureCache.end())
+            {
+                g_TextureCache[textureCacheKey] = { m_pResource, 1, workloadId, queueIndex };
+                g_TextureCacheKeys[m_pResource] = textureCacheKey;
+            }
+        }
+        else
+        {
+            enqueueRequests();
+        }
         //g_DStorageQueueNormal->Submit();
        
         return true;
     }
 
+    void Texture::OnDestroy()
+    {
+        // Tiled textures wait for their tile reads before the resource goes.
+        TiledTextureStreamer::TextureId tiledTexture = TileResidencyMap::c_InvalidTexture;
+        {
+            std::lock_guard<std::mutex> lock(g_TiledTexturesMutex);
+            auto tiledItr = g_TiledTextureIds.find(m_pResource);
+            if (tiledItr != g_TiledTextureIds.end())
+            {
+                tiledTexture = tiledItr->second;
+                g_TiledTextureIds.erase(tiledItr);
+            }
+        }
+        if (tiledTexture != TileResidencyMap::c_InvalidTexture)
+        {
+            g_TiledTextureStreamer.load()->DestroyTexture(tiledTexture);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(g_TextureCacheMutex);
+            auto keyItr = g_TextureCacheKeys.find(m_pResource);
+            if (keyItr != g_TextureCacheKeys.end())
+            {
+                auto cachedItr = g_TextureCache.find(keyItr->second);
+                if (--cachedItr->second.refCount > 0)
+                {
+                    // Another scene still uses it.
+                    m_pResource = nullptr;
+                    return;
+                }
+
+                g_TextureCache.erase(cachedItr);
+                g_TextureCacheKeys.erase(keyItr);
+            }
+        }
+
+        ::CAULDRON_DX12::Texture::OnDestroy();
+    }
+
+    void Texture::BindPlaceholder(ID3D12Resource* pPlaceholder, ID3D12Resource** ppLoadedOut, IMG_INFO* pLoadedHeaderOut)
+    {
+        *ppLoadedOut = m_pResource;
+        *pLoadedHeaderOut = m_header;
+
+        m_pResource = pPlaceholder;
+        m_header.format = pPlaceholder->GetDesc().Format;
+        m_header.bitCount = 32;
+        m_header.mipMapCount = 1;
+        m_header.arraySize = 1;
+        m_header.depth = 1;
+        m_header.width = 1;
+        m_header.height = 1;
+    }
+
+    void Texture::BindLoaded(ID3D12Resource* pLoaded, const IMG_INFO& loadedHeader)
+    {
+        m_pResource = pLoaded;
+        m_header = loadedHeader;
+    }
+
+    // Images used as normal or emissive maps get placeholders that leave the surface flat and unlit, everything else gets white.
+    static std::unordered_map<std::wstring, PlaceholderKind> GetPlaceholderKinds(const GLTFCommon& gltfCommon)
+    {
+        std::unordered_map<std::wstring, PlaceholderKind> placeholderKinds;
+        const auto& j3 = gltfCommon.j3;
+        if (j3.find("materials") == j3.end() || j3.find("textures") == j3.end() || j3.find("images") == j3.end())
+        {
+            return placeholderKinds;
+        }
+
+        std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>, wchar_t> converter;
+        const auto& textures = j3["textures"];
+        const auto& images = j3["images"];
+        auto setKind = [&](const nlohmann::json& material, const char* textureName, PlaceholderKind kind)
+        {
+            const auto textureInfo = material.find(textureName);
+            if (textureInfo == material.end() || textureInfo->find("index") == textureInfo->end())
+            {
+                return;
+            }
+
+            const auto& texture = textures.at(textureInfo->at("index").get<size_t>());
+            if (texture.find("source") == texture.end())
+            {
+                return;
+            }
+
+            const auto& image = images.at(texture["source"].get<size_t>());
+            if (image.find("uri") != image.end())
+            {
+                // Same name Texture::InitFromFile is given.
+                placeholderKinds[converter.from_bytes(gltfCommon.m_path + image["uri"].get<std::string>())] = kind;
+            }
+        };
+
+        for (const auto& material : j3["materials"])
+        {
+            setKind(material, "normalTexture", PlaceholderKind_FlatNormal);
+            setKind(material, "emissiveTexture", PlaceholderKind_Black);
+        }
+
+        return placeholderKinds;
+    }
+
+    void DStorageBindPlaceholderTextures(uint64_t workloadId, const GLTFCommon& gltfCommon)
+    {
+        const auto placeholderKinds = GetPlaceholderKinds(gltfCommon);
+
+        std::lock_guard<std::mutex> lock(g_WorkloadTexturesMutex);
+        for (auto& workloadTexture : g_WorkloadTextures[workloadId % g_WorkloadTextures.size()])
+        {
+            auto* pLoadedResource = workloadTexture.pTexture->GetResource();
+            if (pLoadedResource == nullptr || workloadTexture.pLoadedResource != nullptr)
+            {
+                continue;
+            }
+
+            // SRVs take their format from the resource, keep sRGB textures sRGB.
+            const auto kindItr = placeholderKinds.find(workloadTexture.fileName);
+            const auto kind = kindItr != placeholderKinds.end() ? kindItr->second : PlaceholderKind_White;
+            const DXGI_FORMAT format = pLoadedResource->GetDesc().Format;
+            const bool isSRGB = SetFormatGamma(format, false) != format;
+            workloadTexture.pTexture->BindPlaceholder(g_PlaceholderTextures[kind][isSRGB ? 1 : 0], &workloadTexture.pLoadedResource, &workloadTexture.loadedHeader);
+        }
+    }
+
+    void DStorageBindLoadedTextures(uint64_t workloadId)
+    {
+        std::lock_guard<std::mutex> lock(g_WorkloadTexturesMutex);
+        auto& workloadTextures = g_WorkloadTextures[workloadId % g_WorkloadTextures.size()];
+        for (auto& workloadTexture : workloadTextures)
+        {
+            if (workloadTexture.pLoadedResource)
+            {
+                workloadTexture.pTexture->BindLoaded(workloadTexture.pLoadedResource, workloadTexture.loadedHeader);
+            }
+        }
+        workloadTextures.clear();
+    }
+
+    std::pair<uint32_t, uint32_t> DStorageGetWorkloadTextureProgress(uint64_t workloadId)
+    {
+        const auto& workloadIO = g_WorkloadIO[workloadId % g_WorkloadIO.size()];
+        IDStorageStatusArray* pTextureStatus = workloadIO.pTextureStatus;
+        if (pTextureStatus == nullptr)
+        {
+            return { 0, 0 };
+        }
+
+        // Entries that haven't reached the queue yet may still be complete from an earlier workload, they're not read.
+        const uint32_t textureCount = workloadIO.textureStatusCount;
+        const uint32_t enqueuedCount = workloadIO.textureStatusEnqueuedCount;
+        uint32_t readCount = 0;
+        for (uint32_t statusIndex = 0; statusIndex < enqueuedCount; statusIndex++)
+        {
+            readCount += pTextureStatus->IsComplete(statusIndex) ? 1 : 0;
+        }
+        return { readCount, textureCount };
+    }
+
 #include "GLTF/GLTFTexturesAndBuffersImpl.inl"
 
     struct DStorageErrorEventHandles
@@ -245,12 +1004,76 @@ namespace Sample
     }
 
 
+    // Blocks until everything enqueued on a file to memory queue so far has been read.
+    static void WaitForMemoryQueue(IDStorageQueue* pQueue)
+    {
+        IDStorageStatusArray* statusArray = nullptr;
+        ThrowIfFailed(g_DStorageFactory->CreateStatusArray(1, "File to Memory Status Array", IID_PPV_ARGS(&statusArray)));
+        pQueue->EnqueueStatus(statusArray, 0);
+
+        // Sleep until the reads are done instead of spinning on the status array.
+        HANDLE readEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+        IDStorageQueue1* pQueue1 = nullptr;
+        ThrowIfFailed(pQueue->QueryInterface(IID_PPV_ARGS(&pQueue1)));
+        pQueue1->EnqueueSetEvent(readEvent);
+        pQueue1->Release();
+        pQueue->Submit();
+
+        (void)WaitForSingleObject(readEvent, INFINITE);
+        (void)CloseHandle(readEvent);
+
+        assert(statusArray->IsComplete(0));
+        ThrowIfFailed(statusArray->GetHResult(0));
+
+        // Delete the status array. 
+        statusArray->Release();
+    }
+
+    // 1x1 textures standing in for the ones progressive scenes are still reading, written through the memory queue.
+    static void CreatePlaceholderTextures()
+    {
+        // RGBA8, red in the low byte.
+        static const std::array<uint32_t, PlaceholderKind_Count> texels = { 0xFFFFFFFF, 0xFF000000, 0xFFFF8080 };
+        const DXGI_FORMAT formats[2] = { DXGI_FORMAT_R8G8B8A8_UNORM, DXGI_FORMAT_R8G8B8A8_UNORM_SRGB };
+
+        // Straight on the queue, past its feeder. Nothing else uses it yet and the reads are waited for.
+        IDStorageQueue* pQueue = g_DStorageGPUQueues[c_DStorageMemoryQueueIndex].pQueue;
+        for (uint32_t kind = 0; kind < PlaceholderKind_Count; kind++)
+        {
+            for (uint32_t isSRGB = 0; isSRGB < 2; isSRGB++)
+            {
+                auto& pPlaceholder = g_PlaceholderTextures[kind][isSRGB];
+                ThrowIfFailed(g_pDevice->CreateCommittedResource(&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT)
+                    , D3D12_HEAP_FLAG_NONE
+                    , &CD3DX12_RESOURCE_DESC::Tex2D(formats[isSRGB], 1, 1, 1, 1)
+                    , D3D12_RESOURCE_STATE_COMMON
+                    , nullptr
+                    , IID_PPV_ARGS(&pPlaceholder)));
+
+                DSTORAGE_REQUEST req = {};
+                req.Options.SourceType = DSTORAGE_REQUEST_SOURCE_MEMORY;
+                req.Options.DestinationType = DSTORAGE_REQUEST_DESTINATION_MULTIPLE_SUBRESOURCES;
+                req.Source.Memory.Source = &texels[kind];
+                req.Source.Memory.Size = sizeof(uint32_t);
+                req.Destination.MultipleSubresources.Resource = pPlaceholder;
+                req.Destination.MultipleSubresources.FirstSubresource = 0;
+                req.UncompressedSize = sizeof(uint32_t);
+                req.Name = "Placeholder texture";
+                pQueue->EnqueueRequest(&req);
+            }
+        }
+
+        WaitForMemoryQueue(pQueue);
+    }
+
     bool InitializeDirectStorage(ID3D12Device* const pDevice, const std::wstring& contentPathRoot, const std::unordered_map<std::string, ScenePathPair>& scenePathMap, const IOOptions& ioOptions)
     {
         CPUUserMarker marker("InitializeDirectStorage");
 
 
         g_pScenePathMap = &scenePathMap;
+        g_pDevice = pDevice;
+        g_pIOOptions = &ioOptions;
 
         {
             // Create DirectStorage loader.
@@ -268,20 +1091,21 @@ namespace Sample
         g_DStorageFactory->SetStagingBufferSize(ioOptions.m_stagingBufferSize); // This will depend on assets.
         
         {
-            // Normal priority, File->GPU.
-            DSTORAGE_QUEUE_DESC queueDesc = {};
-            queueDesc.SourceType = DSTORAGE_REQUEST_SOURCE_FILE;
-            queueDesc.Capacity = ioOptions.m_queueLength;
-            queueDesc.Priority = DSTORAGE_PRIORITY_NORMAL;
-            queueDesc.Name = "NormalPriorityFileToGPU";
-            queueDesc.Device = pDevice; // Associate with GPU.
-            ThrowIfFailed(g_DStorageFactory->CreateQueue(&queueDesc, IID_PPV_ARGS(&g_DStorageQueueNormal)));
+            // File->GPU, one queue per priority class. They share the factory's staging buffer.
+            const DSTORAGE_PRIORITY priorities[IOPriorityClass_Count] = { DSTORAGE_PRIORITY_HIGH, DSTORAGE_PRIORITY_NORMAL, DSTORAGE_PRIORITY_LOW };
+            const char* names[IOPriorityClass_Count] = { "HighPriorityFileToGPU", "NormalPriorityFileToGPU", "LowPriorityFileToGPU" };
+            for (uint32_t priorityClass = 0; priorityClass < IOPriorityClass_Count; priorityClass++)
+            {
+                DSTORAGE_QUEUE_DESC queueDesc = {};
+                queueDesc.SourceType = DSTORAGE_REQUEST_SOURCE_FILE;
+                queueDesc.Capacity = ioOptions.m_queueLength;
+                queueDesc.Priority = priorities[priorityClass];
+                queueDesc.Name = names[priorityClass];
+                queueDesc.Device = pDevice; // Associate with GPU.
+                ThrowIfFailed(g_DStorageFactory->CreateQueue(&queueDesc, IID_PPV_ARGS(&g_DStorageGPUQueues[priorityClass].pQueue)));
+            }
 
-            ThrowIfFailed(pDevice->CreateFence(g_DStorageFenceValueGPU, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&g_DStorageFenceGPU)));
-            ThrowIfFailed(pDevice->CreateFence(g_DStorageFenceValueCPU, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&g_DStorageFenceCPU)));
             ThrowIfFailed(pDevice->CreateFence(g_DStorageFenceValueProfile, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&g_DStorageFenceProfile)));
-
-            g_DStorageFenceCPUEvent = CreateEvent(nullptr, false, false, nullptr);
             g_DStorageFenceProfileEvent = CreateEvent(nullptr, false, false, nullptr);
         }
 
@@ -298,225 +1122,711 @@ namespace Sample
             ThrowIfFailed(g_DStorageFactory->CreateQueue(&queueDesc, IID_PPV_ARGS(&g_DStorageQueueRealtime)));
         }
 
-        // Setup async error handler and thread.
-        DStorageErrorEventHandles DStorageQueueRealtimeErrorHandles;
-        DStorageQueueRealtimeErrorHandles.DStorageErrorHandle = g_DStorageQueueRealtime->GetErrorEvent();
-        (void)RegisterWaitForSingleObject(&DStorageQueueRealtimeErrorHandles.RegisteredWaitHandle
-            , DStorageQueueRealtimeErrorHandles.DStorageErrorHandle
-            , DStorageErrorHandler
-            , g_DStorageQueueRealtime
-            , INFINITE
-            , WT_EXECUTEDEFAULT);
-
-        DStorageErrorEventHandles DStorageQueueNormalErrorHandles;
-        DStorageQueueNormalErrorHandles.DStorageErrorHandle = g_DStorageQueueNormal->GetErrorEvent();
-        (void)RegisterWaitForSingleObject(&DStorageQueueNormalErrorHandles.RegisteredWaitHandle
-            , DStorageQueueNormalErrorHandles.DStorageErrorHandle
-            , DStorageErrorHandler
-            , g_DStorageQueueNormal
-            , INFINITE
-            , WT_EXECUTEDEFAULT);
+        {
+            // Normal priority, File->Memory. Reads whole packages into the payload cache.
+            DSTORAGE_QUEUE_DESC queueDesc = {};
+            queueDesc.SourceType = DSTORAGE_REQUEST_SOURCE_FILE;
+            queueDesc.Capacity = DSTORAGE_MIN_QUEUE_CAPACITY;
+            queueDesc.Priority = DSTORAGE_PRIORITY_NORMAL;
+            queueDesc.Name = "NormalPriorityFileToMemory";
+
+            ThrowIfFailed(g_DStorageFactory->CreateQueue(&queueDesc, IID_PPV_ARGS(&g_DStorageQueueFileToMemory)));
+        }
+
+        {
+            // Normal priority, Memory->GPU. For scenes in the payload cache.
+            DSTORAGE_QUEUE_DESC queueDesc = {};
+            queueDesc.SourceType = DSTORAGE_REQUEST_SOURCE_MEMORY;
+            queueDesc.Capacity = ioOptions.m_queueLength;
+            queueDesc.Priority = DSTORAGE_PRIORITY_NORMAL;
+            queueDesc.Name = "NormalPriorityMemoryToGPU";
+            queueDesc.Device = pDevice;
+            ThrowIfFailed(g_DStorageFactory->CreateQueue(&queueDesc, IID_PPV_ARGS(&g_DStorageGPUQueues[c_DStorageMemoryQueueIndex].pQueue)));
+        }
+
+        std::vector<DStorageQueueFeeder*> feeders;
+        for (auto& gpuQueue : g_DStorageGPUQueues)
+        {
+            ThrowIfFailed(pDevice->CreateFence(g_DStorageFenceValueCPU, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&gpuQueue.pFenceCPU)));
+            ThrowIfFailed(pDevice->CreateFence(g_DStorageFenceValueGPU, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&gpuQueue.pFenceGPU)));
+            gpuQueue.pFeeder = new DStorageQueueFeeder;
+            gpuQueue.pFeeder->OnCreate(gpuQueue.pQueue);
+            feeders.push_back(gpuQueue.pFeeder);
+        }
+
+        DStorageSubmitThread::Policy submitPolicy;
+        submitPolicy.maxRequests = ioOptions.m_submitThreshold;
+        submitPolicy.maxBytes = ioOptions.m_submitBytes;
+        submitPolicy.maxLatencyMilliseconds = ioOptions.m_submitLatencyMilliseconds;
+        g_DStorageSubmitThread.OnCreate(feeders, submitPolicy);
+
+        // Setup async error handler and thread.
+        DStorageErrorEventHandles DStorageQueueRealtimeErrorHandles;
+        DStorageQueueRealtimeErrorHandles.DStorageErrorHandle = g_DStorageQueueRealtime->GetErrorEvent();
+        (void)RegisterWaitForSingleObject(&DStorageQueueRealtimeErrorHandles.RegisteredWaitHandle
+            , DStorageQueueRealtimeErrorHandles.DStorageErrorHandle
+            , DStorageErrorHandler
+            , g_DStorageQueueRealtime
+            , INFINITE
+            , WT_EXECUTEDEFAULT);
+
+        for (const auto& gpuQueue : g_DStorageGPUQueues)
+        {
+            DStorageErrorEventHandles DStorageQueueGPUErrorHandles;
+            DStorageQueueGPUErrorHandles.DStorageErrorHandle = gpuQueue.pQueue->GetErrorEvent();
+            (void)RegisterWaitForSingleObject(&DStorageQueueGPUErrorHandles.RegisteredWaitHandle
+                , DStorageQueueGPUErrorHandles.DStorageErrorHandle
+                , DStorageErrorHandler
+                , gpuQueue.pQueue
+                , INFINITE
+                , WT_EXECUTEDEFAULT);
+        }
+
+        DStorageErrorEventHandles DStorageQueueFileToMemoryErrorHandles;
+        DStorageQueueFileToMemoryErrorHandles.DStorageErrorHandle = g_DStorageQueueFileToMemory->GetErrorEvent();
+        (void)RegisterWaitForSingleObject(&DStorageQueueFileToMemoryErrorHandles.RegisteredWaitHandle
+            , DStorageQueueFileToMemoryErrorHandles.DStorageErrorHandle
+            , DStorageErrorHandler
+            , g_DStorageQueueFileToMemory
+            , INFINITE
+            , WT_EXECUTEDEFAULT);
+
+        if (ioOptions.m_useProgressiveScenes)
+        {
+            CreatePlaceholderTextures();
+        }
+
+        // Package files of the selected variant.
+        const auto metaDataFileName{ GetMetaDataFileName(g_Converter.from_bytes(ioOptions.m_packageVariant)) };
+        const auto textureDataFileName{ GetTextureDataFileName(g_Converter.from_bytes(ioOptions.m_packageVariant)) };
+        const auto placementFileName{ GetPlacementFileName(g_Converter.from_bytes(ioOptions.m_packageVariant)) };
+        const auto regionFileName{ GetRegionFileName(g_Converter.from_bytes(ioOptions.m_packageVariant)) };
+        const auto tileFileName{ GetTileFileName(g_Converter.from_bytes(ioOptions.m_packageVariant)) };
+
+        // Find the package of every scene. The converter lists them in the manifest, only scenes missing from it are searched for on disk.
+        std::vector<PackageManifestEntry> manifestEntries;
+        if (!ReadPackageManifest(GetManifestFileName(g_Converter.from_bytes(ioOptions.m_packageVariant)), manifestEntries))
+        {
+            Trace("No package manifest found, searching for packages.");
+        }
+
+        std::unordered_map<std::wstring, const PackageManifestEntry*> manifestLookup;
+        for (const auto& manifestEntry : manifestEntries)
+        {
+            manifestLookup[manifestEntry.sceneDirectory + manifestEntry.sceneFilename] = &manifestEntry;
+        }
+
+        for (const auto& pathPair : *g_pScenePathMap)
+        {
+            const auto scenePath{ g_Converter.from_bytes(pathPair.second.scenePath) };
+            const auto manifestItr = manifestLookup.find(scenePath + g_Converter.from_bytes(pathPair.second.sceneFile));
+            if (manifestItr != manifestLookup.cend())
+            {
+                g_ScenePackages[pathPair.second] = { manifestItr->second->metaData, manifestItr->second->textureData, manifestItr->second->placement, manifestItr->second->regions, manifestItr->second->tiles, manifestItr->second->textureHeapSizes };
+            }
+            else
+            {
+                // The first match is in the scene directory itself, the search also walks the directories below it.
+                auto metaDataInfos{ GetSupportedFilesInfo(scenePath, {metaDataFileName}) };
+                auto textureDataInfos{ GetSupportedFilesInfo(scenePath, {textureDataFileName}) };
+                auto placementInfos{ GetSupportedFilesInfo(scenePath, {placementFileName}) };
+                auto regionInfos{ GetSupportedFilesInfo(scenePath, {regionFileName}) };
+                auto tileInfos{ GetSupportedFilesInfo(scenePath, {tileFileName}) };
+                if (metaDataInfos.empty() || textureDataInfos.empty())
+                {
+                    continue;
+                }
+
+                g_ScenePackages[pathPair.second] = { metaDataInfos[0], textureDataInfos[0]
+                    , (!placementInfos.empty() && IsSameDirectory(placementInfos[0].Name, metaDataInfos[0].Name)) ? placementInfos[0] : FileInfo{}
+                    , (!regionInfos.empty() && IsSameDirectory(regionInfos[0].Name, metaDataInfos[0].Name)) ? regionInfos[0] : FileInfo{}
+                    , (!tileInfos.empty() && IsSameDirectory(tileInfos[0].Name, metaDataInfos[0].Name)) ? tileInfos[0] : FileInfo{} };
+            }
+        }
+
+        assert(g_ScenePackages.size() > 0);
+
+        // The metadata itself is read when a scene first loads, see DStorageAcquireSceneMetaData.
+        return true;
+    }
+
+    static void LoadSceneMetaData(const ScenePathPair& scenePathPair, SceneMetaData& sceneMetaData)
+    {
+        CPUUserMarker marker("LoadSceneMetaData");
+
+        const auto& packageFiles = g_ScenePackages.at(scenePathPair);
+        auto& metaDataHeaders = sceneMetaData.headers;
+        metaDataHeaders.resize(packageFiles.metaData.Size / sizeof(DirectStorageSampleTextureMetadataHeader));
+
+        // Placement tables are optional, packages from older converters don't have them.
+        std::vector<uint8_t> placementBuffer(packageFiles.placement.Name.empty() ? 0 : static_cast<size_t>(packageFiles.placement.Size));
+        auto& regionTable = sceneMetaData.regionTable;
+        regionTable.resize(packageFiles.regions.Name.empty() ? 0 : static_cast<size_t>(packageFiles.regions.Size));
+        auto& tileTable = sceneMetaData.tileTable;
+        tileTable.resize((packageFiles.tiles.Name.empty() || !g_pIOOptions->m_useTiledTextures) ? 0 : static_cast<size_t>(packageFiles.tiles.Size));
+
+        // Keeping track to close later.
+        std::vector<IDStorageFile*> metaDataFileHandles;
+        auto enqueueRead = [&metaDataFileHandles](const FileInfo& fileInfo, void* buffer, const char* name)
+        {
+            DSTORAGE_REQUEST req = {};
+            req.Options.CompressionFormat = DSTORAGE_COMPRESSION_FORMAT_NONE;
+            req.Options.SourceType = DSTORAGE_REQUEST_SOURCE_FILE;
+            req.Options.DestinationType = DSTORAGE_REQUEST_DESTINATION_MEMORY;
+            req.Options.Reserved = 0;
+            ThrowIfFailed(g_DStorageFactory->OpenFile(fileInfo.Name.c_str(), IID_PPV_ARGS(&req.Source.File.Source)));
+            metaDataFileHandles.push_back(req.Source.File.Source);
+            req.Source.File.Offset = 0;
+            req.Source.File.Size = static_cast<uint32_t>(fileInfo.Size);
+            req.Destination.Memory.Buffer = buffer;
+            req.Destination.Memory.Size = static_cast<uint32_t>(fileInfo.Size);
+            req.UncompressedSize = static_cast<uint32_t>(fileInfo.Size);
+            req.CancellationTag = 0;
+            req.Name = name;
+            g_DStorageQueueRealtime->EnqueueRequest(&req);
+        };
+
+        // Load the metadata :)
+        enqueueRead(packageFiles.metaData, metaDataHeaders.data(), "Read metadata");
+        if (!placementBuffer.empty())
+        {
+            enqueueRead(packageFiles.placement, placementBuffer.data(), "Read placement");
+        }
+        if (!regionTable.empty())
+        {
+            enqueueRead(packageFiles.regions, regionTable.data(), "Read regions");
+        }
+        if (!tileTable.empty())
+        {
+            enqueueRead(packageFiles.tiles, tileTable.data(), "Read tiles");
+        }
+        WaitForMemoryQueue(g_DStorageQueueRealtime);
+
+        // Close metadata file handles.
+        for (auto& fileHandle : metaDataFileHandles)
+        {
+            fileHandle->Release();
+        }
+
+        // Scenes can be loaded at any quality tier one of their textures provides.
+        uint32_t qualityTierCount = 1;
+        uint32_t maxTextureSize = 0;
+        for (const auto& metaDataHeader : metaDataHeaders)
+        {
+            qualityTierCount = max(qualityTierCount, metaDataHeader.qualityTierCount);
+            maxTextureSize = max(maxTextureSize, max(static_cast<uint32_t>(metaDataHeader.resourceDesc.Width), metaDataHeader.resourceDesc.Height));
+        }
+        sceneMetaData.qualityTierCount = qualityTierCount;
+        sceneMetaData.maxTextureSize = maxTextureSize;
+
+        // Get uncompressed and on disk sizes. This is only being used for stats.
+        for (uint32_t qualityTier = 0; qualityTier < c_DirectStorageSampleMaxQualityTiers; qualityTier++)
+        {
+            auto& uncompressedSize = sceneMetaData.textureDataSizeUncompressed[qualityTier];
+            auto& diskSize = sceneMetaData.textureDataSizeOnDisk[qualityTier];
+            std::for_each(metaDataHeaders.cbegin(), metaDataHeaders.cend()
+                , [&uncompressedSize,&diskSize,qualityTier](const DirectStorageSampleTextureMetadataHeader& mdh)
+                    { const auto tier = GetTextureQualityTier(mdh, qualityTier); uncompressedSize += tier.resourceSizeUncompressed; diskSize += tier.resourceSizeCompressed; });
+        }
+
+        // Per quality tier, the placement of every texture for heap allocation and offset calculations.
+        // The converter stored these for the adapter it ran on. Only recompute them if this is a different adapter or driver.
+        std::array<std::vector<DirectStorageSampleTexturePlacement>, c_DirectStorageSampleMaxQualityTiers> resourceAllocInfos;
+        std::array<D3D12_RESOURCE_ALLOCATION_INFO, c_DirectStorageSampleMaxQualityTiers> fileAllocInfos{};
+
+        const DirectStorageSamplePlacementHeader* placementHeader = nullptr;
+        if (placementBuffer.size() >= sizeof(DirectStorageSamplePlacementHeader))
+        {
+            placementHeader = reinterpret_cast<const DirectStorageSamplePlacementHeader*>(placementBuffer.data());
+            const bool isValid = placementHeader->version == c_DirectStorageSamplePlacementVersion
+                && placementHeader->textureCount == metaDataHeaders.size()
+                && placementHeader->qualityTierCount == qualityTierCount
+                && placementBuffer.size() == sizeof(DirectStorageSamplePlacementHeader) + sizeof(DirectStorageSampleTexturePlacement) * placementHeader->textureCount * placementHeader->qualityTierCount
+                && IsSamePlacementAdapterKey(placementHeader->adapterKey, GetPlacementAdapterKey(g_pDevice));
+            if (!isValid)
+            {
+                placementHeader = nullptr;
+            }
+        }
+
+        for (uint32_t qualityTier = 0; qualityTier < qualityTierCount; qualityTier++)
+        {
+            auto& resourceAllocInfo = resourceAllocInfos[qualityTier];
+            if (placementHeader)
+            {
+                const auto* tierPlacements = reinterpret_cast<const DirectStorageSampleTexturePlacement*>(placementHeader + 1) + qualityTier * placementHeader->textureCount;
+                resourceAllocInfo.assign(tierPlacements, tierPlacements + placementHeader->textureCount);
+                fileAllocInfos[qualityTier] = { placementHeader->heapSize[qualityTier], placementHeader->heapAlignment[qualityTier] };
+                continue;
+            }
+
+            std::vector<D3D12_RESOURCE_DESC> fileResourceDescs(metaDataHeaders.size());
+            for (size_t resourceDescIdx = 0; resourceDescIdx < fileResourceDescs.size(); resourceDescIdx++)
+            {
+                fileResourceDescs[resourceDescIdx] = GetTextureQualityTier(metaDataHeaders[resourceDescIdx], qualityTier).resourceDesc;
+            }
+
+            fileAllocInfos[qualityTier] = ComputeHeapPlacement(g_pDevice, fileResourceDescs, resourceAllocInfo);
+        }
+
+        if (placementHeader == nullptr)
+        {
+            Trace("Placement table missing or made on another adapter, recomputed: %ls", packageFiles.metaData.Name.c_str());
+        }
+
+        for (uint32_t qualityTier = 0; qualityTier < qualityTierCount; qualityTier++)
+        {
+            sceneMetaData.textureResidentSize[qualityTier] = fileAllocInfos[qualityTier].SizeInBytes;
+        }
+
+        if (g_pIOOptions->m_usePlacedResources)
+        {
+            for (uint32_t qualityTier = 0; qualityTier < qualityTierCount; qualityTier++)
+            {
+                const auto& fileAllocInfo = fileAllocInfos[qualityTier];
+                //CD3DX12_HEAP_DESC
+                D3D12_HEAP_DESC& heapDesc = sceneMetaData.heapTemplates[qualityTier];
+                heapDesc.SizeInBytes = fileAllocInfo.SizeInBytes;
+                heapDesc.Properties.Type = D3D12_HEAP_TYPE_DEFAULT;
+                heapDesc.Properties.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
+                heapDesc.Properties.CreationNodeMask = 0;
+                heapDesc.Properties.VisibleNodeMask = 0;
+
+                // may need to check for UMA here.
+                heapDesc.Properties.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
+
+                heapDesc.Alignment = fileAllocInfo.Alignment;
+                heapDesc.Flags = D3D12_HEAP_FLAG_ALLOW_ONLY_NON_RT_DS_TEXTURES | D3D12_HEAP_FLAG_CREATE_NOT_ZEROED; // For now, allow it to be resident.
+            }
+        }
+
+        // Region tables must match the texture data exactly, anything else is left over from an earlier conversion.
+        const DirectStorageSampleTextureRegionRange* regionRanges = nullptr;
+        const DirectStorageSampleTextureRegion* regions = nullptr;
+        if (!regionTable.empty())
+        {
+            const auto* regionHeader = reinterpret_cast<const DirectStorageSampleRegionHeader*>(regionTable.data());
+            const size_t rangesSize = regionTable.size() >= sizeof(DirectStorageSampleRegionHeader) ? sizeof(DirectStorageSampleTextureRegionRange) * regionHeader->textureCount : 0;
+            bool isValid = regionTable.size() >= sizeof(DirectStorageSampleRegionHeader) + rangesSize
+                && regionHeader->version == c_DirectStorageSampleRegionVersion
+                && regionHeader->textureCount == metaDataHeaders.size()
+                && regionHeader->textureDataSize == packageFiles.textureData.Size
+                && (regionTable.size() - sizeof(DirectStorageSampleRegionHeader) - rangesSize) % sizeof(DirectStorageSampleTextureRegion) == 0;
+            if (isValid)
+            {
+                regionRanges = reinterpret_cast<const DirectStorageSampleTextureRegionRange*>(regionHeader + 1);
+                regions = reinterpret_cast<const DirectStorageSampleTextureRegion*>(regionRanges + regionHeader->textureCount);
+                const size_t regionCount = (regionTable.size() - sizeof(DirectStorageSampleRegionHeader) - rangesSize) / sizeof(DirectStorageSampleTextureRegion);
+                for (uint32_t textureIdx = 0; textureIdx < regionHeader->textureCount && isValid; textureIdx++)
+                {
+                    isValid = regionRanges[textureIdx].regionCount > 0 && static_cast<size_t>(regionRanges[textureIdx].firstRegion) + regionRanges[textureIdx].regionCount <= regionCount;
+                }
+            }
+
+            if (!isValid)
+            {
+                Trace("Region table doesn't match the package, ignored: %ls", packageFiles.regions.Name.c_str());
+                regionRanges = nullptr;
+                regions = nullptr;
+            }
+        }
+
+        // Same for the tile tables.
+        const DirectStorageSampleTextureTiles* textureTiles = nullptr;
+        const DirectStorageSampleTile* tiles = nullptr;
+        if (!tileTable.empty())
+        {
+            const auto* tileHeader = reinterpret_cast<const DirectStorageSampleTileHeader*>(tileTable.data());
+            const size_t texturesSize = tileTable.size() >= sizeof(DirectStorageSampleTileHeader) ? sizeof(DirectStorageSampleTextureTiles) * tileHeader->textureCount : 0;
+            bool isValid = tileTable.size() >= sizeof(DirectStorageSampleTileHeader) + texturesSize
+                && tileHeader->version == c_DirectStorageSampleTileVersion
+                && tileHeader->textureCount == metaDataHeaders.size()
+                && tileHeader->textureDataSize == packageFiles.textureData.Size
+                && (tileTable.size() - sizeof(DirectStorageSampleTileHeader) - texturesSize) % sizeof(DirectStorageSampleTile) == 0;
+            if (isValid)
+            {
+                textureTiles = reinterpret_cast<const DirectStorageSampleTextureTiles*>(tileHeader + 1);
+                tiles = reinterpret_cast<const DirectStorageSampleTile*>(textureTiles + tileHeader->textureCount);
+                const size_t tileCount = (tileTable.size() - sizeof(DirectStorageSampleTileHeader) - texturesSize) / sizeof(DirectStorageSampleTile);
+                for (uint32_t textureIdx = 0; textureIdx < tileHeader->textureCount && isValid; textureIdx++)
+                {
+                    isValid = static_cast<size_t>(textureTiles[textureIdx].firstTile) + textureTiles[textureIdx].tileCount <= tileCount;
+                }
+            }
+
+            if (!isValid)
+            {
+                Trace("Tile table doesn't match the package, ignored: %ls", packageFiles.tiles.Name.c_str());
+                textureTiles = nullptr;
+                tiles = nullptr;
+            }
+        }
+
+        // Open the file handle for the texture data file. It stays open until the metadata is evicted.
+        ThrowIfFailed(g_DStorageFactory->OpenFile(packageFiles.textureData.Name.c_str(), IID_PPV_ARGS(&sceneMetaData.textureFileHandle)));
+
+        std::vector<std::pair<std::wstring, ResourceLookupEntry>> entries(metaDataHeaders.size());
+        for (size_t metaDataIdx = 0; metaDataIdx < metaDataHeaders.size(); metaDataIdx++)
+        {
+            auto& metaDataResource = metaDataHeaders[metaDataIdx];
+
+            ResourceLookupEntry& entry = entries[metaDataIdx].second;
+            entry.reseourceFileHandle = sceneMetaData.textureFileHandle;
+            entry.metaDataHeader = &metaDataResource;
+            if (regionRanges)
+            {
+                entry.regions = regions + regionRanges[metaDataIdx].firstRegion;
+                entry.regionCount = regionRanges[metaDataIdx].regionCount;
+            }
+            if (textureTiles && textureTiles[metaDataIdx].standardMipCount > 0)
+            {
+                entry.tiles = &textureTiles[metaDataIdx];
+                entry.tileEntries = tiles + textureTiles[metaDataIdx].firstTile;
+            }
+            for (uint32_t qualityTier = 0; qualityTier < qualityTierCount; qualityTier++)
+            {
+                const auto& placement = resourceAllocInfos[qualityTier][metaDataIdx];
+                entry.resourceHeapOffset[qualityTier] = placement.heapOffset;
+                entry.resourceHeapSize[qualityTier] = placement.sizeInBytes;
+                entry.resourceHeapAlignment[qualityTier] = placement.alignment;
+            }
+
+            std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>, wchar_t> converter;
+            entry.gltfPath = converter.to_bytes(metaDataResource.resourceName);
+            entries[metaDataIdx].first = metaDataResource.resourceName;
+        }
+
+        std::lock_guard<std::mutex> lock(g_SceneMetaDataMutex);
+        for (auto& entry : entries)
+        {
+            if (!g_ResourceTable.insert_or_assign(std::move(entry.first), std::move(entry.second)).second)
+            {
+                // This should only happen if textures have the same name. Let's see if we can get away with this.
+                assert(!"incompatible resource name found. duplicate.");
+            }
+        }
+    }
+
+    // Caller holds g_SceneMetaDataMutex.
+    static void EvictSceneMetaData(std::unordered_map<ScenePathPair, std::unique_ptr<SceneMetaData>>::iterator sceneItr)
+    {
+        auto& sceneMetaData = *sceneItr->second;
+        assert(sceneMetaData.refCount == 0);
 
-        // generate list of metadata file infos and data files.
-        std::vector<FileInfo> metaDataFileInfos;
-        metaDataFileInfos.reserve(g_pScenePathMap->size());
-        for (const auto& pathPair : *g_pScenePathMap)
+        for (const auto& metaDataHeader : sceneMetaData.headers)
         {
-            auto fileinfos{ GetSupportedFilesInfo(pathPair.second.scenePath, {"MetaData.bin"}) };
-            std::copy(fileinfos.cbegin(), fileinfos.cend(), std::back_inserter(metaDataFileInfos));
+            g_ResourceTable.erase(metaDataHeader.resourceName);
         }
 
-        std::vector<FileInfo> textureDataFileInfos;
-        textureDataFileInfos.reserve(g_pScenePathMap->size());
-        for (const auto& pathPair : *g_pScenePathMap)
+        if (sceneMetaData.textureFileHandle)
         {
-            auto fileinfos{ GetSupportedFilesInfo(pathPair.second.scenePath, {"TextureData.bin"}) };
-            std::copy(fileinfos.cbegin(), fileinfos.cend(), std::back_inserter(textureDataFileInfos));
+            sceneMetaData.textureFileHandle->Release();
         }
 
-        assert(metaDataFileInfos.size() > 0);
-        assert(metaDataFileInfos.size() == textureDataFileInfos.size());
+        g_SceneMetaData.erase(sceneItr);
+    }
 
-        // Create a structure for all metadatas.
-        g_MetaDataHeaders.resize(metaDataFileInfos.size());
-        for (size_t metaDataFileIdx = 0; metaDataFileIdx < metaDataFileInfos.size(); metaDataFileIdx++)
+    bool DStorageAcquireSceneMetaData(const ScenePathPair& scenePathPair)
+    {
+        if (g_ScenePackages.find(scenePathPair) == g_ScenePackages.cend())
         {
-            auto& metaDataHeader = g_MetaDataHeaders[metaDataFileIdx];
-            auto& metaFileInfo = metaDataFileInfos[metaDataFileIdx];
-            metaDataHeader.resize(metaFileInfo.Size / sizeof(DirectStorageSampleTextureMetadataHeader));
+            return false;
         }
 
-        // Keeping track to close later.
-        std::vector<IDStorageFile*> metaDataFileHandles;
+        // Hold a reference before reading, so a trim can't evict the scene while another thread is still loading it.
+        SceneMetaData* pSceneMetaData = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(g_SceneMetaDataMutex);
+            auto& sceneMetaData = g_SceneMetaData[scenePathPair];
+            if (!sceneMetaData)
+            {
+                sceneMetaData = std::make_unique<SceneMetaData>();
+            }
+            sceneMetaData->refCount++;
+            pSceneMetaData = sceneMetaData.get();
+        }
 
-        // Load the metadata :)
-        for (size_t metaDataFileIdx = 0; metaDataFileIdx < metaDataFileInfos.size(); metaDataFileIdx++)
+        std::lock_guard<std::mutex> loadLock(pSceneMetaData->loadMutex);
+        if (!pSceneMetaData->isLoaded)
         {
-            const auto& metaDataFile = metaDataFileInfos[metaDataFileIdx];
-            DSTORAGE_REQUEST req = {};
-            req.Options.CompressionFormat = DSTORAGE_COMPRESSION_FORMAT_NONE;
-            req.Options.SourceType = DSTORAGE_REQUEST_SOURCE_FILE;
-            req.Options.DestinationType = DSTORAGE_REQUEST_DESTINATION_MEMORY;
-            req.Options.Reserved = 0;
-            g_DStorageFactory->OpenFile(metaDataFile.Name.c_str(), IID_PPV_ARGS(&req.Source.File.Source));
-            metaDataFileHandles.push_back(req.Source.File.Source);
-            req.Source.File.Offset = 0;
-            req.Source.File.Size = metaDataFile.Size;
-            req.Destination.Memory.Buffer = g_MetaDataHeaders[metaDataFileIdx].data();
-            req.Destination.Memory.Size = metaDataFile.Size;
-            req.UncompressedSize = metaDataFile.Size;
-            req.CancellationTag = 0;
-            req.Name = "Read metadata";
-            g_DStorageQueueRealtime->EnqueueRequest(&req);
+            LoadSceneMetaData(scenePathPair, *pSceneMetaData);
+
+            std::lock_guard<std::mutex> lock(g_SceneMetaDataMutex);
+            pSceneMetaData->isLoaded = true;
         }
-        IDStorageStatusArray* statusArray = nullptr;
-        ThrowIfFailed(g_DStorageFactory->CreateStatusArray(1, "Real-time Status Array", IID_PPV_ARGS(&statusArray)));
-        g_DStorageQueueRealtime->EnqueueStatus(statusArray, 0);
-        g_DStorageQueueRealtime->Submit();
 
-        while (!statusArray->IsComplete(0)) { _mm_pause(); }
+        return true;
+    }
+
+    void DStorageReleaseSceneMetaData(const ScenePathPair& scenePathPair)
+    {
+        std::lock_guard<std::mutex> lock(g_SceneMetaDataMutex);
+        auto& sceneMetaData = *g_SceneMetaData.at(scenePathPair);
+        assert(sceneMetaData.refCount > 0);
+        sceneMetaData.refCount--;
+        sceneMetaData.lastUsedTime = MillisecondsNow();
+    }
 
-        // Delete the status array. 
-        statusArray->Release();
+    void DStorageTrimSceneMetaData(const IOOptions& ioOptions)
+    {
+        std::lock_guard<std::mutex> lock(g_SceneMetaDataMutex);
 
-        // Gather all the resource descs to prepare for heap allocation and offset calculations.
-        std::vector<std::vector<D3D12_RESOURCE_DESC>> perFileResourceDescs(g_MetaDataHeaders.size());
-        for (size_t perFileResourceDescsIdx = 0; perFileResourceDescsIdx < perFileResourceDescs.size(); perFileResourceDescsIdx++)
+        // Unused scenes, least recently used first.
+        std::vector<std::pair<double, ScenePathPair>> unusedScenes;
+        for (const auto& sceneMetaData : g_SceneMetaData)
         {
-            perFileResourceDescs[perFileResourceDescsIdx].resize(g_MetaDataHeaders[perFileResourceDescsIdx].size());
-            auto& resourceDescs = perFileResourceDescs[perFileResourceDescsIdx];
-            for (size_t resourceDescIdx = 0; resourceDescIdx < resourceDescs.size(); resourceDescIdx++)
+            if (sceneMetaData.second->refCount == 0)
             {
-                resourceDescs[resourceDescIdx] = g_MetaDataHeaders[perFileResourceDescsIdx][resourceDescIdx].resourceDesc;
+                unusedScenes.emplace_back(sceneMetaData.second->lastUsedTime, sceneMetaData.first);
             }
         }
 
-        std::vector< std::vector<D3D12_RESOURCE_ALLOCATION_INFO1>> resourceAllocInfos(g_MetaDataHeaders.size());
-        std::vector<D3D12_RESOURCE_ALLOCATION_INFO> fileAllocInfos(g_MetaDataHeaders.size());
-        for (size_t resourceAllocsIdx = 0; resourceAllocsIdx < g_MetaDataHeaders.size(); resourceAllocsIdx++)
+        if (unusedScenes.empty())
+        {
+            return;
+        }
+
+        std::sort(unusedScenes.begin(), unusedScenes.end(), [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; });
+
+        const double now = MillisecondsNow();
+        const double maxIdleTime = ioOptions.m_metaDataCacheSeconds * 1000.0;
+        size_t cachedCount = unusedScenes.size();
+        for (const auto& unusedScene : unusedScenes)
         {
-            resourceAllocInfos[resourceAllocsIdx].resize(g_MetaDataHeaders[resourceAllocsIdx].size());
+            if ((cachedCount <= ioOptions.m_metaDataCacheSize) && (now - unusedScene.first <= maxIdleTime))
+            {
+                break;
+            }
+
+            EvictSceneMetaData(g_SceneMetaData.find(unusedScene.second));
+            cachedCount--;
         }
+    }
+
+    // Reads a scene's whole texture data file into its payload.
+    static void LoadScenePayload(const ScenePathPair& scenePathPair, ScenePayload& scenePayload)
+    {
+        CPUUserMarker marker("LoadScenePayload");
+
+        scenePayload.data.reset(new uint8_t[scenePayload.size]);
 
-        auto pathPairItr = g_pScenePathMap->cbegin();
-        // Get uncompressed and on disk sizes per file. This is only being used for stats.
-        for (size_t metaDataFileIdx = 0; metaDataFileIdx < metaDataFileInfos.size(); metaDataFileIdx++)
+        IDStorageFile* pTextureFile = GetAcquiredSceneMetaData(scenePathPair).textureFileHandle;
+
+        // Requests take 32 bit sizes, big packages are read in pieces.
+        const uint64_t maxRequestSize = 64 * 1024 * 1024;
+        for (uint64_t offset = 0; offset < scenePayload.size; offset += maxRequestSize)
         {
-            const auto& pathPair = *pathPairItr;
-            const auto& assetMetaData = g_MetaDataHeaders[metaDataFileIdx];
-            auto& uncompressedSize = g_SceneTextureDataSizeUncompressed[pathPair.second];
-            auto& diskSize = g_SceneTextureDataSizeOnDisk[pathPair.second];
-            std::for_each(assetMetaData.cbegin(), assetMetaData.cend()
-                , [&uncompressedSize,&diskSize](const DirectStorageSampleTextureMetadataHeader& mdh) 
-                    { uncompressedSize += mdh.resourceSizeUncompressed; diskSize += mdh.resourceSizeCompressed; });
+            const uint32_t requestSize = static_cast<uint32_t>(min(maxRequestSize, scenePayload.size - offset));
 
-            pathPairItr++;
+            DSTORAGE_REQUEST req = {};
+            req.Options.CompressionFormat = DSTORAGE_COMPRESSION_FORMAT_NONE;
+            req.Options.SourceType = DSTORAGE_REQUEST_SOURCE_FILE;
+            req.Options.DestinationType = DSTORAGE_REQUEST_DESTINATION_MEMORY;
+            req.Source.File.Source = pTextureFile;
+            req.Source.File.Offset = offset;
+            req.Source.File.Size = requestSize;
+            req.Destination.Memory.Buffer = scenePayload.data.get() + offset;
+            req.Destination.Memory.Size = requestSize;
+            req.UncompressedSize = requestSize;
+            req.CancellationTag = 0;
+            req.Name = "Read payload";
+            g_DStorageQueueFileToMemory->EnqueueRequest(&req);
         }
 
+        WaitForMemoryQueue(g_DStorageQueueFileToMemory);
+    }
+
+    bool DStorageAcquireScenePayload(const ScenePathPair& scenePathPair, uint64_t workloadId, uint32_t qualityTier, PayloadCacheLookup* pLookupOut, uint64_t* pBytesSavedOut)
+    {
+        auto& workloadPayload = g_WorkloadPayloads[workloadId % g_WorkloadPayloads.size()];
+        workloadPayload = nullptr;
+        *pLookupOut = PayloadCacheLookup_None;
+        *pBytesSavedOut = 0;
 
-        ID3D12Device6* pDevice6 = nullptr;
-        ThrowIfFailed(pDevice->QueryInterface(IID_PPV_ARGS(&pDevice6)));
-        for (size_t perFileIdx = 0; perFileIdx < fileAllocInfos.size(); perFileIdx++)
+        const uint64_t cacheBudget = g_pIOOptions->m_payloadCacheSize * 1024ull * 1024ull;
+        if (cacheBudget == 0)
         {
-            const auto& fileResourceDescs = perFileResourceDescs[perFileIdx];
-            auto& fileAllocInfo = fileAllocInfos[perFileIdx];
-            auto& resourceAllocInfo = resourceAllocInfos[perFileIdx];
-            fileAllocInfo = pDevice6->GetResourceAllocationInfo1(0, fileResourceDescs.size(), fileResourceDescs.data(), resourceAllocInfo.data());
+            return false;
         }
-        pDevice6->Release();
 
-        if (ioOptions.m_usePlacedResources)
+        const uint64_t payloadSize = g_ScenePackages.at(scenePathPair).textureData.Size;
+
+        ScenePayload* pScenePayload = nullptr;
         {
-            for (size_t fileIdx = 0; fileIdx < fileAllocInfos.size(); fileIdx++)
+            std::lock_guard<std::mutex> lock(g_PayloadCacheMutex);
+            auto payloadItr = g_PayloadCache.find(scenePathPair);
+            if (payloadItr != g_PayloadCache.end())
             {
-                const auto& fileAllocInfo = fileAllocInfos[fileIdx];
-                //CD3DX12_HEAP_DESC
-                D3D12_HEAP_DESC heapDesc{};
-                heapDesc.SizeInBytes = fileAllocInfo.SizeInBytes;
-                heapDesc.Properties.Type = D3D12_HEAP_TYPE_DEFAULT;
-                heapDesc.Properties.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
-                heapDesc.Properties.CreationNodeMask = 0;
-                heapDesc.Properties.VisibleNodeMask = 0;
-
-                // may need to check for UMA here.
-                heapDesc.Properties.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
+                // Already cached, or being read by another load we can wait for.
+                *pLookupOut = PayloadCacheLookup_Hit;
+                *pBytesSavedOut = GetSceneTextureDataSizeOnDisk(scenePathPair, qualityTier);
+                g_PayloadCacheStats.hits++;
+                g_PayloadCacheStats.bytesSaved += *pBytesSavedOut;
+                pScenePayload = payloadItr->second.get();
+            }
+            else
+            {
+                *pLookupOut = PayloadCacheLookup_Miss;
+                g_PayloadCacheStats.misses++;
 
-                heapDesc.Alignment = fileAllocInfo.Alignment;
-                heapDesc.Flags = D3D12_HEAP_FLAG_ALLOW_ONLY_NON_RT_DS_TEXTURES | D3D12_HEAP_FLAG_CREATE_NOT_ZEROED; // For now, allow it to be resident.
+                // Make room, least recently used first. Payloads in use stay, if they don't leave enough room the scene is read from the file.
+                std::vector<std::pair<double, ScenePathPair>> unusedPayloads;
+                for (const auto& cachedPayload : g_PayloadCache)
+                {
+                    if (cachedPayload.second->refCount == 0)
+                    {
+                        unusedPayloads.emplace_back(cachedPayload.second->lastUsedTime, cachedPayload.first);
+                    }
+                }
+                std::sort(unusedPayloads.begin(), unusedPayloads.end(), [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; });
 
-                auto scenePathMapItr = g_pScenePathMap->cbegin();
-                while (scenePathMapItr != g_pScenePathMap->cend())
+                for (const auto& unusedPayload : unusedPayloads)
                 {
-                    const auto& scenePathPair = scenePathMapItr->second;
-                    if (IsSameDirectory(metaDataFileInfos[fileIdx].Name, g_Converter.from_bytes(scenePathPair.scenePath)))
+                    if (g_PayloadCacheSize + payloadSize <= cacheBudget)
                     {
-                        g_SceneHeapTemplates.insert_or_assign(scenePathPair, heapDesc);
                         break;
                     }
-                    scenePathMapItr++;
+
+                    auto unusedItr = g_PayloadCache.find(unusedPayload.second);
+                    g_PayloadCacheSize -= unusedItr->second->size;
+                    g_PayloadCache.erase(unusedItr);
+                }
+
+                if (g_PayloadCacheSize + payloadSize > cacheBudget)
+                {
+                    g_PayloadCacheStats.size = g_PayloadCacheSize;
+                    return false;
                 }
+
+                auto& scenePayload = g_PayloadCache[scenePathPair];
+                scenePayload = std::make_unique<ScenePayload>();
+                scenePayload->size = payloadSize;
+                g_PayloadCacheSize += payloadSize;
+                pScenePayload = scenePayload.get();
             }
+
+            pScenePayload->refCount++;
+            g_PayloadCacheStats.size = g_PayloadCacheSize;
         }
 
-        // Close metadata file handles.
-        for (auto& fileHandle : metaDataFileHandles)
+        // The first load of a scene reads its package into memory, then loads from there like every load after it.
+        std::lock_guard<std::mutex> loadLock(pScenePayload->loadMutex);
+        if (!pScenePayload->isLoaded)
         {
-            fileHandle->Release();
+            LoadScenePayload(scenePathPair, *pScenePayload);
+            pScenePayload->isLoaded = true;
         }
 
+        workloadPayload = pScenePayload->data.get();
+        return true;
+    }
 
-        for (size_t metaDataFileIdx = 0; metaDataFileIdx < g_MetaDataHeaders.size(); metaDataFileIdx++)
+    void DStorageReleaseScenePayload(const ScenePathPair& scenePathPair, uint64_t workloadId)
+    {
+        auto& workloadPayload = g_WorkloadPayloads[workloadId % g_WorkloadPayloads.size()];
+        if (workloadPayload == nullptr)
         {
-            const auto& metaDataInfo = metaDataFileInfos[metaDataFileIdx];
-            const auto& metaDataHeader = g_MetaDataHeaders[metaDataFileIdx];
-
-            // Open the file handle for each texture data file.
-            auto textureFileName = metaDataInfo.Name.substr(0, metaDataInfo.Name.rfind(L"MetaData.bin")) + L"TextureData.bin";
-            //textureFileName.replace(textureFileName.rfind(L"MetaData.bin"), textureFileName.size(), L"TextureData.bin");
+            return;
+        }
+        workloadPayload = nullptr;
 
-            IDStorageFile* fileHandle = nullptr;
-            ThrowIfFailed(g_DStorageFactory->OpenFile(textureFileName.c_str(), IID_PPV_ARGS(&fileHandle)));
-            g_FileHandles.push_back(fileHandle);
+        std::lock_guard<std::mutex> lock(g_PayloadCacheMutex);
+        auto& scenePayload = *g_PayloadCache.at(scenePathPair);
+        assert(scenePayload.refCount > 0);
+        scenePayload.refCount--;
+        scenePayload.lastUsedTime = MillisecondsNow();
+    }
 
-            for (size_t metaDataIdx = 0; metaDataIdx < metaDataHeader.size(); metaDataIdx++)
-            {
-                auto& metaDataResource = metaDataHeader[metaDataIdx];
+    PayloadCacheStats DStorageGetPayloadCacheStats()
+    {
+        std::lock_guard<std::mutex> lock(g_PayloadCacheMutex);
+        return g_PayloadCacheStats;
+    }
 
-                ResourceLookupEntry entry;
-                entry.reseourceFileHandle = fileHandle;
-                entry.metaDataHeader = &metaDataResource;
-                entry.resourceHeapOffset = resourceAllocInfos[metaDataFileIdx][metaDataIdx].Offset;
-                entry.resourceHeapSize = resourceAllocInfos[metaDataFileIdx][metaDataIdx].SizeInBytes;
+    std::vector<uint32_t> DStorageTakeWorkloadTiledTextures(uint64_t workloadId)
+    {
+        std::lock_guard<std::mutex> lock(g_TiledTexturesMutex);
+        return std::move(g_WorkloadTiledTextures[workloadId % g_WorkloadTiledTextures.size()]);
+    }
 
+    void DStorageRequestTiledTextureMips(const std::vector<uint32_t>& tiledTextures, float sceneRadius, float distanceToScene, float projectionScale)
+    {
+        TiledTextureStreamer* pStreamer = g_TiledTextureStreamer;
+        if (pStreamer == nullptr)
+        {
+            return;
+        }
 
-                std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>, wchar_t> converter;
-                entry.gltfPath = converter.to_bytes(metaDataResource.resourceName);
+        // Asks for one mip more than the estimate, so the mip the camera moves on to is usually in before it's sampled.
+        for (const auto tiledTexture : tiledTextures)
+        {
+            const uint32_t mipDrop = GetTextureLODMipDrop(pStreamer->GetTextureSize(tiledTexture), sceneRadius, distanceToScene, projectionScale);
+            pStreamer->RequestMip(tiledTexture, mipDrop > 0 ? mipDrop - 1 : 0);
+        }
+    }
 
-                bool alreadyExists = false;
-                if (!g_ResourceTable.insert_or_assign(std::wstring(metaDataResource.resourceName), entry).second)
-                {
-                    // This should only happen if textures have the same name. Let's see if we can get away with this.
-                    assert(!"incompatible resource name found. duplicate.");
-                }
-            }
+    void DStorageUpdateTiledTextures()
+    {
+        TiledTextureStreamer* pStreamer = g_TiledTextureStreamer;
+        if (pStreamer)
+        {
+            pStreamer->Update();
         }
+    }
 
-        return true;
+    TiledTextureStats DStorageGetTiledTextureStats()
+    {
+        TiledTextureStats tiledTextureStats;
+        TiledTextureStreamer* pStreamer = g_TiledTextureStreamer;
+        if (pStreamer)
+        {
+            const auto stats = pStreamer->GetStats();
+            tiledTextureStats.textureCount = stats.textureCount;
+            tiledTextureStats.slotCount = stats.residency.slotCount;
+            tiledTextureStats.pinnedSlots = stats.residency.pinnedSlots;
+            tiledTextureStats.residentTiles = stats.residency.residentTiles;
+            tiledTextureStats.loadingTiles = stats.residency.loadingTiles;
+            tiledTextureStats.loads = stats.residency.loads;
+            tiledTextureStats.evictions = stats.residency.evictions;
+            tiledTextureStats.bytesRead = stats.bytesRead;
+        }
+        return tiledTextureStats;
     }
     
 
+    std::future<bool> InitializeDirectStorageAsync(ID3D12Device* const pDevice, const std::wstring& contentPathRoot, const std::unordered_map<std::string, ScenePathPair>& scenePathMap, const IOOptions& ioOptions)
+    {
+        // The scene map and options are referenced, not copied, so they have to outlive the initialization.
+        return std::async(std::launch::async, [pDevice, contentPathRoot, &scenePathMap, &ioOptions]()
+            {
+                return InitializeDirectStorage(pDevice, contentPathRoot, scenePathMap, ioOptions);
+            });
+    }
+
     void ShutdownDirectStorage()
     {
         CPUUserMarker marker("DStorage Shutdown");
         // we could call close functions, but we are going to check our code for leaks by using Release.
         
         // Cancel any outstanding requests.
-        g_DStorageQueueNormal->CancelRequestsWithTag(0, 0); 
+        for (uint32_t queueIndex = 0; queueIndex < g_DStorageGPUQueues.size(); queueIndex++)
+        {
+            g_DStorageSubmitThread.CancelRequestsWithTag(queueIndex, 0, 0);
+        }
         g_DStorageQueueRealtime->CancelRequestsWithTag(0, 0);
+        g_DStorageQueueFileToMemory->CancelRequestsWithTag(0, 0);
 
         // wait for everything to finish.
         DStorageSyncCPU();
 
+        // The scenes and their tiled textures are gone by now.
+        TiledTextureStreamer* pTiledTextureStreamer = g_TiledTextureStreamer.exchange(nullptr);
+        if (pTiledTextureStreamer)
+        {
+            pTiledTextureStreamer->OnDestroy();
+            delete pTiledTextureStreamer;
+        }
+
         auto releaseAndCheckRefCount = [](::IUnknown* const obj)
         {
             assert(obj != nullptr);
@@ -527,18 +1837,84 @@ namespace Sample
             }
         };
 
+        // Nothing can be enqueued from here on.
+        g_DStorageSubmitThread.OnDestroy();
+        const auto submitStats = g_DStorageSubmitThread.GetStats();
+        Trace("Submits: %llu, mean batch %.1f requests %.2f MiB, max batch %u requests %.2f MiB, by requests %llu, bytes %llu, latency %llu, flush %llu"
+            , submitStats.submits, submitStats.submits > 0 ? submitStats.requests / (double)submitStats.submits : 0.0
+            , submitStats.submits > 0 ? submitStats.bytes / 1024.0 / 1024.0 / submitStats.submits : 0.0, submitStats.maxBatchRequests, submitStats.maxBatchBytes / 1024.0 / 1024.0
+            , submitStats.submitsByReason[static_cast<uint32_t>(SubmitReason::Requests)], submitStats.submitsByReason[static_cast<uint32_t>(SubmitReason::Bytes)]
+            , submitStats.submitsByReason[static_cast<uint32_t>(SubmitReason::Latency)], submitStats.submitsByReason[static_cast<uint32_t>(SubmitReason::Flush)]);
+
         // Close the queues, status arrays, events, etc.
-        releaseAndCheckRefCount(g_DStorageQueueNormal);
+        const auto enqueueStats = DStorageGetEnqueueStats();
+        Trace("Enqueue: %llu commands waited for room on their queue, at most %u at once"
+            , enqueueStats.deferredCommands, enqueueStats.maxWaitingCommands);
+        for (auto& gpuQueue : g_DStorageGPUQueues)
+        {
+            gpuQueue.pFeeder->OnDestroy();
+            delete gpuQueue.pFeeder;
+            releaseAndCheckRefCount(gpuQueue.pQueue);
+            releaseAndCheckRefCount(gpuQueue.pFenceCPU);
+            releaseAndCheckRefCount(gpuQueue.pFenceGPU);
+            gpuQueue = {};
+        }
         releaseAndCheckRefCount(g_DStorageQueueRealtime);
-        releaseAndCheckRefCount(g_DStorageFenceGPU);
-        releaseAndCheckRefCount(g_DStorageFenceCPU);
+        releaseAndCheckRefCount(g_DStorageQueueFileToMemory);
+
+        for (auto& workloadIO : g_WorkloadIO)
+        {
+            IDStorageStatusArray* pTextureStatus = workloadIO.pTextureStatus.exchange(nullptr);
+            if (pTextureStatus)
+            {
+                releaseAndCheckRefCount(pTextureStatus);
+            }
+        }
+
+        // The passes that used the placeholders went with their scenes.
+        for (auto& placeholders : g_PlaceholderTextures)
+        {
+            for (auto& pPlaceholder : placeholders)
+            {
+                if (pPlaceholder)
+                {
+                    releaseAndCheckRefCount(pPlaceholder);
+                    pPlaceholder = nullptr;
+                }
+            }
+        }
+
+        // Every scene has been unloaded by now, so has every shared texture.
+        assert(g_TextureCache.empty());
+
+        // Nothing reads from the payloads anymore.
+        {
+            std::lock_guard<std::mutex> lock(g_PayloadCacheMutex);
+            for (const auto& scenePayload : g_PayloadCache)
+            {
+                assert(scenePayload.second->refCount == 0);
+            }
+            g_PayloadCache.clear();
+            g_PayloadCacheSize = 0;
+        }
 
-        for (auto fileHandle : g_FileHandles)
+        // Every scene has been unloaded by now, drop all cached metadata and close the texture files.
         {
-            releaseAndCheckRefCount(fileHandle);
+            std::lock_guard<std::mutex> lock(g_SceneMetaDataMutex);
+            while (!g_SceneMetaData.empty())
+            {
+                EvictSceneMetaData(g_SceneMetaData.begin());
+            }
         }
 
-        (void)CloseHandle(g_DStorageFenceCPUEvent);
+        // Per class totals for the run.
+        for (uint32_t priorityClass = 0; priorityClass < IOPriorityClass_Count; priorityClass++)
+        {
+            const auto& stats = g_IOPriorityStats[priorityClass];
+            Trace("%s priority I/O: %llu loads, %llu requests, %.2f MiB, mean latency %.2f ms, max latency %.2f ms, deferred %.2f ms"
+                , GetIOPriorityClassName(static_cast<IOPriorityClass>(priorityClass)), stats.loads, stats.requests, stats.bytes / 1024.0 / 1024.0
+                , stats.loads > 0 ? stats.totalLatency / stats.loads : 0.0, stats.maxLatency, stats.totalDeferTime);
+        }
 
         // release the factory.
         releaseAndCheckRefCount(g_DStorageFactory);
@@ -547,15 +1923,29 @@ namespace Sample
 
     UINT64 DStorageInsertFenceCPU()
     {
+        // Loads insert fences from several threads. Every queue has to see the values in order, or a fence could go backwards.
+        static std::mutex fenceMutex;
+        std::lock_guard<std::mutex> lock(fenceMutex);
         UINT64 fenceValue = ++g_DStorageFenceValueCPU;
-        g_DStorageQueueNormal->EnqueueSignal(g_DStorageFenceCPU, fenceValue);
-        ThrowIfFailed(g_DStorageFenceCPU->SetEventOnCompletion(fenceValue, g_DStorageFenceCPUEvent));
+        for (uint32_t queueIndex = 0; queueIndex < g_DStorageGPUQueues.size(); queueIndex++)
+        {
+            g_DStorageSubmitThread.EnqueueSignal(queueIndex, g_DStorageGPUQueues[queueIndex].pFenceCPU, fenceValue);
+        }
         return fenceValue;
 
     }
 
+    // A null event blocks until the queue gets there.
+    static void WaitForFenceCPU(const DStorageGPUQueue& gpuQueue, uint64_t fenceValue)
+    {
+        if (gpuQueue.pFenceCPU->GetCompletedValue() < fenceValue)
+        {
+            ThrowIfFailed(gpuQueue.pFenceCPU->SetEventOnCompletion(fenceValue, nullptr));
+        }
+    }
+
 
-    static std::array<uint64_t, 512> workloads{ 0 };
+    static std::array<uint64_t, c_MaxWorkloads> workloads{ 0 };
 
     VOID NTAPI DStorageProfileMarkerFenceCallback(
         PTP_CALLBACK_INSTANCE Instance,
@@ -581,44 +1971,69 @@ namespace Sample
         }
     }
 
+    // Unique among live loads so cancellation and the quality tier only affect that load.
+    uint64_t DStorageAllocateWorkloadId()
+    {
+        uint64_t workloadId = 0;
+        {
+            std::lock_guard<std::mutex> lock(g_WorkloadIdMutex);
+            if (!g_FreeWorkloadIds.empty())
+            {
+                workloadId = g_FreeWorkloadIds.back();
+                g_FreeWorkloadIds.pop_back();
+            }
+            else
+            {
+                assert(g_NextWorkloadId < c_MaxWorkloads);
+                workloadId = g_NextWorkloadId++;
+            }
+        }
+
+        workloads[workloadId] = 0;
+        g_WorkloadIO[workloadId].priorityClass = IOPriorityClass_Normal;
+        g_WorkloadIO[workloadId].bProfiled = false;
+        return workloadId;
+    }
+
+    bool DStorageHasFreeWorkloadId()
+    {
+        std::lock_guard<std::mutex> lock(g_WorkloadIdMutex);
+        return !g_FreeWorkloadIds.empty() || g_NextWorkloadId < c_MaxWorkloads;
+    }
+
+    void DStorageFreeWorkloadId(uint64_t workloadId)
+    {
+        std::lock_guard<std::mutex> lock(g_WorkloadIdMutex);
+        assert(workloadId < g_NextWorkloadId && std::find(g_FreeWorkloadIds.cbegin(), g_FreeWorkloadIds.cend(), workloadId) == g_FreeWorkloadIds.cend());
+        g_FreeWorkloadIds.push_back(workloadId);
+    }
+
     // Need a signal to say work started.
     uint64_t DStorageBeginProfileLoading() // return workload id.
     {
         // Generate a work id and insert it into outstanding workload queue
-        ++g_DStorageFenceValueProfile;
-        uint64_t workloadId = g_DStorageFenceValueProfile % workloads.size();
-        workloads[workloadId] = 0;
-
-        // Queue up an event for the start of work.
-        IDStorageQueue1* dstorageQueue1 = nullptr;
-        if (SUCCEEDED(g_DStorageQueueNormal->QueryInterface(IID_PPV_ARGS(&dstorageQueue1))))
-        {
-            auto pTPWait = CreateThreadpoolWait(&DStorageProfileMarkerFenceCallback, (void*)workloadId, nullptr);
-            SetThreadpoolWait(pTPWait, g_DStorageFenceProfileEvent, nullptr);
-            dstorageQueue1->EnqueueSetEvent(g_DStorageFenceProfileEvent);
+        uint64_t workloadId = DStorageAllocateWorkloadId();
 
-            dstorageQueue1->Release();
-        }
+        // The start marker waits for DStorageBeginWorkloadIO, the workload's queue isn't picked until the load gets to its reads.
+        g_WorkloadIO[workloadId].bProfiled = true;
 
         return workloadId;
     }
 
+    // Start and end markers go on the queue the workload's textures are read on, loads from the payload cache use the memory queue.
+    static void EnqueueProfileMarker(uint64_t workloadId)
+    {
+        const uint32_t queueIndex = g_WorkloadPayloads[workloadId % g_WorkloadPayloads.size()] ? c_DStorageMemoryQueueIndex : g_WorkloadIO[workloadId % g_WorkloadIO.size()].queueIndex.load();
 
+        auto pTPWait = CreateThreadpoolWait(&DStorageProfileMarkerFenceCallback, (void*)workloadId, nullptr);
+        SetThreadpoolWait(pTPWait, g_DStorageFenceProfileEvent, nullptr);
+        g_DStorageSubmitThread.EnqueueSetEvent(queueIndex, g_DStorageFenceProfileEvent);
+    }
 
     // Need a signal to say this work ended.
     void DStorageEndProfileLoading(size_t workloadId) // inserts another event to signal end of loading.
     {
-        // Queue up an event for the start of work.
-        IDStorageQueue1* dstorageQueue1 = nullptr;
-        if (SUCCEEDED(g_DStorageQueueNormal->QueryInterface(IID_PPV_ARGS(&dstorageQueue1))))
-        {
-            auto pTPWait = CreateThreadpoolWait(&DStorageProfileMarkerFenceCallback, (void*)workloadId, nullptr);
-            SetThreadpoolWait(pTPWait, g_DStorageFenceProfileEvent, nullptr);
-
-            dstorageQueue1->EnqueueSetEvent(g_DStorageFenceProfileEvent);
-
-            dstorageQueue1->Release();
-        }
+        EnqueueProfileMarker(workloadId);
     }
 
     // Need a way to retrieve the value for the work id.
@@ -631,22 +2046,125 @@ namespace Sample
     void DStorageSyncCPU(uint64_t fenceValue)
     {
         CPUUserMarker marker("DStorageSyncCPU: Waiting for DS to complete on CPU... ");
-        while (g_DStorageFenceCPU->GetCompletedValue() < fenceValue)
+        for (const auto& gpuQueue : g_DStorageGPUQueues)
+        {
+            WaitForFenceCPU(gpuQueue, fenceValue);
+        }
+    }
+
+    WorkloadIOTiming DStorageSyncWorkloadCPU(uint64_t workloadId, uint64_t fenceValue)
+    {
+        CPUUserMarker marker("DStorageSyncWorkloadCPU: Waiting for DS to complete on CPU... ");
+        auto& workloadIO = g_WorkloadIO[workloadId % g_WorkloadIO.size()];
+
+        // Only the queues this workload used, a high priority load doesn't wait for the low priority queue to get to the fence.
+        const uint32_t queueMask = workloadIO.queueMask;
+        for (uint32_t queueIndex = 0; queueIndex < g_DStorageGPUQueues.size(); queueIndex++)
+        {
+            if (queueMask & (1u << queueIndex))
+            {
+                WaitForFenceCPU(g_DStorageGPUQueues[queueIndex], fenceValue);
+            }
+        }
+
+        WorkloadIOTiming timing;
+        timing.priorityClass = static_cast<IOPriorityClass>(workloadIO.queueIndex.load());
+        timing.latency = MillisecondsNow() - workloadIO.beginTime;
+        timing.deferTime = workloadIO.deferTime;
+
+        {
+            std::lock_guard<std::mutex> lock(g_IOPriorityMutex);
+            auto& stats = g_IOPriorityStats[timing.priorityClass];
+            assert(stats.inFlight > 0);
+            stats.inFlight--;
+            stats.loads++;
+            stats.requests += workloadIO.requests;
+            stats.bytes += workloadIO.bytes;
+            stats.totalLatency += timing.latency;
+            stats.maxLatency = max(stats.maxLatency, timing.latency);
+            stats.totalDeferTime += timing.deferTime;
+        }
+
+        // Deferred workloads may go now.
+        g_IOPriorityCondition.notify_all();
+        return timing;
+    }
+
+    // Goes through the queues a workload used one at a time, the threadpool wait is armed again for each one that hasn't reached the fence.
+    struct WorkloadFenceWait
+    {
+        uint32_t queueMask;
+        uint64_t fenceValue;
+        HANDLE fenceEvent;
+        std::function<void()> onComplete;
+    };
+
+    static bool ArmWorkloadFenceWait(WorkloadFenceWait& fenceWait, PTP_WAIT pTPWait)
+    {
+        for (uint32_t queueIndex = 0; queueIndex < g_DStorageGPUQueues.size(); queueIndex++)
+        {
+            if ((fenceWait.queueMask & (1u << queueIndex)) == 0)
+            {
+                continue;
+            }
+
+            ID3D12Fence* pFence = g_DStorageGPUQueues[queueIndex].pFenceCPU;
+            if (pFence->GetCompletedValue() < fenceWait.fenceValue)
+            {
+                ThrowIfFailed(pFence->SetEventOnCompletion(fenceWait.fenceValue, fenceWait.fenceEvent));
+                SetThreadpoolWait(pTPWait, fenceWait.fenceEvent, nullptr);
+                return true;
+            }
+            fenceWait.queueMask &= ~(1u << queueIndex);
+        }
+        return false;
+    }
+
+    VOID NTAPI DStorageWorkloadFenceCallback(
+        PTP_CALLBACK_INSTANCE Instance,
+        PVOID                 Context,
+        PTP_WAIT              Wait,
+        TP_WAIT_RESULT        WaitResult
+    )
+    {
+        (void)Instance;
+        (void)WaitResult;
+
+        WorkloadFenceWait* pFenceWait = reinterpret_cast<WorkloadFenceWait*>(Context);
+        if (ArmWorkloadFenceWait(*pFenceWait, Wait))
         {
-            (void)WaitForSingleObject(g_DStorageFenceCPUEvent, INFINITE);
+            return;
         }
+
+        pFenceWait->onComplete();
+
+        // Closing the wait from its own callback is allowed, it's freed once the callback returns.
+        CloseThreadpoolWait(Wait);
+        CloseHandle(pFenceWait->fenceEvent);
+        delete pFenceWait;
+    }
+
+    void DStorageNotifyWorkloadComplete(uint64_t workloadId, uint64_t fenceValue, std::function<void()> onComplete)
+    {
+        WorkloadFenceWait* pFenceWait = new WorkloadFenceWait{ g_WorkloadIO[workloadId % g_WorkloadIO.size()].queueMask, fenceValue, CreateEvent(nullptr, false, false, nullptr), std::move(onComplete) };
+        PTP_WAIT pTPWait = CreateThreadpoolWait(&DStorageWorkloadFenceCallback, pFenceWait, nullptr);
+
+        // Arms the wait on the first queue still short of the fence, or completes right here if they're all there.
+        DStorageWorkloadFenceCallback(nullptr, pFenceWait, pTPWait, WAIT_OBJECT_0);
     }
 
     void DStorageSyncCPU()
     {
         CPUUserMarker marker("DStorageSyncCPU: Waiting for DS to complete on CPU... ");
         UINT64 fenceValue = DStorageInsertFenceCPU();
-        ThrowIfFailed(g_DStorageFenceCPU->SetEventOnCompletion(fenceValue, g_DStorageFenceCPUEvent));
-        g_DStorageQueueNormal->Submit();
+        for (uint32_t queueIndex = 0; queueIndex < g_DStorageGPUQueues.size(); queueIndex++)
+        {
+            g_DStorageSubmitThread.Flush(queueIndex);
+        }
 
-        while (g_DStorageFenceCPU->GetCompletedValue() < fenceValue)
+        for (const auto& gpuQueue : g_DStorageGPUQueues)
         {
-            (void)WaitForSingleObject(g_DStorageFenceCPUEvent, INFINITE);
+            WaitForFenceCPU(gpuQueue, fenceValue);
         }
     }
 
@@ -654,19 +2172,55 @@ namespace Sample
     {
         CPUUserMarker marker("DStorageSyncCPU: Waiting for DS to complete on GPU... ");
         UINT64 fenceValue = ++g_DStorageFenceValueGPU;
-        g_DStorageQueueNormal->EnqueueSignal(g_DStorageFenceGPU, fenceValue);
-        g_DStorageQueueNormal->Submit();
-        ThrowIfFailed(queue->Wait(g_DStorageFenceGPU, fenceValue));
+        for (uint32_t queueIndex = 0; queueIndex < g_DStorageGPUQueues.size(); queueIndex++)
+        {
+            const auto& gpuQueue = g_DStorageGPUQueues[queueIndex];
+            g_DStorageSubmitThread.EnqueueSignal(queueIndex, gpuQueue.pFenceGPU, fenceValue);
+            g_DStorageSubmitThread.Flush(queueIndex);
+            ThrowIfFailed(queue->Wait(gpuQueue.pFenceGPU, fenceValue));
+        }
     }
 
     void DStorageSubmit()
     {
         CPUUserMarker marker("DStorageSubmit");
-        g_DStorageQueueNormal->Submit();
+        for (uint32_t queueIndex = 0; queueIndex < g_DStorageGPUQueues.size(); queueIndex++)
+        {
+            g_DStorageSubmitThread.Flush(queueIndex);
+        }
     }
 
     void DStorageCancelRequest(uint64_t workloadId)
     {
-        g_DStorageQueueNormal->CancelRequestsWithTag(UINT64_MAX, workloadId);
+        std::lock_guard<std::mutex> lock(g_TextureCacheMutex);
+
+        // Another scene is waiting on textures this load reads, let it finish.
+        // Workload IDs are reused, so at worst a cancel is skipped because of an old load.
+        for (const auto& cachedTexture : g_TextureCache)
+        {
+            if (cachedTexture.second.workloadId == workloadId && cachedTexture.second.refCount > 1)
+            {
+                return;
+            }
+        }
+
+        // Nobody else has these yet. Stop handing them out, their reads are about to be cancelled.
+        for (auto cachedItr = g_TextureCache.begin(); cachedItr != g_TextureCache.end();)
+        {
+            if (cachedItr->second.workloadId == workloadId)
+            {
+                g_TextureCacheKeys.erase(cachedItr->second.pResource);
+                cachedItr = g_TextureCache.erase(cachedItr);
+            }
+            else
+            {
+                ++cachedItr;
+            }
+        }
+
+        for (uint32_t queueIndex = 0; queueIndex < g_DStorageGPUQueues.size(); queueIndex++)
+        {
+            g_DStorageSubmitThread.CancelRequestsWithTag(queueIndex, UINT64_MAX, workloadId);
+        }
     }
 }
@@ -17,15 +17,118 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 // THE SOFTWARE.
 
+#include "DStorageSubmitStats.h"
+
 struct IOOptions;
 
 namespace Sample
 {
+    struct PayloadCacheStats
+    {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t bytesSaved = 0; // Compressed texture bytes served from memory instead of the disk.
+        uint64_t size = 0;
+    };
+
+    // What one load's payload cache lookup did.
+    enum PayloadCacheLookup : uint32_t
+    {
+        PayloadCacheLookup_None, // The cache is off.
+        PayloadCacheLookup_Hit, // The package was cached, or being read in by another load.
+        PayloadCacheLookup_Miss // The load read the package into the cache itself, or it didn't fit.
+    };
+
+    struct TiledTextureStats
+    {
+        uint32_t textureCount = 0;
+        uint32_t slotCount = 0; // 64KiB tiles the pool holds.
+        uint32_t pinnedSlots = 0; // Packed mips.
+        uint32_t residentTiles = 0;
+        uint32_t loadingTiles = 0;
+        uint64_t loads = 0;
+        uint64_t evictions = 0;
+        uint64_t bytesRead = 0; // Compressed.
+    };
+
+    // Texture reads from files go to the queue of their load's priority class, so loads the camera is about to see don't wait behind the rest.
+    enum IOPriorityClass : uint32_t
+    {
+        IOPriorityClass_High,
+        IOPriorityClass_Normal,
+        IOPriorityClass_Low,
+        IOPriorityClass_Count
+    };
+
+    struct IOPriorityStats
+    {
+        uint64_t loads = 0; // Workloads whose reads have finished.
+        uint64_t requests = 0;
+        uint64_t bytes = 0; // Compressed bytes read.
+        double totalLatency = 0.0; // ms from a workload's first read being enqueued to its last one finishing.
+        double maxLatency = 0.0;
+        double totalDeferTime = 0.0; // ms workloads waited for higher classes before enqueueing.
+        uint32_t inFlight = 0;
+    };
+
+    // Commands that found their queue full and waited in the sample instead, over every queue reading into GPU resources.
+    struct EnqueueStats
+    {
+        uint32_t waitingCommands = 0;
+        uint32_t maxWaitingCommands = 0; // Largest of any one queue.
+        uint64_t deferredCommands = 0;
+    };
+
+    // Timings of one workload's reads, see DStorageSyncWorkloadCPU.
+    struct WorkloadIOTiming
+    {
+        IOPriorityClass priorityClass = IOPriorityClass_Normal;
+        double latency = 0.0;
+        double deferTime = 0.0;
+    };
 
     bool InitializeDirectStorage(ID3D12Device* const pDevice, const std::wstring& contentPathRoot, const std::unordered_map<std::string, ScenePathPair>& scenePathMap, const IOOptions& sampleOptions);
+    // Runs InitializeDirectStorage on another thread. Nothing else in here may be used until the future is ready.
+    std::future<bool> InitializeDirectStorageAsync(ID3D12Device* const pDevice, const std::wstring& contentPathRoot, const std::unordered_map<std::string, ScenePathPair>& scenePathMap, const IOOptions& sampleOptions);
     void ShutdownDirectStorage();
 
     uint64_t DStorageBeginProfileLoading();
+    // Only so many loads can hold an ID at once, check DStorageHasFreeWorkloadId first.
+    uint64_t DStorageAllocateWorkloadId();
+    bool DStorageHasFreeWorkloadId();
+    // Once nothing uses the workload any more, its scene has been destroyed.
+    void DStorageFreeWorkloadId(uint64_t workloadId);
+    void DStorageSetWorkloadQualityTier(uint64_t workloadId, uint32_t qualityTier);
+    // Start of the workload's range in the pooled heap it places its textures in.
+    void DStorageSetWorkloadHeapOffset(uint64_t workloadId, uint64_t heapOffset);
+
+    // Everything is normal priority unless priorityqueues is on. Then visible now or soon is high, and later than iolowpriorityseconds is low.
+    IOPriorityClass SelectIOPriorityClass(float timeToVisible, const IOOptions& ioOptions);
+    const char* GetIOPriorityClassName(IOPriorityClass priorityClass);
+    // Can be changed while the workload waits to enqueue its reads, after that they stay on the queue they were enqueued on.
+    void DStorageSetWorkloadPriorityClass(uint64_t workloadId, IOPriorityClass priorityClass);
+    // Call before enqueueing the workload's reads. Low priority workloads wait up to iodeferms for the high and normal ones in flight.
+    void DStorageBeginWorkloadIO(uint64_t workloadId);
+    // Waits for the fence on the queues the workload read from only, and adds its reads to the stats of its class.
+    WorkloadIOTiming DStorageSyncWorkloadCPU(uint64_t workloadId, uint64_t fenceValue);
+    // Calls onComplete on a threadpool thread once the queues the workload read from reach the fence, instead of blocking a thread until then.
+    // Calls it right away if they already have. DStorageSyncWorkloadCPU won't wait in there.
+    void DStorageNotifyWorkloadComplete(uint64_t workloadId, uint64_t fenceValue, std::function<void()> onComplete);
+    std::array<IOPriorityStats, IOPriorityClass_Count> DStorageGetIOPriorityStats();
+    EnqueueStats DStorageGetEnqueueStats();
+    // Submits of the queues reading into GPU resources, see submitthreshold, submitbytes and submitlatencyms.
+    SubmitStats DStorageGetSubmitStats();
+    // Every submit since the last call, for the profiler.
+    std::vector<SubmitEvent> DStorageTakeSubmitEvents();
+
+    // Progressive scenes are shown before their textures are read, with passes created while placeholders stand in for them.
+    // Swaps the textures the workload created for 1x1 placeholders, flat normals for normal maps and black for emissive ones, white for the rest.
+    void DStorageBindPlaceholderTextures(uint64_t workloadId, const GLTFCommon& gltfCommon);
+    // Puts the workload's textures back. Passes created in between keep the placeholders.
+    void DStorageBindLoadedTextures(uint64_t workloadId);
+    // Textures of a progressive workload that have been read, and how many it reads. Each texture's reads are followed by a status entry.
+    // Textures shared with another load are read by that load and not counted.
+    std::pair<uint32_t, uint32_t> DStorageGetWorkloadTextureProgress(uint64_t workloadId);
 
     void DStorageEndProfileLoading(size_t workloadId);
 
@@ -41,17 +144,61 @@ namespace Sample
 
     void DStorageCancelRequest(uint64_t workloadId);
 
-    D3D12_HEAP_DESC GetTextureHeapDescForScene(const ScenePathPair& scenePathPair);
+    // A scene's metadata is read on first use and cached after release. Everything below that takes a scene needs it acquired.
+    bool DStorageAcquireSceneMetaData(const ScenePathPair& scenePathPair);
+    void DStorageReleaseSceneMetaData(const ScenePathPair& scenePathPair);
+    // Evicts released scenes idle for longer than metadatacacheseconds, and the least recently used ones past metadatacachesize.
+    void DStorageTrimSceneMetaData(const IOOptions& ioOptions);
 
-    size_t GetSceneTextureDataSizeOnDisk(const ScenePathPair& scenePathPair);
-    size_t GetSceneTextureDataSizeUncompressed(const ScenePathPair& scenePathPair);
-    double GetSceneTextureCompressionRatio(const ScenePathPair& scenePathPair);
+    // Points the workload's texture reads at the scene's package in the payload cache, reading it in first if it isn't there.
+    // Returns false if the cache is off or the package doesn't fit, the textures are then read from the file. Needs the metadata acquired.
+    // pBytesSavedOut is what this load didn't have to read from the disk, only a hit saves anything.
+    bool DStorageAcquireScenePayload(const ScenePathPair& scenePathPair, uint64_t workloadId, uint32_t qualityTier, PayloadCacheLookup* pLookupOut, uint64_t* pBytesSavedOut);
+    // Once the workload's reads are done. Released payloads stay cached until something else needs the room.
+    void DStorageReleaseScenePayload(const ScenePathPair& scenePathPair, uint64_t workloadId);
+    PayloadCacheStats DStorageGetPayloadCacheStats();
+
+    // With tiledtextures, full quality committed textures whose package has tiles are reserved resources streamed a tile at a time.
+    // The tiled textures the workload created, for the scene to ask for their mips. Call once the workload's reads are done.
+    std::vector<uint32_t> DStorageTakeWorkloadTiledTextures(uint64_t workloadId);
+    // Every frame the scene is shown. Each texture asks for the mips GetTextureLODMipDrop leaves it, and one more.
+    void DStorageRequestTiledTextureMips(const std::vector<uint32_t>& tiledTextures, float sceneRadius, float distanceToScene, float projectionScale);
+    // Once per frame, after the scenes asked for their mips.
+    void DStorageUpdateTiledTextures();
+    TiledTextureStats DStorageGetTiledTextureStats();
+
+    D3D12_HEAP_DESC GetTextureHeapDescForScene(const ScenePathPair& scenePathPair, uint32_t qualityTier);
+
+    size_t GetSceneTextureDataSizeOnDisk(const ScenePathPair& scenePathPair, uint32_t qualityTier);
+    size_t GetSceneTextureDataSizeUncompressed(const ScenePathPair& scenePathPair, uint32_t qualityTier);
+    double GetSceneTextureCompressionRatio(const ScenePathPair& scenePathPair, uint32_t qualityTier);
+    size_t GetSceneTextureResidentSize(const ScenePathPair& scenePathPair, uint32_t qualityTier);
+
+    // Quality tier 0 is full quality, each tier after it drops more mips.
+    uint32_t GetSceneQualityTierCount(const ScenePathPair& scenePathPair);
+    // Tiers better than minQualityTier aren't considered.
+    uint32_t SelectSceneQualityTier(const ScenePathPair& scenePathPair, float distanceToScene, uint32_t minQualityTier, uint64_t textureMemoryBudget, const IOOptions& ioOptions);
+
+    // GPU memory of the scene's textures at the tier its distance would pick, for budgeting a load before its metadata is read. Doesn't need the metadata acquired.
+    uint64_t GetSceneTextureMemoryEstimate(const ScenePathPair& scenePathPair, float distanceToScene, const IOOptions& ioOptions);
+
+    // Width or height of the scene's largest texture, at full quality.
+    uint32_t GetSceneMaxTextureSize(const ScenePathPair& scenePathPair);
+    // Top mips of a texture that can't make it to the screen, for a scene of this radius and distance.
+    // projectionScale is the screen pixels one unit covers at a distance of one unit.
+    uint32_t GetTextureLODMipDrop(uint32_t textureSize, float sceneRadius, float distanceToScene, float projectionScale);
    
    // This class provides functionality to create a 2D-texture from a DDS or any texture format from WIC file.
     class Texture:public ::CAULDRON_DX12::Texture
     {
     public:
         virtual bool InitFromFile(Device* pDevice, UploadHeap* pUploadHeap, ID3D12Heap* pTextureHeap, const char* szFilename, uint64_t workloadId, bool useSRGB = false, float cutOff = 1.0f, D3D12_RESOURCE_FLAGS resourceFlags = D3D12_RESOURCE_FLAG_NONE);
+        // Committed textures can be shared with other scenes, they're only released by the last one.
+        void OnDestroy();
+
+        // See DStorageBindPlaceholderTextures. The texture's resource and header are handed back, to be bound again with BindLoaded.
+        void BindPlaceholder(ID3D12Resource* pPlaceholder, ID3D12Resource** ppLoadedOut, IMG_INFO* pLoadedHeaderOut);
+        void BindLoaded(ID3D12Resource* pLoaded, const IMG_INFO& loadedHeader);
     };
 
     #include "GLTF/GLTFTexturesAndBuffersDecl.inl"
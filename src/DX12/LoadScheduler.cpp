@@ -0,0 +1,345 @@
+// AMD SampleDX12 sample code
+// 
+// Copyright(c) 2023 Advanced Micro Devices, Inc.All rights reserved.
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "stdafx.h"
+#include "LoadScheduler.h"
+
+#include <algorithm>
+
+// Which scheduler's worker the current thread is, if any. Sub-tasks it runs go to its own queue.
+static thread_local LoadScheduler* t_pWorkerScheduler = nullptr;
+static thread_local int t_workerIndex = -1;
+
+static bool IsLowerLoadPriority(float priorityA, uint64_t orderA, float priorityB, uint64_t orderB)
+{
+    return priorityA != priorityB ? priorityA < priorityB : orderA > orderB;
+}
+
+void LoadScheduler::OnCreate(uint32_t workerCount, uint32_t maxConcurrentLoads)
+{
+    assert(m_workers.empty());
+    workerCount = max(workerCount, 1u);
+
+    m_bStopping = false;
+
+    // Queues first, workers steal from each other as soon as they start.
+    m_workerQueues.resize(workerCount);
+    for (auto& pWorkerQueue : m_workerQueues)
+    {
+        pWorkerQueue = std::make_unique<WorkerQueue>();
+    }
+    SetMaxConcurrentLoads(maxConcurrentLoads);
+
+    for (uint32_t workerIndex = 0; workerIndex < workerCount; workerIndex++)
+    {
+        m_workers.emplace_back(&LoadScheduler::WorkerThread, this, workerIndex);
+    }
+}
+
+void LoadScheduler::OnDestroy()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_bStopping = true;
+        m_signalCount++;
+    }
+    m_condition.notify_all();
+
+    for (auto& worker : m_workers)
+    {
+        worker.join();
+    }
+
+    m_workers.clear();
+    m_workerQueues.clear();
+}
+
+void LoadScheduler::SubmitLoadTask(float priority, Task task)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pendingLoads.push_back({ priority, m_loadOrder++, std::move(task) });
+        std::push_heap(m_pendingLoads.begin(), m_pendingLoads.end(), [](const PendingLoad& a, const PendingLoad& b) { return IsLowerLoadPriority(a.priority, a.order, b.priority, b.order); });
+        m_pendingLoadCount++;
+    }
+    Signal();
+}
+
+void LoadScheduler::Submit(Task task)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_tasks.push_back(std::move(task));
+    }
+    Signal();
+}
+
+void LoadScheduler::SubmitDelayed(double delayMilliseconds, Task task)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_delayedTasks.push_back({ MillisecondsNow() + delayMilliseconds, std::move(task) });
+        std::push_heap(m_delayedTasks.begin(), m_delayedTasks.end(), [](const DelayedTask& a, const DelayedTask& b) { return a.time > b.time; });
+    }
+
+    // A sleeping worker may have to wake up earlier than it planned to.
+    Signal();
+}
+
+void LoadScheduler::Run(TaskGroup& group, Task task)
+{
+    group.m_pendingCount++;
+    Task groupTask = [this, &group, task]() { RunGroupTask(group, task); };
+
+    if (t_pWorkerScheduler == this)
+    {
+        WorkerQueue& workerQueue = *m_workerQueues[t_workerIndex];
+        std::lock_guard<std::mutex> lock(workerQueue.mutex);
+        workerQueue.tasks.push_back(std::move(groupTask));
+    }
+    else
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_tasks.push_back(std::move(groupTask));
+    }
+    Signal();
+}
+
+void LoadScheduler::Hold(TaskGroup& group)
+{
+    group.m_pendingCount++;
+}
+
+void LoadScheduler::RunHeld(TaskGroup& group, const Task& task)
+{
+    RunGroupTask(group, task);
+}
+
+void LoadScheduler::RunGroupTask(TaskGroup& group, const Task& task)
+{
+    try
+    {
+        task();
+    }
+    catch (...)
+    {
+        std::lock_guard<std::mutex> lock(group.m_exceptionMutex);
+        if (!group.m_exception)
+        {
+            group.m_exception = std::current_exception();
+        }
+    }
+    group.m_pendingCount--;
+
+    // Wakes a Wait on the group, the group may be gone once it's done.
+    Signal();
+}
+
+void LoadScheduler::Wait(TaskGroup& group)
+{
+    const int workerIndex = t_pWorkerScheduler == this ? t_workerIndex : -1;
+    while (true)
+    {
+        uint64_t signalCount;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            signalCount = m_signalCount;
+        }
+
+        if (group.m_pendingCount == 0)
+        {
+            break;
+        }
+
+        // Only sub-tasks, starting another load here would keep this one waiting until that one's done.
+        Task task;
+        if (TryGetSubTask(workerIndex, task))
+        {
+            task();
+            continue;
+        }
+
+        // The rest are running on other workers. Sleep until one of them finishes or another sub-task is queued.
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_condition.wait(lock, [this, signalCount]() { return m_signalCount != signalCount; });
+    }
+
+    std::lock_guard<std::mutex> lock(group.m_exceptionMutex);
+    if (group.m_exception)
+    {
+        std::rethrow_exception(std::exchange(group.m_exception, nullptr));
+    }
+}
+
+void LoadScheduler::SetMaxConcurrentLoads(uint32_t maxConcurrentLoads)
+{
+    // Keep a worker for unloads and sub-tasks, loads spend a lot of their time waiting on I/O and the GPU.
+    const uint32_t workerCount = static_cast<uint32_t>(m_workerQueues.size());
+    const uint32_t maxLoads = workerCount > 1 ? workerCount - 1 : 1;
+    m_maxConcurrentLoads = max(1u, min(maxConcurrentLoads, maxLoads));
+    Signal();
+}
+
+void LoadScheduler::WorkerThread(uint32_t workerIndex)
+{
+    t_pWorkerScheduler = this;
+    t_workerIndex = static_cast<int>(workerIndex);
+
+    while (true)
+    {
+        uint64_t signalCount;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            signalCount = m_signalCount;
+        }
+
+        Task task;
+        bool isLoad = false;
+        if (TryGetTask(static_cast<int>(workerIndex), task, isLoad))
+        {
+            task();
+            if (isLoad)
+            {
+                // Let the next load in.
+                m_runningLoadCount--;
+                Signal();
+            }
+            continue;
+        }
+
+        // Nothing to do. Sleep until something is submitted, or the next delayed job is due.
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (m_bStopping && m_pendingLoads.empty() && m_tasks.empty() && m_delayedTasks.empty() && m_runningLoadCount == 0)
+        {
+            break;
+        }
+
+        if (m_signalCount == signalCount)
+        {
+            if (m_delayedTasks.empty())
+            {
+                m_condition.wait(lock, [this, signalCount]() { return m_signalCount != signalCount; });
+            }
+            else
+            {
+                const auto wakeUpTime = std::chrono::steady_clock::now() + std::chrono::duration<double, std::milli>(m_delayedTasks.front().time - MillisecondsNow());
+                m_condition.wait_until(lock, wakeUpTime, [this, signalCount]() { return m_signalCount != signalCount; });
+            }
+        }
+    }
+
+    t_pWorkerScheduler = nullptr;
+    t_workerIndex = -1;
+}
+
+bool LoadScheduler::TryGetSubTask(int workerIndex, Task& taskOut)
+{
+    // Newest of our own first, it's the likeliest to have its data in the cache.
+    if (workerIndex >= 0)
+    {
+        WorkerQueue& workerQueue = *m_workerQueues[workerIndex];
+        std::lock_guard<std::mutex> lock(workerQueue.mutex);
+        if (!workerQueue.tasks.empty())
+        {
+            taskOut = std::move(workerQueue.tasks.back());
+            workerQueue.tasks.pop_back();
+            return true;
+        }
+    }
+
+    // Then the oldest of someone else's, starting with the next worker along so thieves spread out.
+    const size_t workerCount = m_workerQueues.size();
+    for (size_t i = 1; i <= workerCount; i++)
+    {
+        const size_t victimIndex = (static_cast<size_t>(workerIndex + 1) + i - 1) % workerCount;
+        if (static_cast<int>(victimIndex) == workerIndex)
+        {
+            continue;
+        }
+
+        WorkerQueue& victimQueue = *m_workerQueues[victimIndex];
+        std::lock_guard<std::mutex> lock(victimQueue.mutex);
+        if (!victimQueue.tasks.empty())
+        {
+            taskOut = std::move(victimQueue.tasks.front());
+            victimQueue.tasks.pop_front();
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool LoadScheduler::TryGetTask(int workerIndex, Task& taskOut, bool& isLoadOut)
+{
+    // Finishing the loads already running comes before starting new ones.
+    isLoadOut = false;
+    if (TryGetSubTask(workerIndex, taskOut))
+    {
+        return true;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    const double now = MillisecondsNow();
+    while (!m_delayedTasks.empty() && m_delayedTasks.front().time <= now)
+    {
+        std::pop_heap(m_delayedTasks.begin(), m_delayedTasks.end(), [](const DelayedTask& a, const DelayedTask& b) { return a.time > b.time; });
+        m_tasks.push_back(std::move(m_delayedTasks.back().task));
+        m_delayedTasks.pop_back();
+    }
+
+    if (!m_tasks.empty())
+    {
+        taskOut = std::move(m_tasks.front());
+        m_tasks.pop_front();
+        return true;
+    }
+
+    if (!m_pendingLoads.empty() && m_runningLoadCount < m_maxConcurrentLoads)
+    {
+        std::pop_heap(m_pendingLoads.begin(), m_pendingLoads.end(), [](const PendingLoad& a, const PendingLoad& b) { return IsLowerLoadPriority(a.priority, a.order, b.priority, b.order); });
+        taskOut = std::move(m_pendingLoads.back().task);
+        m_pendingLoads.pop_back();
+        m_pendingLoadCount--;
+        m_runningLoadCount++;
+        isLoadOut = true;
+        return true;
+    }
+
+    // Shutting down, the delayed jobs don't get to wait any longer.
+    if (m_bStopping && !m_delayedTasks.empty())
+    {
+        std::pop_heap(m_delayedTasks.begin(), m_delayedTasks.end(), [](const DelayedTask& a, const DelayedTask& b) { return a.time > b.time; });
+        taskOut = std::move(m_delayedTasks.back().task);
+        m_delayedTasks.pop_back();
+        return true;
+    }
+
+    return false;
+}
+
+void LoadScheduler::Signal()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_signalCount++;
+    }
+    m_condition.notify_all();
+}
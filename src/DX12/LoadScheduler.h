@@ -0,0 +1,133 @@
+// AMD SampleDX12 sample code
+// 
+// Copyright(c) 2023 Advanced Micro Devices, Inc.All rights reserved.
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Runs scene loads and unloads on a fixed set of worker threads, instead of a new thread per load.
+// Loads wait in a priority queue and only so many run at once. Their sub-tasks go to the worker's own queue,
+// idle workers steal them from the others. Unloads and other short jobs run as soon as a worker is free.
+class LoadScheduler
+{
+public:
+    typedef std::function<void()> Task;
+
+    // Sub-tasks a load waits on.
+    class TaskGroup
+    {
+        friend class LoadScheduler;
+        std::atomic<uint32_t> m_pendingCount{ 0 };
+        std::mutex m_exceptionMutex;
+        std::exception_ptr m_exception; // The first thing a sub-task threw, Wait throws it again.
+    };
+
+    void OnCreate(uint32_t workerCount, uint32_t maxConcurrentLoads);
+    // Runs whatever is still queued, delayed jobs included, then stops the workers.
+    void OnDestroy();
+
+    // Higher priorities start first. The future holds what the load returned, or what it threw.
+    template<typename T>
+    std::future<T> SubmitLoad(float priority, std::function<T()> load)
+    {
+        auto pPromise = std::make_shared<std::promise<T>>();
+        std::future<T> future = pPromise->get_future();
+        SubmitLoadTask(priority, [pPromise, load]()
+            {
+                try
+                {
+                    pPromise->set_value(load());
+                }
+                catch (...)
+                {
+                    pPromise->set_exception(std::current_exception());
+                }
+            });
+        return future;
+    }
+
+    void Submit(Task task);
+    void SubmitDelayed(double delayMilliseconds, Task task);
+
+    // Run queues a sub-task in the group. Wait helps with queued sub-tasks until the group is done, so a waiting load doesn't hold up a worker.
+    // With none left to help with it sleeps until a sub-task finishes or another is queued.
+    void Run(TaskGroup& group, Task task);
+    void Wait(TaskGroup& group);
+    // For a sub-task that waits on something outside the scheduler, like a fence, without holding up a worker. Hold keeps the group pending,
+    // RunHeld runs the task on the calling thread once it's ready, e.g. from a threadpool callback, and lets the group go.
+    void Hold(TaskGroup& group);
+    void RunHeld(TaskGroup& group, const Task& task);
+
+    void SetMaxConcurrentLoads(uint32_t maxConcurrentLoads);
+    uint32_t GetMaxConcurrentLoads() const { return m_maxConcurrentLoads; }
+    uint32_t GetWorkerCount() const { return static_cast<uint32_t>(m_workers.size()); }
+    uint32_t GetRunningLoadCount() const { return m_runningLoadCount; }
+    uint32_t GetPendingLoadCount() const { return m_pendingLoadCount; }
+
+private:
+    struct PendingLoad
+    {
+        float priority;
+        uint64_t order; // Submission order, earlier loads go first among equal priorities.
+        Task task;
+    };
+
+    struct DelayedTask
+    {
+        double time;
+        Task task;
+    };
+
+    struct WorkerQueue
+    {
+        std::mutex mutex;
+        std::deque<Task> tasks; // The owner works from the back, thieves take from the front.
+    };
+
+    void SubmitLoadTask(float priority, Task task);
+    void RunGroupTask(TaskGroup& group, const Task& task);
+    void WorkerThread(uint32_t workerIndex);
+    bool TryGetSubTask(int workerIndex, Task& taskOut);
+    bool TryGetTask(int workerIndex, Task& taskOut, bool& isLoadOut);
+    void Signal();
+
+    std::vector<std::thread> m_workers;
+    std::vector<std::unique_ptr<WorkerQueue>> m_workerQueues;
+    std::atomic<uint32_t> m_maxConcurrentLoads{ 1 };
+    std::atomic<uint32_t> m_runningLoadCount{ 0 };
+    std::atomic<uint32_t> m_pendingLoadCount{ 0 };
+
+    // Everything below is guarded by m_mutex.
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::vector<PendingLoad> m_pendingLoads; // Heap, highest priority on top.
+    std::deque<Task> m_tasks; // Jobs and sub-tasks submitted from outside the workers.
+    std::vector<DelayedTask> m_delayedTasks; // Heap, soonest on top.
+    uint64_t m_loadOrder = 0;
+    uint64_t m_signalCount = 0;
+    bool m_bStopping = false;
+};
@@ -23,6 +23,7 @@
 #include <inttypes.h>
 #include <fcntl.h>
 #include <io.h>
+#include "DStorageSubmitStats.h"
 
 namespace Sample
 {
@@ -40,6 +41,20 @@ namespace Sample
 			m_LoadData.push_back(std::move(data));
 		}
 
+		std::deque<ResidencyEvent> m_ResidencyEvents;
+
+		void AddResidencyEvent(ResidencyEvent&& residencyEvent)
+		{
+			m_ResidencyEvents.push_back(std::move(residencyEvent));
+		}
+
+		std::deque<SubmitEvent> m_SubmitEvents;
+
+		void AddSubmitEvent(const SubmitEvent& submitEvent)
+		{
+			m_SubmitEvents.push_back(submitEvent);
+		}
+
 		void Save(const wchar_t* filename)
 		{
 			assert(filename != nullptr);
@@ -58,7 +73,7 @@ namespace Sample
 					return;
 				}
 
-				auto headerString = "mapName,mapSize Compressed(MiB),mapSize Uncompressed (MiB),loadTime(ms),ioTime(ms),dataRate(MiB/s),amplified data Rate (MiB/s),meanFrameTimeBeforeLoading(us),meanFrameTimeDuringLoading(us),frameCountDuringLoading,useDirectStorage,usePlacedResources\x0d\x0a";
+				auto headerString = "mapName,mapSize Compressed(MiB),mapSize Uncompressed (MiB),loadTime(ms),ioTime(ms),dataRate(MiB/s),amplified data Rate (MiB/s),meanFrameTimeBeforeLoading(us),meanFrameTimeDuringLoading(us),frameCountDuringLoading,useDirectStorage,usePlacedResources,packageVariant,qualityTier,payloadFromMemory,payloadCacheLookup,payloadCacheSaved(MiB),prefetched,ioPriorityClass,ioLatency(ms),ioDeferTime(ms),timeToFirstPixel(ms)\x0d\x0a";
 				auto bufSize = snprintf(nullptr, 0, "%s", headerString) + 1;
 				buffer = static_cast<char*>(malloc(bufSize));
 
@@ -70,11 +85,17 @@ namespace Sample
 					return;
 				}
 
-				const char* formatString = "%s,%-01.2f,%-01.2f,%-01.2f,%-01.2f,%-01.2f,%-01.2f,%-01.2f,%-01.2f,%u,%u,%u\x0d\x0a";
+				const char* formatString = "%s,%-01.2f,%-01.2f,%-01.2f,%-01.2f,%-01.2f,%-01.2f,%-01.2f,%-01.2f,%u,%u,%u,%s,%u,%u,%s,%-01.2f,%u,%s,%-01.2f,%-01.2f,%-01.2f\x0d\x0a";
+
+				auto payloadCacheLookupName = [](const SceneTimingData& data)
+				{
+					static const char* lookupNames[] = { "none", "hit", "miss" };
+					return lookupNames[data.payloadCacheLookup];
+				};
 
 				for (auto& data : m_LoadData)
 				{
-					auto bytesWrittenWithoutNullTerminator = snprintf(buffer, bufSize, formatString, data.loadRequest.m_sceneName->c_str(), data.sceneTextureFileDataSize/1024.0/1024.0, data.sceneTextureUncompressedSize/1024.0/1024.0, data.loadTime, data.ioTime, data.sceneTextureFileDataSize / data.ioTime / 1024.0, data.sceneTextureUncompressedSize / data.ioTime / 1024.0, data.frameTimeMeanBeforeLoading, data.frameTimes.GetArithmeticMean(), (unsigned)data.frameTimes.GetPopulationCount(), (unsigned)data.loadRequest.m_useDirectStorage, (unsigned)data.loadRequest.m_usePlacedResources);
+					auto bytesWrittenWithoutNullTerminator = snprintf(buffer, bufSize, formatString, data.loadRequest.m_sceneName->c_str(), data.sceneTextureFileDataSize/1024.0/1024.0, data.sceneTextureUncompressedSize/1024.0/1024.0, data.loadTime, data.ioTime, data.sceneTextureFileDataSize / data.ioTime / 1024.0, data.sceneTextureUncompressedSize / data.ioTime / 1024.0, data.frameTimeMeanBeforeLoading, data.frameTimes.GetArithmeticMean(), (unsigned)data.frameTimes.GetPopulationCount(), (unsigned)data.loadRequest.m_useDirectStorage, (unsigned)data.loadRequest.m_usePlacedResources, data.loadRequest.m_packageVariant.c_str(), (unsigned)data.loadRequest.m_qualityTier, (unsigned)data.payloadFromMemory, payloadCacheLookupName(data), data.payloadCacheBytesSaved / 1024.0 / 1024.0, (unsigned)data.loadRequest.m_bPrefetched, GetIOPriorityClassName(static_cast<IOPriorityClass>(data.ioPriorityClass)), data.ioLatency, data.ioDeferTime, data.timeToFirstPixel);
 					auto bytesRequiredWithNullTerminator = bytesWrittenWithoutNullTerminator + 1;
 					if (bytesRequiredWithNullTerminator > bufSize) // is the buffer large enough to include null terminator?
 					{
@@ -83,7 +104,7 @@ namespace Sample
 						if (!buffer) break; // premature termination of output because realloc returned nullptr.
 
 						// retry with resized buffer.
-						bytesWrittenWithoutNullTerminator = snprintf(buffer, bufSize, formatString, data.loadRequest.m_sceneName->c_str(), data.sceneTextureFileDataSize / 1024.0 / 1024.0, data.sceneTextureUncompressedSize / 1024.0 / 1024.0, data.loadTime, data.ioTime, data.sceneTextureFileDataSize / data.ioTime / 1024.0, data.sceneTextureUncompressedSize / data.ioTime / 1024.0, data.frameTimeMeanBeforeLoading, data.frameTimes.GetArithmeticMean(), (unsigned)data.frameTimes.GetPopulationCount(), (unsigned)data.loadRequest.m_useDirectStorage, (unsigned)data.loadRequest.m_usePlacedResources);
+						bytesWrittenWithoutNullTerminator = snprintf(buffer, bufSize, formatString, data.loadRequest.m_sceneName->c_str(), data.sceneTextureFileDataSize / 1024.0 / 1024.0, data.sceneTextureUncompressedSize / 1024.0 / 1024.0, data.loadTime, data.ioTime, data.sceneTextureFileDataSize / data.ioTime / 1024.0, data.sceneTextureUncompressedSize / data.ioTime / 1024.0, data.frameTimeMeanBeforeLoading, data.frameTimes.GetArithmeticMean(), (unsigned)data.frameTimes.GetPopulationCount(), (unsigned)data.loadRequest.m_useDirectStorage, (unsigned)data.loadRequest.m_usePlacedResources, data.loadRequest.m_packageVariant.c_str(), (unsigned)data.loadRequest.m_qualityTier, (unsigned)data.payloadFromMemory, payloadCacheLookupName(data), data.payloadCacheBytesSaved / 1024.0 / 1024.0, (unsigned)data.loadRequest.m_bPrefetched, GetIOPriorityClassName(static_cast<IOPriorityClass>(data.ioPriorityClass)), data.ioLatency, data.ioDeferTime, data.timeToFirstPixel);
 					}
 
 					if (bytesWrittenWithoutNullTerminator > 0)
@@ -110,5 +131,72 @@ namespace Sample
 
 
 		}
+
+		// Every load, refusal and eviction the residency manager decided on.
+		void SaveResidency(const wchar_t* filename)
+		{
+			assert(filename != nullptr);
+
+			int file = -1;
+			(void)_wsopen_s(&file, filename, _O_CREAT | _O_TRUNC | _O_NOINHERIT | _O_BINARY | _O_SEQUENTIAL | _O_WRONLY, _SH_DENYNO, _S_IREAD | _S_IWRITE);
+			if (file == -1)
+			{
+				return;
+			}
+
+			const char* headerString = "time(ms),decision,mapName,mapSize(MiB),residentSize(MiB),budget(MiB),priority\x0d\x0a";
+			bool writeFailed = _write(file, headerString, (unsigned)strlen(headerString)) != (int)strlen(headerString);
+
+			std::vector<char> buffer(256);
+			for (const auto& data : m_ResidencyEvents)
+			{
+				if (writeFailed) break;
+
+				auto formatEvent = [&data, &buffer]()
+				{
+					return snprintf(buffer.data(), buffer.size(), "%-01.2f,%s,%s,%-01.2f,%-01.2f,%-01.2f,%-01.2f\x0d\x0a", data.time, GetResidencyDecisionName(data.decision), data.sceneName.c_str(), data.sceneBytes / 1024.0 / 1024.0, data.residentBytes / 1024.0 / 1024.0, data.budget / 1024.0 / 1024.0, data.priority);
+				};
+
+				auto bytesWrittenWithoutNullTerminator = formatEvent();
+				if (bytesWrittenWithoutNullTerminator + 1 > (int)buffer.size())
+				{
+					// retry with resized buffer.
+					buffer.resize(bytesWrittenWithoutNullTerminator + 1);
+					bytesWrittenWithoutNullTerminator = formatEvent();
+				}
+
+				writeFailed = bytesWrittenWithoutNullTerminator < 0 || _write(file, buffer.data(), bytesWrittenWithoutNullTerminator) != bytesWrittenWithoutNullTerminator;
+			}
+
+			(void)_close(file);
+		}
+
+		// Every submit of the queues reading into GPU resources, to tune the submit limits.
+		void SaveSubmits(const wchar_t* filename)
+		{
+			assert(filename != nullptr);
+
+			int file = -1;
+			(void)_wsopen_s(&file, filename, _O_CREAT | _O_TRUNC | _O_NOINHERIT | _O_BINARY | _O_SEQUENTIAL | _O_WRONLY, _SH_DENYNO, _S_IREAD | _S_IWRITE);
+			if (file == -1)
+			{
+				return;
+			}
+
+			const char* headerString = "time(ms),queue,reason,commands,requests,size(KiB),oldestWait(ms)\x0d\x0a";
+			bool writeFailed = _write(file, headerString, (unsigned)strlen(headerString)) != (int)strlen(headerString);
+
+			char buffer[256];
+			for (const auto& data : m_SubmitEvents)
+			{
+				if (writeFailed) break;
+
+				const char* queueName = data.queueIndex < IOPriorityClass_Count ? GetIOPriorityClassName(static_cast<IOPriorityClass>(data.queueIndex)) : "Memory";
+				auto bytesWrittenWithoutNullTerminator = snprintf(buffer, sizeof(buffer), "%-01.2f,%s,%s,%u,%u,%-01.2f,%-01.3f\x0d\x0a", data.time, queueName, GetSubmitReasonName(data.reason), data.commands, data.requests, data.bytes / 1024.0, data.oldestWait);
+				writeFailed = bytesWrittenWithoutNullTerminator < 0 || bytesWrittenWithoutNullTerminator >= (int)sizeof(buffer) || _write(file, buffer, bytesWrittenWithoutNullTerminator) != bytesWrittenWithoutNullTerminator;
+			}
+
+			(void)_close(file);
+		}
 	};
 };
@@ -24,6 +24,9 @@
 #include "SampleOptions.h"
 #include <stdlib.h>
 
+// Buffers every streamed scene gets, whatever is in it.
+static const size_t sceneStaticGeometryMemSize = (240 * 1024 * 1024) - (256 * 1024);
+static const uint32_t sceneConstantBuffersMemSize = 2 * 1024 * 1024;
 
 //--------------------------------------------------------------------------------------
 //
@@ -34,8 +37,19 @@ void Renderer::OnCreate(Device* pDevice, SwapChain* pSwapChain, AsyncPool* pAsyn
 {
     m_pDevice = pDevice;
     m_pSampleOptions = sampleOptions;
+
+    // Placed resources heaps are suballocated from here, instead of being created per scene load.
+    m_textureHeapPool.OnCreate(pDevice, static_cast<uint64_t>(sampleOptions->ioOptions.m_textureHeapPoolSize) * 1024ull * 1024ull);
     m_pAsyncPool = pAsyncPool;
 
+    // Scene loads and unloads run here, leaving the rest of the CPU to rendering.
+    uint32_t loaderThreadCount = sampleOptions->ioOptions.m_loaderThreadCount;
+    if (loaderThreadCount == 0)
+    {
+        loaderThreadCount = max(2u, std::thread::hardware_concurrency() / 2);
+    }
+    m_loadScheduler.OnCreate(loaderThreadCount, sampleOptions->ioOptions.m_maxConcurrentLoads);
+
     // Initialize helpers
 
     // Create all the heaps for the resources views
@@ -124,6 +138,8 @@ void Renderer::OnDestroy()
     if( m_pAsyncPool) 
         m_pAsyncPool->Flush();
 
+    m_loadScheduler.OnDestroy();
+
 
     m_ImGUI.OnDestroy();
     m_ColorConversionPS.OnDestroy();
@@ -141,6 +157,7 @@ void Renderer::OnDestroy()
     m_ArtificialWorkload.OnDestroy();
     m_TransparentCube.OnDestroy();
 
+    m_textureHeapPool.OnDestroy();
     m_UploadHeap.OnDestroy();
     m_GPUTimer.OnDestroy();
     m_VidMemBufferPool.OnDestroy();
@@ -236,7 +253,6 @@ void Renderer::OnRender(const UIState* pState, const Camera& Cam, const TimeStat
     for (auto& sceneData : m_SceneData)
     {
         sceneData->m_gltfCommon.SetAnimationTime(0, timeState.m_animationTime);
-        sceneData->m_gltfCommon.TransformScene(0, sceneData->m_sceneTransform);
 
         sceneData->m_constantBuffer.OnBeginFrame();
 
@@ -255,7 +271,6 @@ void Renderer::OnRender(const UIState* pState, const Camera& Cam, const TimeStat
         currentScenePerFrameData->wireframeOptions.setW(pState->WireframeMode == UIState::WireframeMode::WIREFRAME_MODE_SOLID_COLOR ? 1.0f : 0.0f);
         currentScenePerFrameData->lodBias = 0.0f;
         sceneData->m_pTexturesAndBuffers->SetPerFrameConstants();
-        sceneData->m_pTexturesAndBuffers->SetSkinningMatricesForSkeletons();
     }
 
 
@@ -282,13 +297,30 @@ void Renderer::OnRender(const UIState* pState, const Camera& Cam, const TimeStat
             opaque.reserve(8000);
             for (const auto& sceneData : m_SceneData)
             {
-                
-                // prepare lists with appropriate reservations.
-
-
-                sceneData->m_pbrPass.BuildBatchLists(&opaque, &transparent, bWireframe);
-                sceneData->m_pbrPass.DrawBatchList(pCmdLst1, nullptr, &opaque, bWireframe);
-                opaque.clear();
+                // Instances share everything but their world matrices, which are baked into per-object constants when the batch list is built.
+                auto& gltfCommon = sceneData->m_gltfCommon;
+                for (auto& instance : sceneData->m_instances)
+                {
+                    // Swap in the instance's own matrices, so TransformScene makes its current ones the previous ones for the motion vectors.
+                    std::swap(gltfCommon.m_worldSpaceMats, instance.m_worldSpaceMats);
+                    std::swap(gltfCommon.m_worldSpaceSkeletonMats, instance.m_worldSpaceSkeletonMats);
+                    if (!instance.m_bTransformed)
+                    {
+                        gltfCommon.TransformScene(0, *instance.m_pTransform);
+                        instance.m_bTransformed = true;
+                    }
+                    gltfCommon.TransformScene(0, *instance.m_pTransform);
+                    sceneData->m_pTexturesAndBuffers->SetSkinningMatricesForSkeletons();
+
+                    // Progressive scenes use their placeholder textures until the loaded ones are in.
+                    auto& pbrPass = sceneData->GetPbrPass();
+                    pbrPass.BuildBatchLists(&opaque, &transparent, bWireframe);
+                    pbrPass.DrawBatchList(pCmdLst1, nullptr, &opaque, bWireframe);
+                    opaque.clear();
+
+                    std::swap(gltfCommon.m_worldSpaceMats, instance.m_worldSpaceMats);
+                    std::swap(gltfCommon.m_worldSpaceSkeletonMats, instance.m_worldSpaceSkeletonMats);
+                }
             }
 
             m_GPUTimer.GetTimeStamp(pCmdLst1, "PBR Opaque");
@@ -484,16 +516,67 @@ void Renderer::OnRender(const UIState* pState, const Camera& Cam, const TimeStat
     m_pDevice->GetGraphicsQueue()->ExecuteCommandLists(1, CmdListLists);
 }
 
-    std::future<SceneData*> Renderer::UnloadSceneAsync(std::string sceneName, SceneData* sceneData)
+    std::future<SceneData*> Renderer::UnloadSceneAsync(std::string sceneName, SceneData* sceneData, float keepAliveSeconds)
     {
         Trace("U Load: %s", sceneName.c_str());
-        return std::async([this,sceneData]()
-            {
-                this->m_pDevice->GPUFlush();
-                sceneData->OnDestroy();
-                return static_cast<SceneData*>(nullptr);
-            }
-        );
+
+        std::future<SceneData*> unloadFuture;
+        uint32_t unloadCount;
+        {
+            std::lock_guard<std::mutex> lock(sceneData->m_unloadMutex);
+            sceneData->m_unloadPromise = std::promise<SceneData*>();
+            unloadFuture = sceneData->m_unloadPromise.get_future();
+            unloadCount = ++sceneData->m_unloadCount;
+            sceneData->m_unloadState = keepAliveSeconds > 0.0f ? SceneUnloadState::KeepAlive : SceneUnloadState::Destroying;
+        }
+
+        if (keepAliveSeconds > 0.0f)
+        {
+            // Give the scene a chance to be asked for again before throwing it away. No thread waits meanwhile.
+            m_loadScheduler.SubmitDelayed(keepAliveSeconds * 1000.0, [this, sceneData, unloadCount]()
+                {
+                    {
+                        // Resurrected or ended early, or this is an earlier unload's keep-alive.
+                        std::lock_guard<std::mutex> lock(sceneData->m_unloadMutex);
+                        if (sceneData->m_unloadState != SceneUnloadState::KeepAlive || sceneData->m_unloadCount != unloadCount)
+                        {
+                            return;
+                        }
+                        sceneData->m_unloadState = SceneUnloadState::Destroying;
+                    }
+                    DestroyScene(sceneData);
+                });
+        }
+        else
+        {
+            m_loadScheduler.Submit([this, sceneData]() { DestroyScene(sceneData); });
+        }
+
+        return unloadFuture;
+    }
+
+    void Renderer::DestroyScene(SceneData* sceneData)
+    {
+        // A progressive scene can be unloaded while its textures are still being read.
+        if (!sceneData->m_bTexturesResident && m_pSampleOptions->ioOptions.m_allowCancellation)
+        {
+            Sample::DStorageCancelRequest(sceneData->m_timingData.loadRequest.workloadId);
+        }
+        m_loadScheduler.Wait(sceneData->m_textureTasks);
+
+        if (sceneData->m_bHoldsMetaData)
+        {
+            Sample::DStorageReleaseSceneMetaData(m_pScenePathMap->at(*sceneData->m_timingData.loadRequest.m_sceneName));
+        }
+
+        this->m_pDevice->GPUFlush();
+        sceneData->OnDestroy();
+        m_textureHeapPool.Free(sceneData->m_textureHeapAllocation);
+        if (sceneData->m_timingData.loadRequest.m_useDirectStorage)
+        {
+            Sample::DStorageFreeWorkloadId(sceneData->m_timingData.loadRequest.workloadId);
+        }
+        sceneData->m_unloadPromise.set_value(nullptr);
     }
 
     std::future<SceneData*> Renderer::LoadSceneAsync(const SceneLoadRequest& loadRequest)
@@ -508,6 +591,187 @@ void Renderer::OnRender(const UIState* pState, const Camera& Cam, const TimeStat
         }
     }
 
+    bool Renderer::ResurrectScene(SceneData* sceneData)
+    {
+        std::lock_guard<std::mutex> lock(sceneData->m_unloadMutex);
+        if (sceneData->m_unloadState != SceneUnloadState::KeepAlive)
+        {
+            return false;
+        }
+
+        Trace("R Load: %s", sceneData->m_timingData.loadRequest.m_sceneName->c_str());
+        sceneData->m_unloadState = SceneUnloadState::None;
+        sceneData->m_unloadPromise.set_value(sceneData);
+        return true;
+    }
+
+    void Renderer::EndSceneKeepAlive(SceneData* sceneData)
+    {
+        std::lock_guard<std::mutex> lock(sceneData->m_unloadMutex);
+        if (sceneData->m_unloadState == SceneUnloadState::KeepAlive)
+        {
+            sceneData->m_unloadState = SceneUnloadState::Destroying;
+            m_loadScheduler.Submit([this, sceneData]() { DestroyScene(sceneData); });
+        }
+    }
+
+    uint64_t Renderer::GetSceneBufferMemorySize()
+    {
+        return sceneStaticGeometryMemSize + sceneConstantBuffersMemSize;
+    }
+
+    uint32_t Renderer::SelectRefinedQualityTier(const SceneData* sceneData, const math::Matrix4& transform, float distanceToScene, float projectionScale) const
+    {
+        // Same as the load picks it, see LoadSceneAsyncDirectStorage.
+        assert(sceneData->m_bHoldsMetaData);
+        const auto& scenePathPair = m_pScenePathMap->at(*sceneData->m_timingData.loadRequest.m_sceneName);
+        const uint32_t mipDrop = sceneData->GetTextureLODMipDrop(transform, distanceToScene, projectionScale);
+        const uint32_t textureLODTier = min(mipDrop, Sample::GetSceneQualityTierCount(scenePathPair) - 1);
+        return Sample::SelectSceneQualityTier(scenePathPair, distanceToScene, textureLODTier, GetTextureMemoryBudget(), m_pSampleOptions->ioOptions);
+    }
+
+    uint64_t Renderer::GetTextureMemoryBudget() const
+    {
+        if (m_pSampleOptions->ioOptions.m_textureMemoryBudget > 0)
+        {
+            return m_pSampleOptions->ioOptions.m_textureMemoryBudget * 1024ull * 1024ull;
+        }
+
+        // What the OS will let us use right now, minus what's already in use.
+        IDXGIAdapter3* pAdapter3 = nullptr;
+        if (FAILED(m_pDevice->GetAdapter()->QueryInterface(IID_PPV_ARGS(&pAdapter3))))
+        {
+            return UINT64_MAX;
+        }
+
+        DXGI_QUERY_VIDEO_MEMORY_INFO memoryInfo{};
+        HRESULT hr = pAdapter3->QueryVideoMemoryInfo(0, DXGI_MEMORY_SEGMENT_GROUP_LOCAL, &memoryInfo);
+        pAdapter3->Release();
+
+        if (FAILED(hr))
+        {
+            return UINT64_MAX;
+        }
+
+        return memoryInfo.Budget > memoryInfo.CurrentUsage ? memoryInfo.Budget - memoryInfo.CurrentUsage : 0;
+    }
+
+    // Bounding sphere of the glTF's scene around its origin, from the bounds glTF requires on position accessors.
+    static float GetSceneBoundingRadius(const GLTFCommon& gltfCommon)
+    {
+        const auto& j3 = gltfCommon.j3;
+        if (j3.find("scenes") == j3.end() || j3.find("nodes") == j3.end() || j3.find("meshes") == j3.end() || j3.find("accessors") == j3.end())
+        {
+            return 0.0f;
+        }
+
+        const auto& nodes = j3["nodes"];
+        const auto& meshes = j3["meshes"];
+        const auto& accessors = j3["accessors"];
+
+        float radius = 0.0f;
+        std::function<void(size_t, const math::Matrix4&)> addNode = [&](size_t nodeIdx, const math::Matrix4& parentTransform)
+        {
+            json::object_t node = nodes[nodeIdx];
+            math::Matrix4 transform = parentTransform;
+            if (node.find("matrix") != node.end())
+            {
+                transform *= GetMatrix(node["matrix"].get<json::array_t>());
+            }
+            else
+            {
+                const math::Vector4 translation = GetElementVector(node, "translation", math::Vector4(0, 0, 0, 0));
+                const math::Vector4 rotation = GetElementVector(node, "rotation", math::Vector4(0, 0, 0, 1));
+                const math::Vector4 scale = GetElementVector(node, "scale", math::Vector4(1, 1, 1, 0));
+                transform *= math::Matrix4::translation(translation.getXYZ()) * math::Matrix4::rotation(math::Quat(rotation)) * math::Matrix4::scale(scale.getXYZ());
+            }
+
+            auto meshItr = node.find("mesh");
+            if (meshItr != node.end())
+            {
+                for (const auto& primitive : meshes[meshItr->second.get<size_t>()]["primitives"])
+                {
+                    const auto& accessor = accessors[primitive["attributes"]["POSITION"].get<size_t>()];
+                    if (accessor.find("min") == accessor.end() || accessor.find("max") == accessor.end())
+                    {
+                        continue;
+                    }
+
+                    const math::Vector4 mins = GetVector(accessor["min"].get<json::array_t>());
+                    const math::Vector4 maxs = GetVector(accessor["max"].get<json::array_t>());
+                    for (uint32_t corner = 0; corner < 8; corner++)
+                    {
+                        const math::Point3 point((corner & 1) ? maxs.getX() : mins.getX(), (corner & 2) ? maxs.getY() : mins.getY(), (corner & 4) ? maxs.getZ() : mins.getZ());
+                        radius = max(radius, Vectormath::SSE::length(math::Vector3((transform * point).getXYZ())));
+                    }
+                }
+            }
+
+            auto childrenItr = node.find("children");
+            if (childrenItr != node.end())
+            {
+                for (const auto& child : childrenItr->second)
+                {
+                    addNode(child.get<size_t>(), transform);
+                }
+            }
+        };
+
+        const auto& scene = j3["scenes"][j3.value("scene", 0)];
+        if (scene.find("nodes") != scene.end())
+        {
+            for (const auto& rootNode : scene["nodes"])
+            {
+                addNode(rootNode.get<size_t>(), math::Matrix4::identity());
+            }
+        }
+        return radius;
+    }
+
+    // Closer scenes start loading first, prefetches after every scene the camera is already in.
+    static float GetLoadPriority(const SceneLoadRequest& loadRequest)
+    {
+        return loadRequest.m_bPrefetched ? -FLT_MAX : -loadRequest.m_distanceToScene;
+    }
+
+    void Renderer::RunSceneSetupTasks(LoadScheduler::TaskGroup& setupTasks, SceneData* sceneData, const ScenePathPair& scenePathLookupResult)
+    {
+        m_loadScheduler.Run(setupTasks, [sceneData, &scenePathLookupResult]()
+            {
+                CPUUserMarker marker("Parse glTF");
+                if (sceneData->m_gltfCommon.Load(scenePathLookupResult.scenePath, scenePathLookupResult.sceneFile) == false)
+                {
+                    MessageBox(NULL, "The selected model couldn't be found, please check the documentation", "Cauldron Panic!", MB_ICONERROR);
+                    exit(0);
+                }
+            });
+
+        m_loadScheduler.Run(setupTasks, [this, sceneData]()
+            {
+                // Create a 'static' pool for vertices, indices and constant buffers... should be using placed resources here too. Value is based on assets being loaded.
+                sceneData->m_staticBufferPool.OnCreate(m_pDevice, sceneStaticGeometryMemSize, true, "StaticGeom");
+
+                // our own constant buffer ring... this might not be necessary.
+                // Create a 'dynamic' constant buffer
+                sceneData->m_constantBuffer.OnCreate(m_pDevice, backBufferCount, sceneConstantBuffersMemSize);
+            });
+
+        m_loadScheduler.Run(setupTasks, [this, sceneData]()
+            {
+                // Create all the heaps for the resources views. @todo: these could easily be sized to the data.
+                // Progressive scenes have a second PBR pass for their placeholder textures.
+                const uint32_t pbrPassCount = sceneData->m_bProgressive ? 2 : 1;
+                const uint32_t cbvDescriptorCount = 4000;
+                const uint32_t srvDescriptorCount = 8000 * pbrPassCount;
+                const uint32_t uavDescriptorCount = 10;
+                const uint32_t dsvDescriptorCount = 10;
+                const uint32_t rtvDescriptorCount = 60;
+                const uint32_t samplerDescriptorCount = 20 * pbrPassCount;
+
+                sceneData->m_resourceViewHeaps.OnCreate(m_pDevice, cbvDescriptorCount, srvDescriptorCount, uavDescriptorCount, dsvDescriptorCount, rtvDescriptorCount, samplerDescriptorCount);
+            });
+    }
+
     std::future<SceneData*> Renderer::LoadSceneAsyncDirectStorage(const SceneLoadRequest& loadRequest)
     {
         CPUUserMarker marker("LoadSceneAsyncDirectStorage Requested");
@@ -516,7 +780,7 @@ void Renderer::OnRender(const UIState* pState, const Camera& Cam, const TimeStat
         auto frameTimeMeanAtRequestTime = m_rollingFrameTimeSnapshot.GetArithmeticMean();
         auto frameTimeMedianAtRequestTime = m_rollingFrameTimeSnapshot.GetMedian();
 
-        return std::async([this, loadRequest, requestTime, frameTimeMeanAtRequestTime, frameTimeMedianAtRequestTime]()
+        return m_loadScheduler.SubmitLoad<SceneData*>(GetLoadPriority(loadRequest), [this, loadRequest, requestTime, frameTimeMeanAtRequestTime, frameTimeMedianAtRequestTime]()
             {
                 CPUUserMarker marker("LoadSceneAsync Processing");
 
@@ -525,79 +789,112 @@ void Renderer::OnRender(const UIState* pState, const Camera& Cam, const TimeStat
         const auto& scenePathLookupResult = m_pScenePathMap->at(*loadRequest.m_sceneName);
         AsyncPool asyncPool;
         SceneData* sceneData = new SceneData;
+        sceneData->m_gpuMemorySize = GetSceneBufferMemorySize();
 
         uint64_t fenceId = 0;
         sceneData->m_timingData.loadRequest = loadRequest;
         sceneData->m_timingData.frameTimeMeanBeforeLoading = frameTimeMeanAtRequestTime;
         sceneData->m_timingData.frameTimeMedianBeforeLoading = frameTimeMedianAtRequestTime;
-        sceneData->m_timingData.sceneTextureFileDataSize = Sample::GetSceneTextureDataSizeOnDisk(scenePathLookupResult);
-        sceneData->m_timingData.sceneTextureUncompressedSize = Sample::GetSceneTextureDataSizeUncompressed(scenePathLookupResult);
-        sceneData->m_timingData.sceneTextureCompressionRatio = Sample::GetSceneTextureCompressionRatio(scenePathLookupResult);
+        sceneData->m_bProgressive = m_pSampleOptions->ioOptions.m_useProgressiveScenes;
+
+        // Parsing the glTF and creating the buffers and descriptor heaps don't depend on each other, they run as sub-tasks while this thread gets on with the rest.
+        LoadScheduler::TaskGroup setupTasks;
+        RunSceneSetupTasks(setupTasks, sceneData, scenePathLookupResult);
+
+        // Reads the scene's metadata if it isn't cached, and keeps it from being evicted until the load is done.
+        const bool hasMetaData = Sample::DStorageAcquireSceneMetaData(scenePathLookupResult);
+        assert(hasMetaData);
 
-        if (sceneData->m_gltfCommon.Load(scenePathLookupResult.scenePath, scenePathLookupResult.sceneFile) == false)
+        // Pick the quality tier before any texture is created, the placed heap and every texture of the scene use it.
+        uint32_t qualityTier = 0;
+        if (m_pSampleOptions->ioOptions.m_useQualityTiers)
         {
-            MessageBox(NULL, "The selected model couldn't be found, please check the documentation", "Cauldron Panic!", MB_ICONERROR);
-            exit(0);
+            // The texture LOD needs the scene's bounds, which have to wait for the glTF.
+            uint32_t textureLODTier = 0;
+            if (m_pSampleOptions->ioOptions.m_useTextureLOD)
+            {
+                m_loadScheduler.Wait(setupTasks);
+                sceneData->m_boundingRadius = GetSceneBoundingRadius(sceneData->m_gltfCommon);
+                sceneData->m_maxTextureSize = Sample::GetSceneMaxTextureSize(scenePathLookupResult);
+                const uint32_t mipDrop = sceneData->GetTextureLODMipDrop(loadRequest.m_streamedSceneDataTransform, loadRequest.m_distanceToScene, loadRequest.m_projectionScale);
+                textureLODTier = min(mipDrop, Sample::GetSceneQualityTierCount(scenePathLookupResult) - 1);
+                sceneData->m_textureLODTier = textureLODTier;
+            }
+            qualityTier = Sample::SelectSceneQualityTier(scenePathLookupResult, loadRequest.m_distanceToScene, textureLODTier, GetTextureMemoryBudget(), m_pSampleOptions->ioOptions);
         }
+        Sample::DStorageSetWorkloadQualityTier(loadRequest.workloadId, qualityTier);
+        sceneData->m_timingData.loadRequest.m_qualityTier = qualityTier;
 
-        sceneData->m_pTexturesAndBuffers = reinterpret_cast<CAULDRON_DX12::GLTFTexturesAndBuffers*>(new Sample::GLTFTexturesAndBuffers);
-   
-        // Create a 'static' pool for vertices, indices and constant buffers... should be using placed resources here too. Value is based on assets being loaded.
-        const size_t staticGeometryMemSize = (240 * 1024 * 1024) - (256 * 1024);
+        sceneData->m_timingData.sceneTextureFileDataSize = Sample::GetSceneTextureDataSizeOnDisk(scenePathLookupResult, qualityTier);
+        sceneData->m_timingData.sceneTextureUncompressedSize = Sample::GetSceneTextureDataSizeUncompressed(scenePathLookupResult, qualityTier);
+        sceneData->m_timingData.sceneTextureCompressionRatio = Sample::GetSceneTextureCompressionRatio(scenePathLookupResult, qualityTier);
 
-        sceneData->m_staticBufferPool.OnCreate(m_pDevice, staticGeometryMemSize, true, "StaticGeom");
+        // Scenes in the payload cache are loaded from memory instead of their texture file. A miss reads the file into the cache first, which is still a read from disk.
+        Sample::PayloadCacheLookup payloadCacheLookup;
+        Sample::DStorageAcquireScenePayload(scenePathLookupResult, loadRequest.workloadId, qualityTier, &payloadCacheLookup, &sceneData->m_timingData.payloadCacheBytesSaved);
+        sceneData->m_timingData.payloadCacheLookup = payloadCacheLookup;
+        sceneData->m_timingData.payloadFromMemory = payloadCacheLookup == Sample::PayloadCacheLookup_Hit;
 
-        // our own constant buffer ring... this might not be necessary.
-        // Create a 'dynamic' constant buffer
-        const uint32_t constantBuffersMemSize = 2 * 1024 * 1024;
-        sceneData->m_constantBuffer.OnCreate(m_pDevice, backBufferCount, constantBuffersMemSize);
+        sceneData->m_pTexturesAndBuffers = reinterpret_cast<CAULDRON_DX12::GLTFTexturesAndBuffers*>(new Sample::GLTFTexturesAndBuffers);
 
         // Use placed resources if requested and compatible for this asset.
         sceneData->m_pTextureHeap = nullptr;
         if (loadRequest.m_usePlacedResources)
         {
-            D3D12_HEAP_DESC heapDesc = Sample::GetTextureHeapDescForScene(scenePathLookupResult);
-            m_pDevice->GetDevice()->CreateHeap(&heapDesc, IID_PPV_ARGS(&sceneData->m_pTextureHeap));
+            D3D12_HEAP_DESC heapDesc = Sample::GetTextureHeapDescForScene(scenePathLookupResult, qualityTier);
+            if (m_textureHeapPool.Allocate(heapDesc, sceneData->m_textureHeapAllocation))
+            {
+                // The scene's placement offsets are relative to the start of its range.
+                sceneData->m_pTextureHeap = sceneData->m_textureHeapAllocation.pHeap;
+                Sample::DStorageSetWorkloadHeapOffset(loadRequest.workloadId, sceneData->m_textureHeapAllocation.offset);
+                sceneData->m_gpuMemorySize += heapDesc.SizeInBytes;
+            }
         }
 
+        // Committed textures are counted at their uncompressed size. Ones shared through the texture cache count for every scene using them.
+        if (sceneData->m_pTextureHeap == nullptr)
+        {
+            sceneData->m_gpuMemorySize += sceneData->m_timingData.sceneTextureUncompressedSize;
+        }
+
+        m_loadScheduler.Wait(setupTasks);
         sceneData->m_pTexturesAndBuffers->OnCreate(m_pDevice, &sceneData->m_gltfCommon, nullptr, &sceneData->m_staticBufferPool, &sceneData->m_constantBuffer);
 
+        // Tiled textures ask for their mips by the scene's bounds.
+        if (m_pSampleOptions->ioOptions.m_useTiledTextures && sceneData->m_boundingRadius == 0.0f)
+        {
+            sceneData->m_boundingRadius = GetSceneBoundingRadius(sceneData->m_gltfCommon);
+        }
+
+        // Picks the queue the textures are read on, low priority loads may wait here for closer ones.
+        Sample::DStorageBeginWorkloadIO(loadRequest.workloadId);
         reinterpret_cast<Sample::GLTFTexturesAndBuffers*>(sceneData->m_pTexturesAndBuffers)->LoadTextures(&asyncPool, sceneData->m_pTextureHeap, loadRequest.workloadId);
         Sample::DStorageEndProfileLoading(loadRequest.workloadId);
         fenceId = Sample::DStorageInsertFenceCPU();
         Sample::DStorageSubmit();
 
-        // Create all the heaps for the resources views. @todo: these could easily be sized to the data.
-        const uint32_t cbvDescriptorCount = 4000;
-        const uint32_t srvDescriptorCount = 8000;
-        const uint32_t uavDescriptorCount = 10;
-        const uint32_t dsvDescriptorCount = 10;
-        const uint32_t rtvDescriptorCount = 60;
-        const uint32_t samplerDescriptorCount = 20;
-
-        sceneData->m_resourceViewHeaps.OnCreate(m_pDevice, cbvDescriptorCount, srvDescriptorCount, uavDescriptorCount, dsvDescriptorCount, rtvDescriptorCount, samplerDescriptorCount);
-
         // do the rest of the pass creation.
         {
             CPUUserMarker p("Create passes");
 
+            if (sceneData->m_bProgressive)
+            {
+                CPUUserMarker p("Placeholder m_GLTFPBR->OnCreate");
+
+                // The pass writes the texture descriptors, so it is created while the placeholders stand in for the textures being read.
+                asyncPool.Flush();
+                Sample::DStorageBindPlaceholderTextures(loadRequest.workloadId, sceneData->m_gltfCommon);
+                CreateScenePbrPass(sceneData, sceneData->m_placeholderPbrPass, nullptr, &asyncPool);
+                asyncPool.Flush();
+                Sample::DStorageBindLoadedTextures(loadRequest.workloadId);
+                sceneData->m_bTexturesResident = false;
+            }
+
             {
                 CPUUserMarker p("m_GLTFPBR->OnCreate");
 
-                // same thing as above but for the PBR pass
-                sceneData->m_pbrPass.OnCreate(
-                    m_pDevice,
-                    nullptr,
-                    &sceneData->m_resourceViewHeaps,
-                    &sceneData->m_constantBuffer,
-                    sceneData->m_pTexturesAndBuffers,
-                    &m_SkyDome,
-                    &m_BRDFLUT,
-                    false,                  // use a SSAO mask
-                    ShadowReceivingState_None,
-                    &m_RenderPassFullGBuffer,
-                    &asyncPool
-                );
+                // Nothing reads the loaded textures through this pass until they are resident.
+                CreateScenePbrPass(sceneData, sceneData->m_pbrPass, nullptr, &asyncPool);
             }
         }
 
@@ -621,17 +918,80 @@ void Renderer::OnRender(const UIState* pState, const Camera& Cam, const TimeStat
         fence->Release();
         CloseHandle(evt);
 
+        // Progressive scenes can be drawn from here on, the rest of the load finishes without holding up the caller.
+        if (sceneData->m_bProgressive)
+        {
+            sceneData->m_timingData.timeToFirstPixel = MillisecondsNow() - requestTime;
+            Trace("P Load: %s", loadRequest.m_sceneName->c_str());
+            // A threadpool wait on the fence finishes the load, no worker is held up while the textures are read.
+            const ScenePathPair* pScenePath = &scenePathLookupResult;
+            m_loadScheduler.Hold(sceneData->m_textureTasks);
+            Sample::DStorageNotifyWorkloadComplete(loadRequest.workloadId, fenceId, [this, sceneData, pScenePath, fenceId, requestTime]()
+                {
+                    m_loadScheduler.RunHeld(sceneData->m_textureTasks, [this, sceneData, pScenePath, fenceId, requestTime]()
+                        {
+                            FinishSceneTextures(sceneData, *pScenePath, fenceId, requestTime);
+                        });
+                });
+            return sceneData;
+        }
 
-        Sample::DStorageSyncCPU(fenceId);
+        FinishSceneTextures(sceneData, scenePathLookupResult, fenceId, requestTime);
+        return sceneData;
+            });
+    }
+
+    void Renderer::FinishSceneTextures(SceneData* sceneData, const ScenePathPair& scenePathLookupResult, uint64_t fenceId, double requestTime)
+    {
+        const auto& loadRequest = sceneData->m_timingData.loadRequest;
+
+        const auto ioTiming = Sample::DStorageSyncWorkloadCPU(loadRequest.workloadId, fenceId);
+        sceneData->m_timingData.ioPriorityClass = ioTiming.priorityClass;
+        sceneData->m_timingData.ioLatency = ioTiming.latency;
+        sceneData->m_timingData.ioDeferTime = ioTiming.deferTime;
         //Sample::DStorageSyncGPU(m_pDevice->GetGraphicsQueue());
 
-        sceneData->m_sceneTransform = loadRequest.m_streamedSceneDataTransform;
+        // All reads are done, the payload and metadata can be evicted from here on. Scenes the texture LOD may refine need their metadata to pick the refine's tier.
+        Sample::DStorageReleaseScenePayload(scenePathLookupResult, loadRequest.workloadId);
+        if (sceneData->m_textureLODTier > 0)
+        {
+            sceneData->m_bHoldsMetaData = true;
+        }
+        else
+        {
+            Sample::DStorageReleaseSceneMetaData(scenePathLookupResult);
+        }
+
         sceneData->m_timingData.loadTime = MillisecondsNow() - requestTime;
+        if (!sceneData->m_bProgressive)
+        {
+            sceneData->m_timingData.timeToFirstPixel = sceneData->m_timingData.loadTime;
+        }
+
+        // The packed mips of tiled textures are in as well, their other tiles can be asked for now.
+        sceneData->m_tiledTextures = Sample::DStorageTakeWorkloadTiledTextures(loadRequest.workloadId);
+
+        // The fence covers the texture reads, the render loop may use the loaded textures now.
+        sceneData->m_bTexturesResident = true;
 
         Trace("E Load: %s", loadRequest.m_sceneName->c_str());
+    }
 
-        return sceneData;
-            });
+    void Renderer::CreateScenePbrPass(SceneData* sceneData, GltfPbrPass& pbrPass, UploadHeap* pUploadHeap, AsyncPool* pAsyncPool)
+    {
+        pbrPass.OnCreate(
+            m_pDevice,
+            pUploadHeap,
+            &sceneData->m_resourceViewHeaps,
+            &sceneData->m_constantBuffer,
+            sceneData->m_pTexturesAndBuffers,
+            &m_SkyDome,
+            &m_BRDFLUT,
+            false,                  // use a SSAO mask
+            ShadowReceivingState_None,
+            &m_RenderPassFullGBuffer,
+            pAsyncPool
+        );
     }
 
     std::future<SceneData*> Renderer::LoadSceneAsyncNoDirectStorage(const SceneLoadRequest& loadRequest)
@@ -642,7 +1002,7 @@ void Renderer::OnRender(const UIState* pState, const Camera& Cam, const TimeStat
         auto frameTimeMeanAtRequestTime = m_rollingFrameTimeSnapshot.GetArithmeticMean();
         auto frameTimeMedianAtRequestTime = m_rollingFrameTimeSnapshot.GetMedian();
 
-        return std::async([this, loadRequest, requestTime, frameTimeMeanAtRequestTime, frameTimeMedianAtRequestTime]()
+        return m_loadScheduler.SubmitLoad<SceneData*>(GetLoadPriority(loadRequest), [this, loadRequest, requestTime, frameTimeMeanAtRequestTime, frameTimeMedianAtRequestTime]()
             {
                 CPUUserMarker marker("LoadSceneAsync Processing");
 
@@ -651,16 +1011,15 @@ void Renderer::OnRender(const UIState* pState, const Camera& Cam, const TimeStat
         const auto& scenePathLookupResult = m_pScenePathMap->at(*loadRequest.m_sceneName);
         AsyncPool asyncPool;
         SceneData* sceneData = new SceneData;
+        sceneData->m_gpuMemorySize = GetSceneBufferMemorySize();
 
         sceneData->m_timingData.loadRequest = loadRequest;
         sceneData->m_timingData.frameTimeMeanBeforeLoading = frameTimeMeanAtRequestTime;
         sceneData->m_timingData.frameTimeMedianBeforeLoading = frameTimeMedianAtRequestTime;
 
-        if (sceneData->m_gltfCommon.Load(scenePathLookupResult.scenePath, scenePathLookupResult.sceneFile) == false)
-        {
-            MessageBox(NULL, "The selected model couldn't be found, please check the documentation", "Cauldron Panic!", MB_ICONERROR);
-            exit(0);
-        }
+        // Parsing the glTF and creating the buffers and descriptor heaps don't depend on each other, they run as sub-tasks while this thread gets on with the rest.
+        LoadScheduler::TaskGroup setupTasks;
+        RunSceneSetupTasks(setupTasks, sceneData, scenePathLookupResult);
 
         sceneData->m_pTexturesAndBuffers = new CAULDRON_DX12::GLTFTexturesAndBuffers;
 
@@ -672,33 +1031,12 @@ void Renderer::OnRender(const UIState* pState, const Camera& Cam, const TimeStat
 
         uploadHeap.OnCreate(m_pDevice, uploadHeapSize);
 
-
-        // Create a 'static' pool for vertices, indices and constant buffers... should be using placed resources here too. Value is based on assets being loaded.
-        const size_t staticGeometryMemSize = (240 * 1024 * 1024) - (256 * 1024);
-
-        sceneData->m_staticBufferPool.OnCreate(m_pDevice, staticGeometryMemSize, true, "StaticGeom");
-
-        // our own constant buffer ring... this might not be necessary.
-        // Create a 'dynamic' constant buffer
-        const uint32_t constantBuffersMemSize = 2 * 1024 * 1024;
-        sceneData->m_constantBuffer.OnCreate(m_pDevice, backBufferCount, constantBuffersMemSize);
-
         // Use placed resources if requested and compatible for this asset.
         sceneData->m_pTextureHeap = nullptr;
 
+        m_loadScheduler.Wait(setupTasks);
         sceneData->m_pTexturesAndBuffers->OnCreate(m_pDevice, &sceneData->m_gltfCommon, &uploadHeap, &sceneData->m_staticBufferPool, &sceneData->m_constantBuffer);
 
-        // Create all the heaps for the resources views. @todo: these could easily be sized to the data.
-        const uint32_t cbvDescriptorCount = 4000;
-        const uint32_t srvDescriptorCount = 8000;
-        const uint32_t uavDescriptorCount = 10;
-        const uint32_t dsvDescriptorCount = 10;
-        const uint32_t rtvDescriptorCount = 60;
-        const uint32_t samplerDescriptorCount = 20;
-
-        sceneData->m_resourceViewHeaps.OnCreate(m_pDevice, cbvDescriptorCount, srvDescriptorCount, uavDescriptorCount, dsvDescriptorCount, rtvDescriptorCount, samplerDescriptorCount);
-
-
         reinterpret_cast<CAULDRON_DX12::GLTFTexturesAndBuffers*>(sceneData->m_pTexturesAndBuffers)->LoadTextures(&asyncPool, sceneData->m_pTextureHeap, loadRequest.workloadId);
 
 
@@ -710,19 +1048,7 @@ void Renderer::OnRender(const UIState* pState, const Camera& Cam, const TimeStat
                 CPUUserMarker p("m_GLTFPBR->OnCreate");
 
                 // same thing as above but for the PBR pass
-                sceneData->m_pbrPass.OnCreate(
-                    m_pDevice,
-                    &uploadHeap,
-                    &sceneData->m_resourceViewHeaps,
-                    &sceneData->m_constantBuffer,
-                    sceneData->m_pTexturesAndBuffers,
-                    &m_SkyDome,
-                    &m_BRDFLUT,
-                    false,                  // use a SSAO mask
-                    ShadowReceivingState_None,
-                    &m_RenderPassFullGBuffer,
-                    &asyncPool
-                );
+                CreateScenePbrPass(sceneData, sceneData->m_pbrPass, &uploadHeap, &asyncPool);
             }
         }
 
@@ -731,8 +1057,8 @@ void Renderer::OnRender(const UIState* pState, const Camera& Cam, const TimeStat
         uploadHeap.FlushAndFinish();
         uploadHeap.OnDestroy();
 
-        sceneData->m_sceneTransform = loadRequest.m_streamedSceneDataTransform;
         sceneData->m_timingData.loadTime = MillisecondsNow() - requestTime;
+        sceneData->m_timingData.timeToFirstPixel = sceneData->m_timingData.loadTime;
 
         Trace("E Load: %s", loadRequest.m_sceneName->c_str());
 
@@ -740,16 +1066,18 @@ void Renderer::OnRender(const UIState* pState, const Camera& Cam, const TimeStat
             });
     }
 
-    bool StreamingVolume::IsPointInside(const math::Point3& point) const
+    // The largest scale of the transform, so the bounds still hold when it stretches the scene.
+    static float GetMaxScale(const math::Matrix4& transform)
     {
-        math::Point3 maxs =  m_center + m_radius;
-        math::Point3 mins = m_center - m_radius;
-
-        auto lessEqualThanMaxMask = _mm_cmple_ps(point.get128(), maxs.get128());
-        auto greaterEqualThanMinsMask = _mm_cmpge_ps(point.get128(), mins.get128());
+        return max(Vectormath::SSE::length(transform.getCol0().getXYZ()), max(Vectormath::SSE::length(transform.getCol1().getXYZ()), Vectormath::SSE::length(transform.getCol2().getXYZ())));
+    }
 
-        auto andMask = _mm_and_ps(lessEqualThanMaxMask, greaterEqualThanMinsMask);
-        auto compareResult = _mm_movemask_ps(andMask);
+    uint32_t SceneData::GetTextureLODMipDrop(const math::Matrix4& transform, float distanceToScene, float projectionScale) const
+    {
+        return Sample::GetTextureLODMipDrop(m_maxTextureSize, m_boundingRadius * GetMaxScale(transform), distanceToScene, projectionScale);
+    }
 
-        return compareResult == 0x7;
+    void SceneData::RequestTiledTextureMips(const math::Matrix4& transform, float distanceToScene, float projectionScale) const
+    {
+        Sample::DStorageRequestTiledTextureMips(m_tiledTextures, m_boundingRadius * GetMaxScale(transform), distanceToScene, projectionScale);
     }
@@ -22,7 +22,9 @@
 
 #include "base/GBuffer.h"
 #include "ArtificialWorkload.h"
+#include "LoadScheduler.h"
 #include "TransparentCube.h"
+#include "TextureHeapPool.h"
 
 struct UIState;
 
@@ -141,6 +143,11 @@ struct SceneLoadRequest
     math::Matrix4 m_streamedSceneDataTransform{ math::Matrix4::identity() };
     bool m_useDirectStorage{ false };
     bool m_usePlacedResources{ false };
+    std::string m_packageVariant;
+    float m_distanceToScene{ 0.0f };
+    bool m_bPrefetched{ false }; // Requested before the camera got to the volume.
+    uint32_t m_qualityTier{ 0 }; // Filled in by the renderer when the scene starts loading.
+    float m_projectionScale{ 0.0f }; // Screen pixels one unit covers at a distance of one unit, for the texture LOD.
 };
 
 struct SceneTimingData
@@ -153,6 +160,13 @@ struct SceneTimingData
     double sceneTextureCompressionRatio = 0;
     size_t sceneTextureFileDataSize = 0;
     size_t sceneTextureUncompressedSize = 0;
+    bool payloadFromMemory = false; // Textures were read from a package that was in the payload cache already, the disk wasn't touched.
+    uint32_t payloadCacheLookup = 0; // Sample::PayloadCacheLookup of this load.
+    uint64_t payloadCacheBytesSaved = 0; // Compressed bytes this load didn't read from the disk.
+    uint32_t ioPriorityClass = 1; // Sample::IOPriorityClass of the queue the textures were read on. Normal without DirectStorage.
+    double ioLatency = 0.0; // ms from enqueueing the first texture read to the last one finishing.
+    double ioDeferTime = 0.0; // ms the reads waited for higher priority loads.
+    double timeToFirstPixel = 0.0; // ms until the scene could be drawn. Progressive scenes are drawn with placeholders well before loadTime.
     FrameTimeSnapshotUnlimited frameTimes;
 };
 
@@ -165,9 +179,17 @@ enum class GLTFLoadingState
     Unloaded
 };
 
+enum class SceneUnloadState
+{
+    None,
+    KeepAlive, // Unload requested, waiting to see if the scene is wanted again.
+    Destroying
+};
+
 struct SceneData
 {
     ID3D12Heap* m_pTextureHeap;
+    TextureHeapAllocation m_textureHeapAllocation; // Owns m_pTextureHeap's range, given back to the pool on unload.
     
     // Data held by passes but owned here.
     GLTFCommon m_gltfCommon;
@@ -176,27 +198,69 @@ struct SceneData
     DynamicBufferRing m_constantBuffer;
     ResourceViewHeaps m_resourceViewHeaps;
     GltfPbrPass m_pbrPass;
+    GltfPbrPass m_placeholderPbrPass; // Progressive scenes are drawn with this until their textures have been read.
+
+    // Progressive scenes are handed out as soon as their geometry is ready, their textures are still being read.
+    bool m_bProgressive = false;
+    std::atomic<bool> m_bTexturesResident{ true };
+    LoadScheduler::TaskGroup m_textureTasks; // Finishes the load of a progressive scene.
+
+    GltfPbrPass& GetPbrPass() { return m_bTexturesResident ? m_pbrPass : m_placeholderPbrPass; }
+
+    // One per streaming volume showing the scene, the scene is drawn once with each.
+    struct Instance
+    {
+        const math::Matrix4* m_pTransform = nullptr;
+        // The scene's node and skinning matrices as this instance left them, TransformScene moves them into the previous frame slot.
+        std::vector<Matrix2> m_worldSpaceMats;
+        std::map<int, std::vector<Matrix2>> m_worldSpaceSkeletonMats;
+        bool m_bTransformed = false; // Without a frame behind it, the instance's previous matrices are its current ones.
+    };
+    std::vector<Instance> m_instances;
+
+    // Filled in for the texture LOD.
+    float m_boundingRadius = 0.0f; // Around the origin the streamed scene transform moves the scene to.
+    uint32_t m_maxTextureSize = 0; // Largest texture of the scene at full quality.
+    uint32_t m_textureLODTier = 0; // Quality tier the texture LOD picked, a closer camera can ask for a better one.
+    bool m_bHoldsMetaData = false; // Scenes that can be refined keep their metadata acquired to pick the refine's tier, until they're destroyed.
+
+    // Top mips of the scene's textures that can't make it to the screen, seen through one of its instances.
+    uint32_t GetTextureLODMipDrop(const math::Matrix4& transform, float distanceToScene, float projectionScale) const;
 
-    math::Matrix4 m_sceneTransform;
+    // Streamer ids of the scene's tiled textures, set once its textures are resident.
+    std::vector<uint32_t> m_tiledTextures;
+
+    // Asks for the tiles the scene's tiled textures need this frame, seen through one of its instances.
+    void RequestTiledTextureMips(const math::Matrix4& transform, float distanceToScene, float projectionScale) const;
 
     SceneTimingData m_timingData;
 
+    // Texture, heap and buffer bytes, what the residency manager accounts for the scene.
+    // Without DirectStorage the texture sizes aren't known up front, only the buffers are counted.
+    uint64_t m_gpuMemorySize = 0;
+
+    // Lets an unload waiting out its keep-alive hand the scene back instead of destroying it.
+    std::mutex m_unloadMutex;
+    std::promise<SceneData*> m_unloadPromise; // Fulfilled with the scene when resurrected, nullptr once destroyed.
+    uint32_t m_unloadCount = 0; // Tells a keep-alive running out apart from one of an earlier unload.
+    SceneUnloadState m_unloadState = SceneUnloadState::None;
+
     void OnDestroy()
     {
         m_pbrPass.OnDestroy();
+        if (m_bProgressive)
+        {
+            m_placeholderPbrPass.OnDestroy();
+        }
         m_staticBufferPool.OnDestroy();
         m_constantBuffer.OnDestroy();
         m_resourceViewHeaps.OnDestroy();
         m_pTexturesAndBuffers->OnDestroy(); // TODO: Go in and ensure no references to the heap.
         m_pTexturesAndBuffers = nullptr;
         m_gltfCommon.Unload();
-        if (m_pTextureHeap)
-        {
-            // for placed resources heap.
-            auto textureHeapRefCount = m_pTextureHeap->Release();
-            assert(textureHeapRefCount == 0);
-            m_pTextureHeap = nullptr;
-        }
+
+        // The placed resources heap belongs to the renderer's pool, it frees m_textureHeapAllocation.
+        m_pTextureHeap = nullptr;
     }
 };
 
@@ -213,12 +277,39 @@ struct StreamingVolume
     math::Matrix4 m_streamedSceneDataTransform{ math::Matrix4::identity() }; // location/scale etc to place the streamed data.
 
     GLTFLoadingState m_LoadingState{ GLTFLoadingState::Unloaded };
-    std::future<SceneData*> m_LoadedSceneFuture;
+    std::shared_future<SceneData*> m_LoadedSceneFuture;
     FrameTimeSnapshotUnlimited frameTimes; // measure of frame time while loading this scene data.
     uint64_t workloadId = 0;
     SceneData* m_pSceneData;
     std::string m_sceneName;
-    bool IsPointInside(const math::Point3& point) const;
+    double m_enterTime = 0.0; // When the volume started loading or showing its scene, for the minimum dwell time.
+    bool m_bKeepAlive = false; // Unloading, but the scene can still be resurrected.
+    bool m_bPrefetched = false; // Loading or showing its scene because the camera is heading here, not inside yet.
+    bool m_bTexturesPending = false; // Showing a progressive scene whose textures are still being read.
+};
+
+// Volumes showing the same scene share a single load of it.
+struct SharedScene
+{
+    std::shared_future<SceneData*> m_LoadedSceneFuture;
+    uint32_t m_refCount = 0; // Volumes loading or showing the scene.
+    uint64_t workloadId = 0;
+    bool m_bTimingRecorded = false; // Only the first volume to see the load finish reports its timing.
+    bool m_bResidencyRecorded = false; // Progressive scenes are resident before their load is timed.
+    bool m_bResurrected = false; // Came back from a keep-alive unload, there was no load to time.
+    uint32_t m_ioPriorityClass = 0; // Sample::IOPriorityClass the load's reads were last given.
+    std::shared_future<SceneData*> m_RefinedSceneFuture; // The scene loaded again at a better quality tier for the texture LOD.
+    uint64_t m_refinedWorkloadId = 0;
+    uint64_t m_refineReservedBytes = 0; // What the residency manager reserved for the refine.
+};
+
+// A refined scene that replaced the one volumes showed, or that nobody wanted anymore by the time it was done.
+struct RetiringScene
+{
+    std::string m_sceneName;
+    std::shared_future<SceneData*> m_sceneFuture; // The load until bUnloading, then the unload.
+    bool m_bUnloading = false;
+    uint64_t m_reservedBytes = 0; // Released with the residency manager once it's destroyed.
 };
 
 // This class encapsulates the 'application' and is responsible for handling window events and scene updates (simulation)
@@ -245,22 +336,62 @@ public:
     std::future<SceneData*> LoadSceneAsync(const SceneLoadRequest& loadRequest);
     std::future<SceneData*> LoadSceneAsyncDirectStorage(const SceneLoadRequest& loadRequest);
     std::future<SceneData*> LoadSceneAsyncNoDirectStorage(const SceneLoadRequest& loadRequest);
-    std::future<SceneData*> UnloadSceneAsync(std::string sceneName, SceneData* sceneData);
+    // With a keep-alive, the unload waits that long before destroying the scene. The future returns the scene if it was resurrected meanwhile, nullptr otherwise.
+    std::future<SceneData*> UnloadSceneAsync(std::string sceneName, SceneData* sceneData, float keepAliveSeconds = 0.0f);
+    // Stops a keep-alive unload. Returns false if the scene is already being destroyed.
+    bool ResurrectScene(SceneData* sceneData);
+    // Destroys a keep-alive scene now instead of when its keep-alive runs out.
+    void EndSceneKeepAlive(SceneData* sceneData);
+
+    // What a scene needs before its textures, used as the estimate for scenes that haven't been loaded yet.
+    static uint64_t GetSceneBufferMemorySize();
+
+    // Quality tier a load of the scene would pick now, seen through one of its instances. For the texture LOD to tell whether a refine would be any better.
+    uint32_t SelectRefinedQualityTier(const SceneData* sceneData, const math::Matrix4& transform, float distanceToScene, float projectionScale) const;
 
-    void AddScene(SceneData* sceneData)
+    // A scene shared by several volumes is added once per volume, with that volume's transform.
+    void AddScene(SceneData* sceneData, const math::Matrix4* pTransform)
     {
-        m_SceneData.push_back(sceneData);
+        if (sceneData->m_instances.empty())
+        {
+            m_SceneData.push_back(sceneData);
+        }
+
+        SceneData::Instance instance;
+        instance.m_pTransform = pTransform;
+        instance.m_worldSpaceMats = sceneData->m_gltfCommon.m_worldSpaceMats;
+        instance.m_worldSpaceSkeletonMats = sceneData->m_gltfCommon.m_worldSpaceSkeletonMats;
+        sceneData->m_instances.push_back(std::move(instance));
     }
-    void RemoveScene(SceneData* sceneData)
+    void RemoveScene(SceneData* sceneData, const math::Matrix4* pTransform)
     {
+        auto& instances = sceneData->m_instances;
+        auto foundInstanceItr = std::find_if(instances.begin(), instances.end(), [pTransform](const SceneData::Instance& instance) { return instance.m_pTransform == pTransform; });
+        if (foundInstanceItr != instances.end())
+        {
+            instances.erase(foundInstanceItr);
+        }
+
         auto foundSceneItr = std::find(m_SceneData.begin(), m_SceneData.end(), sceneData);
-        if (foundSceneItr != m_SceneData.end())
+        if (instances.empty() && foundSceneItr != m_SceneData.end())
         {
             m_SceneData.erase(foundSceneItr);
         }
     }
     
+    const LoadScheduler& GetLoadScheduler() const { return m_loadScheduler; }
+
 private:
+    uint64_t GetTextureMemoryBudget() const;
+    void RunSceneSetupTasks(LoadScheduler::TaskGroup& setupTasks, SceneData* sceneData, const ScenePathPair& scenePathLookupResult);
+    void CreateScenePbrPass(SceneData* sceneData, GltfPbrPass& pbrPass, UploadHeap* pUploadHeap, AsyncPool* pAsyncPool);
+    // Waits for the scene's texture reads and releases what they needed, progressive scenes switch to their loaded textures after.
+    void FinishSceneTextures(SceneData* sceneData, const ScenePathPair& scenePathLookupResult, uint64_t fenceId, double requestTime);
+    void DestroyScene(SceneData* sceneData);
+
+    TextureHeapPool                 m_textureHeapPool;
+    LoadScheduler                   m_loadScheduler;
+
     Device                         *m_pDevice;
     const SampleOptions            *m_pSampleOptions;
 
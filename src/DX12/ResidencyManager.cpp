@@ -0,0 +1,312 @@
+// AMD SampleDX12 sample code
+// 
+// Copyright(c) 2023 Advanced Micro Devices, Inc.All rights reserved.
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "stdafx.h"
+#include "ResidencyManager.h"
+
+#include <cfloat>
+
+void AdapterMemoryBudgetSource::OnCreate(Device* pDevice)
+{
+    ThrowIfFailed(pDevice->GetAdapter()->QueryInterface(IID_PPV_ARGS(&m_pAdapter)));
+}
+
+void AdapterMemoryBudgetSource::OnDestroy()
+{
+    if (m_pAdapter)
+    {
+        m_pAdapter->Release();
+        m_pAdapter = nullptr;
+    }
+}
+
+uint64_t AdapterMemoryBudgetSource::GetSceneBudget(uint64_t residentSceneBytes)
+{
+    DXGI_QUERY_VIDEO_MEMORY_INFO memoryInfo{};
+    if (FAILED(m_pAdapter->QueryVideoMemoryInfo(0, DXGI_MEMORY_SEGMENT_GROUP_LOCAL, &memoryInfo)))
+    {
+        return UINT64_MAX;
+    }
+
+    // Our accounting is an estimate, don't let it make the rest of the process look smaller than nothing.
+    const uint64_t otherUsage = memoryInfo.CurrentUsage > residentSceneBytes ? memoryInfo.CurrentUsage - residentSceneBytes : 0;
+    return memoryInfo.Budget > otherUsage ? memoryInfo.Budget - otherUsage : 0;
+}
+
+void ResidencyManager::OnCreate(MemoryBudgetSource* pBudgetSource)
+{
+    m_pBudgetSource = pBudgetSource;
+    m_creationTime = MillisecondsNow();
+    m_budget = m_pBudgetSource->GetSceneBudget(0);
+}
+
+void ResidencyManager::OnDestroy()
+{
+    m_pBudgetSource = nullptr;
+    m_scenes.clear();
+    m_lastSceneBytes.clear();
+    m_refusedScenes.clear();
+    m_refusedScenesThisFrame.clear();
+    m_events.clear();
+    m_residentBytes = 0;
+    m_reservedBytes = 0;
+}
+
+void ResidencyManager::Update(std::vector<std::string>& evictOut)
+{
+    m_frame++;
+    m_budget = m_pBudgetSource->GetSceneBudget(m_residentBytes);
+
+    m_refusedScenes = std::move(m_refusedScenesThisFrame);
+    m_refusedScenesThisFrame.clear();
+
+    if (m_residentBytes <= m_budget)
+    {
+        return;
+    }
+
+    auto evictionOrder = GetEvictionOrder(FLT_MAX);
+
+    // Keep the most important scene even if it doesn't fit by itself, showing something beats thrashing. Unloading scenes aren't shown.
+    const bool hasLoadingScenes = std::any_of(m_scenes.begin(), m_scenes.end(), [](const auto& scene) { return !scene.second.isLoaded; });
+    if (!hasLoadingScenes && !evictionOrder.empty() && !evictionOrder.back()->second.isUnloading)
+    {
+        evictionOrder.pop_back();
+    }
+
+    for (auto itr : evictionOrder)
+    {
+        if (m_residentBytes <= m_budget)
+        {
+            break;
+        }
+        Evict(itr, evictOut);
+    }
+}
+
+void ResidencyManager::SetReservedBytes(uint64_t reservedBytes)
+{
+    m_residentBytes = m_residentBytes - m_reservedBytes + reservedBytes;
+    m_reservedBytes = reservedBytes;
+}
+
+void ResidencyManager::SetScenePriority(const std::string& sceneName, float priority)
+{
+    auto sceneItr = m_scenes.find(sceneName);
+    if (sceneItr != m_scenes.end())
+    {
+        sceneItr->second.priority = priority;
+        sceneItr->second.lastUsedFrame = m_frame;
+    }
+}
+
+bool ResidencyManager::RequestLoad(const std::string& sceneName, float priority, uint64_t estimatedBytes, std::vector<std::string>& evictOut)
+{
+    auto sceneItr = m_scenes.find(sceneName);
+    if (sceneItr != m_scenes.end())
+    {
+        // Its memory never went anywhere.
+        assert(sceneItr->second.isUnloading);
+        sceneItr->second.isUnloading = false;
+        sceneItr->second.priority = priority;
+        sceneItr->second.lastUsedFrame = m_frame;
+        AddEvent(ResidencyDecision::Load, sceneName, sceneItr->second.bytes, priority);
+        m_refusedScenes.erase(sceneName);
+        return true;
+    }
+
+    auto lastBytesItr = m_lastSceneBytes.find(sceneName);
+    const uint64_t sceneBytes = lastBytesItr != m_lastSceneBytes.end() ? std::max(lastBytesItr->second, estimatedBytes) : estimatedBytes;
+
+    if (!MakeRoom(sceneBytes, priority, evictOut))
+    {
+        if (m_refusedScenes.find(sceneName) == m_refusedScenes.end() && m_refusedScenesThisFrame.find(sceneName) == m_refusedScenesThisFrame.end())
+        {
+            AddEvent(ResidencyDecision::Refuse, sceneName, sceneBytes, priority);
+        }
+        m_refusedScenesThisFrame.insert(sceneName);
+        return false;
+    }
+
+    AddEvent(ResidencyDecision::Load, sceneName, sceneBytes, priority);
+
+    SceneResidency& scene = m_scenes[sceneName];
+    scene.bytes = sceneBytes;
+    scene.priority = priority;
+    scene.lastUsedFrame = m_frame;
+    m_residentBytes += sceneBytes;
+    m_refusedScenes.erase(sceneName);
+    return true;
+}
+
+void ResidencyManager::OnSceneLoaded(const std::string& sceneName, uint64_t sceneBytes)
+{
+    auto sceneItr = m_scenes.find(sceneName);
+    assert(sceneItr != m_scenes.end());
+    if (sceneItr == m_scenes.end())
+    {
+        return;
+    }
+
+    m_residentBytes = m_residentBytes - sceneItr->second.bytes + sceneBytes;
+    sceneItr->second.bytes = sceneBytes;
+    sceneItr->second.isLoaded = true;
+    m_lastSceneBytes[sceneName] = sceneBytes;
+}
+
+void ResidencyManager::OnSceneUnloaded(const std::string& sceneName)
+{
+    auto sceneItr = m_scenes.find(sceneName);
+    if (sceneItr != m_scenes.end())
+    {
+        m_residentBytes -= sceneItr->second.bytes;
+        m_scenes.erase(sceneItr);
+    }
+}
+
+void ResidencyManager::OnSceneUnloading(const std::string& sceneName)
+{
+    auto sceneItr = m_scenes.find(sceneName);
+    if (sceneItr != m_scenes.end())
+    {
+        sceneItr->second.isUnloading = true;
+        sceneItr->second.priority = -FLT_MAX;
+    }
+}
+
+void ResidencyManager::OnSceneDestroyed(const std::string& sceneName)
+{
+    auto sceneItr = m_scenes.find(sceneName);
+    if (sceneItr != m_scenes.end() && sceneItr->second.isUnloading)
+    {
+        m_residentBytes -= sceneItr->second.bytes;
+        m_scenes.erase(sceneItr);
+    }
+}
+
+bool ResidencyManager::RequestRefine(const std::string& sceneName, uint64_t estimatedBytes, std::vector<std::string>& evictOut)
+{
+    auto sceneItr = m_scenes.find(sceneName);
+    if (sceneItr == m_scenes.end() || !sceneItr->second.isLoaded || sceneItr->second.isUnloading)
+    {
+        return false;
+    }
+
+    // Refines are retried every frame, only the ones that go ahead are reported.
+    const float priority = sceneItr->second.priority;
+    if (!MakeRoom(estimatedBytes, priority, evictOut))
+    {
+        return false;
+    }
+
+    AddEvent(ResidencyDecision::Load, sceneName, estimatedBytes, priority);
+    m_residentBytes += estimatedBytes;
+    return true;
+}
+
+void ResidencyManager::OnRefineSwapped(const std::string& sceneName, uint64_t reservedBytes, uint64_t refinedBytes, uint64_t replacedBytes)
+{
+    assert(m_residentBytes >= reservedBytes);
+    m_residentBytes = m_residentBytes - reservedBytes + replacedBytes;
+    OnSceneLoaded(sceneName, refinedBytes);
+}
+
+void ResidencyManager::ReleaseRefine(uint64_t reservedBytes)
+{
+    assert(m_residentBytes >= reservedBytes);
+    m_residentBytes -= reservedBytes;
+}
+
+std::vector<ResidencyEvent> ResidencyManager::TakeEvents()
+{
+    std::vector<ResidencyEvent> events;
+    events.swap(m_events);
+    return events;
+}
+
+void ResidencyManager::AddEvent(ResidencyDecision decision, const std::string& sceneName, uint64_t sceneBytes, float priority)
+{
+    ResidencyEvent event;
+    event.time = MillisecondsNow() - m_creationTime;
+    event.decision = decision;
+    event.sceneName = sceneName;
+    event.sceneBytes = sceneBytes;
+    event.residentBytes = m_residentBytes;
+    event.budget = m_budget;
+    event.priority = priority;
+    m_events.push_back(std::move(event));
+
+    Trace("Residency %s: %s %.2f MiB (%.2f / %.2f MiB)", GetResidencyDecisionName(decision), sceneName.c_str(), sceneBytes / 1024.0 / 1024.0, m_residentBytes / 1024.0 / 1024.0, m_budget / 1024.0 / 1024.0);
+}
+
+void ResidencyManager::Evict(SceneMap::iterator itr, std::vector<std::string>& evictOut)
+{
+    assert(itr->second.isLoaded);
+    AddEvent(ResidencyDecision::Evict, itr->first, itr->second.bytes, itr->second.priority);
+
+    evictOut.push_back(itr->first);
+    m_residentBytes -= itr->second.bytes;
+    m_scenes.erase(itr);
+}
+
+bool ResidencyManager::MakeRoom(uint64_t bytes, float priority, std::vector<std::string>& evictOut)
+{
+    // See what would have to go before touching anything.
+    auto evictionOrder = GetEvictionOrder(priority);
+    uint64_t freeableBytes = 0;
+    size_t evictionCount = 0;
+    while (m_residentBytes - freeableBytes + bytes > m_budget && evictionCount < evictionOrder.size())
+    {
+        freeableBytes += evictionOrder[evictionCount++]->second.bytes;
+    }
+
+    if (m_residentBytes - freeableBytes + bytes > m_budget)
+    {
+        return false;
+    }
+
+    for (size_t i = 0; i < evictionCount; i++)
+    {
+        Evict(evictionOrder[i], evictOut);
+    }
+    return true;
+}
+
+std::vector<ResidencyManager::SceneMap::iterator> ResidencyManager::GetEvictionOrder(float belowPriority)
+{
+    std::vector<SceneMap::iterator> evictionOrder;
+    for (auto itr = m_scenes.begin(); itr != m_scenes.end(); ++itr)
+    {
+        if (itr->second.isLoaded && itr->second.priority < belowPriority)
+        {
+            evictionOrder.push_back(itr);
+        }
+    }
+
+    std::sort(evictionOrder.begin(), evictionOrder.end(), [](const auto& a, const auto& b)
+        {
+            if (a->second.priority != b->second.priority)
+            {
+                return a->second.priority < b->second.priority;
+            }
+            return a->second.lastUsedFrame < b->second.lastUsedFrame;
+        });
+
+    return evictionOrder;
+}
@@ -0,0 +1,162 @@
+// AMD SampleDX12 sample code
+// 
+// Copyright(c) 2023 Advanced Micro Devices, Inc.All rights reserved.
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <unordered_set>
+
+// Where the residency budget for streamed scenes comes from.
+class MemoryBudgetSource
+{
+public:
+    virtual ~MemoryBudgetSource() = default;
+
+    // Bytes streamed scenes may use. residentSceneBytes is what they're using now, so sources that see the whole process can leave it out of the rest.
+    virtual uint64_t GetSceneBudget(uint64_t residentSceneBytes) = 0;
+};
+
+// Budget the OS gives the process for the adapter's local memory, less what everything but the streamed scenes uses.
+class AdapterMemoryBudgetSource final : public MemoryBudgetSource
+{
+public:
+    void OnCreate(Device* pDevice);
+    void OnDestroy();
+
+    uint64_t GetSceneBudget(uint64_t residentSceneBytes) override;
+
+private:
+    IDXGIAdapter3* m_pAdapter = nullptr;
+};
+
+// A fixed budget, from the options.
+class FixedMemoryBudgetSource final : public MemoryBudgetSource
+{
+public:
+    void SetBudget(uint64_t budget) { m_budget = budget; }
+
+    uint64_t GetSceneBudget(uint64_t residentSceneBytes) override { return m_budget; }
+
+private:
+    uint64_t m_budget = 0;
+};
+
+enum class ResidencyDecision
+{
+    Load,
+    Refuse,
+    Evict
+};
+
+inline const char* GetResidencyDecisionName(ResidencyDecision decision)
+{
+    static const char* decisionNames[] = { "Load", "Refuse", "Evict" };
+    return decisionNames[static_cast<int>(decision)];
+}
+
+struct ResidencyEvent
+{
+    double time = 0.0; // ms since the residency manager was created.
+    ResidencyDecision decision = ResidencyDecision::Load;
+    std::string sceneName;
+    uint64_t sceneBytes = 0;
+    uint64_t residentBytes = 0; // Before the decision.
+    uint64_t budget = 0;
+    float priority = 0.0f;
+};
+
+// Accounts the GPU memory of streamed scenes against a budget, and decides which scenes to evict or not load when it runs out.
+// Lowest priority scenes go first, least recently used first between equal priorities. Not thread safe, used from the update loop.
+class ResidencyManager
+{
+public:
+    void OnCreate(MemoryBudgetSource* pBudgetSource);
+    void OnDestroy();
+
+    // Call once per frame. Refreshes the budget and fills evictOut with loaded scenes to unload if the budget shrank or a load came in larger than estimated.
+    // At least one scene is always kept.
+    void Update(std::vector<std::string>& evictOut);
+
+    // Memory outside the scenes that comes out of the same budget, like the tile pool. It's never evicted.
+    void SetReservedBytes(uint64_t reservedBytes);
+
+    // Higher priority scenes are kept longer. Call every frame for scenes that are loading or loaded.
+    void SetScenePriority(const std::string& sceneName, float priority);
+
+    // Reserves memory for a scene load. Returns false if it can't fit, even after evicting every lower priority scene.
+    // Otherwise evictOut has the loaded scenes that must be unloaded to make room, they're no longer accounted.
+    // Reserves the larger of estimatedBytes and the size the scene had last time, the tier it loads at may differ.
+    // A scene still unloading takes its memory back, nothing more is reserved.
+    bool RequestLoad(const std::string& sceneName, float priority, uint64_t estimatedBytes, std::vector<std::string>& evictOut);
+    // Replaces the reservation with what the scene actually used.
+    void OnSceneLoaded(const std::string& sceneName, uint64_t sceneBytes);
+    // Scene load was cancelled. Not needed for scenes this evicted.
+    void OnSceneUnloaded(const std::string& sceneName);
+    // The scene is unloading, possibly waiting out a keep-alive, and uses its memory until OnSceneDestroyed. It is the first to be evicted.
+    void OnSceneUnloading(const std::string& sceneName);
+    // The unload is done. Does nothing if a new load of the scene took the memory over meanwhile.
+    void OnSceneDestroyed(const std::string& sceneName);
+
+    // Reserves memory for a refine, a second copy of a loaded scene at a better quality tier that replaces it once its textures are in.
+    // Only scenes of lower priority than the loaded one are evicted for it. The reservation can't be evicted and is kept until ReleaseRefine.
+    bool RequestRefine(const std::string& sceneName, uint64_t estimatedBytes, std::vector<std::string>& evictOut);
+    // The refine replaced the scene, which is accounted at refinedBytes from here on. The reservation holds the replaced copy until it's destroyed.
+    void OnRefineSwapped(const std::string& sceneName, uint64_t reservedBytes, uint64_t refinedBytes, uint64_t replacedBytes);
+    // The copy left over, refine or replaced scene, is destroyed.
+    void ReleaseRefine(uint64_t reservedBytes);
+
+    uint64_t GetBudget() const { return m_budget; }
+    uint64_t GetResidentBytes() const { return m_residentBytes; }
+
+    // Decisions made since the last call.
+    std::vector<ResidencyEvent> TakeEvents();
+
+private:
+    struct SceneResidency
+    {
+        uint64_t bytes = 0;
+        float priority = 0.0f;
+        uint64_t lastUsedFrame = 0;
+        bool isLoaded = false; // Only loaded scenes can be evicted.
+        bool isUnloading = false;
+    };
+
+    using SceneMap = std::unordered_map<std::string, SceneResidency>;
+
+    void AddEvent(ResidencyDecision decision, const std::string& sceneName, uint64_t sceneBytes, float priority);
+    void Evict(SceneMap::iterator itr, std::vector<std::string>& evictOut);
+    // Evicts scenes of lower priority until bytes more fit. Evicts nothing and returns false if they wouldn't fit even then.
+    bool MakeRoom(uint64_t bytes, float priority, std::vector<std::string>& evictOut);
+    std::vector<SceneMap::iterator> GetEvictionOrder(float belowPriority);
+
+    MemoryBudgetSource* m_pBudgetSource = nullptr;
+    uint64_t m_budget = UINT64_MAX;
+    uint64_t m_residentBytes = 0; // Reserved bytes included.
+    uint64_t m_reservedBytes = 0;
+    uint64_t m_frame = 0;
+    double m_creationTime = 0.0;
+
+    SceneMap m_scenes; // Loading and loaded scenes.
+    std::unordered_map<std::string, uint64_t> m_lastSceneBytes;
+
+    // Refused scenes are requested again each frame, only the first refusal in a row is reported.
+    std::unordered_set<std::string> m_refusedScenes;
+    std::unordered_set<std::string> m_refusedScenesThisFrame;
+
+    std::vector<ResidencyEvent> m_events;
+};
@@ -35,10 +35,48 @@ struct IOOptions
     bool m_usePlacedResources = false;
     uint32_t m_stagingBufferSize = 192 * 1024 * 1024;
     uint32_t m_queueLength = 128;
+    uint32_t m_submitThreshold = 32; // Requests enqueued on a queue since its last submit that submit it. 0 turns the limit off.
+    uint32_t m_submitBytes = 16 * 1024 * 1024; // Compressed bytes read by those requests that submit it. 0 turns the limit off.
+    float m_submitLatencyMilliseconds = 2.0f; // Longest anything waits to be submitted. 0 turns the limit off.
 
     bool m_allowCancellation = false;
+
+    float m_volumeEnterMargin = 0.0f; // How far outside a streaming volume the camera starts loading its scene.
+    float m_volumeExitMargin = 0.0f; // How far outside a streaming volume the camera has to get before its scene is unloaded or cancelled.
+    float m_volumeMinDwellSeconds = 0.0f; // Scenes aren't unloaded or cancelled until this long after their volume was entered.
+    float m_unloadKeepAliveSeconds = 0.0f; // How long an unloaded scene waits before being destroyed, in case its volume is entered again.
+    bool m_usePrefetch = false; // Start loading volumes the camera is heading for.
+    float m_prefetchLeadSeconds = 1.0f; // How far ahead to prefetch a scene until its load time has been measured.
+    float m_streamingGridCellSize = 8.0f; // Cell size of the grid used to find the streaming volumes near the camera.
+    uint32_t m_loaderThreadCount = 0; // Worker threads loading and unloading scenes, 0 for half the CPU's threads.
+    uint32_t m_maxConcurrentLoads = 2; // Scene loads running at once, the rest wait in order of priority.
+    bool m_usePriorityQueues = false; // Read textures on high, normal or low priority queues depending on how soon the scene is seen.
+    float m_ioHighPrioritySeconds = 0.5f; // Scenes seen within this many seconds are read at high priority.
+    float m_ioLowPrioritySeconds = 2.0f; // Scenes seen later than this are read at low priority.
+    uint32_t m_ioDeferMilliseconds = 250; // How long low priority reads wait for higher priority ones to finish.
+    bool m_useProgressiveScenes = false; // Show scenes once their geometry is in, with placeholder textures until their textures have been read.
     bool m_disableGPUDecompression = false;
     bool m_disableMetaCommand = false;
+
+    std::string m_packageVariant{ "" }; // Selects MetaData_<variant>.bin/TextureData_<variant>.bin. Empty uses MetaData.bin/TextureData.bin.
+
+    bool m_useQualityTiers = false;
+    uint32_t m_textureMemoryBudget = 0; // MiB. 0 uses the budget reported by the adapter.
+    float m_qualityTierDistance = 0.0f; // Distance from a scene per dropped quality tier. 0 only drops tiers to fit the budget.
+    bool m_useTextureLOD = false; // Drop the quality tiers whose mips can't make it to the screen, and reload scenes the camera gets close to.
+    bool m_useTiledTextures = false; // Stream the tiles of textures packaged with -textureTiles as the camera needs them.
+    uint32_t m_tilePoolSize = 256; // MiB of tiles the tiled textures share.
+
+    uint32_t m_textureHeapPoolSize = 256; // MiB per pooled placed resources heap. 0 creates a heap per scene.
+
+    bool m_useTextureCache = true; // Share committed textures between scenes.
+
+    float m_metaDataCacheSeconds = 30.0f; // How long metadata of scenes that aren't loading is kept.
+    uint32_t m_metaDataCacheSize = 64; // Most scenes that aren't loading to keep metadata for.
+    uint32_t m_payloadCacheSize = 0; // MiB of compressed packages kept in system memory for reloads. 0 turns the cache off.
+
+    bool m_useResidencyManager = true; // Evict or hold back scenes that don't fit the residency budget.
+    uint32_t m_residencyBudget = 0; // MiB for streamed scenes. 0 uses the budget reported by the adapter.
 };
 
 struct CameraOptions
@@ -0,0 +1,170 @@
+// AMD SampleDX12 sample code
+// 
+// Copyright(c) 2023 Advanced Micro Devices, Inc.All rights reserved.
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "stdafx.h"
+#include "StreamingVolumeGrid.h"
+
+// 21 bits per axis, biased so negative coordinates work.
+static constexpr int32_t c_CellCoordBias = 1 << 20;
+static constexpr uint64_t c_CellCoordMask = (1ull << 21) - 1;
+
+void StreamingVolumeGrid::OnCreate(float cellSize)
+{
+    assert(cellSize > 0.0f);
+    m_cellSize = cellSize;
+}
+
+void StreamingVolumeGrid::OnDestroy()
+{
+    m_cells.clear();
+    m_oversizedVolumes.clear();
+    m_queryStamps.clear();
+    m_queryStamp = 0;
+}
+
+void StreamingVolumeGrid::Insert(uint32_t volumeIndex, const math::Point3& boxMin, const math::Point3& boxMax)
+{
+    if (volumeIndex >= m_queryStamps.size())
+    {
+        m_queryStamps.resize(volumeIndex + 1, 0);
+    }
+
+    const CellRange range = GetCellRange(boxMin, boxMax);
+    for (int axis = 0; axis < 3; axis++)
+    {
+        if (range.max[axis] - range.min[axis] >= c_MaxCellsPerAxis)
+        {
+            m_oversizedVolumes.push_back(volumeIndex);
+            return;
+        }
+    }
+
+    for (int32_t z = range.min[2]; z <= range.max[2]; z++)
+    {
+        for (int32_t y = range.min[1]; y <= range.max[1]; y++)
+        {
+            for (int32_t x = range.min[0]; x <= range.max[0]; x++)
+            {
+                m_cells[GetCellKey(x, y, z)].push_back(volumeIndex);
+            }
+        }
+    }
+}
+
+void StreamingVolumeGrid::Query(const math::Point3& boxMin, const math::Point3& boxMax, std::vector<uint32_t>& volumesOut)
+{
+    if (++m_queryStamp == 0)
+    {
+        // Wrapped around, old stamps could look like this query's.
+        std::fill(m_queryStamps.begin(), m_queryStamps.end(), 0);
+        m_queryStamp = 1;
+    }
+
+    for (uint32_t volumeIndex : m_oversizedVolumes)
+    {
+        AddVolume(volumeIndex, volumesOut);
+    }
+
+    const CellRange range = GetCellRange(boxMin, boxMax);
+    const uint64_t rangeCellCount = uint64_t(range.max[0] - range.min[0] + 1) * uint64_t(range.max[1] - range.min[1] + 1) * uint64_t(range.max[2] - range.min[2] + 1);
+
+    // A big query box covers mostly empty cells, going over the occupied ones is cheaper then.
+    if (rangeCellCount > m_cells.size())
+    {
+        for (const auto& cell : m_cells)
+        {
+            int32_t coords[3];
+            GetCellCoords(cell.first, coords);
+            if (coords[0] < range.min[0] || coords[0] > range.max[0] ||
+                coords[1] < range.min[1] || coords[1] > range.max[1] ||
+                coords[2] < range.min[2] || coords[2] > range.max[2])
+            {
+                continue;
+            }
+
+            for (uint32_t volumeIndex : cell.second)
+            {
+                AddVolume(volumeIndex, volumesOut);
+            }
+        }
+        return;
+    }
+
+    for (int32_t z = range.min[2]; z <= range.max[2]; z++)
+    {
+        for (int32_t y = range.min[1]; y <= range.max[1]; y++)
+        {
+            for (int32_t x = range.min[0]; x <= range.max[0]; x++)
+            {
+                auto cellItr = m_cells.find(GetCellKey(x, y, z));
+                if (cellItr == m_cells.end())
+                {
+                    continue;
+                }
+
+                for (uint32_t volumeIndex : cellItr->second)
+                {
+                    AddVolume(volumeIndex, volumesOut);
+                }
+            }
+        }
+    }
+}
+
+StreamingVolumeGrid::CellRange StreamingVolumeGrid::GetCellRange(const math::Point3& boxMin, const math::Point3& boxMax) const
+{
+    // Anything past the edge of the representable range lands in the border cells.
+    auto toCell = [this](float coord)
+    {
+        const float cell = floorf(coord / m_cellSize);
+        return static_cast<int32_t>(max(-float(c_CellCoordBias), min(float(c_CellCoordBias - 1), cell)));
+    };
+
+    CellRange range;
+    for (int axis = 0; axis < 3; axis++)
+    {
+        range.min[axis] = toCell(boxMin[axis]);
+        range.max[axis] = toCell(boxMax[axis]);
+    }
+    return range;
+}
+
+uint64_t StreamingVolumeGrid::GetCellKey(int32_t x, int32_t y, int32_t z)
+{
+    return (uint64_t(x + c_CellCoordBias) & c_CellCoordMask) |
+        ((uint64_t(y + c_CellCoordBias) & c_CellCoordMask) << 21) |
+        ((uint64_t(z + c_CellCoordBias) & c_CellCoordMask) << 42);
+}
+
+void StreamingVolumeGrid::GetCellCoords(uint64_t cellKey, int32_t coords[3])
+{
+    for (int axis = 0; axis < 3; axis++)
+    {
+        coords[axis] = static_cast<int32_t>((cellKey >> (21 * axis)) & c_CellCoordMask) - c_CellCoordBias;
+    }
+}
+
+void StreamingVolumeGrid::AddVolume(uint32_t volumeIndex, std::vector<uint32_t>& volumesOut)
+{
+    if (m_queryStamps[volumeIndex] != m_queryStamp)
+    {
+        m_queryStamps[volumeIndex] = m_queryStamp;
+        volumesOut.push_back(volumeIndex);
+    }
+}
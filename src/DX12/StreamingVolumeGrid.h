@@ -0,0 +1,59 @@
+// AMD SampleDX12 sample code
+// 
+// Copyright(c) 2023 Advanced Micro Devices, Inc.All rights reserved.
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+// Uniform grid over the boxes of the streaming volumes, so finding the volumes near the camera doesn't mean looking at all of them.
+// Volumes are referred to by index and can be added at any time. Volumes spanning too many cells are kept in a list that every query returns.
+class StreamingVolumeGrid
+{
+public:
+    void OnCreate(float cellSize);
+    void OnDestroy();
+
+    void Insert(uint32_t volumeIndex, const math::Point3& boxMin, const math::Point3& boxMax);
+
+    // Appends the volumes whose boxes may overlap the query box, each once.
+    void Query(const math::Point3& boxMin, const math::Point3& boxMax, std::vector<uint32_t>& volumesOut);
+
+private:
+    struct CellRange
+    {
+        int32_t min[3];
+        int32_t max[3];
+    };
+
+    static constexpr int32_t c_MaxCellsPerAxis = 4;
+
+    CellRange GetCellRange(const math::Point3& boxMin, const math::Point3& boxMax) const;
+    static uint64_t GetCellKey(int32_t x, int32_t y, int32_t z);
+    static void GetCellCoords(uint64_t cellKey, int32_t coords[3]);
+    void AddVolume(uint32_t volumeIndex, std::vector<uint32_t>& volumesOut);
+
+    float m_cellSize = 1.0f;
+    std::unordered_map<uint64_t, std::vector<uint32_t>> m_cells;
+    std::vector<uint32_t> m_oversizedVolumes;
+
+    // A volume in several cells is only returned once per query.
+    std::vector<uint32_t> m_queryStamps; // By volume index.
+    uint32_t m_queryStamp = 0;
+};
@@ -0,0 +1,135 @@
+// AMD SampleDX12 sample code
+// 
+// Copyright(c) 2023 Advanced Micro Devices, Inc.All rights reserved.
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "stdafx.h"
+#include "TextureHeapPool.h"
+
+void TextureHeapPool::OnCreate(Device* pDevice, uint64_t heapSize)
+{
+    m_pDevice = pDevice;
+    m_heapSize = heapSize;
+}
+
+void TextureHeapPool::OnDestroy()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto& poolHeap : m_heaps)
+    {
+        if (poolHeap.pHeap)
+        {
+            assert(poolHeap.allocator.IsEmpty());
+            auto heapRefCount = poolHeap.pHeap->Release();
+            assert(heapRefCount == 0);
+        }
+    }
+    m_heaps.clear();
+}
+
+bool TextureHeapPool::Allocate(const D3D12_HEAP_DESC& heapDesc, TextureHeapAllocation& allocationOut)
+{
+    allocationOut = TextureHeapAllocation();
+
+    // MSAA textures need 4MiB aligned heaps, pooled heaps are only 64KiB aligned.
+    const bool canPool = heapDesc.SizeInBytes <= m_heapSize && heapDesc.Alignment <= D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+    if (!canPool)
+    {
+        return SUCCEEDED(m_pDevice->GetDevice()->CreateHeap(&heapDesc, IID_PPV_ARGS(&allocationOut.pHeap)));
+    }
+
+    const uint64_t alignment = heapDesc.Alignment != 0 ? heapDesc.Alignment : D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (uint32_t poolHeapIdx = 0; poolHeapIdx < m_heaps.size(); poolHeapIdx++)
+    {
+        auto& poolHeap = m_heaps[poolHeapIdx];
+        if (poolHeap.pHeap == nullptr)
+        {
+            continue;
+        }
+
+        allocationOut.allocation = poolHeap.allocator.Allocate(heapDesc.SizeInBytes, alignment, allocationOut.offset);
+        if (allocationOut.allocation != TlsfAllocator::c_InvalidAllocation)
+        {
+            allocationOut.pHeap = poolHeap.pHeap;
+            allocationOut.poolHeapIdx = poolHeapIdx;
+            return true;
+        }
+    }
+
+    // Everything is full, grow the pool by one heap. Reuse an empty slot so the vector doesn't keep growing.
+    D3D12_HEAP_DESC poolHeapDesc = heapDesc;
+    poolHeapDesc.SizeInBytes = m_heapSize;
+    poolHeapDesc.Alignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+
+    PoolHeap newHeap;
+    if (FAILED(m_pDevice->GetDevice()->CreateHeap(&poolHeapDesc, IID_PPV_ARGS(&newHeap.pHeap))))
+    {
+        return false;
+    }
+    newHeap.allocator.Reset(m_heapSize);
+
+    auto emptySlotItr = std::find_if(m_heaps.begin(), m_heaps.end(), [](const PoolHeap& poolHeap) { return poolHeap.pHeap == nullptr; });
+    if (emptySlotItr == m_heaps.end())
+    {
+        emptySlotItr = m_heaps.insert(m_heaps.end(), PoolHeap());
+    }
+    *emptySlotItr = std::move(newHeap);
+
+    auto& poolHeap = *emptySlotItr;
+    allocationOut.allocation = poolHeap.allocator.Allocate(heapDesc.SizeInBytes, alignment, allocationOut.offset);
+    assert(allocationOut.allocation != TlsfAllocator::c_InvalidAllocation);
+    allocationOut.pHeap = poolHeap.pHeap;
+    allocationOut.poolHeapIdx = static_cast<uint32_t>(std::distance(m_heaps.begin(), emptySlotItr));
+    return true;
+}
+
+void TextureHeapPool::Free(TextureHeapAllocation& allocation)
+{
+    if (allocation.pHeap == nullptr)
+    {
+        return;
+    }
+
+    if (allocation.poolHeapIdx == UINT32_MAX)
+    {
+        auto heapRefCount = allocation.pHeap->Release();
+        assert(heapRefCount == 0);
+        allocation = TextureHeapAllocation();
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto& poolHeap = m_heaps[allocation.poolHeapIdx];
+    assert(poolHeap.pHeap == allocation.pHeap);
+    poolHeap.allocator.Free(allocation.allocation);
+
+    // Keep one empty heap around for the next load, release any others so memory follows what's streamed in.
+    if (poolHeap.allocator.IsEmpty())
+    {
+        const auto emptyHeapCount = std::count_if(m_heaps.begin(), m_heaps.end(), [](const PoolHeap& heap) { return heap.pHeap && heap.allocator.IsEmpty(); });
+        if (emptyHeapCount > 1)
+        {
+            auto heapRefCount = poolHeap.pHeap->Release();
+            assert(heapRefCount == 0);
+            poolHeap.pHeap = nullptr;
+        }
+    }
+
+    allocation = TextureHeapAllocation();
+}
@@ -0,0 +1,58 @@
+// AMD SampleDX12 sample code
+// 
+// Copyright(c) 2023 Advanced Micro Devices, Inc.All rights reserved.
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include "TlsfAllocator.h"
+
+// Where a scene's textures were placed. Either a range of a pooled heap, or a heap of its own.
+struct TextureHeapAllocation
+{
+    ID3D12Heap* pHeap = nullptr;
+    uint64_t offset = 0;
+    uint32_t poolHeapIdx = UINT32_MAX; // UINT32_MAX for dedicated heaps.
+    TlsfAllocator::Allocation allocation = TlsfAllocator::c_InvalidAllocation;
+};
+
+// Fixed size texture heaps, suballocated between scene loads so streaming doesn't create and release a heap per scene.
+// Scenes that don't fit in a pooled heap, or need a different alignment, get a dedicated heap like before.
+class TextureHeapPool
+{
+public:
+    // heapSize of 0 makes every allocation a dedicated heap.
+    void OnCreate(Device* pDevice, uint64_t heapSize);
+    void OnDestroy();
+
+    // Thread safe. heapDesc is the scene's heap template, only its size and alignment are honored for pooled heaps.
+    bool Allocate(const D3D12_HEAP_DESC& heapDesc, TextureHeapAllocation& allocationOut);
+    // Every resource placed in the range must already be released.
+    void Free(TextureHeapAllocation& allocation);
+
+private:
+    struct PoolHeap
+    {
+        ID3D12Heap* pHeap = nullptr;
+        TlsfAllocator allocator;
+    };
+
+    Device* m_pDevice = nullptr;
+    uint64_t m_heapSize = 0;
+    std::mutex m_mutex;
+    std::vector<PoolHeap> m_heaps; // Released heaps leave a null entry, so indices stay valid.
+};
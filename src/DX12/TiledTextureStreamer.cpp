@@ -0,0 +1,364 @@
+// AMD SampleDX12 sample code
+// 
+// Copyright(c) 2023 Advanced Micro Devices, Inc.All rights reserved.
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include "stdafx.h"
+#include "TiledTextureStreamer.h"
+
+bool TiledTextureStreamer::OnCreate(ID3D12Device* pDevice, ID3D12CommandQueue* pGraphicsQueue, DStorageSubmitThread* pSubmitThread, uint32_t queueIndex, uint64_t poolSize)
+{
+    D3D12_FEATURE_DATA_D3D12_OPTIONS options{};
+    if (FAILED(pDevice->CheckFeatureSupport(D3D12_FEATURE_D3D12_OPTIONS, &options, sizeof(options))) || options.TiledResourcesTier < D3D12_TILED_RESOURCES_TIER_2)
+    {
+        return false;
+    }
+
+    const uint32_t slotCount = static_cast<uint32_t>(poolSize / D3D12_TILED_RESOURCE_TILE_SIZE_IN_BYTES);
+    if (slotCount == 0)
+    {
+        return false;
+    }
+
+    m_pDevice = pDevice;
+    m_pGraphicsQueue = pGraphicsQueue;
+    m_pSubmitThread = pSubmitThread;
+    m_queueIndex = queueIndex;
+
+    CD3DX12_HEAP_DESC heapDesc(static_cast<uint64_t>(slotCount) * D3D12_TILED_RESOURCE_TILE_SIZE_IN_BYTES, D3D12_HEAP_TYPE_DEFAULT, 0, D3D12_HEAP_FLAG_ALLOW_ONLY_NON_RT_DS_TEXTURES);
+    ThrowIfFailed(pDevice->CreateHeap(&heapDesc, IID_PPV_ARGS(&m_pPoolHeap)));
+    m_pPoolHeap->SetName(L"Tile Pool");
+    ThrowIfFailed(pDevice->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&m_pMapFence)));
+    ThrowIfFailed(pDevice->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&m_pReadFence)));
+
+    m_residency.Reset(slotCount);
+    return true;
+}
+
+void TiledTextureStreamer::OnDestroy()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    assert(m_residency.GetStats().pinnedSlots == 0 && m_residency.GetStats().residentTiles == 0);
+
+    // Nothing may still be writing to the pool.
+    ThrowIfFailed(m_pReadFence->SetEventOnCompletion(m_readFenceValue, nullptr));
+    ThrowIfFailed(m_pMapFence->SetEventOnCompletion(m_mapFenceValue, nullptr));
+
+    m_pPoolHeap->Release();
+    m_pMapFence->Release();
+    m_pReadFence->Release();
+    m_pPoolHeap = nullptr;
+    m_pMapFence = nullptr;
+    m_pReadFence = nullptr;
+    m_textures.clear();
+    m_mappedTiles.clear();
+    m_readTiles.clear();
+}
+
+TiledTextureStreamer::TextureId TiledTextureStreamer::CreateTexture(const D3D12_RESOURCE_DESC& resourceDesc, const DirectStorageSampleTextureTiles& textureTiles, const DirectStorageSampleTile* pTiles, IDStorageFile* pFile, const char* name, ID3D12Resource** ppResourceOut)
+{
+    *ppResourceOut = nullptr;
+
+    D3D12_RESOURCE_DESC reservedDesc = resourceDesc;
+    reservedDesc.Alignment = 0;
+    reservedDesc.Layout = D3D12_TEXTURE_LAYOUT_64KB_UNDEFINED_SWIZZLE;
+    ID3D12Resource* pResource = nullptr;
+    if (FAILED(m_pDevice->CreateReservedResource(&reservedDesc, D3D12_RESOURCE_STATE_COMMON, nullptr, IID_PPV_ARGS(&pResource))))
+    {
+        return TileResidencyMap::c_InvalidTexture;
+    }
+
+    // Reads go through a second resource, so the texture never samples a slot that's being read over.
+    ID3D12Resource* pStagingResource = nullptr;
+    if (FAILED(m_pDevice->CreateReservedResource(&reservedDesc, D3D12_RESOURCE_STATE_COMMON, nullptr, IID_PPV_ARGS(&pStagingResource))))
+    {
+        pResource->Release();
+        return TileResidencyMap::c_InvalidTexture;
+    }
+
+    // The converter assumed the standard tile shape, the device has the final say on it and on which mips are packed.
+    UINT tileCount = 0;
+    D3D12_PACKED_MIP_INFO packedMipInfo{};
+    D3D12_TILE_SHAPE tileShape{};
+    UINT subresourceCount = reservedDesc.MipLevels;
+    std::vector<D3D12_SUBRESOURCE_TILING> subresourceTilings(subresourceCount);
+    m_pDevice->GetResourceTiling(pResource, &tileCount, &packedMipInfo, &tileShape, &subresourceCount, 0, subresourceTilings.data());
+
+    bool isValid = packedMipInfo.NumStandardMips == textureTiles.standardMipCount
+        && tileShape.WidthInTexels == textureTiles.tileWidth
+        && tileShape.HeightInTexels == textureTiles.tileHeight;
+
+    auto streamed = std::make_unique<StreamedTexture>();
+    std::vector<uint32_t> mipTileCounts;
+    std::vector<uint32_t> mipFirstTile;
+    if (isValid)
+    {
+        uint32_t mipTileCount = 0;
+        for (uint32_t mip = 0; mip < textureTiles.standardMipCount; mip++)
+        {
+            mipFirstTile.push_back(mipTileCount);
+            mipTileCounts.push_back(subresourceTilings[mip].WidthInTiles * subresourceTilings[mip].HeightInTiles);
+            mipTileCount += mipTileCounts.back();
+        }
+        isValid = mipTileCount == textureTiles.tileCount;
+    }
+
+    // The package lists the tiles smallest mip first, the residency map wants them largest mip first.
+    if (isValid)
+    {
+        streamed->tiles.resize(textureTiles.tileCount);
+        for (uint32_t tileIdx = 0; tileIdx < textureTiles.tileCount && isValid; tileIdx++)
+        {
+            const auto& tile = pTiles[tileIdx];
+            isValid = tile.mipLevel < textureTiles.standardMipCount
+                && tile.x < subresourceTilings[tile.mipLevel].WidthInTiles
+                && tile.y < subresourceTilings[tile.mipLevel].HeightInTiles;
+            if (isValid)
+            {
+                streamed->tiles[mipFirstTile[tile.mipLevel] + tile.y * subresourceTilings[tile.mipLevel].WidthInTiles + tile.x] = tile;
+            }
+        }
+    }
+
+    if (!isValid)
+    {
+        Trace("The device tiles the texture differently from the package, it's loaded whole: %s", name);
+        pResource->Release();
+        pStagingResource->Release();
+        return TileResidencyMap::c_InvalidTexture;
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    std::vector<uint32_t> pinnedSlots;
+    std::vector<TileResidencyMap::TileEviction> evictions;
+    const TextureId textureId = m_residency.AddTexture(mipTileCounts, packedMipInfo.NumTilesForPackedMips, pinnedSlots, evictions);
+    if (textureId == TileResidencyMap::c_InvalidTexture)
+    {
+        Trace("The tile pool has no room for the packed mips, the texture is loaded whole: %s", name);
+        pResource->Release();
+        pStagingResource->Release();
+        return TileResidencyMap::c_InvalidTexture;
+    }
+
+    for (const auto& eviction : evictions)
+    {
+        const auto& evictedTexture = *m_textures[eviction.texture];
+        MapTile(evictedTexture.pResource, evictedTexture.tiles[eviction.tile], TileResidencyMap::c_InvalidSlot);
+    }
+
+    // The packed mips stay mapped for as long as the texture lives.
+    if (packedMipInfo.NumTilesForPackedMips > 0)
+    {
+        const D3D12_TILED_RESOURCE_COORDINATE coordinate{ 0, 0, 0, packedMipInfo.NumStandardMips };
+        const D3D12_TILE_REGION_SIZE regionSize{ packedMipInfo.NumTilesForPackedMips, FALSE, 0, 0, 0 };
+        const std::vector<D3D12_TILE_RANGE_FLAGS> rangeFlags(pinnedSlots.size(), D3D12_TILE_RANGE_FLAG_NONE);
+        const std::vector<UINT> rangeTileCounts(pinnedSlots.size(), 1);
+        m_pGraphicsQueue->UpdateTileMappings(pResource, 1, &coordinate, &regionSize, m_pPoolHeap, static_cast<UINT>(pinnedSlots.size()), rangeFlags.data(), pinnedSlots.data(), rangeTileCounts.data(), D3D12_TILE_MAPPING_FLAG_NONE);
+    }
+    ThrowIfFailed(m_pGraphicsQueue->Signal(m_pMapFence, ++m_mapFenceValue));
+    const uint64_t mapFenceValue = m_mapFenceValue;
+
+    pFile->AddRef();
+    streamed->pResource = pResource;
+    streamed->pStagingResource = pStagingResource;
+    streamed->pFile = pFile;
+    streamed->name = name;
+    streamed->size = static_cast<uint32_t>(max(reservedDesc.Width, static_cast<uint64_t>(reservedDesc.Height)));
+    if (textureId >= m_textures.size())
+    {
+        m_textures.resize(textureId + 1);
+    }
+    m_textures[textureId] = std::move(streamed);
+    lock.unlock();
+
+    // The caller reads the packed mips right away, they need their memory first.
+    ThrowIfFailed(m_pMapFence->SetEventOnCompletion(mapFenceValue, nullptr));
+
+    *ppResourceOut = pResource;
+    return textureId;
+}
+
+void TiledTextureStreamer::DestroyTexture(TextureId texture)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    // No new tiles are picked for it from here on, except for ones requested earlier this frame.
+    m_textures[texture]->isDestroying = true;
+    while (true)
+    {
+        // Mapped tiles that haven't been read yet are dropped, reads in flight are waited for.
+        for (auto& batch : m_mappedTiles)
+        {
+            auto dropped = std::remove_if(batch.loads.begin(), batch.loads.end(), [texture](const TileResidencyMap::TileLoad& load) { return load.texture == texture; });
+            for (auto loadItr = dropped; loadItr != batch.loads.end(); ++loadItr)
+            {
+                m_residency.OnTileLoaded(texture, loadItr->tile);
+            }
+            batch.loads.erase(dropped, batch.loads.end());
+        }
+
+        if (!m_residency.IsLoading(texture))
+        {
+            break;
+        }
+
+        const uint64_t readFenceValue = m_readFenceValue;
+        lock.unlock();
+        ThrowIfFailed(m_pReadFence->SetEventOnCompletion(readFenceValue, nullptr));
+        lock.lock();
+        RetireReads();
+    }
+
+    m_residency.RemoveTexture(texture);
+    m_textures[texture]->pFile->Release();
+    ID3D12Resource* pStagingResource = m_textures[texture]->pStagingResource;
+    m_textures[texture].reset();
+
+    // Mappings still queued on the graphics queue use the resources.
+    const uint64_t mapFenceValue = m_mapFenceValue;
+    lock.unlock();
+    ThrowIfFailed(m_pMapFence->SetEventOnCompletion(mapFenceValue, nullptr));
+    pStagingResource->Release();
+}
+
+void TiledTextureStreamer::RequestMip(TextureId texture, uint32_t mip)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_textures[texture]->isDestroying)
+    {
+        m_residency.RequestMip(texture, mip);
+    }
+}
+
+uint32_t TiledTextureStreamer::GetTextureSize(TextureId texture)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_textures[texture]->size;
+}
+
+void TiledTextureStreamer::Update()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    RetireReads();
+
+    // Tiles whose staging mapping has executed are read.
+    const uint64_t mappedFenceValue = m_pMapFence->GetCompletedValue();
+    TileBatch readBatch;
+    while (!m_mappedTiles.empty() && m_mappedTiles.front().fenceValue <= mappedFenceValue)
+    {
+        for (const auto& load : m_mappedTiles.front().loads)
+        {
+            const auto& texture = *m_textures[load.texture];
+            const auto& tile = texture.tiles[load.tile];
+
+            DSTORAGE_REQUEST req = {};
+            req.Options.CompressionFormat = tile.compressionFormat;
+            req.Options.SourceType = DSTORAGE_REQUEST_SOURCE_FILE;
+            req.Options.DestinationType = DSTORAGE_REQUEST_DESTINATION_TILES;
+            req.Source.File.Source = texture.pFile;
+            req.Source.File.Offset = tile.offset;
+            req.Source.File.Size = tile.sizeCompressed;
+            req.Destination.Tiles.Resource = texture.pStagingResource;
+            req.Destination.Tiles.TiledRegionStartCoordinate = { tile.x, tile.y, 0, tile.mipLevel };
+            req.Destination.Tiles.TileRegionSize = { 1, FALSE, 0, 0, 0 };
+            req.UncompressedSize = D3D12_TILED_RESOURCE_TILE_SIZE_IN_BYTES;
+            req.Name = texture.name.c_str();
+            m_pSubmitThread->EnqueueRequest(m_queueIndex, req);
+
+            m_bytesRead += tile.sizeCompressed;
+            readBatch.loads.push_back(load);
+        }
+        m_mappedTiles.pop_front();
+    }
+
+    if (!readBatch.loads.empty())
+    {
+        readBatch.fenceValue = ++m_readFenceValue;
+        m_pSubmitThread->EnqueueSignal(m_queueIndex, m_pReadFence, readBatch.fenceValue);
+        m_pSubmitThread->Flush(m_queueIndex);
+        m_readTiles.push_back(std::move(readBatch));
+    }
+
+    // Map the next tiles into their staging resources, they're read once the graphics queue gets to the mappings.
+    // An evicted slot is unmapped from its old texture first, the frames submitted before stop sampling it before the read starts.
+    m_residency.Update(c_MaxTileLoadsPerFrame, m_loads, m_evictions);
+    for (const auto& eviction : m_evictions)
+    {
+        const auto& texture = *m_textures[eviction.texture];
+        MapTile(texture.pResource, texture.tiles[eviction.tile], TileResidencyMap::c_InvalidSlot);
+    }
+    for (const auto& load : m_loads)
+    {
+        const auto& texture = *m_textures[load.texture];
+        MapTile(texture.pStagingResource, texture.tiles[load.tile], load.slot);
+    }
+
+    if (!m_loads.empty() || !m_evictions.empty())
+    {
+        ThrowIfFailed(m_pGraphicsQueue->Signal(m_pMapFence, ++m_mapFenceValue));
+        if (!m_loads.empty())
+        {
+            m_mappedTiles.push_back({ m_mapFenceValue, m_loads });
+        }
+    }
+}
+
+TiledTextureStreamer::Stats TiledTextureStreamer::GetStats()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    Stats stats;
+    stats.residency = m_residency.GetStats();
+    stats.textureCount = static_cast<uint32_t>(std::count_if(m_textures.cbegin(), m_textures.cend(), [](const std::unique_ptr<StreamedTexture>& pTexture) { return pTexture != nullptr; }));
+    stats.bytesRead = m_bytesRead;
+    return stats;
+}
+
+void TiledTextureStreamer::MapTile(ID3D12Resource* pResource, const DirectStorageSampleTile& tile, uint32_t slot)
+{
+    const D3D12_TILED_RESOURCE_COORDINATE coordinate{ tile.x, tile.y, 0, tile.mipLevel };
+    const D3D12_TILE_REGION_SIZE regionSize{ 1, FALSE, 0, 0, 0 };
+    const D3D12_TILE_RANGE_FLAGS rangeFlags = slot == TileResidencyMap::c_InvalidSlot ? D3D12_TILE_RANGE_FLAG_NULL : D3D12_TILE_RANGE_FLAG_NONE;
+    const UINT rangeTileCount = 1;
+    m_pGraphicsQueue->UpdateTileMappings(pResource, 1, &coordinate, &regionSize, m_pPoolHeap, 1, &rangeFlags, &slot, &rangeTileCount, D3D12_TILE_MAPPING_FLAG_NONE);
+}
+
+// Caller holds m_mutex.
+void TiledTextureStreamer::RetireReads()
+{
+    // The read tiles go into their textures. Frames submitted from here on come after the mappings on the graphics queue, so they see the tile's data.
+    // The staging mapping is left as it is, nothing samples it and the slot's next read maps it again.
+    bool isMapped = false;
+    const uint64_t completedFenceValue = m_pReadFence->GetCompletedValue();
+    while (!m_readTiles.empty() && m_readTiles.front().fenceValue <= completedFenceValue)
+    {
+        for (const auto& load : m_readTiles.front().loads)
+        {
+            const auto& texture = *m_textures[load.texture];
+            MapTile(texture.pResource, texture.tiles[load.tile], load.slot);
+            m_residency.OnTileLoaded(load.texture, load.tile);
+            isMapped = true;
+        }
+        m_readTiles.pop_front();
+    }
+
+    if (isMapped)
+    {
+        ThrowIfFailed(m_pGraphicsQueue->Signal(m_pMapFence, ++m_mapFenceValue));
+    }
+}
@@ -0,0 +1,113 @@
+// AMD SampleDX12 sample code
+// 
+// Copyright(c) 2023 Advanced Micro Devices, Inc.All rights reserved.
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+#include <deque>
+#include <memory>
+#include <dstorage.h>
+#include "DStorageSubmitThread.h"
+#include "DirectStorageSampleTexturePackageFormat.h"
+#include "TileResidencyMap.h"
+
+// Streams the tiles of reserved textures into one pool heap as the residency map asks for them.
+// A tile is read through a staging reserved resource that nothing samples, its slot is mapped there on the graphics queue and read once the mapping has executed.
+// The texture only gets the slot once the read is done, until then the tile stays unmapped and reads as zero.
+// Thread safe, textures are created and destroyed by the loading threads while the main thread updates.
+class TiledTextureStreamer
+{
+public:
+    using TextureId = TileResidencyMap::TextureId;
+
+    struct Stats
+    {
+        TileResidencyMap::Stats residency;
+        uint32_t textureCount = 0;
+        uint64_t bytesRead = 0; // Compressed, tiles only.
+    };
+
+    // Returns false if the device can't stream tiles. Unmapped tiles have to read as zero, which needs tier 2 tiled resources.
+    // Tiles are read on the submit thread's queue queueIndex.
+    bool OnCreate(ID3D12Device* pDevice, ID3D12CommandQueue* pGraphicsQueue, DStorageSubmitThread* pSubmitThread, uint32_t queueIndex, uint64_t poolSize);
+    // Every texture must be destroyed.
+    void OnDestroy();
+
+    // Creates the reserved resource and maps its packed mips, the caller reads them. The tiles are read from pFile as they're requested.
+    // Returns TileResidencyMap::c_InvalidTexture and no resource if the device tiles the texture differently from the package, or the pool is full.
+    TextureId CreateTexture(const D3D12_RESOURCE_DESC& resourceDesc, const DirectStorageSampleTextureTiles& textureTiles, const DirectStorageSampleTile* pTiles, IDStorageFile* pFile, const char* name, ID3D12Resource** ppResourceOut);
+    // Waits for the texture's tiles in flight. The GPU must be done with the resource, which the caller releases.
+    void DestroyTexture(TextureId texture);
+
+    // The texture is seen at a size that needs this mip this frame, see TileResidencyMap::RequestMip.
+    void RequestMip(TextureId texture, uint32_t mip);
+    // Width or height of mip 0, whichever is larger.
+    uint32_t GetTextureSize(TextureId texture);
+
+    // Once per frame. Maps the tiles that have been read into their textures, reads the ones whose staging mapping has executed and maps the next ones.
+    void Update();
+
+    Stats GetStats();
+
+private:
+    // 4MiB of tiles mapped per frame.
+    static constexpr uint32_t c_MaxTileLoadsPerFrame = 64;
+
+    struct StreamedTexture
+    {
+        ID3D12Resource* pResource = nullptr;
+        ID3D12Resource* pStagingResource = nullptr; // Same tiling as pResource, tiles are read through it.
+        IDStorageFile* pFile = nullptr; // Holds a reference, the scene's metadata may be evicted while the texture lives.
+        std::string name;
+        uint32_t size = 0;
+        std::vector<DirectStorageSampleTile> tiles; // Indexed like the residency map's tiles, mip 0 first and row by row.
+        bool isDestroying = false;
+    };
+
+    // Loads waiting for their fence, in fence order.
+    struct TileBatch
+    {
+        uint64_t fenceValue = 0;
+        std::vector<TileResidencyMap::TileLoad> loads;
+    };
+
+    void MapTile(ID3D12Resource* pResource, const DirectStorageSampleTile& tile, uint32_t slot);
+    void RetireReads();
+
+    std::mutex m_mutex;
+    ID3D12Device* m_pDevice = nullptr;
+    ID3D12CommandQueue* m_pGraphicsQueue = nullptr;
+    DStorageSubmitThread* m_pSubmitThread = nullptr;
+    uint32_t m_queueIndex = 0;
+    ID3D12Heap* m_pPoolHeap = nullptr;
+    ID3D12Fence* m_pMapFence = nullptr; // Signalled on the graphics queue after the staging mappings.
+    ID3D12Fence* m_pReadFence = nullptr; // Signalled on the DirectStorage queue after the reads.
+    uint64_t m_mapFenceValue = 0;
+    uint64_t m_readFenceValue = 0;
+
+    TileResidencyMap m_residency;
+    std::vector<std::unique_ptr<StreamedTexture>> m_textures; // Indexed by texture id. Not moved when it grows, reads in flight point at the names.
+    std::deque<TileBatch> m_mappedTiles;
+    std::deque<TileBatch> m_readTiles;
+    uint64_t m_bytesRead = 0;
+
+    // Scratch, kept to avoid allocating every frame.
+    std::vector<TileResidencyMap::TileLoad> m_loads;
+    std::vector<TileResidencyMap::TileEviction> m_evictions;
+};
@@ -20,6 +20,7 @@
 #include "stdafx.h"
 #include "UI.h"
 #include "DirectStorageSample.h"
+#include "GLTFTextureAndBuffersDirectStorage.h"
 #include "imgui.h"
 #include "base/FrameworkWindows.h"
 
@@ -292,6 +293,58 @@ void DirectStorageSample::BuildUI()
         ImGui::Spacing();
         ImGui::Spacing();
 
+        if (ImGui::CollapsingHeader("Scene Residency", ImGuiTreeNodeFlags_DefaultOpen))
+        {
+            ImGui::Text("Resident (MiB): %7.2f", m_residencyManager.GetResidentBytes() / 1024.0 / 1024.0);
+            if (m_residencyManager.GetBudget() != UINT64_MAX)
+            {
+                ImGui::Text("Budget (MiB): %7.2f", m_residencyManager.GetBudget() / 1024.0 / 1024.0);
+            }
+
+            const auto& loadScheduler = m_pRenderer->GetLoadScheduler();
+            ImGui::Text("Loads Running: %u/%u, Pending: %u", loadScheduler.GetRunningLoadCount(), loadScheduler.GetMaxConcurrentLoads(), loadScheduler.GetPendingLoadCount());
+
+            // Reads that found their queue full, see queuelength. The queues are created by the async init.
+            if (m_sampleOptions.ioOptions.m_useDirectStorage && IsStreamingReady())
+            {
+                const auto enqueueStats = Sample::DStorageGetEnqueueStats();
+                ImGui::Text("Enqueue Waiting: %u (max %u), Deferred: %llu", enqueueStats.waitingCommands, enqueueStats.maxWaitingCommands, enqueueStats.deferredCommands);
+
+                // Mean batch sizes, see submitthreshold, submitbytes and submitlatencyms.
+                const auto submitStats = Sample::DStorageGetSubmitStats();
+                const double submits = static_cast<double>(max(submitStats.submits, 1ull));
+                ImGui::Text("Submits: %llu, Batch: %.1f requests, %.2f MiB mean, %u requests, %.2f MiB max", submitStats.submits, submitStats.requests / submits
+                    , submitStats.bytes / 1024.0 / 1024.0 / submits, submitStats.maxBatchRequests, submitStats.maxBatchBytes / 1024.0 / 1024.0);
+                ImGui::Text("Submitted By: %llu requests, %llu bytes, %llu latency, %llu flush", submitStats.submitsByReason[static_cast<uint32_t>(SubmitReason::Requests)]
+                    , submitStats.submitsByReason[static_cast<uint32_t>(SubmitReason::Bytes)], submitStats.submitsByReason[static_cast<uint32_t>(SubmitReason::Latency)]
+                    , submitStats.submitsByReason[static_cast<uint32_t>(SubmitReason::Flush)]);
+            }
+
+            // Read rate is per load, loads in the same class overlap.
+            if (m_sampleOptions.ioOptions.m_useDirectStorage && m_sampleOptions.ioOptions.m_usePriorityQueues)
+            {
+                const auto ioPriorityStats = Sample::DStorageGetIOPriorityStats();
+                for (uint32_t priorityClass = 0; priorityClass < Sample::IOPriorityClass_Count; priorityClass++)
+                {
+                    const auto& stats = ioPriorityStats[priorityClass];
+                    ImGui::Text("%-6s I/O: %u in flight, %llu done, %7.2f MiB/s, %7.2f ms mean, %7.2f ms max", Sample::GetIOPriorityClassName(static_cast<Sample::IOPriorityClass>(priorityClass))
+                        , stats.inFlight, stats.loads, stats.totalLatency > 0.0 ? stats.bytes / 1024.0 / 1024.0 / (stats.totalLatency / 1000.0) : 0.0
+                        , stats.loads > 0 ? stats.totalLatency / stats.loads : 0.0, stats.maxLatency);
+                }
+            }
+
+            if (m_sampleOptions.ioOptions.m_useDirectStorage && m_sampleOptions.ioOptions.m_useTiledTextures)
+            {
+                const auto tiledTextureStats = Sample::DStorageGetTiledTextureStats();
+                ImGui::Text("Tiled Textures: %u, Tiles: %u resident, %u loading, %u packed, %u slots", tiledTextureStats.textureCount
+                    , tiledTextureStats.residentTiles, tiledTextureStats.loadingTiles, tiledTextureStats.pinnedSlots, tiledTextureStats.slotCount);
+                ImGui::Text("Tiles Loaded: %llu, Evicted: %llu, Read (MiB): %7.2f", tiledTextureStats.loads, tiledTextureStats.evictions, tiledTextureStats.bytesRead / 1024.0 / 1024.0);
+            }
+        }
+
+        ImGui::Spacing();
+        ImGui::Spacing();
+
         if (ImGui::CollapsingHeader("Scene Loading Timings", ImGuiTreeNodeFlags_DefaultOpen))
         {
             const auto sceneLoadingTimings = m_pRenderer->GetSceneLoadingTimings();
@@ -301,9 +354,17 @@ void DirectStorageSample::BuildUI()
                 const auto& sceneTime = *sceneTimePtr;
                 ImGui::Text("Scene Name: %s", sceneTime.loadRequest.m_sceneName->c_str());
                 ImGui::Text("CPU Load Time: %7.2f ms", sceneTime.loadTime);
+                ImGui::Text("Time To First Pixel: %7.2f ms", sceneTime.timeToFirstPixel);
+                if (sceneTime.loadTime == 0.0 && sceneTime.loadRequest.m_useDirectStorage)
+                {
+                    // A progressive scene drawn with placeholders, its textures are still being read.
+                    const auto textureProgress = Sample::DStorageGetWorkloadTextureProgress(sceneTime.loadRequest.workloadId);
+                    ImGui::Text("Textures Read: %u/%u", textureProgress.first, textureProgress.second);
+                }
                 if (sceneTime.ioTime > 0) ImGui::Text("IoTime: %7.2f ms", sceneTime.ioTime);
                 ImGui::Text("DirectStorage: %s", sceneTime.loadRequest.m_useDirectStorage ? "On" : "Off");
                 ImGui::Text("Placed Resources: %s", sceneTime.loadRequest.m_usePlacedResources ? "On" : "Off");
+                if (sceneTime.loadRequest.m_useDirectStorage) ImGui::Text("Texture Source: %s", sceneTime.payloadFromMemory ? "Payload Cache" : "File");
                 ImGui::Text("Texture File Size (MiB): %7.2f", sceneTime.sceneTextureFileDataSize/1024.0/1024.0);
 
                 if (sceneTime.ioTime > 0)
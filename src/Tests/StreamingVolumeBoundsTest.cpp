@@ -0,0 +1,292 @@
+// AMD SampleDX12 sample code
+// 
+// Copyright(c) 2023 Advanced Micro Devices, Inc.All rights reserved.
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+
+
+// Checks the streaming volume bounds kernels on the CPU against each other. Returns non zero on the first failed check.
+// Run with --benchmark <volume count> to time the kernels instead.
+
+#include "StreamingVolumeBounds.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#define CHECK(condition) \
+    do \
+    { \
+        if (!(condition)) \
+        { \
+            std::printf("%s(%d): check failed: %s\n", __FILE__, __LINE__, #condition); \
+            return false; \
+        } \
+    } while (0)
+
+using Kernel = StreamingVolumeBounds::Kernel;
+
+// Written past the end of the outputs, the kernels must leave it alone.
+static constexpr uint8_t c_InsideGuard = 0xCD;
+static constexpr float c_DistanceGuard = 12345.0f;
+static constexpr size_t c_GuardCount = 16;
+
+// Volumes spread over a cube about as dense as the sample's.
+static void AddRandomVolumes(StreamingVolumeBounds& bounds, uint32_t volumeCount, std::mt19937& random)
+{
+    const float worldSize = 10.0f * std::cbrt(static_cast<float>(volumeCount));
+    std::uniform_real_distribution<float> position(-worldSize, worldSize);
+    std::uniform_real_distribution<float> size(0.5f, 5.0f);
+    for (uint32_t i = 0; i < volumeCount; i++)
+    {
+        const float center[3] = { position(random), position(random), position(random) };
+        const float radius[3] = { size(random), size(random), size(random) };
+        bounds.Add(center, radius);
+    }
+}
+
+static bool TestKnownBoxes()
+{
+    StreamingVolumeBounds bounds;
+    bounds.SetKernel(Kernel::Scalar);
+    const float center0[3] = { 0.0f, 0.0f, 0.0f };
+    const float radius0[3] = { 1.0f, 2.0f, 3.0f };
+    const float center1[3] = { 10.0f, 0.0f, 0.0f };
+    const float radius1[3] = { 1.0f, 1.0f, 1.0f };
+    CHECK(bounds.Add(center0, radius0) == 0);
+    CHECK(bounds.Add(center1, radius1) == 1);
+    CHECK(bounds.GetCount() == 2);
+
+    const float point[3] = { 0.5f, 0.0f, 0.0f };
+    uint8_t inside[2] = {};
+    bounds.TestContainment(point, 0.0f, inside);
+    CHECK(inside[0] == 1);
+    CHECK(inside[1] == 0);
+
+    // 8.5 away from the second box's face, a margin that big reaches it.
+    bounds.TestContainment(point, 8.5f, inside);
+    CHECK(inside[1] == 1);
+
+    float distances[2] = {};
+    bounds.GetSignedDistances(point, distances);
+    CHECK(distances[0] == -0.5f);
+    CHECK(distances[1] == 8.5f);
+
+    // Off a corner of the second box.
+    const float cornerPoint[3] = { 14.0f, 5.0f, 0.0f };
+    bounds.GetSignedDistances(cornerPoint, distances);
+    CHECK(std::fabs(distances[1] - 5.0f) < 1e-6f);
+
+    const uint32_t indices[1] = { 1 };
+    bounds.TestContainment(point, 0.0f, indices, 1, inside);
+    CHECK(inside[0] == 0);
+
+    bounds.Clear();
+    CHECK(bounds.GetCount() == 0);
+    return true;
+}
+
+// Every kernel the CPU can run has to give what the scalar one gives, for counts that leave a partial batch
+// of 8 and of 16, over the whole array and through index lists.
+static bool TestKernelsAgree()
+{
+    const Kernel bestKernel = StreamingVolumeBounds::GetBestKernel();
+    std::printf("Best kernel: %s\n", StreamingVolumeBounds::GetKernelName(bestKernel));
+
+    std::mt19937 random(7);
+    const uint32_t volumeCounts[] = { 1, 5, 8, 13, 16, 17, 31, 47, 100, 1001 };
+    for (const uint32_t volumeCount : volumeCounts)
+    {
+        StreamingVolumeBounds bounds;
+        AddRandomVolumes(bounds, volumeCount, random);
+
+        // Any order, repeats, and the last volume, with a length that's not a multiple of 8.
+        std::uniform_int_distribution<uint32_t> volumeIndex(0, volumeCount - 1);
+        std::vector<uint32_t> indices(volumeCount + 3);
+        for (auto& index : indices)
+        {
+            index = volumeIndex(random);
+        }
+        indices.back() = volumeCount - 1;
+
+        const float worldSize = 10.0f * std::cbrt(static_cast<float>(volumeCount));
+        std::uniform_real_distribution<float> position(-worldSize, worldSize);
+        std::uniform_real_distribution<float> margin(0.0f, 10.0f);
+        for (int pointIdx = 0; pointIdx < 20; pointIdx++)
+        {
+            const float point[3] = { position(random), position(random), position(random) };
+            const float pointMargin = margin(random);
+
+            std::vector<uint8_t> expectedInside;
+            std::vector<float> expectedDistances;
+            std::vector<uint8_t> expectedIndexedInside;
+            std::vector<float> expectedIndexedDistances;
+            for (int kernel = 0; kernel <= static_cast<int>(bestKernel); kernel++)
+            {
+                bounds.SetKernel(static_cast<Kernel>(kernel));
+                CHECK(bounds.GetKernel() == static_cast<Kernel>(kernel));
+
+                std::vector<uint8_t> inside(volumeCount + c_GuardCount, c_InsideGuard);
+                std::vector<float> distances(volumeCount + c_GuardCount, c_DistanceGuard);
+                std::vector<uint8_t> indexedInside(indices.size() + c_GuardCount, c_InsideGuard);
+                std::vector<float> indexedDistances(indices.size() + c_GuardCount, c_DistanceGuard);
+                bounds.TestContainment(point, pointMargin, inside.data());
+                bounds.GetSignedDistances(point, distances.data());
+                bounds.TestContainment(point, pointMargin, indices.data(), indices.size(), indexedInside.data());
+                bounds.GetSignedDistances(point, indices.data(), indices.size(), indexedDistances.data());
+
+                for (size_t i = 0; i < c_GuardCount; i++)
+                {
+                    CHECK(inside[volumeCount + i] == c_InsideGuard);
+                    CHECK(distances[volumeCount + i] == c_DistanceGuard);
+                    CHECK(indexedInside[indices.size() + i] == c_InsideGuard);
+                    CHECK(indexedDistances[indices.size() + i] == c_DistanceGuard);
+                }
+                inside.resize(volumeCount);
+                distances.resize(volumeCount);
+                indexedInside.resize(indices.size());
+                indexedDistances.resize(indices.size());
+
+                if (kernel == static_cast<int>(Kernel::Scalar))
+                {
+                    expectedInside = inside;
+                    expectedDistances = distances;
+                    expectedIndexedInside = indexedInside;
+                    expectedIndexedDistances = indexedDistances;
+
+                    // The indexed results are the plain ones looked up.
+                    for (size_t i = 0; i < indices.size(); i++)
+                    {
+                        CHECK(indexedInside[i] == inside[indices[i]]);
+                        CHECK(indexedDistances[i] == distances[indices[i]]);
+                    }
+                    continue;
+                }
+
+                // The containment tests are exact. The distances may differ in the last bits, AVX-512 uses fused multiply adds.
+                CHECK(inside == expectedInside);
+                CHECK(indexedInside == expectedIndexedInside);
+                for (size_t i = 0; i < volumeCount; i++)
+                {
+                    CHECK(std::fabs(distances[i] - expectedDistances[i]) <= 1e-5f * std::fmax(1.0f, std::fabs(expectedDistances[i])));
+                    CHECK((distances[i] <= 0.0f) == (expectedDistances[i] <= 0.0f));
+                }
+                for (size_t i = 0; i < indices.size(); i++)
+                {
+                    CHECK(std::fabs(indexedDistances[i] - expectedIndexedDistances[i]) <= 1e-5f * std::fmax(1.0f, std::fabs(expectedIndexedDistances[i])));
+                }
+            }
+        }
+    }
+    return true;
+}
+
+// Times the kernels over volumeCount random volumes.
+static void Benchmark(uint32_t volumeCount)
+{
+    std::mt19937 random(1);
+    StreamingVolumeBounds bounds;
+    AddRandomVolumes(bounds, volumeCount, random);
+
+    // Every 8th volume, like a list of candidates from the grid.
+    std::vector<uint32_t> indices;
+    for (uint32_t i = 0; i < volumeCount; i += 8)
+    {
+        indices.push_back(i);
+    }
+
+    std::vector<uint8_t> inside(volumeCount);
+    std::vector<float> distances(volumeCount);
+    const int c_Repeats = 50;
+    const float eye[3] = { 0.0f, 0.0f, 0.0f };
+    auto millisecondsSince = [](std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    std::printf("Streaming volume bounds benchmark, %u volumes, %d repeats\n", volumeCount, c_Repeats);
+    for (int kernel = 0; kernel <= static_cast<int>(StreamingVolumeBounds::GetBestKernel()); kernel++)
+    {
+        bounds.SetKernel(static_cast<Kernel>(kernel));
+
+        uint32_t insideCount = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int repeat = 0; repeat < c_Repeats; repeat++)
+        {
+            bounds.TestContainment(eye, static_cast<float>(repeat), inside.data());
+            insideCount += inside[repeat % inside.size()];
+        }
+        const double containmentTime = millisecondsSince(start) / c_Repeats;
+
+        float distanceSum = 0.0f;
+        start = std::chrono::steady_clock::now();
+        for (int repeat = 0; repeat < c_Repeats; repeat++)
+        {
+            bounds.GetSignedDistances(eye, distances.data());
+            distanceSum += distances[repeat % distances.size()];
+        }
+        const double distanceTime = millisecondsSince(start) / c_Repeats;
+
+        start = std::chrono::steady_clock::now();
+        for (int repeat = 0; repeat < c_Repeats; repeat++)
+        {
+            bounds.TestContainment(eye, static_cast<float>(repeat), indices.data(), indices.size(), inside.data());
+            insideCount += inside[repeat % inside.size()];
+        }
+        const double indexedContainmentTime = millisecondsSince(start) / c_Repeats;
+
+        // The sums keep the work from being optimized away.
+        std::printf("%s: containment %.3f ms, signed distance %.3f ms, containment of %u indexed %.3f ms (%u, %.1f)\n",
+            StreamingVolumeBounds::GetKernelName(static_cast<Kernel>(kernel)), containmentTime, distanceTime,
+            static_cast<uint32_t>(indices.size()), indexedContainmentTime, insideCount, distanceSum);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc == 3 && std::string(argv[1]) == "--benchmark")
+    {
+        const uint32_t volumeCount = static_cast<uint32_t>(std::strtoul(argv[2], nullptr, 10));
+        if (volumeCount > 0)
+        {
+            Benchmark(volumeCount);
+        }
+        return 0;
+    }
+
+    const struct
+    {
+        const char* name;
+        bool (*run)();
+    } tests[] =
+    {
+        { "KnownBoxes", TestKnownBoxes },
+        { "KernelsAgree", TestKernelsAgree },
+    };
+
+    int failedCount = 0;
+    for (const auto& test : tests)
+    {
+        const bool passed = test.run();
+        std::printf("%s: %s\n", test.name, passed ? "passed" : "FAILED");
+        failedCount += passed ? 0 : 1;
+    }
+
+    return failedCount;
+}
@@ -0,0 +1,386 @@
+// AMD SampleDX12 sample code
+// 
+// Copyright(c) 2023 Advanced Micro Devices, Inc.All rights reserved.
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+
+
+// Checks the tile residency map on the CPU, it doesn't need a device. Returns non zero on the first failed check.
+
+#include "TileResidencyMap.h"
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <random>
+
+#define CHECK(condition) \
+    do \
+    { \
+        if (!(condition)) \
+        { \
+            std::printf("%s(%d): check failed: %s\n", __FILE__, __LINE__, #condition); \
+            return false; \
+        } \
+    } while (0)
+
+using TextureId = TileResidencyMap::TextureId;
+
+static bool TestLoadSmallestMipsFirst()
+{
+    // Mip 0 has 4 tiles, mip 1 has 1, the rest are packed into 1 slot.
+    TileResidencyMap residency(16);
+    std::vector<uint32_t> pinnedSlots;
+    std::vector<TileResidencyMap::TileEviction> evictions;
+    const TextureId texture = residency.AddTexture({ 4, 1 }, 1, pinnedSlots, evictions);
+    CHECK(texture != TileResidencyMap::c_InvalidTexture);
+    CHECK(pinnedSlots.size() == 1);
+    CHECK(evictions.empty());
+    CHECK(residency.GetStats().pinnedSlots == 1);
+    CHECK(residency.GetResidentMip(texture) == 2);
+
+    // Only one load a frame, the mip 1 tile comes before those of mip 0.
+    std::vector<TileResidencyMap::TileLoad> loads;
+    residency.RequestMip(texture, 0);
+    residency.Update(1, loads, evictions);
+    CHECK(loads.size() == 1);
+    CHECK(residency.GetMipOfTile(texture, loads[0].tile) == 1);
+    CHECK(loads[0].slot != pinnedSlots[0]);
+    CHECK(residency.IsLoading(texture));
+
+    residency.OnTileLoaded(texture, loads[0].tile);
+    CHECK(!residency.IsLoading(texture));
+    CHECK(residency.GetResidentMip(texture) == 1);
+
+    residency.RequestMip(texture, 0);
+    residency.Update(8, loads, evictions);
+    CHECK(loads.size() == 4);
+    for (const auto& load : loads)
+    {
+        CHECK(residency.GetMipOfTile(texture, load.tile) == 0);
+        residency.OnTileLoaded(texture, load.tile);
+    }
+    CHECK(residency.GetResidentMip(texture) == 0);
+    CHECK(residency.GetStats().residentTiles == 5);
+    CHECK(residency.GetStats().loads == 5);
+
+    residency.RemoveTexture(texture);
+    CHECK(residency.GetStats().residentTiles == 0);
+    CHECK(residency.GetStats().pinnedSlots == 0);
+    return true;
+}
+
+static bool TestEvictUnwantedTiles()
+{
+    // The pool fits the first texture's tiles and pinned slot, and the second one's pinned slot.
+    TileResidencyMap residency(6);
+    std::vector<uint32_t> pinnedSlots;
+    std::vector<TileResidencyMap::TileEviction> evictions;
+    std::vector<TileResidencyMap::TileLoad> loads;
+    const TextureId first = residency.AddTexture({ 4 }, 1, pinnedSlots, evictions);
+    const TextureId second = residency.AddTexture({ 4 }, 1, pinnedSlots, evictions);
+    CHECK(first != TileResidencyMap::c_InvalidTexture && second != TileResidencyMap::c_InvalidTexture);
+
+    residency.RequestMip(first, 0);
+    residency.Update(8, loads, evictions);
+    CHECK(loads.size() == 4);
+    for (const auto& load : loads)
+    {
+        residency.OnTileLoaded(first, load.tile);
+    }
+
+    // Still wanted, nothing can go.
+    residency.RequestMip(first, 0);
+    residency.RequestMip(second, 0);
+    residency.Update(8, loads, evictions);
+    CHECK(loads.empty());
+    CHECK(evictions.empty());
+
+    // Not wanted any more, its tiles make room for the second texture's.
+    residency.RequestMip(second, 0);
+    residency.Update(8, loads, evictions);
+    CHECK(loads.size() == 4);
+    CHECK(evictions.size() == 4);
+    for (size_t i = 0; i < loads.size(); i++)
+    {
+        CHECK(evictions[i].texture == first);
+        CHECK(loads[i].texture == second);
+        CHECK(evictions[i].slot == loads[i].slot);
+    }
+    CHECK(residency.GetStats().evictions == 4);
+    CHECK(residency.GetStats().residentTiles == 0);
+    CHECK(residency.GetStats().loadingTiles == 4);
+    CHECK(residency.GetResidentMip(first) == 1);
+    return true;
+}
+
+static bool TestPinnedSlotsDontFit()
+{
+    TileResidencyMap residency(4);
+    std::vector<uint32_t> pinnedSlots;
+    std::vector<TileResidencyMap::TileEviction> evictions;
+    const TextureId first = residency.AddTexture({ 1 }, 3, pinnedSlots, evictions);
+    CHECK(first != TileResidencyMap::c_InvalidTexture);
+
+    // Pinned slots are never evicted.
+    const TextureId second = residency.AddTexture({ 1 }, 2, pinnedSlots, evictions);
+    CHECK(second == TileResidencyMap::c_InvalidTexture);
+    CHECK(pinnedSlots.empty());
+    CHECK(residency.GetStats().pinnedSlots == 3);
+    return true;
+}
+
+// Random adds, removes, requests and loads against a model of every tile, checking the map hands out each slot once.
+static bool TestRandom()
+{
+    enum class TileState
+    {
+        NotResident,
+        Loading,
+        Resident
+    };
+
+    struct ModelTexture
+    {
+        std::vector<uint32_t> mipFirstTile;
+        std::vector<TileState> tiles;
+        std::vector<uint32_t> slots;
+        std::vector<uint32_t> pinnedSlots;
+        uint32_t requestedMip = TileResidencyMap::c_NoMip; // This frame.
+    };
+
+    // Slot to what holds it, pinned slots have the tile c_InvalidSlot.
+    struct SlotOwner
+    {
+        TextureId texture;
+        uint32_t tile;
+    };
+
+    const uint32_t slotCount = 96;
+    TileResidencyMap residency(slotCount);
+    std::map<TextureId, ModelTexture> textures;
+    std::map<uint32_t, SlotOwner> usedSlots;
+    TileResidencyMap::Stats expectedStats;
+    expectedStats.slotCount = slotCount;
+
+    std::mt19937 random(1234);
+    std::vector<uint32_t> pinnedSlots;
+    std::vector<TileResidencyMap::TileEviction> evictions;
+    std::vector<TileResidencyMap::TileLoad> loads;
+
+    // Takes an evicted tile's slot back in the model.
+    auto applyEviction = [&](const TileResidencyMap::TileEviction& eviction) -> bool
+    {
+        CHECK(textures.count(eviction.texture) == 1);
+        ModelTexture& texture = textures[eviction.texture];
+        CHECK(eviction.tile < texture.tiles.size());
+        CHECK(texture.tiles[eviction.tile] == TileState::Resident);
+        CHECK(texture.slots[eviction.tile] == eviction.slot);
+        CHECK(usedSlots.count(eviction.slot) == 1);
+        CHECK(usedSlots[eviction.slot].texture == eviction.texture && usedSlots[eviction.slot].tile == eviction.tile);
+        texture.tiles[eviction.tile] = TileState::NotResident;
+        texture.slots[eviction.tile] = TileResidencyMap::c_InvalidSlot;
+        usedSlots.erase(eviction.slot);
+        expectedStats.residentTiles--;
+        expectedStats.evictions++;
+        return true;
+    };
+
+    for (uint32_t frame = 0; frame < 20000; frame++)
+    {
+        // Add a texture now and then, up to a few mips of shrinking tile counts.
+        if (textures.size() < 12 && random() % 4 == 0)
+        {
+            const uint32_t mipCount = 1 + random() % 4;
+            std::vector<uint32_t> mipTileCounts;
+            for (uint32_t mip = 0; mip < mipCount; mip++)
+            {
+                mipTileCounts.push_back(std::max(1u, (16u >> (2 * mip)) + static_cast<uint32_t>(random() % 2)));
+            }
+            const uint32_t pinnedSlotCount = random() % 3;
+
+            const TextureId textureId = residency.AddTexture(mipTileCounts, pinnedSlotCount, pinnedSlots, evictions);
+            for (const auto& eviction : evictions)
+            {
+                CHECK(applyEviction(eviction));
+            }
+
+            if (textureId == TileResidencyMap::c_InvalidTexture)
+            {
+                CHECK(evictions.empty());
+                CHECK(pinnedSlots.empty());
+            }
+            else
+            {
+                CHECK(textures.count(textureId) == 0);
+                CHECK(pinnedSlots.size() == pinnedSlotCount);
+
+                ModelTexture texture;
+                texture.mipFirstTile.push_back(0);
+                for (uint32_t tileCount : mipTileCounts)
+                {
+                    texture.mipFirstTile.push_back(texture.mipFirstTile.back() + tileCount);
+                }
+                texture.tiles.assign(texture.mipFirstTile.back(), TileState::NotResident);
+                texture.slots.assign(texture.mipFirstTile.back(), TileResidencyMap::c_InvalidSlot);
+                texture.pinnedSlots = pinnedSlots;
+                for (uint32_t slot : pinnedSlots)
+                {
+                    CHECK(slot < slotCount);
+                    CHECK(usedSlots.count(slot) == 0);
+                    usedSlots[slot] = { textureId, TileResidencyMap::c_InvalidSlot };
+                }
+                expectedStats.pinnedSlots += pinnedSlotCount;
+                textures[textureId] = std::move(texture);
+            }
+        }
+
+        // Remove one whose tiles aren't loading.
+        if (!textures.empty() && random() % 8 == 0)
+        {
+            auto textureItr = textures.begin();
+            std::advance(textureItr, random() % textures.size());
+            const ModelTexture& texture = textureItr->second;
+            if (!residency.IsLoading(textureItr->first))
+            {
+                for (size_t tile = 0; tile < texture.tiles.size(); tile++)
+                {
+                    CHECK(texture.tiles[tile] != TileState::Loading);
+                    if (texture.tiles[tile] == TileState::Resident)
+                    {
+                        usedSlots.erase(texture.slots[tile]);
+                        expectedStats.residentTiles--;
+                    }
+                }
+                for (uint32_t slot : texture.pinnedSlots)
+                {
+                    usedSlots.erase(slot);
+                }
+                expectedStats.pinnedSlots -= static_cast<uint32_t>(texture.pinnedSlots.size());
+                residency.RemoveTexture(textureItr->first);
+                textures.erase(textureItr);
+            }
+        }
+
+        // Some textures ask for a mip, some twice.
+        for (auto& texture : textures)
+        {
+            const uint32_t mipCount = static_cast<uint32_t>(texture.second.mipFirstTile.size() - 1);
+            const uint32_t requestCount = random() % 3;
+            for (uint32_t request = 0; request < requestCount; request++)
+            {
+                const uint32_t mip = random() % (mipCount + 1); // One past the last mip asks for the smallest.
+                residency.RequestMip(texture.first, mip);
+                texture.second.requestedMip = std::min(texture.second.requestedMip, std::min(mip, mipCount - 1));
+            }
+        }
+
+        residency.Update(random() % 24, loads, evictions);
+
+        // Evictions only take tiles nobody asked for this frame.
+        for (const auto& eviction : evictions)
+        {
+            const ModelTexture& texture = textures[eviction.texture];
+            const uint32_t mip = residency.GetMipOfTile(eviction.texture, eviction.tile);
+            CHECK(texture.requestedMip == TileResidencyMap::c_NoMip || mip < texture.requestedMip);
+            CHECK(applyEviction(eviction));
+        }
+
+        for (const auto& load : loads)
+        {
+            CHECK(textures.count(load.texture) == 1);
+            ModelTexture& texture = textures[load.texture];
+            CHECK(load.tile < texture.tiles.size());
+            CHECK(texture.tiles[load.tile] == TileState::NotResident);
+            CHECK(texture.requestedMip != TileResidencyMap::c_NoMip && residency.GetMipOfTile(load.texture, load.tile) >= texture.requestedMip);
+            CHECK(load.slot < slotCount);
+            CHECK(usedSlots.count(load.slot) == 0);
+            usedSlots[load.slot] = { load.texture, load.tile };
+            texture.tiles[load.tile] = TileState::Loading;
+            texture.slots[load.tile] = load.slot;
+            expectedStats.loadingTiles++;
+            expectedStats.loads++;
+        }
+
+        for (auto& texture : textures)
+        {
+            texture.second.requestedMip = TileResidencyMap::c_NoMip;
+        }
+
+        // The reads finish in any order, some take a few frames.
+        for (auto& texture : textures)
+        {
+            for (uint32_t tile = 0; tile < texture.second.tiles.size(); tile++)
+            {
+                if (texture.second.tiles[tile] == TileState::Loading && random() % 3 == 0)
+                {
+                    residency.OnTileLoaded(texture.first, tile);
+                    texture.second.tiles[tile] = TileState::Resident;
+                    expectedStats.loadingTiles--;
+                    expectedStats.residentTiles++;
+                }
+            }
+        }
+
+        const auto& stats = residency.GetStats();
+        CHECK(stats.slotCount == expectedStats.slotCount);
+        CHECK(stats.pinnedSlots == expectedStats.pinnedSlots);
+        CHECK(stats.residentTiles == expectedStats.residentTiles);
+        CHECK(stats.loadingTiles == expectedStats.loadingTiles);
+        CHECK(stats.loads == expectedStats.loads);
+        CHECK(stats.evictions == expectedStats.evictions);
+        CHECK(usedSlots.size() == stats.pinnedSlots + stats.residentTiles + stats.loadingTiles);
+        CHECK(usedSlots.size() <= slotCount);
+
+        for (const auto& texture : textures)
+        {
+            // The largest mip whose tiles and all smaller ones are resident.
+            const ModelTexture& model = texture.second;
+            uint32_t residentMip = static_cast<uint32_t>(model.mipFirstTile.size() - 1);
+            while (residentMip > 0 && std::all_of(model.tiles.cbegin() + model.mipFirstTile[residentMip - 1], model.tiles.cbegin() + model.mipFirstTile[residentMip], [](TileState state) { return state == TileState::Resident; }))
+            {
+                residentMip--;
+            }
+            CHECK(residency.GetResidentMip(texture.first) == residentMip);
+        }
+    }
+
+    return true;
+}
+
+int main()
+{
+    const struct
+    {
+        const char* name;
+        bool (*run)();
+    } tests[] =
+    {
+        { "LoadSmallestMipsFirst", TestLoadSmallestMipsFirst },
+        { "EvictUnwantedTiles", TestEvictUnwantedTiles },
+        { "PinnedSlotsDontFit", TestPinnedSlotsDontFit },
+        { "Random", TestRandom },
+    };
+
+    int failedCount = 0;
+    for (const auto& test : tests)
+    {
+        const bool passed = test.run();
+        std::printf("%s: %s\n", test.name, passed ? "passed" : "FAILED");
+        failedCount += passed ? 0 : 1;
+    }
+
+    return failedCount;
+}
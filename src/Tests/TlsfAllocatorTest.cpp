@@ -0,0 +1,301 @@
+// AMD SampleDX12 sample code
+// 
+// Copyright(c) 2023 Advanced Micro Devices, Inc.All rights reserved.
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+
+
+// Checks the TLSF allocator on the CPU, it doesn't need a device. Returns non zero on the first failed check.
+
+#include "TlsfAllocator.h"
+#include <cstdio>
+#include <map>
+#include <random>
+
+#define CHECK(condition) \
+    do \
+    { \
+        if (!(condition)) \
+        { \
+            std::printf("%s(%d): check failed: %s\n", __FILE__, __LINE__, #condition); \
+            return false; \
+        } \
+    } while (0)
+
+static constexpr uint64_t c_KiB = 1024;
+static constexpr uint64_t c_MiB = 1024 * 1024;
+
+static bool TestAllocateAndFree()
+{
+    TlsfAllocator allocator(16 * c_MiB);
+    CHECK(allocator.GetSize() == 16 * c_MiB);
+    CHECK(allocator.IsEmpty());
+    CHECK(allocator.GetLargestFreeSize() == 16 * c_MiB);
+
+    uint64_t offset = UINT64_MAX;
+    const auto allocation = allocator.Allocate(64 * c_KiB, 64 * c_KiB, offset);
+    CHECK(allocation != TlsfAllocator::c_InvalidAllocation);
+    CHECK(offset == 0);
+    CHECK(allocator.GetOffset(allocation) == offset);
+    CHECK(allocator.GetAllocationSize(allocation) == 64 * c_KiB);
+    CHECK(allocator.GetUsedSize() == 64 * c_KiB);
+    CHECK(allocator.GetLargestFreeSize() == 16 * c_MiB - 64 * c_KiB);
+
+    allocator.Free(allocation);
+    CHECK(allocator.IsEmpty());
+    CHECK(allocator.GetLargestFreeSize() == 16 * c_MiB);
+    return true;
+}
+
+static bool TestSizeRounding()
+{
+    // The heap size is rounded down, requests are rounded up to whole blocks.
+    TlsfAllocator allocator(TlsfAllocator::c_MinBlockSize * 4 + 100);
+    CHECK(allocator.GetSize() == TlsfAllocator::c_MinBlockSize * 4);
+
+    uint64_t offset;
+    const auto empty = allocator.Allocate(0, 1, offset);
+    CHECK(empty != TlsfAllocator::c_InvalidAllocation);
+    CHECK(allocator.GetAllocationSize(empty) == TlsfAllocator::c_MinBlockSize);
+
+    const auto odd = allocator.Allocate(TlsfAllocator::c_MinBlockSize + 1, 1, offset);
+    CHECK(odd != TlsfAllocator::c_InvalidAllocation);
+    CHECK(allocator.GetAllocationSize(odd) == TlsfAllocator::c_MinBlockSize * 2);
+    CHECK(offset % TlsfAllocator::c_MinBlockSize == 0);
+
+    // Exactly what is left still fits, one more block doesn't.
+    CHECK(allocator.Allocate(TlsfAllocator::c_MinBlockSize * 2, TlsfAllocator::c_MinBlockSize, offset) == TlsfAllocator::c_InvalidAllocation);
+    const auto last = allocator.Allocate(TlsfAllocator::c_MinBlockSize, TlsfAllocator::c_MinBlockSize, offset);
+    CHECK(last != TlsfAllocator::c_InvalidAllocation);
+    CHECK(allocator.GetUsedSize() == allocator.GetSize());
+    CHECK(allocator.GetLargestFreeSize() == 0);
+    CHECK(allocator.Allocate(1, 1, offset) == TlsfAllocator::c_InvalidAllocation);
+
+    // Bigger than the whole heap, and an empty heap.
+    TlsfAllocator small(TlsfAllocator::c_MinBlockSize);
+    CHECK(small.Allocate(TlsfAllocator::c_MinBlockSize * 2, 1, offset) == TlsfAllocator::c_InvalidAllocation);
+    TlsfAllocator none(TlsfAllocator::c_MinBlockSize - 1);
+    CHECK(none.GetSize() == 0);
+    CHECK(none.GetLargestFreeSize() == 0);
+    CHECK(none.Allocate(1, 1, offset) == TlsfAllocator::c_InvalidAllocation);
+    return true;
+}
+
+static bool TestCoalesce()
+{
+    TlsfAllocator allocator(4 * c_MiB);
+
+    uint64_t offsets[4];
+    TlsfAllocator::Allocation allocations[4];
+    for (int i = 0; i < 4; i++)
+    {
+        allocations[i] = allocator.Allocate(c_MiB, 1, offsets[i]);
+        CHECK(allocations[i] != TlsfAllocator::c_InvalidAllocation);
+    }
+    CHECK(allocator.GetLargestFreeSize() == 0);
+
+    // Free neighbours on both sides of the one freed last, it has to merge with both.
+    allocator.Free(allocations[0]);
+    allocator.Free(allocations[2]);
+    CHECK(allocator.GetLargestFreeSize() == c_MiB);
+    allocator.Free(allocations[1]);
+    CHECK(allocator.GetLargestFreeSize() == 3 * c_MiB);
+
+    // Merging with the block before only.
+    allocator.Free(allocations[3]);
+    CHECK(allocator.IsEmpty());
+    CHECK(allocator.GetLargestFreeSize() == 4 * c_MiB);
+
+    // The merged range is usable as one block again.
+    uint64_t offset;
+    const auto whole = allocator.Allocate(4 * c_MiB, 1, offset);
+    CHECK(whole != TlsfAllocator::c_InvalidAllocation);
+    CHECK(offset == 0);
+    allocator.Free(whole);
+
+    // Merging with the block after only.
+    for (int i = 0; i < 2; i++)
+    {
+        allocations[i] = allocator.Allocate(2 * c_MiB, 1, offsets[i]);
+        CHECK(allocations[i] != TlsfAllocator::c_InvalidAllocation);
+    }
+    allocator.Free(allocations[1]);
+    allocator.Free(allocations[0]);
+    CHECK(allocator.GetLargestFreeSize() == 4 * c_MiB);
+    return true;
+}
+
+static bool TestAlignment()
+{
+    TlsfAllocator allocator(16 * c_MiB);
+
+    // Knock the next free offset off the larger alignments.
+    uint64_t smallOffset;
+    const auto small = allocator.Allocate(TlsfAllocator::c_MinBlockSize, 1, smallOffset);
+    CHECK(small != TlsfAllocator::c_InvalidAllocation);
+
+    // MSAA placement alignment, the padding in front has to go back to the free lists.
+    uint64_t alignedOffset;
+    const auto aligned = allocator.Allocate(64 * c_KiB, 4 * c_MiB, alignedOffset);
+    CHECK(aligned != TlsfAllocator::c_InvalidAllocation);
+    CHECK(alignedOffset % (4 * c_MiB) == 0);
+    CHECK(alignedOffset == 4 * c_MiB);
+    CHECK(allocator.GetUsedSize() == TlsfAllocator::c_MinBlockSize + 64 * c_KiB);
+
+    // The padding is used for requests that fit in it.
+    uint64_t paddingOffset;
+    const auto padding = allocator.Allocate(64 * c_KiB, 1, paddingOffset);
+    CHECK(padding != TlsfAllocator::c_InvalidAllocation);
+    CHECK(paddingOffset < alignedOffset);
+
+    // Alignments smaller than a block still give block aligned offsets.
+    uint64_t tinyAlignedOffset;
+    const auto tinyAligned = allocator.Allocate(100, 16, tinyAlignedOffset);
+    CHECK(tinyAligned != TlsfAllocator::c_InvalidAllocation);
+    CHECK(tinyAlignedOffset % TlsfAllocator::c_MinBlockSize == 0);
+
+    // An alignment as big as the heap only fits at 0.
+    uint64_t offset;
+    CHECK(allocator.Allocate(TlsfAllocator::c_MinBlockSize, 16 * c_MiB, offset) == TlsfAllocator::c_InvalidAllocation);
+
+    allocator.Free(small);
+    allocator.Free(padding);
+    allocator.Free(aligned);
+    allocator.Free(tinyAligned);
+    CHECK(allocator.IsEmpty());
+    CHECK(allocator.GetLargestFreeSize() == 16 * c_MiB);
+
+    const auto whole = allocator.Allocate(TlsfAllocator::c_MinBlockSize, 16 * c_MiB, offset);
+    CHECK(whole != TlsfAllocator::c_InvalidAllocation);
+    CHECK(offset == 0);
+    allocator.Free(whole);
+
+    // With nothing else left, a request for exactly the padding still finds it.
+    TlsfAllocator full(8 * c_MiB);
+    const auto fullFront = full.Allocate(TlsfAllocator::c_MinBlockSize, 1, offset);
+    CHECK(fullFront != TlsfAllocator::c_InvalidAllocation);
+    const auto fullAligned = full.Allocate(4 * c_MiB, 4 * c_MiB, offset);
+    CHECK(fullAligned != TlsfAllocator::c_InvalidAllocation);
+    CHECK(offset == 4 * c_MiB);
+    CHECK(full.GetLargestFreeSize() == 4 * c_MiB - TlsfAllocator::c_MinBlockSize);
+    const auto fullPadding = full.Allocate(4 * c_MiB - TlsfAllocator::c_MinBlockSize, 1, offset);
+    CHECK(fullPadding != TlsfAllocator::c_InvalidAllocation);
+    CHECK(offset == TlsfAllocator::c_MinBlockSize);
+    CHECK(full.GetUsedSize() == full.GetSize());
+
+    // A block that is only big enough once the alignment padding is taken into account.
+    TlsfAllocator tight(2 * c_MiB);
+    const auto front = tight.Allocate(TlsfAllocator::c_MinBlockSize, 1, offset);
+    CHECK(front != TlsfAllocator::c_InvalidAllocation);
+    const auto fits = tight.Allocate(c_MiB, c_MiB, offset);
+    CHECK(fits != TlsfAllocator::c_InvalidAllocation);
+    CHECK(offset == c_MiB);
+    CHECK(tight.Allocate(c_MiB, c_MiB, offset) == TlsfAllocator::c_InvalidAllocation);
+    return true;
+}
+
+// Random allocations and frees, checked against the list of live ranges.
+static bool TestRandom()
+{
+    const uint64_t heapSize = 64 * c_MiB;
+    TlsfAllocator allocator(heapSize);
+
+    std::mt19937 random(1234);
+    std::map<uint64_t, std::pair<uint64_t, TlsfAllocator::Allocation>> liveRanges; // offset -> size, allocation
+    uint64_t liveSize = 0;
+    for (int step = 0; step < 200000; step++)
+    {
+        if (liveRanges.empty() || random() % 100 < 55)
+        {
+            const uint64_t size = random() % 4 == 0 ? (random() % (4 * c_MiB)) : (random() % (256 * c_KiB));
+            const uint64_t alignment = 1ull << (random() % 23); // up to 4 MiB.
+
+            uint64_t offset;
+            const auto allocation = allocator.Allocate(size, alignment, offset);
+            if (allocation == TlsfAllocator::c_InvalidAllocation)
+            {
+                continue;
+            }
+
+            const uint64_t allocationSize = allocator.GetAllocationSize(allocation);
+            CHECK(allocationSize >= size);
+            CHECK(allocationSize % TlsfAllocator::c_MinBlockSize == 0);
+            CHECK(offset % alignment == 0);
+            CHECK(offset % TlsfAllocator::c_MinBlockSize == 0);
+            CHECK(offset + allocationSize <= heapSize);
+
+            // Must not overlap its neighbours.
+            const auto next = liveRanges.lower_bound(offset);
+            CHECK(next == liveRanges.end() || offset + allocationSize <= next->first);
+            if (next != liveRanges.begin())
+            {
+                const auto prev = std::prev(next);
+                CHECK(prev->first + prev->second.first <= offset);
+            }
+
+            liveRanges[offset] = { allocationSize, allocation };
+            liveSize += allocationSize;
+        }
+        else
+        {
+            auto itr = liveRanges.begin();
+            std::advance(itr, random() % liveRanges.size());
+            CHECK(allocator.GetOffset(itr->second.second) == itr->first);
+            allocator.Free(itr->second.second);
+            liveSize -= itr->second.first;
+            liveRanges.erase(itr);
+        }
+
+        CHECK(allocator.GetUsedSize() == liveSize);
+        CHECK(allocator.GetLargestFreeSize() <= heapSize - liveSize);
+    }
+
+    for (const auto& liveRange : liveRanges)
+    {
+        allocator.Free(liveRange.second.second);
+    }
+
+    // Everything merged back into one block.
+    CHECK(allocator.IsEmpty());
+    CHECK(allocator.GetLargestFreeSize() == heapSize);
+    return true;
+}
+
+int main()
+{
+    const struct
+    {
+        const char* name;
+        bool (*run)();
+    } tests[] =
+    {
+        { "AllocateAndFree", TestAllocateAndFree },
+        { "SizeRounding", TestSizeRounding },
+        { "Coalesce", TestCoalesce },
+        { "Alignment", TestAlignment },
+        { "Random", TestRandom },
+    };
+
+    int failedCount = 0;
+    for (const auto& test : tests)
+    {
+        const bool passed = test.run();
+        std::printf("%s: %s\n", test.name, passed ? "passed" : "FAILED");
+        failedCount += passed ? 0 : 1;
+    }
+
+    return failedCount;
+}
@@ -0,0 +1,229 @@
+// AMD SampleDX12 sample code
+// 
+// Copyright(c) 2023 Advanced Micro Devices, Inc.All rights reserved.
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "stdafx.h"
+#include "PackageWriter.h"
+
+PackageWriter::~PackageWriter()
+{
+    if (IsOpen())
+    {
+        (void)Close();
+    }
+}
+
+bool PackageWriter::Open(const wchar_t* const path)
+{
+    if (IsOpen())
+    {
+        return true;
+    }
+
+    // No buffering means every write has to be sector aligned and sized. The staging buffers take care of that.
+    m_fileHandle = CreateFileW(path, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_OVERLAPPED | FILE_FLAG_NO_BUFFERING, NULL);
+    if (m_fileHandle == INVALID_HANDLE_VALUE)
+    {
+        std::wcerr << L"Failure to open file: " << path << std::endl;
+        return false;
+    }
+
+    for (auto& buffer : m_stagingBuffers)
+    {
+        // VirtualAlloc hands back page aligned, zeroed memory.
+        buffer.data = static_cast<uint8_t*>(VirtualAlloc(nullptr, c_StagingBufferSize, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE));
+        buffer.overlapped.hEvent = CreateEvent(nullptr, TRUE, FALSE, nullptr);
+        if (buffer.data == nullptr || buffer.overlapped.hEvent == nullptr)
+        {
+            std::wcerr << L"Failure to allocate write buffers for: " << path << std::endl;
+            Release();
+            return false;
+        }
+    }
+
+    m_currentBufferIdx = 0;
+    m_currentBufferFill = 0;
+    m_currentBufferFileOffset = 0;
+    m_failed = false;
+
+    return true;
+}
+
+bool PackageWriter::Close()
+{
+    if (!IsOpen())
+    {
+        return false;
+    }
+
+    // The last write is rounded up to whole sectors, remember the real size to trim it after.
+    const uint64_t fileSize = m_currentBufferFileOffset + m_currentBufferFill;
+    if (m_currentBufferFill > 0)
+    {
+        const size_t sectorAlignedFill = (m_currentBufferFill + c_SectorAlignment - 1) & ~(c_SectorAlignment - 1);
+        memset(m_stagingBuffers[m_currentBufferIdx].data + m_currentBufferFill, 0, sectorAlignedFill - m_currentBufferFill);
+        (void)SubmitCurrentBuffer(sectorAlignedFill);
+    }
+
+    bool succeeded = WaitForAllBuffers() && !m_failed;
+
+    if (succeeded)
+    {
+        FILE_END_OF_FILE_INFO endOfFile{};
+        endOfFile.EndOfFile.QuadPart = fileSize;
+        succeeded = SetFileInformationByHandle(m_fileHandle, FileEndOfFileInfo, &endOfFile, sizeof(endOfFile)) != FALSE;
+    }
+
+    Release();
+
+    return succeeded;
+}
+
+int64_t PackageWriter::Write(const void* const data, const size_t byteCount)
+{
+    if (!IsOpen() || m_failed)
+    {
+        return -1;
+    }
+
+    const int64_t dataOffset = m_currentBufferFileOffset + m_currentBufferFill;
+
+    const uint8_t* dataPtr = static_cast<const uint8_t*>(data);
+    size_t bytesRemaining = byteCount;
+    while (bytesRemaining > 0)
+    {
+        auto& buffer = m_stagingBuffers[m_currentBufferIdx];
+        const size_t bytesToCopy = min(bytesRemaining, c_StagingBufferSize - m_currentBufferFill);
+        if (dataPtr != nullptr)
+        {
+            memcpy(buffer.data + m_currentBufferFill, dataPtr, bytesToCopy);
+            dataPtr += bytesToCopy;
+        }
+        else
+        {
+            // No data means padding.
+            memset(buffer.data + m_currentBufferFill, 0, bytesToCopy);
+        }
+
+        m_currentBufferFill += bytesToCopy;
+        bytesRemaining -= bytesToCopy;
+
+        if (m_currentBufferFill == c_StagingBufferSize && !SubmitCurrentBuffer(c_StagingBufferSize))
+        {
+            return -1;
+        }
+    }
+
+    return dataOffset;
+}
+
+int64_t PackageWriter::WriteAligned(const void* const data, const size_t byteCount, const size_t alignment)
+{
+    const int64_t dataOffset = Write(data, byteCount);
+    if (dataOffset == -1)
+    {
+        return -1;
+    }
+
+    const uint64_t unalignedOffset = dataOffset + byteCount;
+    const uint64_t alignmentBytes = ((unalignedOffset + alignment - 1) / alignment) * alignment - unalignedOffset;
+    if (alignmentBytes > 0 && Write(nullptr, alignmentBytes) == -1)
+    {
+        return -1;
+    }
+
+    return dataOffset;
+}
+
+bool PackageWriter::SubmitCurrentBuffer(const size_t byteCount)
+{
+    auto& buffer = m_stagingBuffers[m_currentBufferIdx];
+
+    LARGE_INTEGER fileOffset;
+    fileOffset.QuadPart = m_currentBufferFileOffset;
+    buffer.overlapped.Offset = fileOffset.LowPart;
+    buffer.overlapped.OffsetHigh = fileOffset.HighPart;
+    ResetEvent(buffer.overlapped.hEvent);
+
+    if (!WriteFile(m_fileHandle, buffer.data, static_cast<DWORD>(byteCount), nullptr, &buffer.overlapped) && GetLastError() != ERROR_IO_PENDING)
+    {
+        m_failed = true;
+        return false;
+    }
+    buffer.writePending = true;
+
+    // Move on to the next buffer, it may still be in flight from an earlier write.
+    m_currentBufferFileOffset += byteCount;
+    m_currentBufferFill = 0;
+    m_currentBufferIdx = (m_currentBufferIdx + 1) % m_stagingBuffers.size();
+
+    return WaitForBuffer(m_stagingBuffers[m_currentBufferIdx]);
+}
+
+bool PackageWriter::WaitForBuffer(StagingBuffer& buffer)
+{
+    if (!buffer.writePending)
+    {
+        return true;
+    }
+
+    buffer.writePending = false;
+
+    DWORD bytesWritten = 0;
+    if (!GetOverlappedResult(m_fileHandle, &buffer.overlapped, &bytesWritten, TRUE))
+    {
+        m_failed = true;
+        return false;
+    }
+
+    return true;
+}
+
+bool PackageWriter::WaitForAllBuffers()
+{
+    bool succeeded = true;
+    for (auto& buffer : m_stagingBuffers)
+    {
+        succeeded = WaitForBuffer(buffer) && succeeded;
+    }
+
+    return succeeded;
+}
+
+void PackageWriter::Release()
+{
+    (void)WaitForAllBuffers();
+
+    for (auto& buffer : m_stagingBuffers)
+    {
+        if (buffer.data != nullptr)
+        {
+            VirtualFree(buffer.data, 0, MEM_RELEASE);
+            buffer.data = nullptr;
+        }
+
+        if (buffer.overlapped.hEvent != nullptr)
+        {
+            CloseHandle(buffer.overlapped.hEvent);
+            buffer.overlapped.hEvent = nullptr;
+        }
+    }
+
+    CloseHandle(m_fileHandle);
+    m_fileHandle = INVALID_HANDLE_VALUE;
+}
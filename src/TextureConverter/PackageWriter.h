@@ -0,0 +1,77 @@
+// AMD SampleDX12 sample code
+// 
+// Copyright(c) 2023 Advanced Micro Devices, Inc.All rights reserved.
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include "stdafx.h"
+#include <array>
+
+// Streams a package file to disk with unbuffered, overlapped writes.
+// Data is gathered into a few sector aligned staging buffers, full buffers are written while the next one fills.
+// Offsets are tracked here, so nothing has to ask the file system where the data went, and padding is always zero.
+class PackageWriter
+{
+public:
+    PackageWriter() = default;
+    ~PackageWriter();
+
+    PackageWriter(const PackageWriter&) = delete;
+    PackageWriter& operator=(const PackageWriter&) = delete;
+
+    // Creates the file if it isn't open yet. Returns true if the writer is ready to take data.
+    bool Open(const wchar_t* const path);
+
+    // Flushes the staging buffers, trims the sector padding off the end and closes the file.
+    bool Close();
+
+    bool IsOpen() const { return m_fileHandle != INVALID_HANDLE_VALUE; }
+
+    // Bytes written so far, this is what the file size will be after Close.
+    uint64_t GetSize() const { return m_currentBufferFileOffset + m_currentBufferFill; }
+
+    // Appends data. Returns the offset of the data in the file, -1 on failure.
+    int64_t Write(const void* const data, const size_t byteCount);
+
+    // Appends data, then zero pads so the next write starts on an alignment boundary. Returns the offset of the data in the file, -1 on failure.
+    int64_t WriteAligned(const void* const data, const size_t byteCount, const size_t alignment = 4096);
+
+private:
+    static const size_t c_StagingBufferCount = 4;
+    static const size_t c_StagingBufferSize = 4 * 1024 * 1024;
+    static const size_t c_SectorAlignment = 4096; // Covers 512 byte and 4KiB sector drives.
+
+    struct StagingBuffer
+    {
+        uint8_t* data = nullptr;
+        OVERLAPPED overlapped{};
+        bool writePending = false;
+    };
+
+    bool SubmitCurrentBuffer(const size_t byteCount);
+    bool WaitForBuffer(StagingBuffer& buffer);
+    bool WaitForAllBuffers();
+    void Release();
+
+    HANDLE m_fileHandle = INVALID_HANDLE_VALUE;
+    std::array<StagingBuffer, c_StagingBufferCount> m_stagingBuffers;
+    size_t m_currentBufferIdx = 0;
+    size_t m_currentBufferFill = 0;
+    uint64_t m_currentBufferFileOffset = 0; // Where the current staging buffer lands in the file.
+    bool m_failed = false;
+};
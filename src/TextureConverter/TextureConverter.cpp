@@ -25,15 +25,27 @@
 #include "DirectStorageSampleTexturePackageFormat.h"
 #include "PackageUtils.h"
 #include "CompressionSupport.h"
+#include "PackageWriter.h"
+#include "HeapPlacement.h"
 #include <codecvt>
 #include "json.h"
 #include <fstream>
 #include <thread>
+#include <chrono>
 
 
 using Microsoft::WRL::ComPtr;
 
-bool ConvertImages(ID3D12Device* const pDevice, const std::wstring& gltfPath, const std::vector<std::wstring>& imageList, DSTORAGE_COMPRESSION_FORMAT compressionFormat, DSTORAGE_COMPRESSION compressionLevel, bool compressionExhaustive);
+// One package written side by side with the others from the same decode and layout pass.
+struct PackageVariant
+{
+    std::wstring name; // Empty for the default package (MetaData.bin/TextureData.bin).
+    DSTORAGE_COMPRESSION_FORMAT compressionFormat = DSTORAGE_COMPRESSION_FORMAT_NONE;
+    DSTORAGE_COMPRESSION compressionLevel = DSTORAGE_COMPRESSION_DEFAULT;
+    bool compressionExhaustive = false;
+};
+
+bool ConvertImages(ID3D12Device* const pDevice, const std::wstring& gltfPath, const std::vector<std::wstring>& imageList, const std::vector<PackageVariant>& variants, uint32_t reducedQualityTierCount, bool textureRegions, bool textureTiles, nlohmann::json* pReport, std::vector<PackageManifestEntry>& packagesOut);
 int64_t Compress(DSTORAGE_COMPRESSION_FORMAT format, DSTORAGE_COMPRESSION compressionLevel, std::vector<uint8_t>& compressedDst, const std::vector<uint8_t>& uncompressedSrc);
 
 
@@ -100,11 +112,82 @@ static bool ValidateCompressionArgs(const std::wstring& compressionFormatString,
 }
 
 
+// Parses a comma separated list of variants, e.g. "none,gdeflate-fastest,gdeflate-best,exhaustive".
+// Each variant is a compression format with an optional level, or "exhaustive". The variant string is also the package name.
+static bool ParsePackageVariants(const std::wstring& variantsString, std::vector<PackageVariant>& variantsOut)
+{
+    size_t tokenStart = 0;
+    while (tokenStart <= variantsString.size())
+    {
+        size_t tokenEnd = variantsString.find(L',', tokenStart);
+        if (tokenEnd == std::wstring::npos)
+        {
+            tokenEnd = variantsString.size();
+        }
+
+        std::wstring token = variantsString.substr(tokenStart, tokenEnd - tokenStart);
+        tokenStart = tokenEnd + 1;
+
+        if (token.empty())
+        {
+            return false;
+        }
+
+        PackageVariant variant;
+        variant.name = token;
+
+        if (token == L"exhaustive")
+        {
+            variant.compressionExhaustive = true;
+        }
+        else
+        {
+            auto levelSeparator = token.find(L'-');
+            std::wstring formatString = token.substr(0, levelSeparator);
+            std::wstring levelString = (levelSeparator == std::wstring::npos) ? std::wstring(L"default") : token.substr(levelSeparator + 1);
+
+            if (!ValidateCompressionArgs(formatString, levelString, L""))
+            {
+                return false;
+            }
+
+            variant.compressionFormat = TranslateCompressionFormatToValue(formatString);
+            if (variant.compressionFormat == DSTORAGE_COMPRESSION_FORMAT_GDEFLATE)
+            {
+                variant.compressionLevel = TranslateCompressionLevelToValueGDeflate(levelString);
+            }
+        }
+
+        // Two variants with the same name would write to the same files.
+        for (const auto& existingVariant : variantsOut)
+        {
+            if (existingVariant.name == variant.name)
+            {
+                return false;
+            }
+        }
+
+        variantsOut.push_back(std::move(variant));
+    }
+
+    return !variantsOut.empty();
+}
+
+
+static double MillisecondsSince(const std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
 static const std::wstring& GetUsageString()
 {
     static const std::wstring usageString(L""
     L"Usage: TextureConverter.exe -configFile=<path to DirectStorageSample.json> -compressionFormat=<Compression Format> [-compressionLevel=<Valid Compression Level>] [-compressionExhaustive=<false|true>]"
     L"\n"
+    L"       TextureConverter.exe -configFile=<path to DirectStorageSample.json> -variants=<Variant>[,<Variant>...]"
+    L"\n"
+    L"       Either form accepts [-qualityTiers=<0|1|2>] [-textureRegions=<false|true>] [-textureTiles=<false|true>] [-report=<path to report .json>]"
+    L"\n"
     L"Compression Formats:\n"
     L"\tnone\n"
     L"\tgdeflate\n"
@@ -118,6 +201,29 @@ static const std::wstring& GetUsageString()
     L"\tfalse (use the compressionLevel and compressionFormat specified -- default)\n"
     L"\ttrue (Use the compression format and compression level with the best compression ratio. compressionLevel and compressionFormat specified are ignored)\n"
     L"\n"
+    L"Variants:\n"
+    L"\t<Compression Format>[-<Compression Level>] (e.g. none, gdeflate-fastest, gdeflate-best)\n"
+    L"\texhaustive (same as -compressionExhaustive=true)\n"
+    L"\tEach variant is written to MetaData_<Variant>.bin and TextureData_<Variant>.bin from a single decode of every texture.\n"
+    L"\tThe other compression options are ignored when variants are given.\n"
+    L"\n"
+    L"Quality Tiers:\n"
+    L"\t0 (only store the full texture -- default)\n"
+    L"\t1 (also store each texture without its top mip)\n"
+    L"\t2 (also store each texture without its top mip and without its top two mips)\n"
+    L"\n"
+    L"Texture Regions:\n"
+    L"\tfalse (store each quality tier of a texture as one compressed block -- default)\n"
+    L"\ttrue (store each texture as separately compressed regions of at most 16MiB, smallest mips first, listed in Regions.bin)\n"
+    L"\tQuality tiers share the regions of the full texture, so they don't add to the package size.\n"
+    L"\n"
+    L"Texture Tiles:\n"
+    L"\tfalse (only store the textures as above -- default)\n"
+    L"\ttrue (also store 2D textures as 64KiB tiles of a reserved resource, listed in Tiles.bin, for tiled texture streaming)\n"
+    L"\n"
+    L"Report:\n"
+    L"\tWrites per texture sizes, formats and decode/layout/compress/write times plus per package totals as JSON.\n"
+    L"\n"
     );
 
     return usageString;
@@ -130,6 +236,11 @@ int wmain(int argc, wchar_t* argv[])
     std::wstring compressionFormatString(L"");
     std::wstring compressionLevelString(L"default");
     std::wstring compressionExhaustiveString(L"");
+    std::wstring variantsString(L"");
+    std::wstring qualityTiersString(L"0");
+    std::wstring textureRegionsString(L"false");
+    std::wstring textureTilesString(L"false");
+    std::wstring reportPath(L"");
     DSTORAGE_COMPRESSION_FORMAT compressionFormatValue = DSTORAGE_COMPRESSION_FORMAT_NONE;
     DSTORAGE_COMPRESSION compressionLevelValue = DSTORAGE_COMPRESSION_DEFAULT;
     bool compressionExhaustiveValue = false;
@@ -164,41 +275,132 @@ int wmain(int argc, wchar_t* argv[])
                 compressionExhaustiveString = std::wstring(wcschr(argValPtr, L'=') + 1);
                 continue;
             }
+
+            if ((argValPtr = wcsstr(&argv[argIdx][1], L"variants=")) != nullptr)
+            {
+                variantsString = std::wstring(wcschr(argValPtr, L'=') + 1);
+                continue;
+            }
+
+            if ((argValPtr = wcsstr(&argv[argIdx][1], L"qualityTiers=")) != nullptr)
+            {
+                qualityTiersString = std::wstring(wcschr(argValPtr, L'=') + 1);
+                continue;
+            }
+
+            if ((argValPtr = wcsstr(&argv[argIdx][1], L"textureRegions=")) != nullptr)
+            {
+                textureRegionsString = std::wstring(wcschr(argValPtr, L'=') + 1);
+                continue;
+            }
+
+            if ((argValPtr = wcsstr(&argv[argIdx][1], L"textureTiles=")) != nullptr)
+            {
+                textureTilesString = std::wstring(wcschr(argValPtr, L'=') + 1);
+                continue;
+            }
+
+            if ((argValPtr = wcsstr(&argv[argIdx][1], L"report=")) != nullptr)
+            {
+                reportPath = std::wstring(wcschr(argValPtr, L'=') + 1);
+                continue;
+            }
         }
     }
 
-    if (!ValidateCompressionArgs(compressionFormatString, compressionLevelString, compressionExhaustiveString))
+    // Reduced quality tiers stored alongside the full texture.
+    uint32_t reducedQualityTierCount = static_cast<uint32_t>(wcstoul(qualityTiersString.c_str(), nullptr, 10));
+    if (reducedQualityTierCount >= c_DirectStorageSampleMaxQualityTiers)
     {
-        std::wcerr << "Invalid arguments." << std::endl << GetUsageString();
+        std::wcerr << "Invalid quality tiers." << std::endl << GetUsageString();
 
         // bail.
         return -1;
     }
 
+    std::wcout << L"Reduced Quality Tiers: " << reducedQualityTierCount << std::endl;
 
-    if (compressionExhaustiveString != L"")
+    if (textureRegionsString != L"false" && textureRegionsString != L"true")
     {
-        compressionExhaustiveValue = TranslateCompressionExhaustiveToValue(compressionExhaustiveString);
+        std::wcerr << "Invalid texture regions." << std::endl << GetUsageString();
+
+        // bail.
+        return -1;
     }
 
-    if (compressionExhaustiveValue == false)
+    const bool textureRegions = textureRegionsString == L"true";
+    std::wcout << L"Texture Regions: " << textureRegionsString << std::endl;
+
+    if (textureTilesString != L"false" && textureTilesString != L"true")
     {
-        // Setup compression settings.
-        if (compressionFormatString != L"")
+        std::wcerr << "Invalid texture tiles." << std::endl << GetUsageString();
+
+        // bail.
+        return -1;
+    }
+
+    const bool textureTiles = textureTilesString == L"true";
+    std::wcout << L"Texture Tiles: " << textureTilesString << std::endl;
+
+    std::vector<PackageVariant> variants;
+
+    if (variantsString != L"")
+    {
+        if (!ParsePackageVariants(variantsString, variants))
         {
-            compressionFormatValue = TranslateCompressionFormatToValue(compressionFormatString);
+            std::wcerr << "Invalid variants." << std::endl << GetUsageString();
 
-            if (compressionFormatValue == DSTORAGE_COMPRESSION_FORMAT_GDEFLATE)
-            {
-                compressionLevelValue = TranslateCompressionLevelToValueGDeflate(compressionLevelString);
-            }
+            // bail.
+            return -1;
         }
 
-        std::wcout << L"Compression Format: " << TranslateCompressionFormatToString(compressionFormatValue) << std::endl << L"Compression Level: " << TranslateCompressionLevelToStringGDeflate(compressionLevelValue) << std::endl;
+        for (const auto& variant : variants)
+        {
+            std::wcout << L"Variant: " << variant.name << std::endl;
+        }
     }
     else
     {
-        std::wcout << L"Compression exhaustive search enabled." << std::endl;
+        if (!ValidateCompressionArgs(compressionFormatString, compressionLevelString, compressionExhaustiveString))
+        {
+            std::wcerr << "Invalid arguments." << std::endl << GetUsageString();
+
+            // bail.
+            return -1;
+        }
+
+
+        if (compressionExhaustiveString != L"")
+        {
+            compressionExhaustiveValue = TranslateCompressionExhaustiveToValue(compressionExhaustiveString);
+        }
+
+        if (compressionExhaustiveValue == false)
+        {
+            // Setup compression settings.
+            if (compressionFormatString != L"")
+            {
+                compressionFormatValue = TranslateCompressionFormatToValue(compressionFormatString);
+
+                if (compressionFormatValue == DSTORAGE_COMPRESSION_FORMAT_GDEFLATE)
+                {
+                    compressionLevelValue = TranslateCompressionLevelToValueGDeflate(compressionLevelString);
+                }
+            }
+
+            std::wcout << L"Compression Format: " << TranslateCompressionFormatToString(compressionFormatValue) << std::endl << L"Compression Level: " << TranslateCompressionLevelToStringGDeflate(compressionLevelValue) << std::endl;
+        }
+        else
+        {
+            std::wcout << L"Compression exhaustive search enabled." << std::endl;
+        }
+
+        // The default package keeps the original file names.
+        PackageVariant variant;
+        variant.compressionFormat = compressionFormatValue;
+        variant.compressionLevel = compressionLevelValue;
+        variant.compressionExhaustive = compressionExhaustiveValue;
+        variants.push_back(variant);
     }
 
     
@@ -209,6 +411,12 @@ int wmain(int argc, wchar_t* argv[])
     }
 
 
+    // Resolve before changing directory so a relative report path is relative to where the converter was started.
+    if (reportPath != L"")
+    {
+        reportPath = GetFullDirectoryPath(reportPath) + GetFileName(reportPath);
+    }
+
     std::wstring configPath(GetFullDirectoryPath(configFile));
     SetCurrentDirectoryW(configPath.c_str());
 
@@ -221,6 +429,7 @@ int wmain(int argc, wchar_t* argv[])
     configStream >> config;
     const auto& scenes = config["scenes"];
     std::vector<std::wstring> gltfFilePaths;
+    std::unordered_map<std::wstring, std::pair<std::wstring, std::wstring>> gltfSceneDirectoryAndFilename; // For the manifest.
     std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>, wchar_t> utf8utf16converter;
     for (const auto& scene : scenes)
     {
@@ -230,6 +439,7 @@ int wmain(int argc, wchar_t* argv[])
         auto scenePathWstr = utf8utf16converter.from_bytes(sceneDirectory + sceneFilename);
         if (PathFileExistsW(scenePathWstr.c_str()))
         {
+            gltfSceneDirectoryAndFilename[scenePathWstr] = { utf8utf16converter.from_bytes(sceneDirectory), utf8utf16converter.from_bytes(sceneFilename) };
             gltfFilePaths.push_back(std::move(scenePathWstr));
         }
         else
@@ -265,71 +475,77 @@ int wmain(int argc, wchar_t* argv[])
     }
 
 
+    nlohmann::json report;
+    report["packages"] = nlohmann::json::array();
+
+    const auto conversionStart = std::chrono::steady_clock::now();
+
+    // One manifest per variant listing all of its packages.
+    std::vector<std::vector<PackageManifestEntry>> manifests(variants.size());
+
     std::wcout << L"Converting textures for..." << std::endl;
     for (const auto& gltfRelativePath : gltfRelativePaths)
     {
         // Resolve to full path before conversion?
         std::wcout << gltfRelativePath.first << std::endl;
-        if (!ConvertImages(pDevice.Get(), gltfRelativePath.first, gltfRelativePath.second,compressionFormatValue, compressionLevelValue, compressionExhaustiveValue))
+        std::vector<PackageManifestEntry> packages;
+        if (!ConvertImages(pDevice.Get(), gltfRelativePath.first, gltfRelativePath.second, variants, reducedQualityTierCount, textureRegions, textureTiles, reportPath != L"" ? &report : nullptr, packages))
         {
             std::wcerr << L"Failure to convert images for..." << gltfRelativePath.first << std::endl;
+            continue;
         }
-    }
-}
 
-bool CreateFileOnDisk(const wchar_t* const path, HANDLE* handleInOut)
-{
-    assert(handleInOut != nullptr);
+        const auto& sceneDirectoryAndFilename = gltfSceneDirectoryAndFilename.at(gltfRelativePath.first);
+        for (size_t variantIdx = 0; variantIdx < packages.size(); variantIdx++)
+        {
+            if (packages[variantIdx].metaData.Name.empty())
+            {
+                // No texture of this scene could be converted.
+                continue;
+            }
 
-    // Create files if necessary.
-    if (*handleInOut == INVALID_HANDLE_VALUE)
+            packages[variantIdx].sceneDirectory = sceneDirectoryAndFilename.first;
+            packages[variantIdx].sceneFilename = sceneDirectoryAndFilename.second;
+            manifests[variantIdx].push_back(std::move(packages[variantIdx]));
+        }
+    }
+
+    // The report goes first so it survives a failed manifest write, a failed report doesn't stop the manifests.
+    int result = 0;
+    if (reportPath != L"")
     {
-        *handleInOut = CreateFileW(path, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
-        if (GetLastError() == ERROR_ALREADY_EXISTS)
+        report["totalMs"] = MillisecondsSince(conversionStart);
+
+        std::ofstream reportStream(reportPath, std::ios::out | std::ios::trunc);
+        if (reportStream)
         {
-            SetLastError(ERROR_SUCCESS); // ignore if already exist.
+            reportStream << report.dump(4) << std::endl;
+            std::wcout << L"Report written to: " << reportPath << std::endl;
         }
-        else if (GetLastError() != ERROR_SUCCESS)
+        else
         {
-            std::wcerr << L"Failure to open file: " << path << std::endl;
-            return false;
+            std::wcerr << L"Failure to write report: " << reportPath << std::endl;
+            result = -1;
         }
     }
 
-    return true;
-}
-
-int64_t WriteDataToDisk(const HANDLE fileHandle, const void* const data, const size_t byteCount)
-{
-    LARGE_INTEGER filePointerOrStatus{ 0 };
-    filePointerOrStatus.LowPart = SetFilePointer(fileHandle, 0, &filePointerOrStatus.HighPart, FILE_CURRENT);
-
-    size_t totalBytesWritten = 0;
-    const char* dataPtr = (char*) data;
-    size_t bytesRemaining = byteCount;
-
-    while (bytesRemaining > 0)
+    // Written next to the config file, which is where the sample runs from.
+    for (size_t variantIdx = 0; variantIdx < variants.size(); variantIdx++)
     {
-        DWORD bytesToWrite = static_cast<DWORD>(min(bytesRemaining, MAXDWORD));
-        DWORD bytesWrittenThisCall = 0;
-        if (WriteFile(fileHandle, dataPtr + totalBytesWritten, bytesToWrite, &bytesWrittenThisCall, NULL))
-        {
-            bytesRemaining -= bytesWrittenThisCall;
-            dataPtr += bytesWrittenThisCall;
-        }
-        else
+        const auto manifestFileName = GetManifestFileName(variants[variantIdx].name);
+        if (!WritePackageManifest(manifestFileName, manifests[variantIdx]))
         {
+            std::wcerr << L"Failure to write manifest: " << manifestFileName << std::endl;
             return -1;
         }
     }
 
-    // Return prior offset in current file so we know where the data is located.
-    return filePointerOrStatus.QuadPart;
+    return result;
 }
 
 #if 1
 // Find best compressino for the given asset.
-int64_t CompressExhaustive(std::vector<uint8_t>& compressedDst, const std::vector<uint8_t>& uncompressedSrc, DSTORAGE_COMPRESSION_FORMAT* formatOut)
+int64_t CompressExhaustive(std::vector<uint8_t>& compressedDst, const std::vector<uint8_t>& uncompressedSrc, DSTORAGE_COMPRESSION_FORMAT* formatOut, DSTORAGE_COMPRESSION* levelOut)
 {
     // @todo this much be updated as formats and levels are added.
     DSTORAGE_COMPRESSION_FORMAT supportedFormatMax = DSTORAGE_COMPRESSION_FORMAT_GDEFLATE;
@@ -351,6 +567,7 @@ int64_t CompressExhaustive(std::vector<uint8_t>& compressedDst, const std::vecto
                 smallestSize = compressedSize;
                 compressedDst = std::move(tempCompressedBuffer);
                 *formatOut = static_cast<DSTORAGE_COMPRESSION_FORMAT>(format);
+                *levelOut = static_cast<DSTORAGE_COMPRESSION>(level);
             }
         }
     }
@@ -394,11 +611,540 @@ int64_t Compress(DSTORAGE_COMPRESSION_FORMAT format, DSTORAGE_COMPRESSION compre
 }
 
 
-bool ConvertImages(ID3D12Device* const pDevice, const std::wstring& gltfPath, const std::vector<std::wstring>& imageList, DSTORAGE_COMPRESSION_FORMAT compressionFormat, DSTORAGE_COMPRESSION compressionLevel, bool compressionExhaustive)
+// Compresses texture data as requested by a package variant. Returns the size of the data gpuDataPtrOut points to, -1 on failure.
+static int64_t CompressForVariant(const PackageVariant& variant, const std::wstring& imagePath, const std::vector<uint8_t>& textureData, std::vector<uint8_t>& gpuData, const uint8_t** gpuDataPtrOut, DSTORAGE_COMPRESSION_FORMAT* compressionFormatOut, DSTORAGE_COMPRESSION* compressionLevelOut)
+{
+    *compressionFormatOut = variant.compressionFormat;
+    *compressionLevelOut = variant.compressionLevel;
+
+    int64_t gpuDataSize = -1;
+    if (variant.compressionExhaustive)
+    {
+        gpuDataSize = CompressExhaustive(gpuData, textureData, compressionFormatOut, compressionLevelOut);
+        *gpuDataPtrOut = gpuData.data();
+    }
+    else if (variant.compressionFormat != DSTORAGE_COMPRESSION_FORMAT_NONE)
+    {
+        // compression enabled.
+        gpuData.resize(textureData.size());
+        gpuDataSize = Compress(variant.compressionFormat, variant.compressionLevel, gpuData, textureData);
+        if (gpuDataSize == -1)
+        {
+            std::wcerr << "Failed to compress image: " << imagePath << std::endl;
+            return -1;
+        }
+        *gpuDataPtrOut = gpuData.data();
+
+        if (textureData.size() <= gpuDataSize)
+        {
+            // Turns out compression didn't help us at all. TODO: Determine threshold at which compression should be disabled.
+            std::wcout << "Compression ineffective for " << imagePath << " (" << variant.name << ")" << std::endl;
+        }
+    }
+    else
+    {
+        // no compression... other variants still need the uncompressed data, so just point at it.
+        *gpuDataPtrOut = textureData.data();
+        gpuDataSize = textureData.size();
+        if (gpuDataSize == 0)
+        {
+            return -1;
+        }
+    }
+
+    return gpuDataSize;
+}
+
+static bool IsBlockCompressed(DXGI_FORMAT format)
+{
+    return (format >= DXGI_FORMAT_BC1_TYPELESS && format <= DXGI_FORMAT_BC5_SNORM) || (format >= DXGI_FORMAT_BC6H_TYPELESS && format <= DXGI_FORMAT_BC7_UNORM_SRGB);
+}
+
+// Builds a reduced quality tier of a texture by dropping its top mips. The remaining mips are copied from the already laid out full texture.
+static bool BuildQualityTier(ID3D12Device* const pDevice, const D3D12_RESOURCE_DESC& resourceDesc, const std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT>& subresourceFootprints, const std::vector<uint8_t>& textureData, uint32_t droppedMips, D3D12_RESOURCE_DESC* tierResourceDescOut, std::vector<uint8_t>& tierTextureDataOut)
+{
+    if (resourceDesc.Dimension != D3D12_RESOURCE_DIMENSION_TEXTURE2D || resourceDesc.MipLevels <= droppedMips)
+    {
+        return false;
+    }
+
+    D3D12_RESOURCE_DESC tierResourceDesc = resourceDesc;
+    tierResourceDesc.Width = max(resourceDesc.Width >> droppedMips, 1ull);
+    tierResourceDesc.Height = max(resourceDesc.Height >> droppedMips, 1u);
+    tierResourceDesc.MipLevels = resourceDesc.MipLevels - droppedMips;
+
+    // Block compressed textures need a top mip made of whole blocks.
+    if (IsBlockCompressed(resourceDesc.Format) && (((tierResourceDesc.Width % 4) != 0) || ((tierResourceDesc.Height % 4) != 0)))
+    {
+        return false;
+    }
+
+    UINT tierSubresourceCount = tierResourceDesc.DepthOrArraySize * tierResourceDesc.MipLevels;
+    std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT> tierFootprints(tierSubresourceCount);
+    std::vector<UINT> tierRowsCount(tierSubresourceCount);
+    std::vector<UINT64> tierRowByteCount(tierSubresourceCount);
+    UINT64 tierTotalByteCount = 0;
+
+    pDevice->GetCopyableFootprints(&tierResourceDesc
+        , 0, tierSubresourceCount
+        , 0, &tierFootprints[0]
+        , &tierRowsCount[0]
+        , &tierRowByteCount[0]
+        , &tierTotalByteCount);
+
+    tierTextureDataOut.assign(tierTotalByteCount, 0);
+
+    // Tier mip N is mip N + droppedMips of the full texture, so only the row pitches and offsets differ.
+    for (UINT arraySlice = 0; arraySlice < tierResourceDesc.DepthOrArraySize; arraySlice++)
+    {
+        for (UINT mip = 0; mip < tierResourceDesc.MipLevels; mip++)
+        {
+            const UINT tierSubresourceIdx = mip + arraySlice * tierResourceDesc.MipLevels;
+            const UINT subresourceIdx = (mip + droppedMips) + arraySlice * resourceDesc.MipLevels;
+            const auto& dstFootprint = tierFootprints[tierSubresourceIdx];
+            const auto& srcFootprint = subresourceFootprints[subresourceIdx];
+
+            for (UINT row = 0; row < tierRowsCount[tierSubresourceIdx]; row++)
+            {
+                memcpy(tierTextureDataOut.data() + dstFootprint.Offset + row * dstFootprint.Footprint.RowPitch
+                    , textureData.data() + srcFootprint.Offset + row * srcFootprint.Footprint.RowPitch
+                    , tierRowByteCount[tierSubresourceIdx]);
+            }
+        }
+    }
+
+    *tierResourceDescOut = tierResourceDesc;
+    return true;
+}
+
+// A region of the full texture and where its data starts in the laid out texture data.
+struct TextureRegionSource
+{
+    DirectStorageSampleTextureRegion region;
+    uint64_t dataOffset;
+};
+
+// Splits a texture into regions of at most c_DirectStorageSampleMaxRegionSize, smallest mips first.
+// Regions are made of whole rows, so each one is a contiguous part of the laid out texture data that keeps its row pitch.
+static std::vector<TextureRegionSource> BuildTextureRegions(const D3D12_RESOURCE_DESC& resourceDesc, const std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT>& subresourceFootprints, const std::vector<UINT>& subresourceRowsCount, const std::vector<UINT64>& subresourceRowByteCount)
+{
+    std::vector<TextureRegionSource> regions;
+
+    const UINT arraySize = resourceDesc.Dimension == D3D12_RESOURCE_DIMENSION_TEXTURE3D ? 1 : resourceDesc.DepthOrArraySize;
+    const UINT blockHeight = IsBlockCompressed(resourceDesc.Format) ? 4 : 1;
+    for (UINT mip = resourceDesc.MipLevels; mip-- > 0;)
+    {
+        const UINT mipWidth = static_cast<UINT>(max(resourceDesc.Width >> mip, 1ull));
+        const UINT mipHeight = max(resourceDesc.Height >> mip, 1u);
+        for (UINT arraySlice = 0; arraySlice < arraySize; arraySlice++)
+        {
+            const UINT subresourceIdx = mip + arraySlice * resourceDesc.MipLevels;
+            const auto& footprint = subresourceFootprints[subresourceIdx].Footprint;
+            const uint64_t rowPitch = footprint.RowPitch;
+            const UINT rowCount = subresourceRowsCount[subresourceIdx];
+
+            // 3D textures are split into depth slices, everything else into rows. A region gets at least one of either.
+            UINT slicesPerRegion = footprint.Depth;
+            UINT rowsPerRegion = rowCount;
+            if (footprint.Depth > 1)
+            {
+                slicesPerRegion = static_cast<UINT>(min(max(c_DirectStorageSampleMaxRegionSize / (rowPitch * rowCount), 1ull), static_cast<uint64_t>(footprint.Depth)));
+            }
+            else
+            {
+                rowsPerRegion = static_cast<UINT>(min(max(c_DirectStorageSampleMaxRegionSize / rowPitch, 1ull), static_cast<uint64_t>(rowCount)));
+            }
+
+            for (UINT firstSlice = 0; firstSlice < footprint.Depth; firstSlice += slicesPerRegion)
+            {
+                const UINT sliceCount = min(slicesPerRegion, footprint.Depth - firstSlice);
+                for (UINT firstRow = 0; firstRow < rowCount; firstRow += rowsPerRegion)
+                {
+                    const UINT regionRowCount = min(rowsPerRegion, rowCount - firstRow);
+
+                    TextureRegionSource source{};
+                    source.region.mipLevel = mip;
+                    source.region.arraySlice = arraySlice;
+                    source.region.box = { 0, firstRow * blockHeight, firstSlice, mipWidth, min((firstRow + regionRowCount) * blockHeight, mipHeight), firstSlice + sliceCount };
+                    // Same size GetCopyableFootprints gives a texture the size of the box, the last row isn't padded out to the pitch.
+                    source.region.sizeUncompressed = static_cast<uint32_t>(rowPitch * (regionRowCount * sliceCount - 1) + subresourceRowByteCount[subresourceIdx]);
+                    source.dataOffset = subresourceFootprints[subresourceIdx].Offset + (firstSlice * rowCount + firstRow) * rowPitch;
+                    regions.push_back(source);
+                }
+            }
+        }
+    }
+
+    return regions;
+}
+
+// Compresses and writes every region of a texture, then pads so the next texture starts aligned.
+// The quality tiers point into the same data, tier N just leaves out the regions of the top N mips, which come last.
+static bool WriteTextureRegions(const PackageVariant& variant, const std::wstring& imagePath, const std::vector<D3D12_RESOURCE_DESC>& tierResourceDescs, const std::vector<std::vector<uint8_t>>& tierTextureData, const std::vector<TextureRegionSource>& regionSources, PackageWriter& texturedataWriter, DirectStorageSampleTextureMetadataHeader& metadata, std::vector<DirectStorageSampleTextureRegion>& regionsOut, double* compressMsOut, double* writeMsOut)
+{
+    const size_t firstRegion = regionsOut.size();
+    int64_t textureOffset = -1;
+    *compressMsOut = 0.0;
+    *writeMsOut = 0.0;
+
+    for (const auto& source : regionSources)
+    {
+        const std::vector<uint8_t> regionData(tierTextureData[0].begin() + source.dataOffset, tierTextureData[0].begin() + source.dataOffset + source.region.sizeUncompressed);
+
+        DirectStorageSampleTextureRegion region = source.region;
+        std::vector<uint8_t> gpuData;
+        const uint8_t* gpuDataPtr = nullptr;
+        DSTORAGE_COMPRESSION compressionLevel = DSTORAGE_COMPRESSION_DEFAULT;
+        const auto compressStart = std::chrono::steady_clock::now();
+        const int64_t gpuDataSize = CompressForVariant(variant, imagePath, regionData, gpuData, &gpuDataPtr, &region.compressionFormat, &compressionLevel);
+        if (gpuDataSize == -1)
+        {
+            return false;
+        }
+        *compressMsOut += MillisecondsSince(compressStart);
+
+        const auto writeStart = std::chrono::steady_clock::now();
+        region.sizeCompressed = static_cast<uint32_t>(gpuDataSize);
+        region.offset = texturedataWriter.Write(gpuDataPtr, gpuDataSize);
+        if (region.offset == -1)
+        {
+            std::wcerr << "Failed to write texture data: " << imagePath << std::endl;
+            return false;
+        }
+        *writeMsOut += MillisecondsSince(writeStart);
+
+        textureOffset = textureOffset == -1 ? region.offset : textureOffset;
+        regionsOut.push_back(region);
+    }
+
+    if (textureOffset == -1 || texturedataWriter.WriteAligned(nullptr, 0) == -1)
+    {
+        std::wcerr << "Failed to write texture data: " << imagePath << std::endl;
+        return false;
+    }
+    assert((textureOffset % 4096) == 0);
+
+    metadata.qualityTierCount = static_cast<uint32_t>(tierTextureData.size());
+    for (uint32_t tierIdx = 0; tierIdx < metadata.qualityTierCount; tierIdx++)
+    {
+        DirectStorageSampleTextureQualityTier tier{};
+        tier.resourceDesc = tierResourceDescs[tierIdx];
+        tier.compressionFormat = regionsOut[firstRegion].compressionFormat; // Regions carry their own, this is only informational.
+        tier.resourceSizeUncompressed = tierTextureData[tierIdx].size();
+        tier.resourceOffset = textureOffset;
+        for (size_t regionIdx = firstRegion; regionIdx < regionsOut.size() && regionsOut[regionIdx].mipLevel >= tierIdx; regionIdx++)
+        {
+            tier.resourceSizeCompressed = regionsOut[regionIdx].offset + regionsOut[regionIdx].sizeCompressed - textureOffset;
+        }
+
+        if (tierIdx == 0)
+        {
+            metadata.resourceDesc = tier.resourceDesc;
+            metadata.compressionFormat = tier.compressionFormat;
+            metadata.resourceSizeCompressed = tier.resourceSizeCompressed;
+            metadata.resourceSizeUncompressed = tier.resourceSizeUncompressed;
+            metadata.resourceOffset = tier.resourceOffset;
+        }
+        else
+        {
+            metadata.reducedQualityTiers[tierIdx - 1] = tier;
+        }
+    }
+
+    return true;
+}
+
+// A texture stored as tiles of a reserved resource. The tile data is gathered from the laid out texture as it's written.
+struct TextureTileLayout
+{
+    DirectStorageSampleTextureTiles textureTiles; // Offsets and sizes are filled in per variant.
+    uint32_t tileWidthInElements;
+    uint32_t tileHeightInElements;
+    uint32_t elementByteCount; // Texels, or 4x4 blocks of block compressed textures.
+    std::vector<uint8_t> packedData;
+    std::vector<DirectStorageSampleTile> tiles; // Only mip and position, in the order they are written.
+};
+
+// Works out the standard tile shape of a 2D texture, which mips get their own tiles and lays out the packed mips.
+// Returns false if the texture can't be stored as tiles, it's then only stored the regular way.
+static bool BuildTextureTiles(ID3D12Device* const pDevice, const D3D12_RESOURCE_DESC& resourceDesc, const std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT>& subresourceFootprints, const std::vector<UINT>& subresourceRowsCount, const std::vector<UINT64>& subresourceRowByteCount, const std::vector<uint8_t>& textureData, TextureTileLayout& layoutOut)
+{
+    if (resourceDesc.Dimension != D3D12_RESOURCE_DIMENSION_TEXTURE2D || resourceDesc.DepthOrArraySize != 1)
+    {
+        return false;
+    }
+
+    // Standard tiles are 64KiB of elements in a shape that only depends on the element size.
+    const uint32_t blockSize = IsBlockCompressed(resourceDesc.Format) ? 4 : 1;
+    const uint64_t elementsWide = (resourceDesc.Width + blockSize - 1) / blockSize;
+    const uint32_t elementByteCount = static_cast<uint32_t>(subresourceRowByteCount[0] / elementsWide);
+    if (elementByteCount * elementsWide != subresourceRowByteCount[0])
+    {
+        return false;
+    }
+
+    uint32_t tileWidth = 0;
+    uint32_t tileHeight = 0;
+    switch (elementByteCount)
+    {
+    case 1: tileWidth = 256; tileHeight = 256; break;
+    case 2: tileWidth = 256; tileHeight = 128; break;
+    case 4: tileWidth = 128; tileHeight = 128; break;
+    case 8: tileWidth = 128; tileHeight = 64; break;
+    case 16: tileWidth = 64; tileHeight = 64; break;
+    default: return false;
+    }
+    assert(tileWidth * tileHeight * elementByteCount == D3D12_TILED_RESOURCE_TILE_SIZE_IN_BYTES);
+
+    // Mips at least a tile in both directions get their own tiles, the rest are packed together.
+    uint32_t standardMipCount = 0;
+    while (standardMipCount < resourceDesc.MipLevels
+        && max(resourceDesc.Width >> standardMipCount, 1ull) >= tileWidth * blockSize
+        && max(resourceDesc.Height >> standardMipCount, 1u) >= tileHeight * blockSize)
+    {
+        standardMipCount++;
+    }
+
+    if (standardMipCount == 0)
+    {
+        return false;
+    }
+
+    layoutOut = TextureTileLayout{};
+    layoutOut.textureTiles.tileWidth = tileWidth * blockSize;
+    layoutOut.textureTiles.tileHeight = tileHeight * blockSize;
+    layoutOut.textureTiles.standardMipCount = standardMipCount;
+    layoutOut.tileWidthInElements = tileWidth;
+    layoutOut.tileHeightInElements = tileHeight;
+    layoutOut.elementByteCount = elementByteCount;
+
+    // The packed mips are read in one request, laid out like the runtime's footprints of those subresources.
+    const UINT packedMipCount = resourceDesc.MipLevels - standardMipCount;
+    if (packedMipCount > 0)
+    {
+        std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT> packedFootprints(packedMipCount);
+        std::vector<UINT> packedRowsCount(packedMipCount);
+        std::vector<UINT64> packedRowByteCount(packedMipCount);
+        UINT64 packedTotalByteCount = 0;
+        pDevice->GetCopyableFootprints(&resourceDesc
+            , standardMipCount, packedMipCount
+            , 0, &packedFootprints[0]
+            , &packedRowsCount[0]
+            , &packedRowByteCount[0]
+            , &packedTotalByteCount);
+
+        layoutOut.packedData.assign(packedTotalByteCount, 0);
+        for (UINT packedMip = 0; packedMip < packedMipCount; packedMip++)
+        {
+            const auto& dstFootprint = packedFootprints[packedMip];
+            const auto& srcFootprint = subresourceFootprints[standardMipCount + packedMip];
+            for (UINT row = 0; row < packedRowsCount[packedMip]; row++)
+            {
+                memcpy(layoutOut.packedData.data() + dstFootprint.Offset + row * dstFootprint.Footprint.RowPitch
+                    , textureData.data() + srcFootprint.Offset + row * srcFootprint.Footprint.RowPitch
+                    , packedRowByteCount[packedMip]);
+            }
+        }
+    }
+
+    // Smallest mip first, so what gets streamed in first is close together in the file.
+    for (uint32_t mip = standardMipCount; mip-- > 0;)
+    {
+        const uint32_t mipElementsWide = static_cast<uint32_t>(subresourceRowByteCount[mip] / elementByteCount);
+        const uint32_t tilesWide = (mipElementsWide + tileWidth - 1) / tileWidth;
+        const uint32_t tilesHigh = (subresourceRowsCount[mip] + tileHeight - 1) / tileHeight;
+        for (uint32_t y = 0; y < tilesHigh; y++)
+        {
+            for (uint32_t x = 0; x < tilesWide; x++)
+            {
+                DirectStorageSampleTile tile{};
+                tile.mipLevel = mip;
+                tile.x = x;
+                tile.y = y;
+                layoutOut.tiles.push_back(tile);
+            }
+        }
+    }
+
+    return true;
+}
+
+// Copies one tile out of the laid out texture, rows of the tile are packed and whatever is past the edge of the mip is zero.
+static void GatherTileData(const TextureTileLayout& layout, const DirectStorageSampleTile& tile, const std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT>& subresourceFootprints, const std::vector<UINT>& subresourceRowsCount, const std::vector<UINT64>& subresourceRowByteCount, const std::vector<uint8_t>& textureData, std::vector<uint8_t>& tileDataOut)
+{
+    tileDataOut.assign(D3D12_TILED_RESOURCE_TILE_SIZE_IN_BYTES, 0);
+
+    const auto& footprint = subresourceFootprints[tile.mipLevel];
+    const uint64_t tileRowByteCount = static_cast<uint64_t>(layout.tileWidthInElements) * layout.elementByteCount;
+    const uint64_t srcColumnOffset = tile.x * tileRowByteCount;
+    const uint64_t copyByteCount = min(tileRowByteCount, subresourceRowByteCount[tile.mipLevel] - srcColumnOffset);
+    for (uint32_t row = 0; row < layout.tileHeightInElements; row++)
+    {
+        const uint32_t srcRow = tile.y * layout.tileHeightInElements + row;
+        if (srcRow >= subresourceRowsCount[tile.mipLevel])
+        {
+            break;
+        }
+
+        memcpy(tileDataOut.data() + row * tileRowByteCount
+            , textureData.data() + footprint.Offset + srcRow * footprint.Footprint.RowPitch + srcColumnOffset
+            , copyByteCount);
+    }
+}
+
+// Compresses and writes the packed mips and every tile of a texture after its regular data, then pads so the next texture starts aligned.
+static bool WriteTextureTiles(const PackageVariant& variant, const std::wstring& imagePath, const TextureTileLayout& layout, const std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT>& subresourceFootprints, const std::vector<UINT>& subresourceRowsCount, const std::vector<UINT64>& subresourceRowByteCount, const std::vector<uint8_t>& textureData, PackageWriter& texturedataWriter, DirectStorageSampleTextureTiles& textureTilesOut, std::vector<DirectStorageSampleTile>& tilesOut, uint64_t* compressedBytesOut, double* compressMsOut, double* writeMsOut)
 {
+    textureTilesOut = layout.textureTiles;
+    textureTilesOut.firstTile = static_cast<uint32_t>(tilesOut.size());
+    textureTilesOut.tileCount = static_cast<uint32_t>(layout.tiles.size());
+    *compressedBytesOut = 0;
+    *compressMsOut = 0.0;
+    *writeMsOut = 0.0;
+
+    // Compresses and appends one piece, returns its offset or -1.
+    auto writePiece = [&](const std::vector<uint8_t>& data, DSTORAGE_COMPRESSION_FORMAT* compressionFormatOut, uint32_t* sizeCompressedOut) -> int64_t
+    {
+        std::vector<uint8_t> gpuData;
+        const uint8_t* gpuDataPtr = nullptr;
+        DSTORAGE_COMPRESSION compressionLevel = DSTORAGE_COMPRESSION_DEFAULT;
+        const auto compressStart = std::chrono::steady_clock::now();
+        const int64_t gpuDataSize = CompressForVariant(variant, imagePath, data, gpuData, &gpuDataPtr, compressionFormatOut, &compressionLevel);
+        if (gpuDataSize == -1)
+        {
+            return -1;
+        }
+        *compressMsOut += MillisecondsSince(compressStart);
+
+        const auto writeStart = std::chrono::steady_clock::now();
+        const int64_t offset = texturedataWriter.Write(gpuDataPtr, gpuDataSize);
+        *writeMsOut += MillisecondsSince(writeStart);
+        *sizeCompressedOut = static_cast<uint32_t>(gpuDataSize);
+        *compressedBytesOut += gpuDataSize;
+        return offset;
+    };
+
+    if (!layout.packedData.empty())
+    {
+        textureTilesOut.packedSizeUncompressed = static_cast<uint32_t>(layout.packedData.size());
+        textureTilesOut.packedOffset = writePiece(layout.packedData, &textureTilesOut.packedCompressionFormat, &textureTilesOut.packedSizeCompressed);
+        if (textureTilesOut.packedOffset == -1)
+        {
+            std::wcerr << "Failed to write texture tiles: " << imagePath << std::endl;
+            return false;
+        }
+    }
+
+    std::vector<uint8_t> tileData;
+    for (const auto& layoutTile : layout.tiles)
+    {
+        GatherTileData(layout, layoutTile, subresourceFootprints, subresourceRowsCount, subresourceRowByteCount, textureData, tileData);
+
+        DirectStorageSampleTile tile = layoutTile;
+        tile.offset = writePiece(tileData, &tile.compressionFormat, &tile.sizeCompressed);
+        if (tile.offset == -1)
+        {
+            std::wcerr << "Failed to write texture tiles: " << imagePath << std::endl;
+            return false;
+        }
+        tilesOut.push_back(tile);
+    }
+
+    if (texturedataWriter.WriteAligned(nullptr, 0) == -1)
+    {
+        std::wcerr << "Failed to write texture tiles: " << imagePath << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+
+// Sums up a package's texture entries and moves it into the report.
+static void AppendPackageReport(nlohmann::json& packageReport, double closeMs, nlohmann::json& report)
+{
+    uint64_t textureCount = 0;
+    uint64_t rawBytes = 0;
+    uint64_t compressedBytes = 0;
+    uint64_t paddingBytes = 0;
+    uint64_t tileCompressedBytes = 0;
+    double decodeMs = 0.0;
+    double layoutMs = 0.0;
+    double compressMs = 0.0;
+    double writeMs = closeMs;
+    for (const auto& textureReport : packageReport["textures"])
+    {
+        textureCount += textureReport["qualityTier"].get<size_t>() == 0 ? 1 : 0;
+        rawBytes += textureReport["rawBytes"].get<uint64_t>();
+        compressedBytes += textureReport["compressedBytes"].get<uint64_t>();
+        paddingBytes += textureReport["paddingBytes"].get<uint64_t>();
+        tileCompressedBytes += textureReport.value("tileCompressedBytes", 0ull);
+        decodeMs += textureReport["decodeMs"].get<double>();
+        layoutMs += textureReport["layoutMs"].get<double>();
+        compressMs += textureReport["compressMs"].get<double>();
+        writeMs += textureReport["writeMs"].get<double>();
+    }
+
+    auto& totals = packageReport["totals"];
+    totals["textureCount"] = textureCount;
+    totals["rawBytes"] = rawBytes;
+    totals["compressedBytes"] = compressedBytes;
+    totals["paddingBytes"] = paddingBytes;
+    totals["tileCompressedBytes"] = tileCompressedBytes;
+    totals["compressionRatio"] = compressedBytes > 0 ? rawBytes / (double)compressedBytes : 0.0;
+    totals["decodeMs"] = decodeMs;
+    totals["layoutMs"] = layoutMs;
+    totals["compressMs"] = compressMs;
+    totals["writeMs"] = writeMs;
+    totals["compressThroughputMiBps"] = compressMs > 0.0 ? rawBytes / 1024.0 / 1024.0 / (compressMs / 1000.0) : 0.0;
+    totals["writeThroughputMiBps"] = writeMs > 0.0 ? (compressedBytes + paddingBytes) / 1024.0 / 1024.0 / (writeMs / 1000.0) : 0.0;
+
+    report["packages"].push_back(std::move(packageReport));
+}
+
+bool ConvertImages(ID3D12Device* const pDevice, const std::wstring& gltfPath, const std::vector<std::wstring>& imageList, const std::vector<PackageVariant>& variants, uint32_t reducedQualityTierCount, bool textureRegions, bool textureTiles, nlohmann::json* pReport, std::vector<PackageManifestEntry>& packagesOut)
+{
+    packagesOut.resize(variants.size());
+
+    // One pair of files per variant.
+    std::vector<PackageWriter> metadataWriters(variants.size());
+    std::vector<PackageWriter> texturedataWriters(variants.size());
+
+    // Quality tier descs of every texture written, in metadata order. Used for the placement tables.
+    std::vector<std::vector<D3D12_RESOURCE_DESC>> writtenTierResourceDescs;
+
+    // Region tables per variant, offsets differ between variants.
+    std::vector<std::vector<DirectStorageSampleTextureRegionRange>> regionRanges(variants.size());
+    std::vector<std::vector<DirectStorageSampleTextureRegion>> regions(variants.size());
+
+    // Same for the tile tables.
+    std::vector<std::vector<DirectStorageSampleTextureTiles>> textureTileRanges(variants.size());
+    std::vector<std::vector<DirectStorageSampleTile>> tiles(variants.size());
 
-    HANDLE metadataFileHandle = INVALID_HANDLE_VALUE;
-    HANDLE texturedataFileHandle = INVALID_HANDLE_VALUE;
+    std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>, wchar_t> utf8Converter;
+
+    // One report per package, filled in as textures are written.
+    std::vector<nlohmann::json> packageReports(variants.size());
+    for (size_t variantIdx = 0; variantIdx < variants.size(); variantIdx++)
+    {
+        packageReports[variantIdx]["gltf"] = utf8Converter.to_bytes(gltfPath);
+        packageReports[variantIdx]["variant"] = utf8Converter.to_bytes(variants[variantIdx].name);
+        packageReports[variantIdx]["textures"] = nlohmann::json::array();
+    }
+
+    // Keep what was converted so far in the report when bailing, that is when it is needed most.
+    const auto failConversion = [&]()
+    {
+        if (pReport != nullptr)
+        {
+            for (auto& packageReport : packageReports)
+            {
+                packageReport["failed"] = true;
+                AppendPackageReport(packageReport, 0.0, *pReport);
+            }
+        }
+        return false;
+    };
 
     ImgLoader* imgLoader = nullptr;
 
@@ -415,6 +1161,8 @@ bool ConvertImages(ID3D12Device* const pDevice, const std::wstring& gltfPath, co
 
         IMG_INFO info;
 
+        const auto decodeStart = std::chrono::steady_clock::now();
+
         // Read in image file.
         std::wstring upperCaseImageName(gltfRelativeImagePath);
         std::transform(gltfRelativeImagePath.begin(), gltfRelativeImagePath.end(), upperCaseImageName.begin(), [](const wchar_t& a) { return std::toupper(a); });
@@ -439,6 +1187,9 @@ bool ConvertImages(ID3D12Device* const pDevice, const std::wstring& gltfPath, co
             continue;
         }
 
+        const double decodeMs = MillisecondsSince(decodeStart);
+        const auto layoutStart = std::chrono::steady_clock::now();
+
         // Create resource desc.
         UINT subresourceCount = max(info.arraySize, info.depth) * info.mipMapCount;
         D3D12_RESOURCE_DESC resourceDesc{};
@@ -494,82 +1245,358 @@ bool ConvertImages(ID3D12Device* const pDevice, const std::wstring& gltfPath, co
             }
         }
 
-        // Create required files.
-        if (!CreateFileOnDisk((std::wstring(gltfPathWithoutFilename.data()) + (L"MetaData.bin")).c_str(), &metadataFileHandle))
+        // Build the reduced quality tiers from the mips laid out above.
+        std::vector<D3D12_RESOURCE_DESC> tierResourceDescs{ resourceDesc };
+        std::vector<std::vector<uint8_t>> tierTextureData(1);
+        tierTextureData[0] = std::move(textureData);
+        for (uint32_t droppedMips = 1; droppedMips <= reducedQualityTierCount; droppedMips++)
         {
-            return false;
+            D3D12_RESOURCE_DESC tierResourceDesc{};
+            std::vector<uint8_t> tierData;
+            if (!BuildQualityTier(pDevice, resourceDesc, subresourceFootprints, tierTextureData[0], droppedMips, &tierResourceDesc, tierData))
+            {
+                // Too few mips left, smaller tiers will not work either.
+                break;
+            }
+
+            tierResourceDescs.push_back(tierResourceDesc);
+            tierTextureData.push_back(std::move(tierData));
         }
 
-        if (!CreateFileOnDisk((std::wstring(gltfPathWithoutFilename.data()) + (L"TextureData.bin")).c_str(), &texturedataFileHandle))
+        std::vector<TextureRegionSource> regionSources;
+        if (textureRegions)
         {
-            return false;
+            regionSources = BuildTextureRegions(resourceDesc, subresourceFootprints, subresourceRowsCount, subresourceRowByteCount);
         }
 
+        TextureTileLayout tileLayout{};
+        const bool isTiled = textureTiles && BuildTextureTiles(pDevice, resourceDesc, subresourceFootprints, subresourceRowsCount, subresourceRowByteCount, tierTextureData[0], tileLayout);
 
-        std::vector<uint8_t> gpuData;
-        int64_t gpuDataSize = -1;
-        if (compressionExhaustive)
-        {
-            gpuDataSize = CompressExhaustive(gpuData, textureData, &compressionFormat);
-        }
-        else if (compressionFormat != DSTORAGE_COMPRESSION_FORMAT_NONE)
+        const double layoutMs = MillisecondsSince(layoutStart);
+
+        // Compress and write the same texture data once per variant.
+        for (size_t variantIdx = 0; variantIdx < variants.size(); variantIdx++)
         {
-            // compression enabled.
-            gpuData.resize(textureData.size());
-            gpuDataSize = Compress(compressionFormat, compressionLevel, gpuData, textureData);
-            if (gpuDataSize == -1)
+            const auto& variant = variants[variantIdx];
+            auto& metadataWriter = metadataWriters[variantIdx];
+            auto& texturedataWriter = texturedataWriters[variantIdx];
+
+            // Create required files.
+            if (!metadataWriter.Open((std::wstring(gltfPathWithoutFilename.data()) + GetMetaDataFileName(variant.name)).c_str()))
             {
-                std::wcerr << "Failed to compress image: " << gltfRelativeImagePath << std::endl;
-                return false;
+                return failConversion();
+            }
+
+            if (!texturedataWriter.Open((std::wstring(gltfPathWithoutFilename.data()) + GetTextureDataFileName(variant.name)).c_str()))
+            {
+                return failConversion();
             }
 
-            if (textureData.size() <= gpuDataSize)
+            // Assemble metadata. Cleared including padding so packages are byte for byte reproducible.
+            DirectStorageSampleTextureMetadataHeader metadata;
+            memset(&metadata, 0, sizeof(metadata));
+            wcsncpy(metadata.resourceName, gltfRelativeImagePath.c_str(), std::extent_v<decltype(metadata.resourceName)> - 1);
+            metadata.resourceName[std::extent_v<decltype(metadata.resourceName)> - 1] = '\0'; // ensure truncation.
+            metadata.qualityTierCount = static_cast<uint32_t>(tierTextureData.size());
+            const size_t firstTextureReport = pReport != nullptr ? packageReports[variantIdx]["textures"].size() : 0;
+
+            if (textureRegions)
+            {
+                DirectStorageSampleTextureRegionRange range{ static_cast<uint32_t>(regions[variantIdx].size()), static_cast<uint32_t>(regionSources.size()) };
+                double compressMs = 0.0;
+                double writeMs = 0.0;
+                if (!WriteTextureRegions(variant, gltfRelativeImagePath, tierResourceDescs, tierTextureData, regionSources, texturedataWriter, metadata, regions[variantIdx], &compressMs, &writeMs))
+                {
+                    return failConversion();
+                }
+                regionRanges[variantIdx].push_back(range);
+
+                if (pReport != nullptr)
+                {
+                    // The tiers share the regions, so the texture is listed once.
+                    nlohmann::json textureReport;
+                    textureReport["name"] = utf8Converter.to_bytes(imageName);
+                    textureReport["qualityTier"] = 0;
+                    textureReport["qualityTierCount"] = metadata.qualityTierCount;
+                    textureReport["regionCount"] = range.regionCount;
+                    textureReport["width"] = metadata.resourceDesc.Width;
+                    textureReport["height"] = metadata.resourceDesc.Height;
+                    textureReport["depthOrArraySize"] = metadata.resourceDesc.DepthOrArraySize;
+                    textureReport["mipLevels"] = metadata.resourceDesc.MipLevels;
+                    textureReport["dxgiFormat"] = static_cast<uint32_t>(metadata.resourceDesc.Format);
+                    textureReport["rawBytes"] = metadata.resourceSizeUncompressed;
+                    textureReport["compressedBytes"] = metadata.resourceSizeCompressed;
+                    textureReport["paddingBytes"] = ((metadata.resourceSizeCompressed + 4095) / 4096) * 4096 - metadata.resourceSizeCompressed;
+                    textureReport["compressionFormat"] = utf8Converter.to_bytes(TranslateCompressionFormatToString(metadata.compressionFormat));
+                    textureReport["compressionLevel"] = "";
+                    textureReport["decodeMs"] = variantIdx == 0 ? decodeMs : 0.0;
+                    textureReport["layoutMs"] = variantIdx == 0 ? layoutMs : 0.0;
+                    textureReport["compressMs"] = compressMs;
+                    textureReport["writeMs"] = writeMs;
+                    packageReports[variantIdx]["textures"].push_back(std::move(textureReport));
+                }
+            }
+
+            else
             {
-                // Turns out compression didn't help us at all. TODO: Determine threshold at which compression should be disabled.
-                std::wcout << "Compression ineffective for " << gltfRelativeImagePath << std::endl;
+                for (size_t tierIdx = 0; tierIdx < tierTextureData.size(); tierIdx++)
+                {
+                    std::vector<uint8_t> gpuData;
+                    const uint8_t* gpuDataPtr = nullptr;
+                    DSTORAGE_COMPRESSION_FORMAT compressionFormat = DSTORAGE_COMPRESSION_FORMAT_NONE;
+                    DSTORAGE_COMPRESSION compressionLevel = DSTORAGE_COMPRESSION_DEFAULT;
+                    const auto compressStart = std::chrono::steady_clock::now();
+                    int64_t gpuDataSize = CompressForVariant(variant, gltfRelativeImagePath, tierTextureData[tierIdx], gpuData, &gpuDataPtr, &compressionFormat, &compressionLevel);
+                    if (gpuDataSize == -1)
+                    {
+                        return failConversion();
+                    }
+                    const double compressMs = MillisecondsSince(compressStart);
+
+                    DirectStorageSampleTextureQualityTier tier{};
+                    tier.resourceDesc = tierResourceDescs[tierIdx];
+                    tier.compressionFormat = compressionFormat;
+                    tier.resourceSizeCompressed = gpuDataSize; // will be same as uncompressed size without compression.
+                    tier.resourceSizeUncompressed = tierTextureData[tierIdx].size();
+                    const auto writeStart = std::chrono::steady_clock::now();
+                    tier.resourceOffset = texturedataWriter.WriteAligned(gpuDataPtr, gpuDataSize);
+                    if (tier.resourceOffset == -1)
+                    {
+                        std::wcerr << "Failed to write texture data: " << gltfRelativeImagePath << std::endl;
+                        return failConversion();
+                    }
+                    assert((tier.resourceOffset % 4096) == 0);
+                    const double writeMs = MillisecondsSince(writeStart);
+
+                    if (pReport != nullptr)
+                    {
+                        // Decoding and layout happen once per texture, so they are only listed with the full quality tier of the first variant.
+                        nlohmann::json textureReport;
+                        textureReport["name"] = utf8Converter.to_bytes(imageName);
+                        textureReport["qualityTier"] = tierIdx;
+                        textureReport["width"] = tier.resourceDesc.Width;
+                        textureReport["height"] = tier.resourceDesc.Height;
+                        textureReport["depthOrArraySize"] = tier.resourceDesc.DepthOrArraySize;
+                        textureReport["mipLevels"] = tier.resourceDesc.MipLevels;
+                        textureReport["dxgiFormat"] = static_cast<uint32_t>(tier.resourceDesc.Format);
+                        textureReport["rawBytes"] = tier.resourceSizeUncompressed;
+                        textureReport["compressedBytes"] = tier.resourceSizeCompressed;
+                        textureReport["paddingBytes"] = ((gpuDataSize + 4095) / 4096) * 4096 - gpuDataSize;
+                        textureReport["compressionFormat"] = utf8Converter.to_bytes(TranslateCompressionFormatToString(compressionFormat));
+                        textureReport["compressionLevel"] = compressionFormat == DSTORAGE_COMPRESSION_FORMAT_NONE ? std::string("") : utf8Converter.to_bytes(TranslateCompressionLevelToStringGDeflate(compressionLevel));
+                        textureReport["decodeMs"] = tierIdx == 0 && variantIdx == 0 ? decodeMs : 0.0;
+                        textureReport["layoutMs"] = tierIdx == 0 && variantIdx == 0 ? layoutMs : 0.0;
+                        textureReport["compressMs"] = compressMs;
+                        textureReport["writeMs"] = writeMs;
+                        packageReports[variantIdx]["textures"].push_back(std::move(textureReport));
+                    }
+
+                    if (tierIdx == 0)
+                    {
+                        metadata.resourceDesc = tier.resourceDesc;
+                        metadata.compressionFormat = tier.compressionFormat;
+                        metadata.resourceSizeCompressed = tier.resourceSizeCompressed;
+                        metadata.resourceSizeUncompressed = tier.resourceSizeUncompressed;
+                        metadata.resourceOffset = tier.resourceOffset;
+                    }
+                    else
+                    {
+                        metadata.reducedQualityTiers[tierIdx - 1] = tier;
+                    }
+                }
+            }
+
+            // The tiles follow the texture's regular data, textures that can't be tiled still get an entry.
+            if (textureTiles)
+            {
+                DirectStorageSampleTextureTiles textureTileRange{};
+                uint64_t tileBytes = 0;
+                double compressMs = 0.0;
+                double writeMs = 0.0;
+                if (isTiled && !WriteTextureTiles(variant, gltfRelativeImagePath, tileLayout, subresourceFootprints, subresourceRowsCount, subresourceRowByteCount, tierTextureData[0], texturedataWriter, textureTileRange, tiles[variantIdx], &tileBytes, &compressMs, &writeMs))
+                {
+                    return failConversion();
+                }
+                textureTileRanges[variantIdx].push_back(textureTileRange);
+
+                if (pReport != nullptr)
+                {
+                    auto& textureReport = packageReports[variantIdx]["textures"][firstTextureReport];
+                    textureReport["tileCount"] = textureTileRange.tileCount;
+                    textureReport["tileCompressedBytes"] = tileBytes;
+                    textureReport["compressMs"] = textureReport["compressMs"].get<double>() + compressMs;
+                    textureReport["writeMs"] = textureReport["writeMs"].get<double>() + writeMs;
+                }
+            }
+
+            // Write CPU Data.
+            if (metadataWriter.Write(&metadata, sizeof(metadata)) == -1)
+            {
+                std::wcerr << "Failed to write metadata: " << gltfRelativeImagePath << std::endl;
+                return failConversion();
             }
         }
-        else
+
+        writtenTierResourceDescs.push_back(tierResourceDescs);
+
+        delete imgLoader;
+    }
+
+    // Precompute heap placement on this adapter, the runtime only recomputes it if it is running on something else.
+    if (!writtenTierResourceDescs.empty())
+    {
+        DirectStorageSamplePlacementHeader placementHeader;
+        memset(&placementHeader, 0, sizeof(placementHeader));
+        placementHeader.version = c_DirectStorageSamplePlacementVersion;
+        placementHeader.textureCount = static_cast<uint32_t>(writtenTierResourceDescs.size());
+        placementHeader.adapterKey = GetPlacementAdapterKey(pDevice);
+        for (const auto& tierResourceDescs : writtenTierResourceDescs)
         {
-            // no compression... avoiding allocation.
-            gpuData = std::move(textureData);
-            gpuDataSize = gpuData.size();
-            if (gpuDataSize == 0)
+            placementHeader.qualityTierCount = max(placementHeader.qualityTierCount, static_cast<uint32_t>(tierResourceDescs.size()));
+        }
+
+        std::vector<DirectStorageSampleTexturePlacement> placements;
+        placements.reserve(placementHeader.qualityTierCount * placementHeader.textureCount);
+        for (uint32_t qualityTier = 0; qualityTier < placementHeader.qualityTierCount; qualityTier++)
+        {
+            // Textures with fewer tiers use their smallest one, same as the runtime.
+            std::vector<D3D12_RESOURCE_DESC> resourceDescs(writtenTierResourceDescs.size());
+            for (size_t resourceIdx = 0; resourceIdx < resourceDescs.size(); resourceIdx++)
             {
-                return false;
+                const auto& tierResourceDescs = writtenTierResourceDescs[resourceIdx];
+                resourceDescs[resourceIdx] = tierResourceDescs[min(static_cast<size_t>(qualityTier), tierResourceDescs.size() - 1)];
             }
+
+            std::vector<DirectStorageSampleTexturePlacement> tierPlacements;
+            const auto heapAllocInfo = ComputeHeapPlacement(pDevice, resourceDescs, tierPlacements);
+            placementHeader.heapSize[qualityTier] = heapAllocInfo.SizeInBytes;
+            placementHeader.heapAlignment[qualityTier] = heapAllocInfo.Alignment;
+            placements.insert(placements.end(), tierPlacements.cbegin(), tierPlacements.cend());
         }
 
-        // Write GPU Data and obtain offset to data.
-        int64_t textureDataOffsetOnDisk = WriteDataToDisk(texturedataFileHandle, gpuData.data(), gpuDataSize);
-        
-        // Assemble metadata.
-        DirectStorageSampleTextureMetadataHeader metadata;
-        metadata.resourceDesc = resourceDesc;
-        metadata.resourceSizeCompressed = gpuDataSize; // will be same as uncompressed size without compression.
-        metadata.resourceSizeUncompressed = subresourceTotalByteCount;
-        metadata.compressionFormat = compressionFormat;
-        wcsncpy(metadata.resourceName, gltfRelativeImagePath.c_str(), std::extent_v<decltype(metadata.resourceName)> - 1);
-        metadata.resourceName[std::extent_v<decltype(metadata.resourceName)> - 1] = '\0'; // ensure truncation.
-        metadata.resourceOffset = textureDataOffsetOnDisk;
-        assert((textureDataOffsetOnDisk % 4096) == 0);
-
-        // Write CPU Data.
-        WriteDataToDisk(metadataFileHandle, &metadata, sizeof(metadata));
-
-        // Align next write for Texture data.
-
-        // now align the data..
-        int64_t unalignedOffset = WriteDataToDisk(texturedataFileHandle, nullptr, 0);
-        char zeroData[4096];
-        int64_t dataAlignmentBytes = ((unalignedOffset + 4095) & (~4096 + 1))- unalignedOffset;
-        (void)WriteDataToDisk(texturedataFileHandle, zeroData, dataAlignmentBytes);
+        for (size_t variantIdx = 0; variantIdx < variants.size(); variantIdx++)
+        {
+            PackageWriter placementWriter;
+            auto& placementInfo = packagesOut[variantIdx].placement;
+            placementInfo.Name = std::wstring(gltfPathWithoutFilename.data()) + GetPlacementFileName(variants[variantIdx].name);
+            if (!placementWriter.Open(placementInfo.Name.c_str())
+                || placementWriter.Write(&placementHeader, sizeof(placementHeader)) == -1
+                || placementWriter.Write(placements.data(), placements.size() * sizeof(DirectStorageSampleTexturePlacement)) == -1)
+            {
+                std::wcerr << "Failed to write placement table for: " << gltfPath << std::endl;
+                return failConversion();
+            }
 
-        delete imgLoader;
+            placementInfo.Size = placementWriter.GetSize();
+            packagesOut[variantIdx].textureHeapSizes.assign(placementHeader.heapSize, placementHeader.heapSize + placementHeader.qualityTierCount);
+            if (!placementWriter.Close())
+            {
+                std::wcerr << "Failed to write placement table for: " << gltfPath << std::endl;
+                return failConversion();
+            }
+        }
     }
 
-    CloseHandle(metadataFileHandle);
-    CloseHandle(texturedataFileHandle);
+    for (size_t variantIdx = 0; variantIdx < variants.size(); variantIdx++)
+    {
+        const std::wstring regionFileName = std::wstring(gltfPathWithoutFilename.data()) + GetRegionFileName(variants[variantIdx].name);
+        if (!textureRegions || writtenTierResourceDescs.empty())
+        {
+            // Don't leave a table from an earlier conversion next to a package that has no regions.
+            DeleteFileW(regionFileName.c_str());
+            continue;
+        }
 
-    return true;
+        DirectStorageSampleRegionHeader regionHeader;
+        memset(&regionHeader, 0, sizeof(regionHeader));
+        regionHeader.version = c_DirectStorageSampleRegionVersion;
+        regionHeader.textureCount = static_cast<uint32_t>(regionRanges[variantIdx].size());
+        regionHeader.textureDataSize = texturedataWriters[variantIdx].GetSize();
+
+        PackageWriter regionWriter;
+        auto& regionInfo = packagesOut[variantIdx].regions;
+        regionInfo.Name = regionFileName;
+        if (!regionWriter.Open(regionInfo.Name.c_str())
+            || regionWriter.Write(&regionHeader, sizeof(regionHeader)) == -1
+            || regionWriter.Write(regionRanges[variantIdx].data(), regionRanges[variantIdx].size() * sizeof(DirectStorageSampleTextureRegionRange)) == -1
+            || regionWriter.Write(regions[variantIdx].data(), regions[variantIdx].size() * sizeof(DirectStorageSampleTextureRegion)) == -1)
+        {
+            std::wcerr << "Failed to write region table for: " << gltfPath << std::endl;
+            return failConversion();
+        }
+
+        regionInfo.Size = regionWriter.GetSize();
+        if (!regionWriter.Close())
+        {
+            std::wcerr << "Failed to write region table for: " << gltfPath << std::endl;
+            return failConversion();
+        }
+    }
+
+    for (size_t variantIdx = 0; variantIdx < variants.size(); variantIdx++)
+    {
+        const std::wstring tileFileName = std::wstring(gltfPathWithoutFilename.data()) + GetTileFileName(variants[variantIdx].name);
+        if (!textureTiles || writtenTierResourceDescs.empty())
+        {
+            // Don't leave a table from an earlier conversion next to a package that has no tiles.
+            DeleteFileW(tileFileName.c_str());
+            continue;
+        }
+
+        DirectStorageSampleTileHeader tileHeader;
+        memset(&tileHeader, 0, sizeof(tileHeader));
+        tileHeader.version = c_DirectStorageSampleTileVersion;
+        tileHeader.textureCount = static_cast<uint32_t>(textureTileRanges[variantIdx].size());
+        tileHeader.textureDataSize = texturedataWriters[variantIdx].GetSize();
+
+        PackageWriter tileWriter;
+        auto& tileInfo = packagesOut[variantIdx].tiles;
+        tileInfo.Name = tileFileName;
+        if (!tileWriter.Open(tileInfo.Name.c_str())
+            || tileWriter.Write(&tileHeader, sizeof(tileHeader)) == -1
+            || tileWriter.Write(textureTileRanges[variantIdx].data(), textureTileRanges[variantIdx].size() * sizeof(DirectStorageSampleTextureTiles)) == -1
+            || tileWriter.Write(tiles[variantIdx].data(), tiles[variantIdx].size() * sizeof(DirectStorageSampleTile)) == -1)
+        {
+            std::wcerr << "Failed to write tile table for: " << gltfPath << std::endl;
+            return failConversion();
+        }
+
+        tileInfo.Size = tileWriter.GetSize();
+        if (!tileWriter.Close())
+        {
+            std::wcerr << "Failed to write tile table for: " << gltfPath << std::endl;
+            return failConversion();
+        }
+    }
+
+    bool allWritten = true;
+    for (size_t variantIdx = 0; variantIdx < variants.size(); variantIdx++)
+    {
+        // Closing flushes whatever is still staged, count it as write time.
+        const auto closeStart = std::chrono::steady_clock::now();
+        if (metadataWriters[variantIdx].IsOpen())
+        {
+            packagesOut[variantIdx].metaData = { std::wstring(gltfPathWithoutFilename.data()) + GetMetaDataFileName(variants[variantIdx].name), metadataWriters[variantIdx].GetSize() };
+            allWritten = metadataWriters[variantIdx].Close() && allWritten;
+        }
+
+        if (texturedataWriters[variantIdx].IsOpen())
+        {
+            packagesOut[variantIdx].textureData = { std::wstring(gltfPathWithoutFilename.data()) + GetTextureDataFileName(variants[variantIdx].name), texturedataWriters[variantIdx].GetSize() };
+            allWritten = texturedataWriters[variantIdx].Close() && allWritten;
+        }
+        const double closeMs = MillisecondsSince(closeStart);
+
+        if (pReport != nullptr)
+        {
+            AppendPackageReport(packageReports[variantIdx], closeMs, *pReport);
+        }
+    }
+
+    if (!allWritten)
+    {
+        std::wcerr << "Failed to finish writing packages for: " << gltfPath << std::endl;
+    }
+
+    return allWritten;
 }